@@ -34,6 +34,8 @@ HEADER_CLASSES += ../include/TLoggerPlugin
 HEADER_CLASSES += ../include/TStdOutLogger
 HEADER_CLASSES += ../include/TMailMessage
 HEADER_CLASSES += ../include/TModelUtil
+HEADER_CLASSES += ../include/TModelEncoder
+HEADER_CLASSES += ../include/TModelDecoder
 HEADER_CLASSES += ../include/TMultipartFormData
 HEADER_CLASSES += ../include/TOption
 HEADER_CLASSES += ../include/TSession
@@ -71,6 +73,7 @@ HEADER_CLASSES += ../include/TAccessLog
 HEADER_CLASSES += ../include/TActionWorker
 HEADER_CLASSES += ../include/TAtomicQueue
 HEADER_CLASSES += ../include/TJsonUtil
+HEADER_CLASSES += ../include/TJsonWriter
 HEADER_CLASSES += ../include/TJobScheduler
 HEADER_CLASSES += ../include/TCommandLineInterface
 HEADER_CLASSES += ../include/TSendmailMailer
@@ -88,6 +91,7 @@ HEADER_CLASSES += ../include/TDebug
 HEADER_CLASSES += ../include/TBackgroundProcess
 HEADER_CLASSES += ../include/TBackgroundProcessHandler
 HEADER_CLASSES += ../include/TCache
+HEADER_CLASSES += ../include/TFragmentCache
 HEADER_CLASSES += ../include/THttpClient
 HEADER_CLASSES += ../include/TOAuth2Client
 HEADER_CLASSES += ../include/TUrlRoute
@@ -139,6 +143,8 @@ HEADER_FILES += tloggerplugin.h
 HEADER_FILES += tstdoutlogger.h
 HEADER_FILES += tmailmessage.h
 HEADER_FILES += tmodelutil.h
+HEADER_FILES += tmodelencoder.h
+HEADER_FILES += tmodeldecoder.h
 HEADER_FILES += tmultipartformdata.h
 HEADER_FILES += toption.h
 HEADER_FILES += tsession.h
@@ -171,6 +177,7 @@ HEADER_FILES += taccesslog.h
 HEADER_FILES += tactionworker.h
 HEADER_FILES += tatomicqueue.h
 HEADER_FILES += tjsonutil.h
+HEADER_FILES += tjsonwriter.h
 HEADER_FILES += tjobscheduler.h
 HEADER_FILES += tcommandlineinterface.h
 HEADER_FILES += tsendmailmailer.h
@@ -190,6 +197,8 @@ HEADER_FILES += tdebug.h
 HEADER_FILES += tbackgroundprocess.h
 HEADER_FILES += tbackgroundprocesshandler.h
 HEADER_FILES += tcache.h
+HEADER_FILES += tfragmentcache.h
+HEADER_FILES += tmetrics.h
 HEADER_FILES += thttpclient.h
 HEADER_FILES += toauth2client.h
 HEADER_FILES += turlroute.h
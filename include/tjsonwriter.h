@@ -0,0 +1 @@
+#include "../src/tjsonwriter.h"
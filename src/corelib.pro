@@ -117,6 +117,8 @@ HEADERS += tdatabasecontext.h
 SOURCES += tdatabasecontext.cpp
 HEADERS += tactionthread.h
 SOURCES += tactionthread.cpp
+HEADERS += tactionthreadpool.h
+SOURCES += tactionthreadpool.cpp
 HEADERS += thttpsocket.h
 SOURCES += thttpsocket.cpp
 HEADERS += thttpclient.h
@@ -127,6 +129,8 @@ HEADERS += tabstractcontroller.h
 SOURCES += tabstractcontroller.cpp
 HEADERS += tactioncontroller.h
 SOURCES += tactioncontroller.cpp
+HEADERS += tdispatcher.h
+SOURCES += tdispatcher.cpp
 HEADERS += directcontroller.h
 SOURCES += directcontroller.cpp
 HEADERS += tactionview.h
@@ -211,6 +215,10 @@ HEADERS += tabstractmodel.h
 SOURCES += tabstractmodel.cpp
 HEADERS += tmodelutil.h
 SOURCES += tmodelutil.cpp
+HEADERS += tmodelencoder.h
+SOURCES += tmodelencoder.cpp
+HEADERS += tmodeldecoder.h
+SOURCES += tmodeldecoder.cpp
 HEADERS += tmodelobject.h
 SOURCES += tmodelobject.cpp
 HEADERS += tsystemglobal.h
@@ -235,6 +243,10 @@ HEADERS += tabstractlogstream.h
 SOURCES += tabstractlogstream.cpp
 HEADERS += tbasiclogstream.h
 SOURCES += tbasiclogstream.cpp
+HEADERS += tasynclogstream.h
+SOURCES += tasynclogstream.cpp
+HEADERS += tloglayout.h
+SOURCES += tloglayout.cpp
 HEADERS += tmailmessage.h
 SOURCES += tmailmessage.cpp
 HEADERS += tpopmailer.h
@@ -289,6 +301,8 @@ HEADERS += twebsocketframe.h
 SOURCES += twebsocketframe.cpp
 HEADERS += twebsocketworker.h
 SOURCES += twebsocketworker.cpp
+HEADERS += twebsocketworkerpool.h
+SOURCES += twebsocketworkerpool.cpp
 HEADERS += twebsocketsession.h
 SOURCES += twebsocketsession.cpp
 HEADERS += tpublisher.h
@@ -313,6 +327,8 @@ HEADERS += tstack.h
 SOURCES += tstack.cpp
 HEADERS += tqueue.h
 SOURCES += tqueue.cpp
+HEADERS += ttimerwheel.h
+SOURCES += ttimerwheel.cpp
 HEADERS += tdatabasecontextthread.h
 SOURCES += tdatabasecontextthread.cpp
 HEADERS += tdatabasecontextmainthread.h
@@ -321,6 +337,8 @@ HEADERS += tdebug.h
 SOURCES += tdebug.cpp
 HEADERS += tjsonutil.h
 SOURCES += tjsonutil.cpp
+HEADERS += tjsonwriter.h
+SOURCES += tjsonwriter.cpp
 HEADERS += tjsloader.h
 SOURCES += tjsloader.cpp
 HEADERS += tjsmodule.h
@@ -345,6 +363,14 @@ HEADERS += tcachememcachedstore.h
 SOURCES += tcachememcachedstore.cpp
 HEADERS += tcachesharedmemorystore.h
 SOURCES += tcachesharedmemorystore.cpp
+HEADERS += tlocalcache.h
+SOURCES += tlocalcache.cpp
+HEADERS += tfragmentcache.h
+SOURCES += tfragmentcache.cpp
+HEADERS += tmetrics.h
+SOURCES += tmetrics.cpp
+HEADERS += ttrace.h
+SOURCES += ttrace.cpp
 HEADERS += toauth2client.h
 SOURCES += toauth2client.cpp
 HEADERS += tmemcached.h
@@ -374,7 +400,6 @@ HEADERS += tfnamespace.h
 HEADERS += tdeclexport.h
 HEADERS += tfcore.h
 HEADERS += tfexception.h
-HEADERS += tdispatcher.h
 HEADERS += tloggerplugin.h
 HEADERS += tsessionobject.h
 HEADERS += tsessionmongoobject.h
@@ -386,6 +411,8 @@ HEADERS += thttprequestheader.h
 HEADERS += thttpresponseheader.h
 HEADERS += tsharedmemory.h
 HEADERS += tcommandlineinterface.h
+HEADERS += tatomicringbuffer.h
+HEADERS += tasynclogwriter.h
 
 # For Windows
 windows {
@@ -422,6 +449,30 @@ linux-* {
   SOURCES += tmemcacheddriver_linux.cpp
 }
 
+# Native TLS
+linux-* {
+  !isEmpty( enable_tls ) {
+    DEFINES += TF_ENABLE_TLS
+    HEADERS += ttlscontext.h
+    SOURCES += ttlscontext.cpp
+    HEADERS += ttlsconnection.h
+    SOURCES += ttlsconnection.cpp
+    LIBS += $$system("pkg-config --libs openssl 2>/dev/null || echo -lssl -lcrypto")
+    QMAKE_CXXFLAGS += $$system("pkg-config --cflags-only-I openssl 2>/dev/null")
+  }
+}
+
+# io_uring backend
+linux-* {
+  !isEmpty( enable_io_uring ) {
+    DEFINES += TF_ENABLE_IO_URING
+    HEADERS += tiouring.h
+    SOURCES += tiouring.cpp
+    LIBS += $$system("pkg-config --libs liburing 2>/dev/null || echo -luring")
+    QMAKE_CXXFLAGS += $$system("pkg-config --cflags-only-I liburing 2>/dev/null")
+  }
+}
+
 # For Mac
 macx {
   SOURCES += tprocessinfo_macx.cpp
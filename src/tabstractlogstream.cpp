@@ -63,8 +63,22 @@ void TAbstractLogStream::loggerWrite(const TLog &log)
 
 void TAbstractLogStream::loggerWrite(const QList<TLog> &logs)
 {
-    for (auto log : (const QList<TLog> &)logs) {
-        loggerWrite(log);
+    for (auto *logger : (const QList<TLogger *> &)loggerList) {
+        if (!logger || !logger->isOpen()) {
+            continue;
+        }
+
+        QList<TLog> list;
+        list.reserve(logs.count());
+        for (auto &log : logs) {
+            if (log.priority <= logger->threshold()) {
+                list << log;
+            }
+        }
+
+        if (!list.isEmpty()) {
+            logger->log(list);
+        }
     }
 }
 
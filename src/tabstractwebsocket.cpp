@@ -7,6 +7,7 @@
 
 #include "tabstractwebsocket.h"
 #include "tdispatcher.h"
+#include "tmetrics.h"
 #include "turlroute.h"
 #include "twebsocket.h"
 #include "twebsocketendpoint.h"
@@ -29,6 +30,7 @@ TAbstractWebSocket::TAbstractWebSocket(const THttpRequestHeader &header) :
     mutexData(),
     sessionStore()
 {
+    TMetrics::add(TMetrics::ActiveWebSockets);
 }
 
 
@@ -39,6 +41,7 @@ TAbstractWebSocket::~TAbstractWebSocket()
     }
 
     delete keepAliveTimer;
+    TMetrics::add(TMetrics::ActiveWebSockets, -1);
 }
 
 
@@ -5,6 +5,7 @@
  * the New BSD License, which is incorporated herein by reference.
  */
 
+#include "tloglayout.h"
 #include "tsystemglobal.h"
 #include <TAccessLog>
 
@@ -29,88 +30,7 @@ TAccessLog::TAccessLog(const QByteArray &host, const QByteArray &req, int dur) :
 
 QByteArray TAccessLog::toByteArray(const QByteArray &layout, const QByteArray &dateTimeFormat) const
 {
-    QByteArray message;
-    int pos = 0;
-    QByteArray dig;
-    message.reserve(127);
-
-    while (pos < layout.length()) {
-        char c = layout.at(pos++);
-        if (c != '%') {
-            message.append(c);
-            continue;
-        }
-
-        dig.resize(0);
-        for (;;) {
-            if (pos >= layout.length()) {
-                message.append('%').append(dig);
-                break;
-            }
-
-            c = layout.at(pos++);
-            if (c >= '0' && c <= '9') {
-                dig += c;
-                continue;
-            }
-
-            switch (c) {
-            case 'h':
-                message.append(remoteHost);
-                break;
-
-            case 'd':  // %d : timestamp
-                if (!dateTimeFormat.isEmpty()) {
-                    message.append(timestamp.toString(dateTimeFormat).toLocal8Bit());
-                } else {
-                    message.append(timestamp.toString(Qt::ISODate).toLatin1());
-                }
-                break;
-
-            case 'r':
-                message.append(request);
-                break;
-
-            case 's':
-                message.append(QString::number(statusCode).toLatin1());
-                break;
-
-            case 'O':
-                if (dig.isEmpty()) {
-                    message.append(QString::number(responseBytes).toLatin1());
-                } else {
-                    const QChar fillChar = (dig[0] == '0') ? QLatin1Char('0') : QLatin1Char(' ');
-                    message.append(QString("%1").arg(responseBytes, dig.toInt(), 10, fillChar).toLatin1());
-                }
-                break;
-
-            case 'e':
-                if (dig.isEmpty()) {
-                    message.append(QString::number(duration).toLatin1());
-                } else {
-                    const QChar fillChar = (dig[0] == '0') ? QLatin1Char('0') : QLatin1Char(' ');
-                    message.append(QString("%1").arg(duration, dig.toInt(), 10, fillChar).toLatin1());
-                }
-                break;
-
-            case 'n':  // %n : newline
-                message.append('\n');
-                break;
-
-            case '%':
-                message.append('%').append(dig);
-                dig.resize(0);
-                continue;
-                break;
-
-            default:
-                message.append('%').append(dig).append(c);
-                break;
-            }
-            break;
-        }
-    }
-    return message;
+    return TLogLayout::cached(layout, dateTimeFormat, TLogLayout::AccessLog).format(*this);
 }
 
 
@@ -6,6 +6,7 @@
  */
 
 #include "taccesslogstream.h"
+#include "tasynclogwriter.h"
 #include "tfilelogger.h"
 
 /*!
@@ -14,17 +15,26 @@
 */
 
 
-TAccessLogStream::TAccessLogStream(const QString &fileName)
+TAccessLogStream::TAccessLogStream(const QString &fileName, bool asyncWrite) :
+    logger(new TFileLogger)
 {
-    TFileLogger *fileLogger = new TFileLogger;
-    fileLogger->setFileName(fileName);
-    fileLogger->open();
-    logger = fileLogger;
+    logger->setFileName(fileName);
+    logger->open();
+
+    if (asyncWrite) {
+        // Writes the logs in batches by a dedicated thread
+        writer = new TAsyncLogWriter<QByteArray>([this](const QByteArrayList &logs) { logger->write(logs); });
+        writer->start();
+    }
 }
 
 
 TAccessLogStream::~TAccessLogStream()
 {
+    if (writer) {
+        writer->stop();
+        delete writer;
+    }
     logger->flush();
     delete logger;
 }
@@ -32,7 +42,13 @@ TAccessLogStream::~TAccessLogStream()
 
 void TAccessLogStream::writeLog(const QByteArray &log)
 {
-    if (logger->isOpen()) {
+    if (!logger->isOpen()) {
+        return;
+    }
+
+    if (writer) {
+        writer->write(log);
+    } else {
         logger->log(log);
     }
 }
@@ -40,5 +56,8 @@ void TAccessLogStream::writeLog(const QByteArray &log)
 
 void TAccessLogStream::flush()
 {
+    if (writer) {
+        writer->flush();
+    }
     logger->flush();
 }
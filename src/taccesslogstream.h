@@ -3,18 +3,21 @@
 #include <QString>
 #include <TGlobal>
 
-class TLogger;
+class TFileLogger;
+template <class T>
+class TAsyncLogWriter;
 
 
 class T_CORE_EXPORT TAccessLogStream {
 public:
-    TAccessLogStream(const QString &fileName);
+    TAccessLogStream(const QString &fileName, bool asyncWrite = false);
     ~TAccessLogStream();
     void writeLog(const QByteArray &log);
     void flush();
 
 private:
-    TLogger *logger {nullptr};
+    TFileLogger *logger {nullptr};
+    TAsyncLogWriter<QByteArray> *writer {nullptr};
 
     // Disable
     TAccessLogStream() = delete;
@@ -7,9 +7,11 @@
 
 #include "tabstractwebsocket.h"
 #include "thttpsocket.h"
+#include "tmetrics.h"
 #include "tpublisher.h"
 #include "tsessionmanager.h"
 #include "tsystemglobal.h"
+#include "ttrace.h"
 #include "turlroute.h"
 #include <QHostAddress>
 #include <QSet>
@@ -40,6 +42,7 @@ TActionContext::~TActionContext()
 {
     release();
     accessLogger.close();
+    delete _trace;
 }
 
 
@@ -59,11 +62,26 @@ void TActionContext::execute(THttpRequest &request)
     static const bool SessionAutoIdRegeneration = Tf::appSettings()->value(Tf::SessionAutoIdRegeneration).toBool();
 
     THttpResponseHeader responseHeader;
+    QElapsedTimer metricsTimer;
+    QByteArray metricsRoute;
+
+    _statusCode = 0;
+    if (TMetrics::isEnabled()) {
+        metricsTimer.start();
+    }
 
     try {
         _httpRequest = &request;
         const THttpRequestHeader &reqHeader = _httpRequest->header();
 
+        // Trace
+        if (TTrace::isEnabled()) {
+            if (!_trace) {
+                _trace = new TTrace;
+            }
+            _trace->start(reqHeader);
+        }
+
         // Access log
         if (Tf::isAccessLoggerAvailable()) {
             accessLogger.open();
@@ -130,8 +148,10 @@ void TActionContext::execute(THttpRequest &request)
                 QByteArray sessionId = _httpRequest->cookie(TSession::sessionName());
                 if (!sessionId.isEmpty()) {
                     // Finds a session
+                    TTrace::Span span(TTrace::SessionLoad);
                     session = TSessionManager::instance().findSession(sessionId);
                 }
+                _storedSession = session;  // shares the data until modified
                 _currController->setSession(session);
 
                 // Exports flash-variant
@@ -169,9 +189,15 @@ void TActionContext::execute(THttpRequest &request)
             // Do filters
             if (Q_LIKELY(_currController->preFilter())) {
                 // Dispatches
-                bool inv = ctlrDispatcher.invoke(route.action, route.params);
+                bool inv;
+                {
+                    TTrace::Span span(TTrace::Action);
+                    inv = ctlrDispatcher.invoke(route.action, route.params);
+                }
                 if (!inv) {
                     _currController->setStatusCode(Tf::NotFound);
+                } else if (TMetrics::isEnabled()) {
+                    metricsRoute = route.controller + '#' + route.action;
                 }
             }
 
@@ -195,7 +221,13 @@ void TActionContext::execute(THttpRequest &request)
                 path = route.controller;
             }
 
-            if (Q_LIKELY(method == Tf::Get)) {  // GET Method
+            if (Q_UNLIKELY(TMetrics::isEnabled() && method == Tf::Get && path == TMetrics::path())) {
+                // Runtime metrics
+                QByteArray metrics = TMetrics::exposition();
+                QBuffer buf(&metrics);
+                responseBytes = writeResponse(Tf::OK, responseHeader, QByteArrayLiteral("text/plain; version=0.0.4; charset=utf-8"), &buf, metrics.length());
+
+            } else if (Q_LIKELY(method == Tf::Get)) {  // GET Method
                 QString canonicalPath = QUrl(QStringLiteral(".")).resolved(QUrl(path)).toString().mid(1);
                 QFile reqPath(Tf::app()->publicPath() + canonicalPath);
                 QFileInfo fi(reqPath);
@@ -265,6 +297,15 @@ void TActionContext::execute(THttpRequest &request)
 
     accessLogger.write();  // Writes access log
     _currController = nullptr;
+
+    // No response means an internal server error
+    int statusCode = (_statusCode > 0) ? _statusCode : (int)Tf::InternalServerError;
+    if (_trace) {
+        _trace->finish(statusCode);
+    }
+    if (TMetrics::isEnabled()) {
+        TMetrics::observeRequest(metricsRoute, statusCode, metricsTimer.nsecsElapsed() / 1000);
+    }
 }
 
 
@@ -312,8 +353,19 @@ void TActionContext::flushResponse(TActionController *controller, bool immediate
 
     // Session store
     if (controller->sessionEnabled()) {
-        bool stored = TSessionManager::instance().store(controller->session());
+        TTrace::Span span(TTrace::SessionStore);
+        TSession &session = controller->session();
+        bool stored;
+        if (!_storedSession.id().isEmpty() && session.id() == _storedSession.id()
+            && *static_cast<const QVariantMap *>(&session) == *static_cast<const QVariantMap *>(&_storedSession)) {
+            // Unchanged, extends the lifetime only
+            stored = TSessionManager::instance().touch(session);
+        } else {
+            stored = TSessionManager::instance().store(session);
+        }
+
         if (Q_LIKELY(stored)) {
+            _storedSession = session;
             controller->addCookie(TSession::sessionName(), controller->session().id(), SessionCookieMaxAge,
                 SessionCookiePath, SessionCookieDomain, false, true, SessionCookieSameSite);
 
@@ -464,10 +516,16 @@ int64_t TActionContext::writeResponse(THttpResponseHeader &header, QIODevice *bo
 
     header.setContentLength(length);
     tSystemDebug("content-length: %ld", (int64_t)header.contentLength());
+    _statusCode = header.statusCode();
     header.setRawHeader(QByteArrayLiteral("Server"), QByteArrayLiteral("TreeFrog server"));
     header.setCurrentDate();
 
+    if (_trace && _trace->isActive() && TTrace::isServerTimingEnabled()) {
+        header.setRawHeader(QByteArrayLiteral("Server-Timing"), _trace->serverTiming());
+    }
+
     // Write data
+    TTrace::Span span(TTrace::SocketWrite);
     return writeResponse(header, body);
 }
 
@@ -4,6 +4,7 @@
 #include <TAtomic>
 #include <TAccessLog>
 #include <TGlobal>
+#include <TSession>
 #include <QMap>
 #include <QStringList>
 
@@ -16,6 +17,7 @@ class THttpResponse;
 class TApplicationServer;
 class TTemporaryFile;
 class TActionController;
+class TTrace;
 
 
 class T_CORE_EXPORT TActionContext : public TDatabaseContext, public TAbstractActionContext {
@@ -56,6 +58,9 @@ private:
     TActionController *_currController {nullptr};
     QList<TTemporaryFile *> _tempFiles;
     THttpRequest *_httpRequest {nullptr};
+    TSession _storedSession;  // session as in the store
+    int _statusCode {0};  // of the response written
+    TTrace *_trace {nullptr};
 
     T_DISABLE_COPY(TActionContext)
     T_DISABLE_MOVE(TActionContext)
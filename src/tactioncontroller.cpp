@@ -7,6 +7,7 @@
 
 #include "tsessionmanager.h"
 #include "ttextview.h"
+#include "ttrace.h"
 #include <QCryptographicHash>
 #include <QDir>
 #include <QDomDocument>
@@ -23,6 +24,7 @@
 #include <TCache>
 #include <TDispatcher>
 #include <TFormValidator>
+#include <TJsonWriter>
 #include <TSession>
 #include <QMessageAuthenticationCode>
 #include <QJsonArray>
@@ -432,6 +434,8 @@ bool TActionController::renderAndCache(const QByteArray &key, int seconds, const
     if ((int)_rendered > 0) {
         QByteArray responseMsg = response().body();
         Tf::cache()->set(key, responseMsg, seconds);
+    } else {
+        Tf::cache()->releaseLease(key);
     }
     return (bool)_rendered;
 }
@@ -439,6 +443,9 @@ bool TActionController::renderAndCache(const QByteArray &key, int seconds, const
 /*!
   Renders the template cached with the \a key. If no item with the \a key
   found, returns false.
+  When the item is missing or expired, only one of the concurrent requests
+  gets false and renders it with renderAndCache(); the others wait for it,
+  or are served the expired item if Cache.StaleWhileRevalidate is set.
   To use this function, enable cache module in application.ini.
   \sa renderAndCache()
 */
@@ -449,8 +456,9 @@ bool TActionController::renderOnCache(const QByteArray &key)
         return false;
     }
 
-    auto responseMsg = Tf::cache()->get(key);
-    if (responseMsg.isEmpty()) {
+    bool recompute = false;
+    auto responseMsg = Tf::cache()->fetch(key, recompute);
+    if (recompute || responseMsg.isEmpty()) {
         return false;
     }
 
@@ -506,6 +514,8 @@ QByteArray TActionController::renderView(TActionView *view)
         tSystemError("view null pointer.  action:%s", qUtf8Printable(activeAction()));
         return QByteArray();
     }
+
+    TTrace::Span span(TTrace::Render);
     view->setController(this);
     view->setVariantMap(allVariants());
 
@@ -916,6 +926,14 @@ bool TActionController::renderJson(const QStringList &list)
     return renderJson(QJsonArray::fromStringList(list));
 }
 
+/*!
+  Renders the JSON text written by the \a writer as HTTP response.
+*/
+bool TActionController::renderJson(const TJsonWriter &writer)
+{
+    return sendData(writer.data(), "application/json; charset=utf-8");
+}
+
 #if QT_VERSION >= 0x050c00  // 5.12.0
 
 /*!
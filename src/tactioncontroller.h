@@ -15,6 +15,7 @@ class TActionView;
 class TAbstractUser;
 class TFormValidator;
 class TCache;
+class TJsonWriter;
 class QDomDocument;
 
 
@@ -80,6 +81,7 @@ protected:
     bool renderJson(const QVariantMap &map);
     bool renderJson(const QVariantList &list);
     bool renderJson(const QStringList &list);
+    bool renderJson(const TJsonWriter &writer);
     bool renderAndCache(const QByteArray &key, int seconds, const QString &action = QString(), const QString &layout = QString());
     bool renderOnCache(const QByteArray &key);
     void removeCache(const QByteArray &key);
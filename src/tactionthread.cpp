@@ -5,6 +5,7 @@
  * the New BSD License, which is incorporated herein by reference.
  */
 
+#include "tactionthreadpool.h"
 #include "tfcore.h"
 #include "thttpsocket.h"
 #include "tsessionmanager.h"
@@ -18,6 +19,7 @@
 #include <TApplicationServerBase>
 #include <THttpRequest>
 #include <TSession>
+#include <TThreadApplicationServer>
 #include <TWebApplication>
 #include <atomic>
 
@@ -25,6 +27,13 @@ constexpr int RECV_BUF_SIZE = 8 * 1024;
 
 namespace {
 std::atomic<int> threadCounter(0);
+
+
+bool tlsEnabled()
+{
+    static const bool enabled = Tf::appSettings()->value(Tf::TLSEnable).toBool();
+    return enabled;
+}
 }
 
 
@@ -89,7 +98,26 @@ void TActionThread::setSocketDescriptor(qintptr socket)
 }
 
 
+/*!
+  Serves the connections. A thread of TActionThreadPool takes the
+  sockets queued one after another until the pool stops.
+*/
 void TActionThread::run()
+{
+    if (!_pool) {
+        handleConnection();
+        return;
+    }
+
+    int socketDescriptor;
+    while (_pool->takeSocket(this, socketDescriptor)) {
+        TActionContext::socketDesc = socketDescriptor;
+        handleConnection();
+    }
+}
+
+
+void TActionThread::handleConnection()
 {
     class Counter {
         std::atomic<int> &_num;
@@ -109,6 +137,10 @@ void TActionThread::run()
     TActionContext::socketDesc = 0;
     TDatabaseContext::setCurrentDatabaseContext(this);
 
+    if (Q_UNLIKELY(tlsEnabled() && !_httpSocket->startServerEncryption())) {
+        goto socket_error;
+    }
+
     try {
         for (;;) {
             QList<THttpRequest> requests = readRequest(_httpSocket);
@@ -140,11 +172,21 @@ void TActionThread::run()
                 break;
             }
 
+            if (parkSocket()) {
+                // Waits for the next request without this thread
+                goto socket_cleanup;
+            }
+
             if (threadCount() >= _maxThreads && _maxThreads > 0) {
                 // Do not keep-alive
                 break;
             }
 
+            if (_pool && _pool->queuedCount() > 0) {
+                // Gives way to the connections waiting for a thread
+                break;
+            }
+
             if (_httpSocket->state() != QAbstractSocket::ConnectedState) {
                 goto receive_end;
             }
@@ -174,7 +216,7 @@ socket_error:
     TActionContext::socketDesc = 0;
     TActionContext::release();
     TDatabaseContext::setCurrentDatabaseContext(nullptr);
-    _httpSocket->deleteLater();
+    delete _httpSocket;  // no event loop runs for a deferred delete
     _httpSocket = nullptr;
 }
 
@@ -230,8 +272,35 @@ void TActionThread::closeSocket()
 }
 
 
+/*!
+  Hands the keep-alive socket over to the application server, which
+  watches it until the next request arrives. Returns true if the socket
+  was parked.
+*/
+bool TActionThread::parkSocket()
+{
+    if (_httpSocket->state() != QAbstractSocket::ConnectedState || _httpSocket->isEncrypted() || !_readBuffer.isEmpty()) {
+        return false;
+    }
+
+    int sd = _httpSocket->socketDescriptor();
+    _httpSocket->setSocketDescriptor(0, QAbstractSocket::UnconnectedState);  // detach
+    if (!TThreadApplicationServer::parkKeepAliveSocket(sd)) {
+        _httpSocket->setSocketDescriptor(sd, QAbstractSocket::ConnectedState);
+        return false;
+    }
+    return true;
+}
+
+
 bool TActionThread::handshakeForWebSocket(const THttpRequestHeader &header)
 {
+    if (Q_UNLIKELY(_httpSocket->isEncrypted())) {
+        // WebSocket is not supported over the native TLS
+        tSystemWarn("WebSocket over TLS not supported");
+        return false;
+    }
+
     if (!TWebSocket::searchEndpoint(header)) {
         return false;
     }
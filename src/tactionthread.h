@@ -4,6 +4,7 @@
 
 class THttpSocket;
 class THttpRequest;
+class TActionThreadPool;
 class THttpRequestHeader;
 class THttpResponseHeader;
 class QIODevice;
@@ -22,11 +23,13 @@ public:
 
 protected:
     void run() override;
+    void handleConnection();
     void emitError(int socketError) override;
     int64_t writeResponse(THttpResponseHeader &header, QIODevice *body) override;
     void flushSocket() override { }
     void closeSocket() override;
     bool handshakeForWebSocket(const THttpRequestHeader &header);
+    bool parkSocket();
 
 signals:
     void error(int socketError);
@@ -35,7 +38,9 @@ private:
     THttpSocket *_httpSocket {nullptr};
     int _maxThreads {0};
     QByteArray _readBuffer;
+    TActionThreadPool *_pool {nullptr};
 
+    friend class TActionThreadPool;
     T_DISABLE_COPY(TActionThread)
     T_DISABLE_MOVE(TActionThread)
 };
@@ -0,0 +1,155 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tactionthreadpool.h"
+#include "tfcore.h"
+#include "tsystemglobal.h"
+#include <TActionThread>
+
+/*!
+  \class TActionThreadPool
+  \brief The TActionThreadPool class manages long-lived TActionThread
+  threads which serve the connections accepted by the application server.
+
+  The accepted sockets are queued and each thread takes the next one
+  after its connection ends, so no thread is started or stopped per
+  connection. The pool starts with the minimum number of threads and
+  grows up to the maximum while the sockets queued outnumber the idle
+  threads; a thread above the minimum exits after staying idle for a
+  minute. When all the threads are busy, the sockets wait in the queue.
+*/
+
+namespace {
+constexpr int IDLE_THREAD_TIMEOUT = 60000;  // msecs
+}
+
+
+TActionThreadPool::TActionThreadPool(int minThreads, int maxThreads) :
+    _minThreads(qBound(0, minThreads, maxThreads)),
+    _maxThreads(qMax(maxThreads, 1))
+{
+    QMutexLocker locker(&_mutex);
+    for (int i = 0; i < _minThreads; i++) {
+        startThread();
+    }
+}
+
+
+TActionThreadPool::~TActionThreadPool()
+{
+    stop();
+
+    for (auto *thread : (const QList<TActionThread *> &)_threads) {
+        thread->wait();
+        delete thread;
+    }
+    _threads.clear();
+    deleteExitedThreads();
+}
+
+/*!
+  Queues the \a socketDescriptor accepted and returns immediately; an
+  idle thread takes it. A thread is started if none is idle and the
+  number of threads is less than the maximum.
+*/
+void TActionThreadPool::start(int socketDescriptor)
+{
+    QMutexLocker locker(&_mutex);
+    if (Q_UNLIKELY(_stopped)) {
+        tf_close_socket(socketDescriptor);
+        return;
+    }
+
+    _sockets.enqueue(socketDescriptor);
+    if (_sockets.count() > _idleThreads && _threads.count() < _maxThreads) {
+        deleteExitedThreads();
+        startThread();
+    }
+    _socketAvailable.wakeOne();
+}
+
+/*!
+  Stops the threads after their connections end. The sockets still
+  queued are closed.
+*/
+void TActionThreadPool::stop()
+{
+    QMutexLocker locker(&_mutex);
+    _stopped = true;
+    while (!_sockets.isEmpty()) {
+        tf_close_socket(_sockets.dequeue());
+    }
+    _socketAvailable.wakeAll();
+}
+
+/*!
+  Returns the number of the threads in the pool.
+*/
+int TActionThreadPool::threadCount() const
+{
+    QMutexLocker locker(&_mutex);
+    return _threads.count();
+}
+
+/*!
+  Returns the number of the sockets waiting for a thread.
+*/
+int TActionThreadPool::queuedCount() const
+{
+    QMutexLocker locker(&_mutex);
+    return _sockets.count();
+}
+
+// Called with the mutex locked
+void TActionThreadPool::startThread()
+{
+    auto *thread = new TActionThread(0);
+    thread->_pool = this;
+    _threads << thread;
+    thread->start();
+    tSystemDebug("Action thread started. threads:%ld", (int64_t)_threads.count());
+}
+
+// Called with the mutex locked
+void TActionThreadPool::deleteExitedThreads()
+{
+    for (auto *thread : (const QList<TActionThread *> &)_exitedThreads) {
+        thread->wait();
+        delete thread;
+    }
+    _exitedThreads.clear();
+}
+
+// Takes the next socket, called by the threads; returns false if the
+// thread is to exit
+bool TActionThreadPool::takeSocket(TActionThread *thread, int &socketDescriptor)
+{
+    QMutexLocker locker(&_mutex);
+    _idleThreads++;
+    while (_sockets.isEmpty()) {
+        bool exits = _stopped;
+        if (!exits) {
+            bool woken = _socketAvailable.wait(&_mutex, IDLE_THREAD_TIMEOUT);
+            exits = !woken && _sockets.isEmpty() && _threads.count() > _minThreads;
+        }
+
+        if (exits) {
+            _idleThreads--;
+            if (!_stopped) {
+                // Shrinks the pool; deleted by the next growth or stop
+                _threads.removeOne(thread);
+                _exitedThreads << thread;
+                tSystemDebug("Action thread exited. threads:%ld", (int64_t)_threads.count());
+            }
+            return false;
+        }
+    }
+
+    _idleThreads--;
+    socketDescriptor = _sockets.dequeue();
+    return true;
+}
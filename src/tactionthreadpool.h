@@ -0,0 +1,39 @@
+#pragma once
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+#include <TGlobal>
+
+class TActionThread;
+
+
+class T_CORE_EXPORT TActionThreadPool {
+public:
+    TActionThreadPool(int minThreads, int maxThreads);
+    ~TActionThreadPool();
+
+    void start(int socketDescriptor);
+    void stop();
+    int threadCount() const;
+    int queuedCount() const;
+
+private:
+    bool takeSocket(TActionThread *thread, int &socketDescriptor);
+    void startThread();
+    void deleteExitedThreads();
+
+    mutable QMutex _mutex;
+    QWaitCondition _socketAvailable;
+    QQueue<int> _sockets;
+    QList<TActionThread *> _threads;
+    QList<TActionThread *> _exitedThreads;
+    int _minThreads {0};
+    int _maxThreads {0};
+    int _idleThreads {0};
+    bool _stopped {false};
+
+    friend class TActionThread;
+    T_DISABLE_COPY(TActionThreadPool)
+    T_DISABLE_MOVE(TActionThreadPool)
+};
@@ -3,6 +3,7 @@
 #include <QTextStream>
 #include <QVariant>
 #include <TActionHelper>
+#include <TFragmentCache>
 #include <TGlobal>
 #include <THttpRequest>
 #include <THttpUtility>
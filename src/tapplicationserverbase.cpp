@@ -12,6 +12,7 @@
 #include <QList>
 #include <TActionContext>
 #include <TActionController>
+#include <TAppSettings>
 #include <TDispatcher>
 #include <TWebApplication>
 #ifdef Q_OS_WIN
@@ -21,6 +22,9 @@
 #ifdef Q_OS_UNIX
 #include <tfcore_unix.h>
 #endif
+#ifdef TF_ENABLE_TLS
+#include "ttlscontext.h"
+#endif
 
 /*!
   \class TApplicationServerBase
@@ -185,3 +189,26 @@ TApplicationServerBase::~TApplicationServerBase()
 {
     nativeSocketCleanup();
 }
+
+/*!
+  Sets up the TLS context if TLS is enabled in the application.ini.
+  Returns false if the context can not be set up.
+*/
+bool TApplicationServerBase::setupTls()
+{
+    if (!Tf::appSettings()->value(Tf::TLSEnable).toBool()) {
+        return true;
+    }
+
+#ifdef TF_ENABLE_TLS
+    if (!TTlsContext::instance()) {
+        tSystemError("Failed to set up TLS. Check the TLS settings.");
+        return false;
+    }
+    tSystemInfo("TLS enabled");
+    return true;
+#else
+    tSystemError("TLS not supported. Configure with --enable-tls.");
+    return false;
+#endif
+}
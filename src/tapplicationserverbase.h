@@ -29,6 +29,7 @@ public:
     static int duplicateSocket(int socketDescriptor);
     static void invokeStaticInitialize();
     static void invokeStaticRelease();
+    static bool setupTls();
 
 private:
     TApplicationServerBase();
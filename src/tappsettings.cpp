@@ -81,6 +81,27 @@ const QMap<Tf::AppAttribute, QString> attributeMap = {
     {Tf::CacheBackend, "Cache.Backend"},
     {Tf::CacheGcProbability, "Cache.GcProbability"},
     {Tf::CacheEnableCompression, "Cache.EnableCompression"},
+    {Tf::AccessLogEnableAsyncWrite, "AccessLog.EnableAsyncWrite"},
+    {Tf::SqlQueryLogEnableAsyncWrite, "SqlQueryLog.EnableAsyncWrite"},
+    {Tf::TLSEnable, "TLS.Enable"},
+    {Tf::TLSCertificateFile, "TLS.CertificateFile"},
+    {Tf::TLSPrivateKeyFile, "TLS.PrivateKeyFile"},
+    {Tf::TLSAlpnProtocols, "TLS.AlpnProtocols"},
+    {Tf::TLSSessionCacheSize, "TLS.SessionCacheSize"},
+    {Tf::TLSEnableKernelTls, "TLS.EnableKernelTls"},
+    {Tf::WebSocketMaxWorkerThreads, "WebSocket.MaxWorkerThreads"},
+    {Tf::CacheL1MaxEntries, "Cache.L1MaxEntries"},
+    {Tf::CacheL1TimeToLive, "Cache.L1TimeToLive"},
+    {Tf::CacheStaleWhileRevalidate, "Cache.StaleWhileRevalidate"},
+    {Tf::CacheLeaseTimeout, "Cache.LeaseTimeout"},
+    {Tf::SessionGcInterval, "Session.GcInterval"},
+    {Tf::MPMEpollBackend, "MPM.epoll.Backend"},
+    {Tf::HttpRequestHeaderTimeout, "HttpRequestHeaderTimeout"},
+    {Tf::MPMEpollMaxRecvBufferSize, "MPM.epoll.MaxRecvBufferSize"},
+    {Tf::MetricsPath, "Metrics.Path"},
+    {Tf::TraceSampleRate, "Trace.SampleRate"},
+    {Tf::TraceExport, "Trace.Export"},
+    {Tf::TraceServerTiming, "Trace.ServerTiming"},
 };
 
 
@@ -107,6 +128,25 @@ const QMap<Tf::AppAttribute, QVariant> defaultValueMap = {
     {Tf::SessionAutoIdRegeneration, false},
     {Tf::ActionMailerDelayedDelivery, false},
     {Tf::InternalEncoding, "UTF-8"},
+    {Tf::AccessLogEnableAsyncWrite, false},
+    {Tf::SqlQueryLogEnableAsyncWrite, false},
+    {Tf::TLSEnable, false},
+    {Tf::TLSAlpnProtocols, "http/1.1"},
+    {Tf::TLSSessionCacheSize, 20480},
+    {Tf::TLSEnableKernelTls, false},
+    {Tf::WebSocketMaxWorkerThreads, 0},
+    {Tf::CacheL1MaxEntries, 0},
+    {Tf::CacheL1TimeToLive, 5},
+    {Tf::CacheStaleWhileRevalidate, 0},
+    {Tf::CacheLeaseTimeout, 10},
+    {Tf::SessionGcInterval, 300},
+    {Tf::MPMEpollBackend, "epoll"},
+    {Tf::HttpRequestHeaderTimeout, 0},
+    {Tf::MPMEpollMaxRecvBufferSize, 0},
+    {Tf::MetricsPath, ""},
+    {Tf::TraceSampleRate, 0.0},
+    {Tf::TraceExport, ""},
+    {Tf::TraceServerTiming, false},
 };
 
 
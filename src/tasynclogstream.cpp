@@ -0,0 +1,48 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tasynclogstream.h"
+#include <TSystemGlobal>
+
+/*!
+  \class TAsyncLogStream
+  \brief The TAsyncLogStream class provides a stream for logs which
+  are written by a dedicated thread.
+
+  The logs are put into a lock-free ring buffer, so that the thread
+  logging does not wait for the loggers. The writer thread passes
+  the logs to the loggers in batches.
+*/
+
+
+TAsyncLogStream::TAsyncLogStream(const QList<TLogger *> loggers) :
+    TAbstractLogStream(loggers),
+    writer([this](const QList<TLog> &logs) { loggerWrite(logs); })
+{
+    loggerOpen();
+    writer.start();
+}
+
+
+TAsyncLogStream::~TAsyncLogStream()
+{
+    writer.stop();
+    loggerFlush();
+}
+
+
+void TAsyncLogStream::writeLog(const TLog &log)
+{
+    writer.write(log);
+}
+
+
+void TAsyncLogStream::flush()
+{
+    writer.flush();
+    loggerFlush();
+}
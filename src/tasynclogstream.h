@@ -0,0 +1,19 @@
+#pragma once
+#include "tabstractlogstream.h"
+#include "tasynclogwriter.h"
+
+
+class T_CORE_EXPORT TAsyncLogStream : public TAbstractLogStream {
+public:
+    TAsyncLogStream(const QList<TLogger *> loggers);
+    ~TAsyncLogStream();
+
+    void writeLog(const TLog &log) override;
+    void flush() override;
+
+private:
+    TAsyncLogWriter<TLog> writer;
+
+    T_DISABLE_COPY(TAsyncLogStream)
+    T_DISABLE_MOVE(TAsyncLogStream)
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include "tatomicringbuffer.h"
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <TGlobal>
+#include <functional>
+
+
+/*
+  Writer thread which takes the logs pushed into a lock-free ring
+  buffer by request threads and passes them to the sink in batches.
+  The writer sleeps on a wait condition while the buffer is empty, and
+  the request threads sleep on another while it is full or flushing.
+*/
+template <class T>
+class TAsyncLogWriter : public QThread {
+public:
+    using Sink = std::function<void(const QList<T> &)>;
+
+    TAsyncLogWriter(const Sink &sink, int capacity = 8192);
+    ~TAsyncLogWriter();
+
+    void write(const T &log);
+    void flush();
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    enum {
+        MaxBatchCount = 256,
+        MaxDrainWait = 32,  // msecs, against a wakeup missed
+    };
+
+    int drain();
+    void waitDrained();
+
+    TAtomicRingBuffer<T> _buffer;
+    Sink _sink;
+    std::atomic<quint64> _pushed {0};
+    std::atomic<quint64> _written {0};
+    std::atomic<bool> _sleeping {false};  // writer waiting for logs
+    std::atomic<int> _waiting {0};  // threads waiting for the writer
+    QMutex _mutex;
+    QWaitCondition _logPushed;
+    QWaitCondition _logsDrained;
+
+    T_DISABLE_COPY(TAsyncLogWriter)
+    T_DISABLE_MOVE(TAsyncLogWriter)
+};
+
+
+template <class T>
+inline TAsyncLogWriter<T>::TAsyncLogWriter(const Sink &sink, int capacity) :
+    QThread(),
+    _buffer(capacity),
+    _sink(sink)
+{
+}
+
+
+template <class T>
+inline TAsyncLogWriter<T>::~TAsyncLogWriter()
+{
+    stop();
+}
+
+
+template <class T>
+inline void TAsyncLogWriter<T>::write(const T &log)
+{
+    if (Q_UNLIKELY(!isRunning() || isInterruptionRequested())) {
+        _sink(QList<T>({log}));
+        return;
+    }
+
+    while (Q_UNLIKELY(!_buffer.push(log))) {
+        // Buffer full, waits for the writer thread
+        waitDrained();
+    }
+    _pushed++;
+
+    if (_sleeping.load()) {
+        QMutexLocker locker(&_mutex);
+        _logPushed.wakeOne();
+    }
+}
+
+// Waits until all the logs pushed so far are passed to the sink
+template <class T>
+inline void TAsyncLogWriter<T>::flush()
+{
+    const quint64 target = _pushed.load();
+    while (_written.load() < target && isRunning() && currentThread() != this) {
+        waitDrained();
+    }
+}
+
+
+template <class T>
+inline void TAsyncLogWriter<T>::stop()
+{
+    if (isRunning()) {
+        requestInterruption();
+        {
+            QMutexLocker locker(&_mutex);
+            _logPushed.wakeOne();
+        }
+        wait();
+    }
+
+    while (drain() > 0) { }
+}
+
+// Waits for the writer thread to drain a batch of the logs
+template <class T>
+inline void TAsyncLogWriter<T>::waitDrained()
+{
+    QMutexLocker locker(&_mutex);
+    _waiting++;
+    _logPushed.wakeOne();
+    _logsDrained.wait(&_mutex, MaxDrainWait);
+    _waiting--;
+}
+
+
+template <class T>
+inline int TAsyncLogWriter<T>::drain()
+{
+    QList<T> logs;
+    T log;
+    int cnt = 0;
+
+    while (cnt < MaxBatchCount && _buffer.pop(log)) {
+        logs << log;
+        cnt++;
+    }
+
+    if (cnt > 0) {
+        _sink(logs);
+        _written += cnt;
+
+        if (_waiting.load() > 0) {
+            QMutexLocker locker(&_mutex);
+            _logsDrained.wakeAll();
+        }
+    }
+    return cnt;
+}
+
+
+template <class T>
+inline void TAsyncLogWriter<T>::run()
+{
+    while (!isInterruptionRequested()) {
+        if (drain() > 0) {
+            continue;
+        }
+
+        QMutexLocker locker(&_mutex);
+        _sleeping = true;
+        // A log pushed after this check wakes the writer
+        if (_written.load() >= _pushed.load() && !isInterruptionRequested()) {
+            _logPushed.wait(&_mutex);
+        }
+        _sleeping = false;
+    }
+
+    while (drain() > 0) { }
+}
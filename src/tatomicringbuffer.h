@@ -0,0 +1,117 @@
+#pragma once
+#include <TGlobal>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+
+/*
+  Bounded lock-free ring buffer for multiple producers and multiple
+  consumers. The capacity is rounded up to a power of two.
+*/
+template <class T>
+class TAtomicRingBuffer {
+public:
+    TAtomicRingBuffer(int capacity);
+
+    bool push(const T &value);
+    bool pop(T &value);
+    int capacity() const { return (int)(_mask + 1); }
+    int count() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence {0};
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    size_t _mask {0};
+    alignas(64) std::atomic<size_t> _enqueuePos {0};
+    alignas(64) std::atomic<size_t> _dequeuePos {0};
+
+    T_DISABLE_COPY(TAtomicRingBuffer)
+    T_DISABLE_MOVE(TAtomicRingBuffer)
+};
+
+
+template <class T>
+inline TAtomicRingBuffer<T>::TAtomicRingBuffer(int capacity)
+{
+    size_t size = 2;
+    while ((int)size < capacity) {
+        size <<= 1;
+    }
+
+    _cells.reset(new Cell[size]);
+    _mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+
+template <class T>
+inline bool TAtomicRingBuffer<T>::push(const T &value)
+{
+    Cell *cell;
+    size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;) {
+        cell = &_cells[pos & _mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // full
+        } else {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->value = value;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+
+template <class T>
+inline bool TAtomicRingBuffer<T>::pop(T &value)
+{
+    Cell *cell;
+    size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+
+    for (;;) {
+        cell = &_cells[pos & _mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // empty
+        } else {
+            pos = _dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    value = std::move(cell->value);
+    cell->value = T();
+    cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+    return true;
+}
+
+
+template <class T>
+inline int TAtomicRingBuffer<T>::count() const
+{
+    size_t enq = _enqueuePos.load(std::memory_order_relaxed);
+    size_t deq = _dequeuePos.load(std::memory_order_relaxed);
+    return (enq > deq) ? (int)(enq - deq) : 0;
+}
@@ -7,13 +7,25 @@
 
 #include "tcachefactory.h"
 #include "tcachestore.h"
+#include "tlocalcache.h"
+#include "tmetrics.h"
+#include "ttrace.h"
 #include <TAppSettings>
 #include <TCache>
+#include <QtEndian>
 #include <TWebApplication>
+#include <climits>
+
+constexpr auto WRAPPING_MAGIC = "\x7fTFC";
+constexpr int WRAPPING_HEADER_LEN = 12;  // magic and freshness limit
 
 /*!
   \class TCache
   \brief The TCache class stores items so that can be served faster.
+
+  If Cache.L1MaxEntries is set in the application.ini, values read are
+  also held in a local cache in memory for a few seconds, so reads of
+  hot keys need no access to the cache backend.
 */
 
 TCache::TCache()
@@ -30,6 +42,7 @@ TCache::TCache()
                 _cache = nullptr;
             }
         }
+        _local = (_cache) ? TLocalCache::instance() : nullptr;
     } else {
         tWarn() << "Cache not available. Check the settings of application.ini such as 'Cache.SettingsFile' and 'Cache.Backend'.";
     }
@@ -63,17 +76,34 @@ void TCache::cleanup()
 /*!
   Stores a new item with the \a key and a \a value in the cache and sets the
   timeout after a given number of \a seconds.
+  If Cache.StaleWhileRevalidate is set, the item is kept for the more
+  seconds to be served by fetch() while it is being refreshed.
  */
 bool TCache::set(const QByteArray &key, const QByteArray &value, int seconds)
 {
+    TTrace::Span span(TTrace::Cache);
     bool ret = false;
 
     if (_cache) {
+        QByteArray data = value;
+        int ttl = seconds;
+        if (staleSeconds() > 0 && seconds > 0) {
+            data = wrap(value, Tf::getMSecsSinceEpoch() + seconds * 1000LL);
+            ttl += staleSeconds();
+        }
+
         if (compressionEnabled()) {
-            ret = _cache->set(key, Tf::lz4Compress(value), seconds);
+            ret = _cache->set(key, Tf::lz4Compress(data), ttl);
         } else {
-            ret = _cache->set(key, value, seconds);
+            ret = _cache->set(key, data, ttl);
+        }
+
+        // Drops the old value after the write, not to be read again
+        // from the store into the local caches
+        if (_local) {
+            _local->remove(key);
         }
+        releaseLease(key);
 
         // GC
         if (_gcDivisor > 0 && Tf::random(1, _gcDivisor) == 1) {
@@ -88,17 +118,166 @@ bool TCache::set(const QByteArray &key, const QByteArray &value, int seconds)
  */
 QByteArray TCache::get(const QByteArray &key)
 {
+    TTrace::Span span(TTrace::Cache);
     QByteArray value;
 
+    if (_local && _local->get(key, value)) {
+        TMetrics::add(TMetrics::CacheHits);
+        return value;
+    }
+
     if (_cache) {
-        value = _cache->get(key);
-        if (compressionEnabled()) {
-            value = Tf::lz4Uncompress(value);
+        int64_t freshUntil = 0;
+        value = read(key, freshUntil);
+        if (freshUntil > 0 && freshUntil <= Tf::getMSecsSinceEpoch()) {
+            value.clear();  // stale
         }
+        keepLocal(key, value, freshUntil);
+    }
+    TMetrics::add(value.isEmpty() ? TMetrics::CacheMisses : TMetrics::CacheHits);
+    return value;
+}
+
+/*!
+  Returns the value associated with the \a key, coalescing the
+  recomputations of a missing item. If the item is missing or stale,
+  only one caller across the application servers gets \a recompute
+  set to true and is expected to store a new value with set(); the
+  other callers are served the stale value, or wait for the new value
+  up to Cache.LeaseTimeout seconds.
+  \sa releaseLease()
+ */
+QByteArray TCache::fetch(const QByteArray &key, bool &recompute)
+{
+    constexpr int WAIT_INTERVAL = 20;  // msecs
+    TTrace::Span span(TTrace::Cache);
+    QByteArray value;
+    int64_t freshUntil = 0;
+
+    recompute = false;
+    if (_local && _local->get(key, value)) {
+        TMetrics::add(TMetrics::CacheHits);
+        return value;
+    }
+
+    if (!_cache) {
+        TMetrics::add(TMetrics::CacheMisses);
+        recompute = true;
+        return value;
+    }
+
+    value = read(key, freshUntil);
+    TMetrics::add(value.isEmpty() ? TMetrics::CacheMisses : TMetrics::CacheHits);
+    if (!value.isEmpty()) {
+        if (freshUntil > 0 && freshUntil <= Tf::getMSecsSinceEpoch()) {
+            // Stale; one caller refreshes it
+            recompute = acquireLease(key);
+        } else {
+            keepLocal(key, value, freshUntil);
+        }
+        return value;
+    }
+
+    const int64_t deadline = Tf::getMSecsSinceEpoch() + leaseSeconds() * 1000LL;
+    while (!acquireLease(key)) {
+        if (Tf::getMSecsSinceEpoch() >= deadline) {
+            tWarn("Lease timed out, recomputing: %s", key.data());
+            break;
+        }
+
+        // Waits for the value computed by the holder of the lease
+        Tf::msleep(WAIT_INTERVAL);
+        value = read(key, freshUntil);
+        if (!value.isEmpty()) {
+            return value;
+        }
+    }
+    recompute = true;
+    return value;
+}
+
+/*!
+  Releases the lease for the \a key acquired by fetch(), which is
+  released by set() too. Call it if no value is stored after fetch().
+ */
+void TCache::releaseLease(const QByteArray &key)
+{
+    if (_cache && _leases.remove(key)) {
+        _cache->remove(leaseKey(key));
+    }
+}
+
+
+bool TCache::acquireLease(const QByteArray &key)
+{
+    if (_leases.contains(key)) {
+        return true;
+    }
+
+    bool ok = _cache->add(leaseKey(key), QByteArrayLiteral("1"), leaseSeconds());
+    if (ok) {
+        _leases.insert(key);
+    }
+    return ok;
+}
+
+// Reads the item and unwraps the value stored with its freshness limit
+QByteArray TCache::read(const QByteArray &key, int64_t &freshUntil)
+{
+    QByteArray value = _cache->get(key);
+    if (compressionEnabled()) {
+        value = Tf::lz4Uncompress(value);
+    }
+
+    freshUntil = 0;
+    if (value.size() >= WRAPPING_HEADER_LEN && value.startsWith(WRAPPING_MAGIC)) {
+        freshUntil = qFromBigEndian<qint64>(value.constData() + 4);
+        value.remove(0, WRAPPING_HEADER_LEN);
     }
     return value;
 }
 
+
+void TCache::keepLocal(const QByteArray &key, const QByteArray &value, int64_t freshUntil)
+{
+    if (_local && !value.isEmpty()) {
+        int seconds = (freshUntil > 0) ? (freshUntil - Tf::getMSecsSinceEpoch()) / 1000 : INT_MAX;
+        _local->set(key, value, seconds);
+    }
+}
+
+
+QByteArray TCache::wrap(const QByteArray &value, int64_t freshUntil)
+{
+    QByteArray data;
+    data.reserve(WRAPPING_HEADER_LEN + value.size());
+    data += WRAPPING_MAGIC;
+    data.resize(WRAPPING_HEADER_LEN);
+    qToBigEndian<qint64>(freshUntil, data.data() + 4);
+    data += value;
+    return data;
+}
+
+
+QByteArray TCache::leaseKey(const QByteArray &key)
+{
+    return QByteArrayLiteral("tf.lease:") + key;
+}
+
+
+int TCache::staleSeconds()
+{
+    static int seconds = Tf::appSettings()->value(Tf::CacheStaleWhileRevalidate).toInt();
+    return seconds;
+}
+
+
+int TCache::leaseSeconds()
+{
+    static int seconds = qMax(Tf::appSettings()->value(Tf::CacheLeaseTimeout).toInt(), 1);
+    return seconds;
+}
+
 /*!
   Removes the item that have the \a key from the cache.
  */
@@ -106,6 +285,11 @@ void TCache::remove(const QByteArray &key)
 {
     if (_cache) {
         _cache->remove(key);
+        releaseLease(key);
+    }
+
+    if (_local) {
+        _local->remove(key);
     }
 }
 
@@ -117,6 +301,10 @@ void TCache::clear()
     if (_cache) {
         _cache->clear();
     }
+
+    if (_local) {
+        _local->clear();
+    }
 }
 
 
@@ -1,7 +1,9 @@
 #pragma once
+#include <QSet>
 #include <TGlobal>
 
 class TCacheStore;
+class TLocalCache;
 
 
 class T_CORE_EXPORT TCache {
@@ -11,6 +13,8 @@ public:
 
     bool set(const QByteArray &key, const QByteArray &value, int seconds);
     QByteArray get(const QByteArray &key);
+    QByteArray fetch(const QByteArray &key, bool &recompute);
+    void releaseLease(const QByteArray &key);
     void remove(const QByteArray &key);
     void clear();
 
@@ -19,9 +23,19 @@ public:
 private:
     void initialize();
     void cleanup();
+    bool acquireLease(const QByteArray &key);
+    QByteArray read(const QByteArray &key, int64_t &freshUntil);
+    void keepLocal(const QByteArray &key, const QByteArray &value, int64_t freshUntil);
+
+    static QByteArray wrap(const QByteArray &value, int64_t freshUntil);
+    static QByteArray leaseKey(const QByteArray &key);
+    static int staleSeconds();
+    static int leaseSeconds();
 
     TCacheStore *_cache {nullptr};
+    TLocalCache *_local {nullptr};
     int _gcDivisor {0};
+    QSet<QByteArray> _leases;
 
     friend class TWebApplication;
     T_DISABLE_COPY(TCache)
@@ -39,6 +39,13 @@ bool TCacheMemcachedStore::set(const QByteArray &key, const QByteArray &value, i
 }
 
 
+bool TCacheMemcachedStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    TMemcached memcached(Tf::KvsEngine::CacheKvs);
+    return memcached.add(key, value, seconds);
+}
+
+
 bool TCacheMemcachedStore::remove(const QByteArray &key)
 {
     TMemcached memcached(Tf::KvsEngine::CacheKvs);
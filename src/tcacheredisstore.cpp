@@ -6,6 +6,7 @@
  */
 
 #include "tcacheredisstore.h"
+#include "tredisdriver.h"
 #include <TRedis>
 
 
@@ -39,6 +40,20 @@ bool TCacheRedisStore::set(const QByteArray &key, const QByteArray &value, int s
 }
 
 
+bool TCacheRedisStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    TRedis redis(Tf::KvsEngine::CacheKvs);
+    if (!redis.driver()) {
+        return false;
+    }
+
+    QVariantList resp;
+    QByteArrayList command = {"SET", key, value, "NX", "EX", QByteArray::number(seconds)};
+    bool res = redis.driver()->request(command, resp);
+    return (res && resp.isEmpty());  // 'OK' is not listed, but a nil is
+}
+
+
 bool TCacheRedisStore::remove(const QByteArray &key)
 {
     TRedis redis(Tf::KvsEngine::CacheKvs);
@@ -32,6 +32,13 @@ bool TCacheSharedMemoryStore::set(const QByteArray &key, const QByteArray &value
 }
 
 
+bool TCacheSharedMemoryStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    TSharedMemoryKvs kvs(Tf::KvsEngine::CacheKvs);
+    return kvs.add(key, value, seconds);
+}
+
+
 QByteArray TCacheSharedMemoryStore::get(const QByteArray &key)
 {
     TSharedMemoryKvs kvs(Tf::KvsEngine::CacheKvs);
@@ -16,6 +16,7 @@ public:
     void close() override {}
     QByteArray get(const QByteArray &key) override;
     bool set(const QByteArray &key, const QByteArray &value, int seconds) override;
+    bool add(const QByteArray &key, const QByteArray &value, int seconds) override;
     bool remove(const QByteArray &key) override;
     void clear() override;
     void gc() override;
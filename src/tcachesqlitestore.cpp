@@ -170,6 +170,38 @@ bool TCacheSQLiteStore::set(const QByteArray &key, const QByteArray &value, int
 }
 
 
+bool TCacheSQLiteStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    if (key.isEmpty() || seconds <= 0) {
+        return false;
+    }
+
+    int64_t current = QDateTime::currentMSecsSinceEpoch() / 1000;
+    TSqlQuery query(Tf::app()->databaseIdForCache());
+
+    if (sqliteMajorVersion >= 3 && sqliteMinorVersion >= 24) {
+        // Overwrites only an expired item
+        query.prepare(QStringLiteral("insert into %1 (%2,%3,%4) values (:key,:ts,:blob) on conflict(k) do update set b=:blob, t=:ts where t<=:now").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN));
+        query.bind(":now", (qint64)current);
+    } else {
+        TSqlQuery del(Tf::app()->databaseIdForCache());
+        del.prepare(QStringLiteral("delete from %1 where %2=:key and %3<=:now").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN));
+        del.bind(":key", key).bind(":now", (qint64)current);
+        del.exec();
+        query.prepare(QStringLiteral("insert or ignore into %1 (%2,%3,%4) values (:key,:ts,:blob)").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN));
+    }
+
+    query.bind(":key", key).bind(":ts", (qint64)(current + seconds)).bind(":blob", value);
+    if (!query.exec()) {
+        if (lastError().isValid()) {
+            tSystemError("SQLite error : %s [%s:%d]", qUtf8Printable(lastErrorString()), __FILE__, __LINE__);
+        }
+        return false;
+    }
+    return query.numRowsAffected() > 0;
+}
+
+
 bool TCacheSQLiteStore::read(const QByteArray &key, QByteArray &blob, int64_t &timestamp)
 {
     bool ret = false;
@@ -22,8 +22,19 @@ public:
     virtual void close() = 0;
     virtual QByteArray get(const QByteArray &key) = 0;
     virtual bool set(const QByteArray &key, const QByteArray &value, int seconds) = 0;
+    virtual bool add(const QByteArray &key, const QByteArray &value, int seconds);
     virtual bool remove(const QByteArray &key) = 0;
     virtual void clear() = 0;
     virtual void gc() = 0;
     virtual QMap<QString, QVariant> defaultSettings() const { return QMap<QString, QVariant>(); }
 };
+
+
+// Not atomic; the stores which can do it atomically override this
+inline bool TCacheStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    if (!get(key).isEmpty()) {
+        return false;
+    }
+    return set(key, value, seconds);
+}
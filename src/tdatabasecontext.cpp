@@ -7,8 +7,10 @@
 
 #include "tdatabasecontext.h"
 #include "tkvsdatabasepool.h"
+#include "tmetrics.h"
 #include "tsqldatabasepool.h"
 #include "tsystemglobal.h"
+#include "ttrace.h"
 #include <QSqlDatabase>
 #include <QThreadStorage>
 #include <QtCore>
@@ -64,6 +66,8 @@ QSqlDatabase &TDatabaseContext::getSqlDatabase(int id)
     int n = 0;
     do {
         if (!db.isValid()) {
+            TMetrics::Timer metricsTimer(TMetrics::SqlPoolWait);
+            TTrace::Span span(TTrace::SqlPoolWait);
             db = TSqlDatabasePool::instance()->database(id);
         }
 
@@ -89,6 +93,8 @@ TKvsDatabase &TDatabaseContext::getKvsDatabase(Tf::KvsEngine engine)
 {
     TKvsDatabase &db = kvsDatabases[(int)engine];
     if (!db.isValid()) {
+        TMetrics::Timer metricsTimer(TMetrics::KvsPoolWait);
+        TTrace::Span span(TTrace::KvsPoolWait);
         db = TKvsDatabasePool::instance()->database(engine);
     }
 
@@ -5,6 +5,7 @@
  * the New BSD License, which is incorporated herein by reference.
  */
 
+#include "tasynclogstream.h"
 #include "tbasiclogstream.h"
 #include "tloggerfactory.h"
 #include "tsystemglobal.h"
@@ -72,7 +73,11 @@ void Tf::setupAppLoggers(TLogger *logger)
         return;
     }
 
-    stream = new TBasicLogStream(loggers);
+    if (Tf::app()->loggerSettings().value("EnableAsyncWrite", false).toBool()) {
+        stream = new TAsyncLogStream(loggers);
+    } else {
+        stream = new TBasicLogStream(loggers);
+    }
 
     // Starts flash timer for appliation logger
     flushTimer = new QTimer();
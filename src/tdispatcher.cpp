@@ -0,0 +1,131 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tdispatcher.h"
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadStorage>
+#include <array>
+
+/*!
+  \class TDispatchTable
+  \brief The TDispatchTable class provides the tables to resolve the
+  actions of controllers quickly.
+
+  The table for a class is built once from its meta-object, which maps
+  a pair of the action name and the number of arguments to the index
+  of the slot. The tables are cached per thread, so that resolving an
+  action is a lookup without lock.
+*/
+
+namespace {
+
+using MethodIndexes = std::array<int, NUM_METHOD_PARAMS>;
+using Table = QHash<QByteArray, MethodIndexes>;
+
+QMutex tableMutex;
+QHash<const QMetaObject *, const Table *> tables;  // never deleted
+QThreadStorage<QHash<const QMetaObject *, const Table *>> tableCache;
+QThreadStorage<QHash<QString, std::function<QObject *()>>> factoryCache;
+
+
+const Table *buildTable(const QMetaObject *metaObject)
+{
+    // Slots of which all the parameters are QString, the derived class first
+    QHash<QByteArray, MethodIndexes> slotIndexes;
+    for (int i = metaObject->methodCount() - 1; i >= 0; i--) {
+        QMetaMethod mm = metaObject->method(i);
+        if (mm.methodType() != QMetaMethod::Slot || mm.parameterCount() >= NUM_METHOD_PARAMS) {
+            continue;
+        }
+
+        bool ok = true;
+        for (int j = 0; j < mm.parameterCount() && ok; j++) {
+            ok = (mm.parameterType(j) == QMetaType::QString);
+        }
+        if (!ok) {
+            continue;
+        }
+
+        auto it = slotIndexes.find(mm.name());
+        if (it == slotIndexes.end()) {
+            MethodIndexes indexes;
+            indexes.fill(-1);
+            it = slotIndexes.insert(mm.name(), indexes);
+        }
+        if ((*it)[mm.parameterCount()] < 0) {
+            (*it)[mm.parameterCount()] = i;
+        }
+    }
+
+    // Resolves the slot for each number of arguments in the same order
+    // as TDispatcher looked it up
+    auto *table = new Table;
+    for (auto it = slotIndexes.cbegin(); it != slotIndexes.cend(); ++it) {
+        const MethodIndexes &found = it.value();
+        MethodIndexes resolved;
+        resolved.fill(-1);
+
+        for (int argc = 0; argc < NUM_METHOD_PARAMS; argc++) {
+            for (int i = argc; i >= 0 && resolved[argc] < 0; i--) {
+                resolved[argc] = found[i];
+            }
+            for (int i = argc + 1; i < NUM_METHOD_PARAMS - 1 && resolved[argc] < 0; i++) {
+                resolved[argc] = found[i];
+            }
+        }
+        table->insert(it.key(), resolved);
+    }
+    return table;
+}
+
+}  // namespace
+
+/*!
+  Returns the index of the slot of \a metaObject to be invoked for the
+  action \a methodName with \a argCount arguments; otherwise returns -1.
+*/
+int TDispatchTable::methodIndex(const QMetaObject *metaObject, const QByteArray &methodName, int argCount)
+{
+    auto &cache = tableCache.localData();
+    const Table *table = cache.value(metaObject);
+
+    if (Q_UNLIKELY(!table)) {
+        QMutexLocker locker(&tableMutex);
+        table = tables.value(metaObject);
+        if (!table) {
+            table = buildTable(metaObject);
+            tables.insert(metaObject, table);
+        }
+        cache.insert(metaObject, table);
+    }
+
+    auto it = table->constFind(methodName);
+    if (it == table->constEnd()) {
+        return -1;
+    }
+    return (*it)[qBound(0, argCount, NUM_METHOD_PARAMS - 1)];
+}
+
+/*!
+  Returns the factory function to create an object of \a metaType.
+*/
+std::function<QObject *()> TDispatchTable::factory(const QString &metaType)
+{
+    auto &cache = factoryCache.localData();
+    auto it = cache.constFind(metaType);
+    if (Q_LIKELY(it != cache.constEnd())) {
+        return it.value();
+    }
+
+    auto factory = Tf::objectFactories()->value(metaType.toLatin1().toLower(), nullptr);
+    if (factory) {
+        cache.insert(metaType, factory);
+    }
+    return factory;
+}
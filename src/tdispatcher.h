@@ -4,11 +4,20 @@
 #include <QMetaObject>
 #include <QMetaType>
 #include <QStringList>
+#include <QThread>
 #include <TGlobal>
+#include <functional>
 
 constexpr int NUM_METHOD_PARAMS = 11;
 
 
+class T_CORE_EXPORT TDispatchTable {
+public:
+    static int methodIndex(const QMetaObject *metaObject, const QByteArray &methodName, int argCount);
+    static std::function<QObject *()> factory(const QString &metaType);
+};
+
+
 template <class T>
 class TDispatcher {
 public:
@@ -22,6 +31,9 @@ public:
     bool hasMethod(const QByteArray &methodName);
 
 private:
+    int methodIndex(const QByteArray &methodName, int argCount);
+    bool invokeQueued(const QMetaMethod &mm, const QStringList &args, Qt::ConnectionType connectionType);
+
     QString _metaType;
     T *_ptr {nullptr};
 
@@ -44,139 +56,130 @@ inline TDispatcher<T>::~TDispatcher()
 
 
 template <class T>
-inline QMetaMethod TDispatcher<T>::method(const QByteArray &methodName, int argCount)
+inline int TDispatcher<T>::methodIndex(const QByteArray &methodName, int argCount)
 {
-    static const QByteArray params[NUM_METHOD_PARAMS] = {
-        QByteArrayLiteral("()"),
-        QByteArrayLiteral("(QString)"),
-        QByteArrayLiteral("(QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString,QString,QString,QString,QString)")};
-
     object();
     if (Q_UNLIKELY(!_ptr)) {
         tSystemDebug("Failed to invoke, no such class: %s", qUtf8Printable(_metaType));
-        return QMetaMethod();
-    }
-
-    int idx = -1;
-    int narg = qMin(argCount, NUM_METHOD_PARAMS - 1);
-    for (int i = narg; i >= 0; i--) {
-        // Find method
-        QByteArray mtd = methodName;
-        mtd += params[i];
-        idx = _ptr->metaObject()->indexOfSlot(mtd.constData());
-        if (idx >= 0) {
-            tSystemDebug("Found method: %s", mtd.constData());
-            break;
-        }
-    }
-
-    if (idx < 0) {
-        for (int i = narg + 1; i < NUM_METHOD_PARAMS - 1; i++) {
-            // Find method
-            QByteArray mtd = methodName;
-            mtd += params[i];
-            idx = _ptr->metaObject()->indexOfSlot(mtd.constData());
-            if (idx >= 0) {
-                tSystemDebug("Found method: %s", mtd.constData());
-                break;
-            }
-        }
+        return -1;
     }
 
+    int idx = TDispatchTable::methodIndex(_ptr->metaObject(), methodName, argCount);
     if (Q_UNLIKELY(idx < 0)) {
         tSystemDebug("No such method: %s", qUtf8Printable(methodName));
-        return QMetaMethod();
     }
+    return idx;
+}
 
-    return _ptr->metaObject()->method(idx);
+
+template <class T>
+inline QMetaMethod TDispatcher<T>::method(const QByteArray &methodName, int argCount)
+{
+    int idx = methodIndex(methodName, argCount);
+    return (idx >= 0) ? _ptr->metaObject()->method(idx) : QMetaMethod();
 }
 
 
 template <class T>
 inline bool TDispatcher<T>::hasMethod(const QByteArray &methodName)
 {
-    for (int i = 0; i < NUM_METHOD_PARAMS; i++) {
-        if (method(methodName, i).isValid()) {
-            return true;
-        }
-    }
-    return false;
+    object();
+    return _ptr && TDispatchTable::methodIndex(_ptr->metaObject(), methodName, NUM_METHOD_PARAMS - 1) >= 0;
 }
 
 
 template <class T>
 inline bool TDispatcher<T>::invoke(const QByteArray &method, const QStringList &args, Qt::ConnectionType connectionType)
+{
+    int idx = methodIndex(method, args.count());
+    if (Q_UNLIKELY(idx < 0)) {
+        tSystemDebug("Failed to invoke method: %s", qUtf8Printable(method));
+        return false;
+    }
+
+    tSystemDebug("Invoke method: %s", qUtf8Printable(_metaType + "." + method));
+    bool direct = (connectionType == Qt::DirectConnection)
+        || (connectionType == Qt::AutoConnection && _ptr->thread() == QThread::currentThread());
+
+    if (Q_UNLIKELY(!direct)) {
+        return invokeQueued(_ptr->metaObject()->method(idx), args, connectionType);
+    }
+
+    // Calls the slot directly, without checking the types of arguments
+    // at each call as QMetaMethod::invoke() does
+    const int paramCount = _ptr->metaObject()->method(idx).parameterCount();
+    if (Q_UNLIKELY(paramCount > qMin(args.count(), NUM_METHOD_PARAMS - 1))) {
+        return false;  // too few arguments
+    }
+
+    void *argv[NUM_METHOD_PARAMS] = {nullptr};
+    for (int i = 0; i < paramCount; i++) {
+        argv[i + 1] = const_cast<QString *>(&args[i]);
+    }
+    QMetaObject::metacall(_ptr, QMetaObject::InvokeMetaMethod, idx, argv);
+    return true;
+}
+
+
+template <class T>
+inline bool TDispatcher<T>::invokeQueued(const QMetaMethod &mm, const QStringList &args, Qt::ConnectionType connectionType)
 {
     bool ret = false;
-    QMetaMethod mm = this->method(method, args.count());
 
-    if (Q_UNLIKELY(!mm.isValid())) {
-        tSystemDebug("Failed to invoke method: %s", qUtf8Printable(method));
-    } else {
-        tSystemDebug("Invoke method: %s", qUtf8Printable(_metaType + "." + method));
-        switch (args.count()) {
-        case 0:
-            ret = mm.invoke(_ptr, connectionType);
-            break;
-        case 1:
-            ret = mm.invoke(_ptr, connectionType, Q_ARG(QString, args.value(0)));
-            break;
-        case 2:
-            ret = mm.invoke(_ptr, connectionType, Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)));
-            break;
-        case 3:
-            ret = mm.invoke(_ptr, connectionType,
-                Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)));
-            break;
-        case 4:
-            ret = mm.invoke(_ptr, connectionType,
-                Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
-                Q_ARG(QString, args.value(3)));
-            break;
-        case 5:
-            ret = mm.invoke(_ptr, connectionType,
-                Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
-                Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)));
-            break;
-        case 6:
-            ret = mm.invoke(_ptr, connectionType,
-                Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
-                Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)));
-            break;
-        case 7:
-            ret = mm.invoke(_ptr, connectionType,
-                Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
-                Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)),
-                Q_ARG(QString, args.value(6)));
-            break;
-        case 8:
-            ret = mm.invoke(_ptr, connectionType,
-                Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
-                Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)),
-                Q_ARG(QString, args.value(6)), Q_ARG(QString, args.value(7)));
-            break;
-        case 9:
-            ret = mm.invoke(_ptr, connectionType,
-                Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
-                Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)),
-                Q_ARG(QString, args.value(6)), Q_ARG(QString, args.value(7)), Q_ARG(QString, args.value(8)));
-            break;
-        default:
-            ret = mm.invoke(_ptr, connectionType,
-                Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
-                Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)),
-                Q_ARG(QString, args.value(6)), Q_ARG(QString, args.value(7)), Q_ARG(QString, args.value(8)),
-                Q_ARG(QString, args.value(9)));
-            break;
-        }
+    switch (args.count()) {
+    case 0:
+        ret = mm.invoke(_ptr, connectionType);
+        break;
+    case 1:
+        ret = mm.invoke(_ptr, connectionType, Q_ARG(QString, args.value(0)));
+        break;
+    case 2:
+        ret = mm.invoke(_ptr, connectionType, Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)));
+        break;
+    case 3:
+        ret = mm.invoke(_ptr, connectionType,
+            Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)));
+        break;
+    case 4:
+        ret = mm.invoke(_ptr, connectionType,
+            Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
+            Q_ARG(QString, args.value(3)));
+        break;
+    case 5:
+        ret = mm.invoke(_ptr, connectionType,
+            Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
+            Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)));
+        break;
+    case 6:
+        ret = mm.invoke(_ptr, connectionType,
+            Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
+            Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)));
+        break;
+    case 7:
+        ret = mm.invoke(_ptr, connectionType,
+            Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
+            Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)),
+            Q_ARG(QString, args.value(6)));
+        break;
+    case 8:
+        ret = mm.invoke(_ptr, connectionType,
+            Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
+            Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)),
+            Q_ARG(QString, args.value(6)), Q_ARG(QString, args.value(7)));
+        break;
+    case 9:
+        ret = mm.invoke(_ptr, connectionType,
+            Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
+            Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)),
+            Q_ARG(QString, args.value(6)), Q_ARG(QString, args.value(7)), Q_ARG(QString, args.value(8)));
+        break;
+    default:
+        ret = mm.invoke(_ptr, connectionType,
+            Q_ARG(QString, args.value(0)), Q_ARG(QString, args.value(1)), Q_ARG(QString, args.value(2)),
+            Q_ARG(QString, args.value(3)), Q_ARG(QString, args.value(4)), Q_ARG(QString, args.value(5)),
+            Q_ARG(QString, args.value(6)), Q_ARG(QString, args.value(7)), Q_ARG(QString, args.value(8)),
+            Q_ARG(QString, args.value(9)));
+        break;
     }
     return ret;
 }
@@ -186,7 +189,7 @@ template <class T>
 inline T *TDispatcher<T>::object()
 {
     if (!_ptr) {
-        auto factory = Tf::objectFactories()->value(_metaType.toLatin1().toLower(), nullptr);
+        auto factory = TDispatchTable::factory(_metaType);
         if (Q_LIKELY(factory)) {
             auto p = factory();
             _ptr = dynamic_cast<T *>(p);
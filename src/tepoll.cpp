@@ -15,12 +15,17 @@
 #include <QBuffer>
 #include <QByteArray>
 #include <QFileInfo>
+#include <QThread>
+#include <TAppSettings>
 #include <TApplicationServerBase>
 #include <THttpRequestHeader>
 #include <TSession>
 #include <TWebApplication>
 #include <sys/epoll.h>
 #include <sys/types.h>
+#ifdef TF_ENABLE_IO_URING
+# include "tiouring.h"
+#endif
 
 constexpr int MaxEvents = 128;
 
@@ -53,6 +58,25 @@ public:
 TEpoll::TEpoll() :
     _events(new struct epoll_event[MaxEvents])
 {
+    QString backend = Tf::appSettings()->value(Tf::MPMEpollBackend).toString().toLower();
+    if (backend == QLatin1String("io_uring")) {
+#ifdef TF_ENABLE_IO_URING
+        if (Tf::appSettings()->value(Tf::TLSEnable).toBool()) {
+            tSystemWarn("io_uring backend not available with the native TLS");
+        } else {
+            _uring = TIoUring::create();
+        }
+
+        if (_uring) {
+            tSystemDebug("Event backend: io_uring");
+            return;
+        }
+#else
+        tSystemWarn("io_uring backend not enabled, configure with --enable-io-uring");
+#endif
+        tSystemWarn("Event backend falls back to epoll");
+    }
+
     _epollFd = epoll_create1(EPOLL_CLOEXEC);
     if (_epollFd < 0) {
         tSystemError("Failed epoll_create1()");
@@ -62,6 +86,9 @@ TEpoll::TEpoll() :
 
 TEpoll::~TEpoll()
 {
+#ifdef TF_ENABLE_IO_URING
+    delete _uring;
+#endif
     delete[] _events;
 
     if (_epollFd > 0) {
@@ -76,6 +103,16 @@ int TEpoll::wait(int timeout)
         return _numEvents - _eventIterator;
     }
 
+    _pollingThread = QThread::currentThreadId();
+#ifdef TF_ENABLE_IO_URING
+    if (_uring) {
+        _polling = true;
+        int num = _uring->wait(timeout);
+        _polling = false;
+        return num;
+    }
+#endif
+
     _eventIterator = 0;
     _polling = true;
     _numEvents = tf_epoll_wait(_epollFd, _events, MaxEvents, timeout);
@@ -92,11 +129,22 @@ int TEpoll::wait(int timeout)
 
 TEpollSocket *TEpoll::next()
 {
+#ifdef TF_ENABLE_IO_URING
+    if (_uring) {
+        return _uring->next();
+    }
+#endif
     return (_eventIterator < _numEvents) ? (TEpollSocket *)_events[_eventIterator++].data.ptr : nullptr;
 }
 
 bool TEpoll::canReceive() const
 {
+#ifdef TF_ENABLE_IO_URING
+    if (_uring) {
+        return _uring->canReceive();
+    }
+#endif
+
     if (Q_UNLIKELY(_eventIterator <= 0))
         return false;
 
@@ -106,6 +154,12 @@ bool TEpoll::canReceive() const
 
 bool TEpoll::canSend() const
 {
+#ifdef TF_ENABLE_IO_URING
+    if (_uring) {
+        return _uring->canSend();
+    }
+#endif
+
     if (Q_UNLIKELY(_eventIterator <= 0)) {
         return false;
     }
@@ -137,40 +191,82 @@ bool TEpoll::addPoll(TEpollSocket *socket, int events)
     if (!events || socket->socketDescriptor() == 0) {
         return false;
     }
-    struct epoll_event ev;
-    ev.events = events;
-    ev.data.ptr = socket;
 
-    int ret = tf_epoll_ctl(_epollFd, EPOLL_CTL_ADD, socket->socketDescriptor(), &ev);
-    int err = errno;
-    if (Q_UNLIKELY(ret < 0)) {
-        if (err != EEXIST) {
-            tSystemError("Failed epoll_ctl (EPOLL_CTL_ADD)  sd:%d errno:%d", socket->socketDescriptor(), err);
-        } else {
-            ret = 0;
-        }
-    } else {
-        tSystemDebug("OK epoll_ctl (EPOLL_CTL_ADD) (events:%u)  sd:%d", events, socket->socketDescriptor());
+    if (socket->_pollEvents == events) {
+        return true;  // already added
     }
-    return !ret;
-}
 
+#ifdef TF_ENABLE_IO_URING
+    if (_uring) {
+        socket->_pollEvents = events;
+        return _uring->addPoll(socket, events);
+    }
+#endif
+    return controlPoll(socket, EPOLL_CTL_ADD, events);
+}
 
+/*!
+  Changes the events of the \a socket to \a events. Nothing is done
+  if they are not changed.
+*/
 bool TEpoll::modifyPoll(TEpollSocket *socket, int events)
 {
     if (!events || socket->socketDescriptor() == 0) {
         return false;
     }
+
+    if (socket->_pollEvents == events) {
+        return true;
+    }
+
+#ifdef TF_ENABLE_IO_URING
+    if (_uring) {
+        socket->_pollEvents = events;
+        return true;
+    }
+#endif
+    return controlPoll(socket, EPOLL_CTL_MOD, events);
+}
+
+/*!
+  Modifies the \a socket with its current events to be notified again
+  of the edge-triggered events which are ready.
+*/
+bool TEpoll::rearmPoll(TEpollSocket *socket)
+{
+    if (!socket->_pollEvents || socket->socketDescriptor() == 0) {
+        return false;
+    }
+
+#ifdef TF_ENABLE_IO_URING
+    if (_uring) {
+        return true;  // no edge-triggered events
+    }
+#endif
+    return controlPoll(socket, EPOLL_CTL_MOD, socket->_pollEvents);
+}
+
+
+bool TEpoll::controlPoll(TEpollSocket *socket, int op, int events)
+{
     struct epoll_event ev;
     ev.events = events;
     ev.data.ptr = socket;
 
-    int ret = tf_epoll_ctl(_epollFd, EPOLL_CTL_MOD, socket->socketDescriptor(), &ev);
+    int ret = tf_epoll_ctl(_epollFd, op, socket->socketDescriptor(), &ev);
     int err = errno;
     if (Q_UNLIKELY(ret < 0)) {
-        tSystemError("Failed epoll_ctl (EPOLL_CTL_MOD)  sd:%d errno:%d ev:0x%x", socket->socketDescriptor(), err, events);
+        if (op == EPOLL_CTL_ADD && err == EEXIST) {
+            ret = 0;
+        } else {
+            tSystemError("Failed epoll_ctl (op:%d)  sd:%d errno:%d ev:0x%x", op, socket->socketDescriptor(), err, events);
+        }
     } else {
-        tSystemDebug("OK epoll_ctl (EPOLL_CTL_MOD)  sd:%d", socket->socketDescriptor());
+        tSystemDebug("OK epoll_ctl (op:%d) (events:%u)  sd:%d", op, events, socket->socketDescriptor());
+    }
+
+    if (!ret) {
+        socket->_pollEvents = events;
     }
     return !ret;
 }
@@ -178,6 +274,13 @@ bool TEpoll::modifyPoll(TEpollSocket *socket, int events)
 
 bool TEpoll::deletePoll(TEpollSocket *socket)
 {
+#ifdef TF_ENABLE_IO_URING
+    if (_uring) {
+        socket->_pollEvents = 0;
+        return _uring->deletePoll(socket);
+    }
+#endif
+
     if (socket->socketDescriptor() == 0) {
         return false;
     }
@@ -190,6 +293,7 @@ bool TEpoll::deletePoll(TEpollSocket *socket)
     } else {
         tSystemDebug("OK epoll_ctl (EPOLL_CTL_DEL)  sd:%d", socket->socketDescriptor());
     }
+    socket->_pollEvents = 0;
 
     return !ret;
 }
@@ -211,6 +315,14 @@ void TEpoll::dispatchEvents()
             sock->dispose();
             break;
 
+        case TSendData::Send:
+            // Sends the data queued by the other thread
+            if (sock->isConnected() && sock->send() < 0) {
+                deletePoll(sock);
+                sock->dispose();
+            }
+            break;
+
         case TSendData::SwitchToWebSocket: {
             tSystemDebug("Switch to WebSocket");
             Q_ASSERT(sd->buffer == nullptr);
@@ -266,24 +378,26 @@ void TEpoll::releaseAllPollingSockets()
 
 void TEpoll::setSendData(TEpollSocket *socket, const QByteArray &header, QIODevice *body, bool autoRemove, TAccessLogger &&accessLogger)
 {
-    QByteArray response = header;
+    QByteArray response;
     QFileInfo fi;
 
     if (Q_LIKELY(body)) {
         QBuffer *buffer = dynamic_cast<QBuffer *>(body);
         if (buffer) {
+            response.reserve(header.length() + buffer->data().length());
+            response += header;
             response += buffer->data();
         } else {
+            response = header;
             fi.setFile(*dynamic_cast<QFile *>(body));
         }
+    } else {
+        response = header;
     }
 
     TSendBuffer *sendbuf = TEpollSocket::createSendBuffer(response, fi, autoRemove, std::move(accessLogger));
     socket->enqueueSendData(sendbuf);
-    bool res = modifyPoll(socket, (EPOLLIN | EPOLLOUT | EPOLLET));  // reset
-    if (!res) {
-        socket->dispose();
-    }
+    sendOrWait(socket);
 }
 
 
@@ -291,7 +405,33 @@ void TEpoll::setSendData(TEpollSocket *socket, const QByteArray &data)
 {
     TSendBuffer *sendbuf = TEpollSocket::createSendBuffer(data);
     socket->enqueueSendData(sendbuf);
-    bool res = modifyPoll(socket, (EPOLLIN | EPOLLOUT | EPOLLET));  // reset
+    sendOrWait(socket);
+}
+
+// Sends the queued data right away in the polling thread. The rest of
+// the data is sent on the EPOLLOUT event which occurs when the socket
+// becomes writable again after EAGAIN.
+void TEpoll::sendOrWait(TEpollSocket *socket)
+{
+    bool res;
+    if (Q_LIKELY(QThread::currentThreadId() == _pollingThread && socket->isConnected())) {
+        res = (socket->send() >= 0);
+        if (!res) {
+            deletePoll(socket);
+        }
+    } else {
+#ifdef TF_ENABLE_IO_URING
+        if (_uring) {
+            // The ring is used only in the polling thread
+            _sendRequests.enqueue(new TSendData(TSendData::Send, socket));
+            _uring->wakeUp();
+            return;
+        }
+#endif
+        // Lets the polling thread send it
+        res = rearmPoll(socket);
+    }
+
     if (!res) {
         socket->dispose();
     }
@@ -10,6 +10,7 @@ class TEpollSocket;
 class TAccessLogger;
 class TSendData;
 class THttpRequestHeader;
+class TIoUring;
 struct epoll_event;
 
 
@@ -27,9 +28,11 @@ public:
 
     bool addPoll(TEpollSocket *socket, int events);
     bool modifyPoll(TEpollSocket *socket, int events);
+    bool rearmPoll(TEpollSocket *socket);
     bool deletePoll(TEpollSocket *socket);
     void dispatchEvents();
     void releaseAllPollingSockets();
+    TIoUring *ioUring() const { return _uring; }
 
     // For action workers
     void setSendData(TEpollSocket *socket, const QByteArray &header, QIODevice *body, bool autoRemove, TAccessLogger &&accessLogger);
@@ -39,10 +42,10 @@ public:
 
     static TEpoll *instance();
 
-protected:
-    bool modifyPoll(int fd, int events);
-
 private:
+    bool controlPoll(TEpollSocket *socket, int op, int events);
+    void sendOrWait(TEpollSocket *socket);
+
     int _epollFd {0};
     int _listenSocket {0};
     struct epoll_event *_events {nullptr};
@@ -50,6 +53,8 @@ private:
     int _numEvents {0};
     int _eventIterator {0};
     TQueue<TSendData *> _sendRequests;
+    Qt::HANDLE _pollingThread {nullptr};
+    TIoUring *_uring {nullptr};
 
     TEpoll();
     T_DISABLE_COPY(TEpoll)
@@ -15,21 +15,51 @@
 #include <THttpRequestHeader>
 #include <TSystemGlobal>
 #include <TWebApplication>
-#include <ctime>
+#ifdef TF_ENABLE_IO_URING
+# include "tiouring.h"
+#endif
 using namespace Tf;
 
-constexpr int BUFFER_RESERVE_SIZE = 1023;
-
 namespace {
 int64_t systemLimitBodyBytes = -1;
+TTimerWheel timerWheel;
+
+
+int keepAliveTimeout()
+{
+    static const int timeout = Tf::appSettings()->value(Tf::HttpKeepAliveTimeout).toInt();
+    return timeout;
+}
+
+
+int requestHeaderTimeout()
+{
+    static const int timeout = Tf::appSettings()->value(Tf::HttpRequestHeaderTimeout).toInt();
+    return timeout;
+}
 }
 
+/*!
+  Returns true if the accepted sockets are encrypted with TLS.
+*/
+bool TEpollHttpSocket::tlsEnabled()
+{
+    static const bool enabled = Tf::appSettings()->value(Tf::TLSEnable).toBool();
+    return enabled;
+}
+
+
 TEpollHttpSocket *TEpollHttpSocket::accept(int listeningSocket)
 {
     struct sockaddr_storage addr;
     socklen_t addrlen = sizeof(addr);
 
+#ifdef TF_ENABLE_IO_URING
+    TIoUring *uring = TEpoll::instance()->ioUring();
+    int actfd = (uring) ? uring->accept((sockaddr *)&addr, &addrlen) : tf_accept4(listeningSocket, (sockaddr *)&addr, &addrlen, SOCK_CLOEXEC | SOCK_NONBLOCK);
+#else
     int actfd = tf_accept4(listeningSocket, (sockaddr *)&addr, &addrlen, SOCK_CLOEXEC | SOCK_NONBLOCK);
+#endif
     int err = errno;
     if (Q_UNLIKELY(actfd < 0)) {
         if (err != EAGAIN) {
@@ -38,7 +68,16 @@ TEpollHttpSocket *TEpollHttpSocket::accept(int listeningSocket)
         return nullptr;
     }
 
-    return create(actfd, QHostAddress((sockaddr *)&addr), true);
+    TEpollHttpSocket *sock = create(actfd, QHostAddress((sockaddr *)&addr), false);
+    if (Q_LIKELY(sock)) {
+        if (Q_UNLIKELY(TEpollHttpSocket::tlsEnabled() && !sock->startServerEncryption())) {
+            delete sock;
+            return nullptr;
+        }
+        sock->watch();
+        sock->updateTimer();
+    }
+    return sock;
 }
 
 
@@ -59,17 +98,17 @@ TEpollHttpSocket *TEpollHttpSocket::create(int socketDescriptor, const QHostAddr
 
 
 TEpollHttpSocket::TEpollHttpSocket(int socketDescriptor, const QHostAddress &address) :
-    TEpollSocket(socketDescriptor, Tf::SocketState::Connected, address),
-    _idleElapsed()
+    TEpollSocket(socketDescriptor, Tf::SocketState::Connected, address)
 {
-    _recvBuffer.reserve(BUFFER_RESERVE_SIZE);
-    _idleElapsed = std::time(nullptr);
+    _lastActive = timerWheel.currentTime();
+    _timer.data = this;
 }
 
 
 TEpollHttpSocket::~TEpollHttpSocket()
 {
     tSystemDebug("~TEpollHttpSocket");
+    timerWheel.stop(&_timer);
 }
 
 
@@ -94,7 +133,7 @@ int TEpollHttpSocket::send()
 {
     int ret = TEpollSocket::send();
     if (ret == 0) {
-        _idleElapsed = std::time(nullptr);
+        updateTimer();
     }
     return ret;
 }
@@ -104,7 +143,7 @@ int TEpollHttpSocket::recv()
 {
     int ret = TEpollSocket::recv();
     if (ret == 0) {
-        _idleElapsed = std::time(nullptr);
+        updateTimer();
     }
     return ret;
 }
@@ -141,7 +180,11 @@ bool TEpollHttpSocket::seekRecvBuffer(int pos)
             tSystemDebug("Upgrade: %s", upgradeHeader.data());
 
             if (upgradeHeader == "websocket") {
-                if (TWebSocket::searchEndpoint(header)) {
+                if (Q_UNLIKELY(isEncrypted())) {
+                    // WebSocket is not supported over the native TLS
+                    tSystemWarn("WebSocket over TLS not supported");
+                    disconnect();
+                } else if (TWebSocket::searchEndpoint(header)) {
                     // Switch protocols
                     switchToWebSocket(header);
                 } else {
@@ -172,7 +215,7 @@ void TEpollHttpSocket::releaseWorker()
 {
     tSystemDebug("TEpollHttpSocket::releaseWorker");
 
-    bool res = TEpoll::instance()->modifyPoll(this, (EPOLLIN | EPOLLOUT | EPOLLET));  // reset
+    bool res = TEpoll::instance()->modifyPoll(this, (EPOLLIN | EPOLLOUT | EPOLLET));  // skipped if unchanged
     if (!res) {
         dispose();
     }
@@ -210,6 +253,31 @@ void TEpollHttpSocket::clear()
     _recvBuffer.resize(0);
 }
 
+// Restarts the timer of the keep-alive timeout. While a request header
+// is arriving, the timer is not extended beyond the deadline of the
+// request header timeout.
+void TEpollHttpSocket::updateTimer()
+{
+    int64_t now = timerWheel.currentTime();
+    int64_t deadline = (keepAliveTimeout() > 0) ? now + keepAliveTimeout() : INT64_MAX;
+    _lastActive = now;
+
+    if (requestHeaderTimeout() > 0 && _lengthToRead < 0 && !_recvBuffer.isEmpty()) {
+        if (!_headerDeadline) {
+            _headerDeadline = now + requestHeaderTimeout();
+        }
+        deadline = std::min(deadline, _headerDeadline);
+    } else {
+        _headerDeadline = 0;
+    }
+
+    if (deadline == INT64_MAX) {
+        timerWheel.stop(&_timer);
+    } else {
+        timerWheel.start(&_timer, deadline);
+    }
+}
+
 
 QList<TEpollHttpSocket *> TEpollHttpSocket::allSockets()
 {
@@ -229,5 +297,18 @@ QList<TEpollHttpSocket *> TEpollHttpSocket::allSockets()
 */
 int TEpollHttpSocket::idleTime() const
 {
-    return (uint)std::time(nullptr) - _idleElapsed;
+    return timerWheel.currentTime() - _lastActive;
+}
+
+/*!
+  Returns the sockets which exceeded the keep-alive timeout or the
+  request header timeout. Only the sockets timed out are visited.
+*/
+QList<TEpollHttpSocket *> TEpollHttpSocket::timedOutSockets()
+{
+    QList<TEpollHttpSocket *> sockets;
+    for (auto *timer : timerWheel.expire(TTimerWheel::clock())) {
+        sockets << static_cast<TEpollHttpSocket *>(timer->data);
+    }
+    return sockets;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "tepollsocket.h"
+#include "ttimerwheel.h"
 #include <TGlobal>
 
 class QHostAddress;
@@ -21,6 +22,8 @@ public:
     static TEpollHttpSocket *accept(int listeningSocket);
     static TEpollHttpSocket *create(int socketDescriptor, const QHostAddress &address, bool watch = true);
     static QList<TEpollHttpSocket *> allSockets();
+    static QList<TEpollHttpSocket *> timedOutSockets();
+    static bool tlsEnabled();
 
 protected:
     virtual int send() override;
@@ -28,10 +31,13 @@ protected:
     virtual bool seekRecvBuffer(int pos) override;
     void parse();
     void clear();
+    void updateTimer();
 
 private:
-    int64_t _lengthToRead {0};
-    uint _idleElapsed {0};
+    int64_t _lengthToRead {-1};
+    int64_t _lastActive {0};  // secs of the timer wheel clock
+    int64_t _headerDeadline {0};
+    TTimerWheel::Timer _timer;
     TActionWorker *_worker {nullptr};
 
     TEpollHttpSocket(int socketDescriptor, const QHostAddress &address);
@@ -8,13 +8,23 @@
 #include "tepollsocket.h"
 #include "tepoll.h"
 #include "tfcore.h"
+#include "tmetrics.h"
 #include "tsendbuffer.h"
 #include <THttpHeader>
+#include <TAppSettings>
 #include <TSystemGlobal>
 #include <TWebApplication>
 #include <TMultiplexingServer>
 #include <QFileInfo>
 #include <QSet>
+#include <memory>
+#ifdef TF_ENABLE_TLS
+# include "ttlsconnection.h"
+# include "ttlscontext.h"
+#endif
+#ifdef TF_ENABLE_IO_URING
+# include "tiouring.h"
+#endif
 
 class SendData;
 
@@ -31,6 +41,23 @@ int recvBufSize = 0;
 QSet<TEpollSocket *> socketManager;
 
 
+// Data is read into this block of the polling thread and then only the
+// bytes read are copied into the receive buffer of the socket, so that
+// an idle connection holds no buffer reserved for reading
+char *recvBlock()
+{
+    static thread_local std::unique_ptr<char[]> block(new char[recvBufSize]);
+    return block.get();
+}
+
+
+int64_t maxRecvBufferSize()
+{
+    static const int64_t size = Tf::appSettings()->value(Tf::MPMEpollMaxRecvBufferSize).toLongLong();
+    return size;
+}
+
+
 void setAddressAndPort(const QHostAddress &address, uint16_t port, tf_sockaddr *aa, int &addrSize)
 {
     if (address.protocol() == QAbstractSocket::IPv6Protocol || address.protocol() == QAbstractSocket::AnyIPProtocol) {
@@ -93,6 +120,7 @@ TEpollSocket::TEpollSocket()
     tSystemDebug("TEpollSocket  socket:%d", _socket);
     socketManager.insert(this);
     initBuffer(_socket);
+    TMetrics::add(TMetrics::ActiveSockets);
 }
 
 
@@ -104,6 +132,7 @@ TEpollSocket::TEpollSocket(int socketDescriptor, Tf::SocketState state, const QH
     tSystemDebug("TEpollSocket  socket:%d", _socket);
     socketManager.insert(this);
     initBuffer(_socket);
+    TMetrics::add(TMetrics::ActiveSockets);
 }
 
 
@@ -111,9 +140,16 @@ TEpollSocket::~TEpollSocket()
 {
     tSystemDebug("TEpollSocket::destructor");
 
+#ifdef TF_ENABLE_IO_URING
+    if (_pollEvents && TEpoll::instance()->ioUring()) {
+        // The kernel may still refer to the buffers
+        TEpoll::instance()->deletePoll(this);
+    }
+#endif
     close();
     socketManager.remove(this);
     TMultiplexingServer::instance()->_garbageSockets.remove(this);
+    TMetrics::add(TMetrics::ActiveSockets, -1);
 
     while (!_sendBuffer.isEmpty()) {
         TSendBuffer *buf = _sendBuffer.dequeue();
@@ -133,6 +169,14 @@ void TEpollSocket::dispose()
 
 void TEpollSocket::close()
 {
+#ifdef TF_ENABLE_TLS
+    if (_tls) {
+        _tls->shutdown();
+        delete _tls;
+        _tls = nullptr;
+    }
+#endif
+
     if (_socket > 0) {
         tf_close_socket(_socket);
         _socket = 0;
@@ -185,6 +229,50 @@ bool TEpollSocket::watch()
 }
 
 
+/*!
+  Starts the TLS handshake as a server on the connected socket.
+  The handshake proceeds without blocking on the events of the socket.
+*/
+bool TEpollSocket::startServerEncryption()
+{
+#ifdef TF_ENABLE_TLS
+    const TTlsContext *context = TTlsContext::instance();
+    if (!context || _tls) {
+        return false;
+    }
+
+    _tls = new TTlsConnection(context, _socket);
+    if (!_tls->isValid()) {
+        delete _tls;
+        _tls = nullptr;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*!
+  Performs the TLS handshake.
+  @return  1:established  0:in progress  -1:error
+ */
+int TEpollSocket::handshake()
+{
+#ifdef TF_ENABLE_TLS
+    int res = _tls->handshake();
+    if (res > 0) {
+        // Resets the edge-triggered events to receive the data arrived
+        // during the handshake
+        TEpoll::instance()->rearmPoll(this);
+    }
+    return res;
+#else
+    return -1;
+#endif
+}
+
+
 /*!
   Receives data
   @return  0:success  -1:error
@@ -195,10 +283,29 @@ int TEpollSocket::recv()
     int err = 0;
     int len;
 
+#ifdef TF_ENABLE_IO_URING
+    if (TEpoll::instance()->ioUring()) {
+        return TEpoll::instance()->ioUring()->recv(this);
+    }
+#endif
+
+#ifdef TF_ENABLE_TLS
+    if (_tls && !_tls->isEstablished()) {
+        int res = handshake();
+        if (res <= 0) {
+            return res;
+        }
+    }
+#endif
+
+    char *buf = recvBlock();
     for (;;) {
-        void *buf = getRecvBuffer(recvBufSize);
         errno = 0;
+#ifdef TF_ENABLE_TLS
+        len = (_tls) ? _tls->read(buf, recvBufSize) : tf_recv(_socket, buf, recvBufSize, 0);
+#else
         len = tf_recv(_socket, buf, recvBufSize, 0);
+#endif
         err = errno;
 
         if (len <= 0) {
@@ -206,7 +313,9 @@ int TEpollSocket::recv()
         }
 
         // Read successfully
-        seekRecvBuffer(len);
+        if (!appendRecvData(buf, len)) {
+            return -1;
+        }
     }
 
     if (!len && !err) {
@@ -241,6 +350,21 @@ int TEpollSocket::send()
 {
     int ret = 0;
 
+#ifdef TF_ENABLE_IO_URING
+    if (TEpoll::instance()->ioUring()) {
+        return TEpoll::instance()->ioUring()->send(this);
+    }
+#endif
+
+#ifdef TF_ENABLE_TLS
+    if (_tls && !_tls->isEstablished()) {
+        int res = handshake();
+        if (res <= 0) {
+            return res;
+        }
+    }
+#endif
+
     if (_sendBuffer.isEmpty()) {
         return ret;
     }
@@ -259,7 +383,11 @@ int TEpollSocket::send()
             }
 
             errno = 0;
+#ifdef TF_ENABLE_TLS
+            len = (_tls) ? _tls->write(data, len) : tf_send(_socket, data, len);
+#else
             len = tf_send(_socket, data, len);
+#endif
             err = errno;
 
             if (len <= 0) {
@@ -302,10 +430,32 @@ int TEpollSocket::send()
 }
 
 
+/*!
+  Appends the \a data received to the receive buffer. Returns false if
+  the buffer exceeds MPM.epoll.MaxRecvBufferSize.
+*/
+bool TEpollSocket::appendRecvData(const char *data, int length)
+{
+    int64_t limit = maxRecvBufferSize();
+    if (Q_UNLIKELY(limit > 0 && _recvBuffer.size() + length > limit)) {
+        tSystemWarn("Receive buffer exceeds the limit : sd:%d  limit:%lld", _socket, (qint64)limit);
+        return false;
+    }
+
+    void *buf = getRecvBuffer(length);
+    std::memcpy(buf, data, length);
+    seekRecvBuffer(length);
+    return true;
+}
+
+
 void *TEpollSocket::getRecvBuffer(int size)
 {
-    int len = _recvBuffer.size();
-    _recvBuffer.reserve(len + size);
+    int64_t len = _recvBuffer.size();
+    if (len + size > _recvBuffer.capacity()) {
+        // Grows geometrically
+        _recvBuffer.reserve(std::max(len + size, (int64_t)_recvBuffer.capacity() * 2));
+    }
     return _recvBuffer.data() + len;
 }
 
@@ -12,6 +12,7 @@ class THttpRequestHeader;
 class QHostAddress;
 class QThread;
 class QFileInfo;
+class TTlsConnection;
 
 
 class T_CORE_EXPORT TEpollSocket {
@@ -46,6 +47,8 @@ public:
     void setSocketDescriptor(int socketDescriptor);
     bool setSocketOption(int level, int optname, int val);
     bool watch();
+    bool startServerEncryption();
+    bool isEncrypted() const { return (bool)_tls; }
 
     virtual bool canReadRequest() { return false; }
     virtual void process() { }
@@ -70,10 +73,15 @@ private:
     QHostAddress _peerAddress;
     QQueue<TSendBuffer *> _sendBuffer;
     bool _autoDelete {true};
+    TTlsConnection *_tls {nullptr};
+    int _pollEvents {0};  // events registered to epoll
 
+    int handshake();
+    bool appendRecvData(const char *data, int length);
     static void initBuffer(int socketDescriptor);
 
     friend class TEpoll;
+    friend class TIoUring;
     friend class TMultiplexingServer;
     T_DISABLE_COPY(TEpollSocket)
     T_DISABLE_MOVE(TEpollSocket)
@@ -10,7 +10,7 @@
 #include "tepoll.h"
 #include "turlroute.h"
 #include "twebsocketframe.h"
-#include "twebsocketworker.h"
+#include "twebsocketworkerpool.h"
 #include <QCryptographicHash>
 #include <QDataStream>
 #include <TAppSettings>
@@ -151,21 +151,25 @@ void TEpollWebSocket::process()
 
     auto payloads = readAllBinaryRequest();
     if (!payloads.isEmpty()) {
-        TWebSocketWorker *_worker = new TWebSocketWorker(TWebSocketWorker::Receiving, this, reqHeader.path());
-        _worker->setPayloads(payloads);
-        startWorker(_worker);
-        delete _worker;
-        _worker = nullptr;
+        TWebSocketTask task;
+        task.mode = TWebSocketWorker::Receiving;
+        task.payloads = payloads;
+        startWorker(task);
         releaseWorker();
     }
 }
 
-
-void TEpollWebSocket::startWorker(TWebSocketWorker *worker)
+// Runs the task in the worker pool, waiting for it in the epoll thread
+// since the socket is not thread-safe
+void TEpollWebSocket::startWorker(const TWebSocketTask &task)
 {
-    worker->moveToThread(thread());
-    worker->start();
-    worker->wait();
+    TWebSocketTask t = task;
+    t.socket = this;
+    t.requestPath = reqHeader.path();
+
+    _processing = true;
+    TWebSocketWorkerPool::instance()->startAndWait(t);
+    _processing = false;
 }
 
 
@@ -173,7 +177,7 @@ void TEpollWebSocket::releaseWorker()
 {
     tSystemDebug("TEpollWebSocket::releaseWorker");
 
-    bool res = TEpoll::instance()->modifyPoll(this, (EPOLLIN | EPOLLOUT | EPOLLET));  // reset
+    bool res = TEpoll::instance()->modifyPoll(this, (EPOLLIN | EPOLLOUT | EPOLLET));  // skipped if unchanged
     if (!res) {
         dispose();
     }
@@ -182,23 +186,21 @@ void TEpollWebSocket::releaseWorker()
 
 void TEpollWebSocket::startWorkerForOpening(const TSession &session)
 {
-    TWebSocketWorker *worker = new TWebSocketWorker(TWebSocketWorker::Opening, this, reqHeader.path());
-    worker->setSession(session);
-    startWorker(worker);
-
+    TWebSocketTask task;
+    task.mode = TWebSocketWorker::Opening;
+    task.session = session;
+    startWorker(task);
     releaseWorker();
-    delete worker;
 }
 
 
 void TEpollWebSocket::startWorkerForClosing()
 {
     if (!closing.load()) {
-        TWebSocketWorker *worker = new TWebSocketWorker(TWebSocketWorker::Closing, this, reqHeader.path());
-        startWorker(worker);
-
+        TWebSocketTask task;
+        task.mode = TWebSocketWorker::Closing;
+        startWorker(task);
         releaseWorker();
-        delete worker;
     }
 }
 
@@ -8,7 +8,7 @@
 #include <THttpResponseHeader>
 
 class QHostAddress;
-class TWebSocketWorker;
+struct TWebSocketTask;
 class TWebSocketFrame;
 class TSession;
 class THttpRequestHeader;
@@ -24,7 +24,7 @@ public:
     QList<QPair<int, QByteArray>> readAllBinaryRequest();
     virtual bool canReadRequest() override;
     virtual void process() override;
-    virtual bool isProcessing() const override { return (bool)_worker; }
+    virtual bool isProcessing() const override { return _processing; }
     void startWorkerForOpening(const TSession &session);
     void startWorkerForClosing();
     void disconnect() override;
@@ -46,11 +46,11 @@ protected:
     void clear();
 
 private:
-    void startWorker(TWebSocketWorker *worker);
+    void startWorker(const TWebSocketTask &task);
     TEpollWebSocket(int socketDescriptor, const QHostAddress &address, const THttpRequestHeader &header);
 
     QList<TWebSocketFrame> _frames;
-    TWebSocketWorker *_worker {nullptr};
+    bool _processing {false};
 
     friend class TEpoll;
     T_DISABLE_COPY(TEpollWebSocket)
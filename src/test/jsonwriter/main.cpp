@@ -0,0 +1,228 @@
+#include <TfTest/TfTest>
+#include <QJsonDocument>
+#include <TAbstractModel>
+#include <TModelObject>
+#include "../../tjsonwriter.h"
+
+
+class FooObject : public TModelObject {
+    Q_OBJECT
+    Q_PROPERTY(int id MEMBER id)
+    Q_PROPERTY(QString user_name MEMBER user_name)
+    Q_PROPERTY(double score MEMBER score)
+    Q_PROPERTY(QDateTime created_at MEMBER created_at)
+public:
+    int id {0};
+    QString user_name;
+    double score {0};
+    QDateTime created_at;
+
+    bool isNull() const override { return id == 0; }
+    bool create() override { return false; }
+    bool update() override { return false; }
+    bool save() override { return false; }
+    bool remove() override { return false; }
+};
+
+
+class Foo : public TAbstractModel {
+public:
+    Foo(int id = 0, const QString &name = QString(), double score = 0, const QDateTime &createdAt = QDateTime())
+    {
+        d.id = id;
+        d.user_name = name;
+        d.score = score;
+        d.created_at = createdAt;
+    }
+    Foo(const Foo &other) : TAbstractModel() { *this = other; }
+    Foo &operator=(const Foo &other)
+    {
+        d.id = other.d.id;
+        d.user_name = other.d.user_name;
+        d.score = other.d.score;
+        d.created_at = other.d.created_at;
+        return *this;
+    }
+
+private:
+    FooObject d;
+
+    TModelObject *modelData() override { return &d; }
+    const TModelObject *modelData() const override { return &d; }
+};
+
+
+// Hides the score from the JSON
+class Bar : public Foo {
+public:
+    using Foo::Foo;
+
+    QJsonObject toJsonObject(const QStringList &properties = QStringList()) const override
+    {
+        QJsonObject json = Foo::toJsonObject(properties);
+        json.remove("score");
+        return json;
+    }
+};
+
+
+class TestJsonWriter : public QObject
+{
+    Q_OBJECT
+private slots:
+    void writeVariant_data();
+    void writeVariant();
+    void writeStructure();
+    void writeModel_data();
+    void writeModel();
+    void writeModelList();
+    void writeModelOverridden();
+};
+
+
+void TestJsonWriter::writeVariant_data()
+{
+    QTest::addColumn<QVariant>("value");
+
+    QTest::newRow("1") << QVariant(true);
+    QTest::newRow("2") << QVariant(0);
+    QTest::newRow("3") << QVariant(-2147483647);
+    QTest::newRow("4") << QVariant(123456789u);
+    QTest::newRow("5") << QVariant(3.25);
+    QTest::newRow("6") << QVariant(-0.001);
+    QTest::newRow("7") << QVariant(1e21);
+    QTest::newRow("8") << QVariant(100.0);
+    QTest::newRow("9") << QVariant(QString());
+    QTest::newRow("10") << QVariant(QString("hello world"));
+    QTest::newRow("11") << QVariant(QString("\"quoted\" \\ / \b\f\n\r\t \x01\x1f"));
+    QTest::newRow("12") << QVariant(QString::fromUtf8(u8"日本語 é 😀"));
+    QTest::newRow("13") << QVariant(QStringList({"a", "b", "c"}));
+    QTest::newRow("14") << QVariant(QVariantList({1, "x", false, 2.5}));
+    QTest::newRow("15") << QVariant(QVariantMap({{"b", 1}, {"a", "x"}, {"c", QVariantList({1, 2})}}));
+    QTest::newRow("16") << QVariant(QDateTime(QDate(2024, 2, 29), QTime(23, 59, 58, 7)));
+    QTest::newRow("17") << QVariant(QDateTime(QDate(1999, 1, 2), QTime(3, 4, 5), Qt::UTC));
+    QTest::newRow("18") << QVariant(QDate(2001, 12, 31));
+    QTest::newRow("19") << QVariant(QTime(8, 30, 0, 250));
+    QTest::newRow("20") << QVariant(9007199254740991.0);
+    QTest::newRow("21") << QVariant(-1152921504606846976.0);
+    QTest::newRow("22") << QVariant(12345678901234567890.0);
+    QTest::newRow("23") << QVariant(1.8446744073709552e19);
+    QTest::newRow("24") << QVariant(123456789012.5);
+}
+
+
+void TestJsonWriter::writeVariant()
+{
+    QFETCH(QVariant, value);
+
+    TJsonWriter writer;
+    writer.beginArray();
+    writer.writeVariant(value);
+    writer.endArray();
+
+    QJsonArray array;
+    array.append(QJsonValue::fromVariant(value));
+    QByteArray expected = QJsonDocument(array).toJson(QJsonDocument::Compact);
+    QCOMPARE(writer.data(), expected);
+}
+
+
+void TestJsonWriter::writeStructure()
+{
+    TJsonWriter writer;
+    writer.beginObject();
+    writer.writeKey(QLatin1String("data"));
+    writer.beginArray();
+    writer.beginObject();
+    writer.writeKey(QString("id"));
+    writer.writeInt(1);
+    writer.writeKey(QString("name"));
+    writer.writeString(QLatin1String("foo"));
+    writer.endObject();
+    writer.beginObject();
+    writer.endObject();
+    writer.writeNull();
+    writer.endArray();
+    writer.writeKey(QLatin1String("count"));
+    writer.writeUInt(2);
+    writer.endObject();
+
+    QCOMPARE(writer.data(), QByteArray("{\"data\":[{\"id\":1,\"name\":\"foo\"},{},null],\"count\":2}"));
+}
+
+
+void TestJsonWriter::writeModel_data()
+{
+    QTest::addColumn<QStringList>("properties");
+
+    QTest::newRow("1") << QStringList();
+    QTest::newRow("2") << QStringList({"id", "userName"});
+    QTest::newRow("3") << QStringList({"createdAt"});
+}
+
+
+void TestJsonWriter::writeModel()
+{
+    QFETCH(QStringList, properties);
+
+    Foo foo(12, QString::fromUtf8(u8"Hanako \"H\" 日本"), 3.5, QDateTime(QDate(2024, 5, 6), QTime(7, 8, 9), Qt::UTC));
+    TJsonWriter writer;
+    writer.writeModel(foo, properties);
+
+    QByteArray expected = QJsonDocument(foo.toJsonObject(properties)).toJson(QJsonDocument::Compact);
+    QCOMPARE(writer.data(), expected);
+}
+
+
+void TestJsonWriter::writeModelList()
+{
+    QList<Foo> list;
+    list << Foo(1, "foo", -0.25, QDateTime(QDate(2020, 1, 1), QTime(0, 0, 0), Qt::UTC));
+    list << Foo(2, QString(), 0);
+    list << Foo(3, "baz", 1e10, QDateTime(QDate(1999, 12, 31), QTime(23, 59, 59, 999)));
+
+    TJsonWriter writer;
+    writer.beginObject();
+    writer.writeKey(QLatin1String("data"));
+    writer.writeModelList(list);
+    writer.endObject();
+
+    QJsonArray array;
+    for (auto &foo : list) {
+        array.append(foo.toJsonObject());
+    }
+    QJsonObject object {{"data", array}};
+    QCOMPARE(writer.data(), QJsonDocument(object).toJson(QJsonDocument::Compact));
+
+    // Empty list
+    writer.clear();
+    writer.writeModelList(QList<Foo>());
+    QCOMPARE(writer.data(), QByteArray("[]"));
+}
+
+void TestJsonWriter::writeModelOverridden()
+{
+    Bar bar(5, "bar", 2.5);
+    TJsonWriter writer;
+    writer.writeModel(bar);
+    QCOMPARE(writer.data(), QJsonDocument(bar.toJsonObject()).toJson(QJsonDocument::Compact));
+    QVERIFY(!writer.data().contains("score"));
+
+    // Through the reference to the base class
+    writer.clear();
+    writer.writeModel(static_cast<const TAbstractModel &>(bar));
+    QCOMPARE(writer.data(), QJsonDocument(bar.toJsonObject()).toJson(QJsonDocument::Compact));
+
+    QList<Bar> list;
+    list << Bar(1, "a", 1) << Bar(2, "b", 2);
+    writer.clear();
+    writer.writeModelList(list);
+    QJsonArray array;
+    for (auto &b : list) {
+        array.append(b.toJsonObject());
+    }
+    QCOMPARE(writer.data(), QJsonDocument(array).toJson(QJsonDocument::Compact));
+}
+
+TF_TEST_SQLLESS_MAIN(TestJsonWriter)
+#include "main.moc"
@@ -0,0 +1,128 @@
+#include <TfTest/TfTest>
+#include "../../tlocalcache.h"
+
+
+class TestLocalCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void hitAndMiss();
+    void expire();
+    void evictLeastRecentlyUsed();
+    void invalidate();
+};
+
+// Returns the keys of one shard of the cache
+static QByteArrayList keysOfShard(int count)
+{
+    QByteArrayList keys;
+    const uint shard = qHash(QByteArray("key0")) % 16;
+    for (int i = 0; keys.count() < count; i++) {
+        QByteArray key = "key" + QByteArray::number(i);
+        if (qHash(key) % 16 == shard) {
+            keys << key;
+        }
+    }
+    return keys;
+}
+
+
+void TestLocalCache::hitAndMiss()
+{
+    TLocalCache cache(1000, 10);
+    QByteArray value;
+
+    QVERIFY(!cache.get("foo", value));
+    cache.set("foo", "bar", 10);
+    QVERIFY(cache.get("foo", value));
+    QCOMPARE(value, QByteArray("bar"));
+
+    cache.set("foo", "baz", 10);  // overwrites
+    QVERIFY(cache.get("foo", value));
+    QCOMPARE(value, QByteArray("baz"));
+
+    cache.set("", "bar", 10);  // ignored
+    cache.set("hoge", "bar", 0);
+    QVERIFY(!cache.get("", value));
+    QVERIFY(!cache.get("hoge", value));
+
+    auto stats = cache.statistics();
+    QCOMPARE(stats.hits, 2ULL);
+    QCOMPARE(stats.misses, 4ULL);
+    QCOMPARE(stats.count, 1);
+}
+
+
+void TestLocalCache::expire()
+{
+    TLocalCache cache(1000, 1);  // capped to one second
+    QByteArray value;
+
+    cache.set("foo", "bar", 100);
+    cache.set("hoge", "bar", 1);
+    QVERIFY(cache.get("foo", value));
+    QVERIFY(cache.get("hoge", value));
+
+    Tf::msleep(1100);
+    QVERIFY(!cache.get("foo", value));
+    QVERIFY(!cache.get("hoge", value));
+    QCOMPARE(cache.statistics().count, 0);
+}
+
+
+void TestLocalCache::evictLeastRecentlyUsed()
+{
+    TLocalCache cache(32, 10);  // two entries per shard
+    const QByteArrayList keys = keysOfShard(4);
+    QByteArray value;
+
+    cache.set(keys[0], "0", 10);
+    cache.set(keys[1], "1", 10);
+    QVERIFY(cache.get(keys[0], value));  // keys[1] is the least recently used
+
+    cache.set(keys[2], "2", 10);
+    QVERIFY(!cache.get(keys[1], value));
+    QVERIFY(cache.get(keys[0], value));
+    QCOMPARE(value, QByteArray("0"));
+    QVERIFY(cache.get(keys[2], value));
+    QCOMPARE(value, QByteArray("2"));
+
+    cache.set(keys[0], "00", 10);  // updated as recently used
+    cache.set(keys[3], "3", 10);
+    QVERIFY(!cache.get(keys[2], value));
+    QVERIFY(cache.get(keys[0], value));
+    QCOMPARE(value, QByteArray("00"));
+
+    auto stats = cache.statistics();
+    QCOMPARE(stats.evictions, 2ULL);
+    QCOMPARE(stats.count, 2);
+}
+
+
+void TestLocalCache::invalidate()
+{
+    TLocalCache cache(1000, 10);
+    QByteArray value;
+
+    cache.set("foo", "1", 10);
+    cache.set("bar", "2", 10);
+    cache.set("baz", "3", 10);
+
+    cache.invalidate("foo");
+    QVERIFY(!cache.get("foo", value));
+    QVERIFY(cache.get("bar", value));
+
+    cache.invalidate("nothing");
+    QCOMPARE(cache.statistics().count, 2);
+
+    cache.invalidate(QByteArray());  // all
+    QVERIFY(!cache.get("bar", value));
+    QVERIFY(!cache.get("baz", value));
+
+    auto stats = cache.statistics();
+    QCOMPARE(stats.invalidations, 3ULL);
+    QCOMPARE(stats.count, 0);
+}
+
+TF_TEST_SQLLESS_MAIN(TestLocalCache)
+#include "main.moc"
@@ -0,0 +1,147 @@
+#include <TfTest/TfTest>
+#include <TAccessLog>
+#include <TLog>
+#include <TLogger>
+#include "../../tloglayout.h"
+#include "../../tatomicringbuffer.h"
+
+
+class TestLogLayout : public QObject
+{
+    Q_OBJECT
+private slots:
+    void formatAppLog_data();
+    void formatAppLog();
+    void formatAccessLog_data();
+    void formatAccessLog();
+    void timestampCache();
+    void ringBuffer();
+    void changeLayout();
+};
+
+
+class NullLogger : public TLogger {
+public:
+    QString key() const override { return "Null"; }
+    bool isMultiProcessSafe() const override { return true; }
+    bool open() override { return true; }
+    void close() override { }
+    bool isOpen() const override { return true; }
+    void log(const QByteArray &) override { }
+};
+
+
+void TestLogLayout::formatAppLog_data()
+{
+    QTest::addColumn<QByteArray>("layout");
+    QTest::addColumn<int>("priority");
+    QTest::addColumn<QByteArray>("output");
+
+    QTest::newRow("1") << QByteArray("%d %5P %m%n") << (int)Tf::WarnLevel << QByteArray("2024-02-29 23:59:58  WARN hello\n");
+    QTest::newRow("2") << QByteArray("[%p] %m") << (int)Tf::ErrorLevel << QByteArray("[error] hello");
+    QTest::newRow("3") << QByteArray("%7P|%e") << (int)Tf::InfoLevel << QByteArray("INFO   |-12");
+    QTest::newRow("4") << QByteArray("%05e %%5 %x %") << (int)Tf::DebugLevel << QByteArray("-0012 %%5 %x %");
+    QTest::newRow("5") << QByteArray("%P") << -1 << QByteArray();
+}
+
+
+void TestLogLayout::formatAppLog()
+{
+    QFETCH(QByteArray, layout);
+    QFETCH(int, priority);
+    QFETCH(QByteArray, output);
+
+    TLog log(priority, "hello", -12);
+    log.timestamp = QDateTime(QDate(2024, 2, 29), QTime(23, 59, 58, 7));
+    TLogLayout compiled(layout, "yyyy-MM-dd hh:mm:ss");
+    QCOMPARE(compiled.format(log), output);
+}
+
+
+void TestLogLayout::formatAccessLog_data()
+{
+    QTest::addColumn<QByteArray>("layout");
+    QTest::addColumn<QByteArray>("output");
+
+    QTest::newRow("1") << QByteArray("%h %d \"%r\" %s %O%n") << QByteArray("127.0.0.1 2024-02-29 23:59:58 \"GET / HTTP/1.1\" 200 512\n");
+    QTest::newRow("2") << QByteArray("%06O %4e %m") << QByteArray("000512   34 %m");
+}
+
+
+void TestLogLayout::formatAccessLog()
+{
+    QFETCH(QByteArray, layout);
+    QFETCH(QByteArray, output);
+
+    TAccessLog log("127.0.0.1", "GET / HTTP/1.1", 34);
+    log.timestamp = QDateTime(QDate(2024, 2, 29), QTime(23, 59, 58, 7));
+    log.statusCode = 200;
+    log.responseBytes = 512;
+    TLogLayout compiled(layout, "yyyy-MM-dd hh:mm:ss", TLogLayout::AccessLog);
+    QCOMPARE(compiled.format(log), output);
+    QCOMPARE(log.toByteArray(layout, "yyyy-MM-dd hh:mm:ss"), output);
+}
+
+
+void TestLogLayout::timestampCache()
+{
+    TLog log(Tf::InfoLevel, "msg");
+    log.timestamp = QDateTime(QDate(2024, 1, 1), QTime(0, 0, 0, 100));
+
+    TLogLayout sec("%d %m", "hh:mm:ss");
+    TLogLayout msec("%d %m", "hh:mm:ss.zzz");
+    QCOMPARE(sec.format(log), QByteArray("00:00:00 msg"));
+    QCOMPARE(msec.format(log), QByteArray("00:00:00.100 msg"));
+
+    log.timestamp = log.timestamp.addMSecs(500);
+    QCOMPARE(sec.format(log), QByteArray("00:00:00 msg"));
+    QCOMPARE(msec.format(log), QByteArray("00:00:00.600 msg"));
+
+    log.timestamp = log.timestamp.addMSecs(500);
+    QCOMPARE(sec.format(log), QByteArray("00:00:01 msg"));
+    QCOMPARE(msec.format(log), QByteArray("00:00:01.100 msg"));
+}
+
+
+void TestLogLayout::ringBuffer()
+{
+    TAtomicRingBuffer<QByteArray> buffer(5);
+    QCOMPARE(buffer.capacity(), 8);
+
+    for (int i = 0; i < 8; ++i) {
+        QVERIFY(buffer.push(QByteArray::number(i)));
+    }
+    QVERIFY(!buffer.push("full"));
+    QCOMPARE(buffer.count(), 8);
+
+    QByteArray value;
+    for (int i = 0; i < 8; ++i) {
+        QVERIFY(buffer.pop(value));
+        QCOMPARE(value, QByteArray::number(i));
+    }
+    QVERIFY(!buffer.pop(value));
+    QCOMPARE(buffer.count(), 0);
+}
+
+
+void TestLogLayout::changeLayout()
+{
+    TLog log(Tf::WarnLevel, "hello");
+    log.timestamp = QDateTime(QDate(2024, 2, 29), QTime(23, 59, 58));
+
+    NullLogger logger;
+    Tf::setAppLogDateTimeFormat("hh:mm:ss");
+    Tf::setAppLogLayout("%P %m");
+    QCOMPARE(logger.logToByteArray(log), QByteArray("WARN hello"));
+
+    // Recompiled after the change
+    Tf::setAppLogLayout("%d [%p] %m");
+    QCOMPARE(logger.logToByteArray(log), QByteArray("23:59:58 [warn] hello"));
+
+    Tf::setAppLogDateTimeFormat("yyyy-MM-dd");
+    QCOMPARE(logger.logToByteArray(log), QByteArray("2024-02-29 [warn] hello"));
+}
+
+
+TF_TEST_SQLLESS_MAIN(TestLogLayout)
+#include "main.moc"
@@ -20,6 +20,8 @@ private slots:
     void testAlloc7();
     void testAlloc8();
     void testReuse1();
+    void testReuse2();
+    void testRealloc1();
 
     void bench();
 };
@@ -231,6 +233,55 @@ void TestMalloc::testReuse1()
     QCOMPARE(alloc->dataSegmentSize(), 0U);
 }
 
+void TestMalloc::testReuse2()
+{
+    void *p1 = alloc->malloc(64);
+    void *p2 = alloc->malloc(4096);
+    void *p3 = alloc->malloc(64);
+    void *p4 = alloc->malloc(32);
+
+    alloc->free(p1);
+    alloc->free(p3);
+    QCOMPARE(alloc->countFreeBlocks(), 2);
+    QCOMPARE(alloc->largestFreeBlockSize(), 64U);
+    // Taken from the free list of the same class
+    void *p5 = alloc->malloc(50);
+    QVERIFY(p5 == p1 || p5 == p3);
+    QCOMPARE(alloc->countFreeBlocks(), 1);
+    alloc->free(p5);
+    alloc->free(p2);
+    QCOMPARE(alloc->countBlocks(), 2);
+    QCOMPARE(alloc->countFreeBlocks(), 1);
+#if defined(Q_PROCESSOR_X86_32) || defined(Q_PROCESSOR_ARM_32)
+    QCOMPARE(alloc->largestFreeBlockSize(), 64U + 16 + 4096 + 16 + 64);
+#else
+    QCOMPARE(alloc->largestFreeBlockSize(), 64U + 24 + 4096 + 24 + 64);
+#endif
+    alloc->summary();
+    alloc->free(p4);
+    QCOMPARE(alloc->countBlocks(), 0);
+    QCOMPARE(alloc->countFreeBlocks(), 0);
+    QCOMPARE(alloc->dataSegmentSize(), 0U);
+}
+
+void TestMalloc::testRealloc1()
+{
+    void *p1 = alloc->malloc(4096);
+    void *p2 = alloc->malloc(1024);
+    void *p3 = alloc->malloc(32);
+
+    alloc->free(p2);
+    // Grows into the next free block
+    void *p4 = alloc->realloc(p1, 4096 + 100);
+    QCOMPARE(p4, p1);
+    QCOMPARE(alloc->countBlocks(), 3);
+    QCOMPARE(alloc->countFreeBlocks(), 1);
+    alloc->free(p4);
+    alloc->free(p3);
+    QCOMPARE(alloc->countBlocks(), 0);
+    QCOMPARE(alloc->dataSegmentSize(), 0U);
+}
+
 
 void TestMalloc::bench()
 {
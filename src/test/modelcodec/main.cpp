@@ -0,0 +1,235 @@
+#include <TfTest/TfTest>
+#include <QDateTime>
+#include <TModelDecoder>
+#include <TModelEncoder>
+#include <climits>
+
+const quint32 SchemaVersion = 0x1234abcd;
+
+
+class TestModelCodec : public QObject
+{
+    Q_OBJECT
+private slots:
+    void int64_data();
+    void int64();
+    void integers();
+    void strings();
+    void dates();
+    void legacy();
+    void skipSchemaMismatch();
+    void readPastEnd();
+};
+
+
+void TestModelCodec::int64_data()
+{
+    QTest::addColumn<qint64>("value");
+
+    QTest::newRow("0") << (qint64)0;
+    QTest::newRow("1") << (qint64)1;
+    QTest::newRow("-1") << (qint64)-1;
+    QTest::newRow("63") << (qint64)63;
+    QTest::newRow("-64") << (qint64)-64;
+    QTest::newRow("64") << (qint64)64;
+    QTest::newRow("INT64_MIN") << (qint64)INT64_MIN;
+    QTest::newRow("INT64_MAX") << (qint64)INT64_MAX;
+}
+
+
+void TestModelCodec::int64()
+{
+    QFETCH(qint64, value);
+
+    QByteArray buf;
+    QDataStream out(&buf, QIODevice::WriteOnly);
+    {
+        TModelEncoder encoder(out, SchemaVersion);
+        encoder << value << (quint64)value;
+    }
+
+    QDataStream in(buf);
+    TModelDecoder decoder(in, SchemaVersion);
+    qint64 actual = 1;
+    quint64 uactual = 1;
+    decoder >> actual >> uactual;
+    QCOMPARE(decoder.status(), TModelDecoder::Ok);
+    QCOMPARE(actual, value);
+    QCOMPARE(uactual, (quint64)value);
+}
+
+
+void TestModelCodec::integers()
+{
+    QByteArray buf;
+    QDataStream out(&buf, QIODevice::WriteOnly);
+    {
+        TModelEncoder encoder(out, SchemaVersion);
+        encoder << 0 << -1 << INT_MIN << INT_MAX << 0u << UINT_MAX << true << false;
+    }
+
+    QDataStream in(buf);
+    TModelDecoder decoder(in, SchemaVersion);
+    int i1, i2, i3, i4;
+    uint u1, u2;
+    bool b1, b2;
+    decoder >> i1 >> i2 >> i3 >> i4 >> u1 >> u2 >> b1 >> b2;
+    QCOMPARE(decoder.status(), TModelDecoder::Ok);
+    QCOMPARE(i1, 0);
+    QCOMPARE(i2, -1);
+    QCOMPARE(i3, INT_MIN);
+    QCOMPARE(i4, INT_MAX);
+    QCOMPARE(u1, 0u);
+    QCOMPARE(u2, UINT_MAX);
+    QCOMPARE(b1, true);
+    QCOMPARE(b2, false);
+}
+
+
+void TestModelCodec::strings()
+{
+    const QString text = QString::fromUtf8("h\xc3\xa9llo \xe4\xb8\x96\xe7\x95\x8c");
+    QByteArray buf;
+    QDataStream out(&buf, QIODevice::WriteOnly);
+    {
+        TModelEncoder encoder(out, SchemaVersion);
+        encoder << QString() << QString("") << text << QByteArray() << QByteArray("\0\xff", 2);
+    }
+
+    QDataStream in(buf);
+    TModelDecoder decoder(in, SchemaVersion);
+    QString s1("x"), s2("x"), s3;
+    QByteArray b1("x"), b2;
+    decoder >> s1 >> s2 >> s3 >> b1 >> b2;
+    QCOMPARE(decoder.status(), TModelDecoder::Ok);
+    // A null string is decoded as an empty one
+    QVERIFY(s1.isEmpty());
+    QVERIFY(s2.isEmpty());
+    QCOMPARE(s3, text);
+    QVERIFY(b1.isEmpty());
+    QCOMPARE(b2, QByteArray("\0\xff", 2));
+}
+
+
+void TestModelCodec::dates()
+{
+    const QDateTime dt(QDate(2024, 2, 29), QTime(23, 59, 58, 123), Qt::UTC);
+    QByteArray buf;
+    QDataStream out(&buf, QIODevice::WriteOnly);
+    {
+        TModelEncoder encoder(out, SchemaVersion);
+        encoder << QDateTime() << dt << QDate() << QDate(1970, 1, 1);
+    }
+
+    QDataStream in(buf);
+    TModelDecoder decoder(in, SchemaVersion);
+    QDateTime d1 = QDateTime::currentDateTime(), d2;
+    QDate d3 = QDate::currentDate(), d4;
+    decoder >> d1 >> d2 >> d3 >> d4;
+    QCOMPARE(decoder.status(), TModelDecoder::Ok);
+    QVERIFY(d1.isNull());
+    QCOMPARE(d2, dt);
+    QVERIFY(d3.isNull());
+    QCOMPARE(d4, QDate(1970, 1, 1));
+}
+
+
+void TestModelCodec::legacy()
+{
+    QVariantMap map;
+    map.insert("id", 10);
+    map.insert("name", QString("foo"));
+    map.insert("created_at", QDateTime(QDate(2024, 1, 1), QTime(0, 0), Qt::UTC));
+
+    QByteArray buf;
+    QDataStream out(&buf, QIODevice::WriteOnly);
+    out << map << (qint32)-7;
+
+    QDataStream in(buf);
+    TModelDecoder decoder(in, SchemaVersion);
+    QVERIFY(decoder.isLegacy());
+    QCOMPARE(decoder.legacyValues(), map);
+
+    // Nothing is decoded positionally
+    int id = 99;
+    decoder >> id;
+    QCOMPARE(id, 99);
+
+    // The stream is positioned after the map
+    qint32 trailer = 0;
+    in >> trailer;
+    QCOMPARE(in.status(), QDataStream::Ok);
+    QCOMPARE(trailer, (qint32)-7);
+}
+
+
+void TestModelCodec::skipSchemaMismatch()
+{
+    QByteArray buf;
+    QDataStream out(&buf, QIODevice::WriteOnly);
+    {
+        TModelEncoder encoder(out, SchemaVersion + 1);
+        encoder << 1 << QString("old") << QDateTime::currentDateTimeUtc();
+    }
+    {
+        TModelEncoder encoder(out, SchemaVersion);
+        encoder << 2 << QString("new");
+    }
+    out << (qint32)-7;
+
+    QDataStream in(buf);
+    {
+        TModelDecoder decoder(in, SchemaVersion);
+        QCOMPARE(decoder.status(), TModelDecoder::SchemaMismatch);
+        int id = 99;
+        QString name("x");
+        decoder >> id >> name;
+        QCOMPARE(id, 99);
+        QCOMPARE(name, QString("x"));
+    }
+    {
+        TModelDecoder decoder(in, SchemaVersion);
+        int id = 0;
+        QString name;
+        decoder >> id >> name;
+        QCOMPARE(decoder.status(), TModelDecoder::Ok);
+        QCOMPARE(id, 2);
+        QCOMPARE(name, QString("new"));
+    }
+
+    qint32 trailer = 0;
+    in >> trailer;
+    QCOMPARE(in.status(), QDataStream::Ok);
+    QCOMPARE(trailer, (qint32)-7);
+}
+
+
+void TestModelCodec::readPastEnd()
+{
+    QByteArray buf;
+    QDataStream out(&buf, QIODevice::WriteOnly);
+    {
+        TModelEncoder encoder(out, SchemaVersion);
+        encoder << 1 << QString("foo");
+    }
+
+    QDataStream in(buf);
+    TModelDecoder decoder(in, SchemaVersion);
+    int id = 0;
+    QString name;
+    qint64 extra = 99;
+    decoder >> id >> name >> extra;
+    QCOMPARE(decoder.status(), TModelDecoder::ReadPastEnd);
+    QCOMPARE(id, 1);
+    QCOMPARE(name, QString("foo"));
+    QCOMPARE(extra, (qint64)99);
+
+    // A truncated blob is not decoded
+    QDataStream trunc(buf.left(buf.size() - 2));
+    TModelDecoder decoder2(trunc, SchemaVersion);
+    QCOMPARE(decoder2.status(), TModelDecoder::ReadPastEnd);
+}
+
+
+TF_TEST_SQLLESS_MAIN(TestModelCodec)
+#include "main.moc"
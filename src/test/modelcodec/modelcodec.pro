@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = modelcodec
+SOURCES = main.cpp
@@ -22,6 +22,9 @@ private slots:
     void itemsCountChangesMakeCurrentPageInvalid();
     void limitChangesMakeCurrentPageInvalid_data();
     void limitChangesMakeCurrentPageInvalid();
+    void cursor();
+    void tamperedCursor_data();
+    void tamperedCursor();
 };
 
 void TestPaginator::constructor_data()
@@ -409,6 +412,58 @@ void TestPaginator::limitChangesMakeCurrentPageInvalid()
     QCOMPARE(pager.currentPage(), expectedCurrentPage);
 }
 
+void TestPaginator::cursor()
+{
+    QVariantList keys;
+    keys << 10 << QString("foo bar") << QDateTime(QDate(2024, 2, 29), QTime(12, 0, 0)) << QByteArray("\xff\xfe", 2);
+
+    QByteArray cursor = TPaginator::encodeCursor(keys);
+    QVERIFY(!cursor.contains('+'));
+    QVERIFY(!cursor.contains('/'));
+    QVERIFY(!cursor.contains('='));
+
+    bool ok = false;
+    QCOMPARE(TPaginator::decodeCursor(cursor, &ok), keys);
+    QVERIFY(ok);
+
+    // Empty keys for the first page
+    cursor = TPaginator::encodeCursor(QVariantList());
+    QVERIFY(TPaginator::decodeCursor(cursor, &ok).isEmpty());
+    QVERIFY(ok);
+}
+
+void TestPaginator::tamperedCursor_data()
+{
+    QTest::addColumn<QByteArray>("cursor");
+
+    QByteArray cursor = TPaginator::encodeCursor(QVariantList() << 10 << QString("foo"));
+    QByteArray other = TPaginator::encodeCursor(QVariantList() << 11 << QString("foo"));
+    int idx = cursor.indexOf('.');
+
+    QByteArray data = cursor;
+    data[1] = (data[1] == 'A') ? 'B' : 'A';
+    QByteArray digest = cursor;
+    digest[idx + 1] = (digest[idx + 1] == 'A') ? 'B' : 'A';
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("no digest") << cursor.left(idx);
+    QTest::newRow("empty digest") << cursor.left(idx + 1);
+    QTest::newRow("no data") << cursor.mid(idx);
+    QTest::newRow("data changed") << data;
+    QTest::newRow("digest changed") << digest;
+    QTest::newRow("digest swapped") << QByteArray(cursor.left(idx) + other.mid(other.indexOf('.')));
+    QTest::newRow("digest truncated") << cursor.left(cursor.length() - 1);
+}
+
+void TestPaginator::tamperedCursor()
+{
+    QFETCH(QByteArray, cursor);
+
+    bool ok = true;
+    QVERIFY(TPaginator::decodeCursor(cursor, &ok).isEmpty());
+    QVERIFY(!ok);
+}
+
 #if QT_VERSION < 0x050000
 Q_DECLARE_METATYPE(QList<int>)
 #endif
@@ -20,6 +20,9 @@ private slots:
     void testAlloc3_data();
     void testAlloc3();
     void testAlloc4();
+    void testRehash();
+    void testExpire();
+    void testEviction();
 
     void bench1();
     void bench2();
@@ -203,6 +206,124 @@ void TestSharedMemoryHash::testAlloc4()
 }
 
 
+void TestSharedMemoryHash::testRehash()
+{
+    //
+    // Grows the table across rehashes while reading and writing
+    //
+    TSharedMemoryKvs smhash;
+    QMap<QByteArray, QByteArray> map;
+    smhash.clear();
+    const uint initialSize = smhash.tableSize();
+
+    for (int i = 0; smhash.tableSize() < initialSize * 4; i++) {
+        QByteArray key = "rehash" + QByteArray::number(i);
+        QByteArray value = randomString(Tf::random(16, 64));
+        QVERIFY(smhash.set(key, value, 100));
+        map.insert(key, value);
+
+        // Reads and writes during the incremental rehash
+        QByteArray k = "rehash" + QByteArray::number(Tf::random(i));
+        QCOMPARE(smhash.get(k), map.value(k));
+        if (i % 7 == 0) {
+            QCOMPARE(smhash.remove(k), map.contains(k));
+            map.remove(k);
+        } else if (i % 5 == 0) {
+            value = randomString(32);
+            QVERIFY(smhash.set(k, value, 100));
+            map.insert(k, value);
+        }
+        QCOMPARE(smhash.count(), (uint)map.count());
+    }
+
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        QCOMPARE(smhash.get(it.key()), it.value());
+    }
+
+    smhash.rehash();  // completes it
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        QCOMPARE(smhash.get(it.key()), it.value());
+    }
+    QCOMPARE(smhash.count(), (uint)map.count());
+    smhash.clear();
+}
+
+
+void TestSharedMemoryHash::testExpire()
+{
+    //
+    // Expired entries are reclaimed by writes through the wheel
+    //
+    TSharedMemoryKvs smhash;
+    smhash.clear();
+
+    for (int i = 0; i < 50; i++) {
+        QVERIFY(smhash.set("short" + QByteArray::number(i), "value", 1));
+        QVERIFY(smhash.set("long" + QByteArray::number(i), "value", 100));
+    }
+    QCOMPARE(smhash.count(), 100U);
+
+    Tf::msleep(2100);
+    QCOMPARE(smhash.get("short0"), QByteArray());  // expired
+    QCOMPARE(smhash.get("long0"), QByteArray("value"));
+
+    // Writes remove the expired ones
+    for (int i = 0; i < 10; i++) {
+        QVERIFY(smhash.set("long" + QByteArray::number(i), "value2", 100));
+    }
+    QCOMPARE(smhash.count(), 50U);
+    for (int i = 0; i < 50; i++) {
+        QCOMPARE(smhash.get("long" + QByteArray::number(i)), QByteArray((i < 10) ? "value2" : "value"));
+    }
+    smhash.clear();
+}
+
+
+void TestSharedMemoryHash::testEviction()
+{
+    //
+    // Evicts the least recently used entries over the memory limit
+    //
+    TSharedMemoryKvs smhash;
+    smhash.clear();
+    const quint64 oldLimit = smhash.memoryLimit();
+    const QByteArray value = randomString(1000);
+
+    // Three quarters are cold, so that sampling finds one for each eviction
+    for (int i = 0; i < 200; i++) {
+        QVERIFY(smhash.set("lru" + QByteArray::number(i), value, 100));
+    }
+    smhash.setMemoryLimit(smhash.usedBytes());
+
+    Tf::msleep(1100);
+    for (int i = 150; i < 200; i++) {
+        QCOMPARE(smhash.get("lru" + QByteArray::number(i)), value);  // hot
+    }
+
+    const quint64 evicted = smhash.evictedCount();
+    for (int i = 0; i < 10; i++) {
+        QVERIFY(smhash.set("new" + QByteArray::number(i), value, 100));
+    }
+    QVERIFY(smhash.usedBytes() <= smhash.memoryLimit());
+    QVERIFY(smhash.evictedCount() - evicted >= 10);
+
+    int coldEvicted = 0;
+    for (int i = 0; i < 200; i++) {
+        if (smhash.get("lru" + QByteArray::number(i)).isEmpty()) {
+            QVERIFY2(i < 150, "hot entry evicted");
+            coldEvicted++;
+        }
+    }
+    QCOMPARE((quint64)coldEvicted, smhash.evictedCount() - evicted);
+    for (int i = 0; i < 10; i++) {
+        QCOMPARE(smhash.get("new" + QByteArray::number(i)), value);
+    }
+
+    smhash.setMemoryLimit(oldLimit);
+    smhash.clear();
+}
+
+
 static void insert(uint count, float factor)
 {
     QByteArray key, value;
@@ -0,0 +1,192 @@
+#include <TfTest/TfTest>
+#include <TPaginator>
+#include <TSqlORMapper>
+#include <TSqlObject>
+#include <TSqlQuery>
+
+using SortColumns = QList<QPair<QString, Tf::SortOrder>>;
+Q_DECLARE_METATYPE(SortColumns)
+
+
+class ItemObject : public TSqlObject {
+public:
+    int id {0};
+    QString name;
+    int score {0};
+
+    enum PropertyIndex {
+        Id = 0,
+        Name,
+        Score,
+    };
+
+    int primaryKeyIndex() const { return Id; }
+    QString tableName() const { return QStringLiteral("item"); }
+
+private:
+    Q_OBJECT
+    Q_PROPERTY(int id READ getid WRITE setid)
+    T_DEFINE_PROPERTY(int, id)
+    Q_PROPERTY(QString name READ getname WRITE setname)
+    T_DEFINE_PROPERTY(QString, name)
+    Q_PROPERTY(int score READ getscore WRITE setscore)
+    T_DEFINE_PROPERTY(int, score)
+};
+
+
+class ItemMapper : public TSqlORMapper<ItemObject> {
+public:
+    using TSqlORMapper<ItemObject>::keysetFilter;
+    using TSqlORMapper<ItemObject>::setSortOrder;
+
+    void setSortOrder(const SortColumns &columns)
+    {
+        for (auto &p : columns) {
+            TSqlORMapper<ItemObject>::setSortOrder(p.first, p.second);
+        }
+    }
+};
+
+
+class TestSqlORMapper : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void keysetFilter_data();
+    void keysetFilter();
+    void keysetFilterInvalid();
+    void keysetValues();
+    void keysetPages_data();
+    void keysetPages();
+};
+
+
+void TestSqlORMapper::initTestCase()
+{
+    // id, name, score
+    //  1 a 1,  2 b 2,  3 a 0,  4 b 1,  5 a 2,  6 b 0,  7 a 1,  8 b 2,  9 a 0
+    TSqlQuery query;
+    QVERIFY(query.exec(QStringLiteral("CREATE TABLE item (id INTEGER PRIMARY KEY, name TEXT NOT NULL, score INTEGER NOT NULL)")));
+    for (int i = 1; i <= 9; i++) {
+        QString sql = QStringLiteral("INSERT INTO item (id, name, score) VALUES (%1, '%2', %3)").arg(i).arg(QLatin1String((i % 2) ? "a" : "b")).arg(i % 3);
+        QVERIFY(query.exec(sql));
+    }
+}
+
+
+void TestSqlORMapper::keysetFilter_data()
+{
+    QTest::addColumn<SortColumns>("sort");
+    QTest::addColumn<QVariantList>("keys");
+    QTest::addColumn<QString>("filter");
+
+    QTest::newRow("pk only")
+        << SortColumns()
+        << (QVariantList() << 4)
+        << QString("(t0.\"id\") > (4)");
+    QTest::newRow("row value asc")
+        << (SortColumns() << qMakePair(QString("score"), Tf::AscendingOrder))
+        << (QVariantList() << 1 << 4)
+        << QString("(t0.\"score\", t0.\"id\") > (1, 4)");
+    QTest::newRow("row value desc")
+        << (SortColumns() << qMakePair(QString("name"), Tf::DescendingOrder) << qMakePair(QString("score"), Tf::DescendingOrder))
+        << (QVariantList() << "b" << 2 << 8)
+        << QString("(t0.\"name\", t0.\"score\", t0.\"id\") < ('b', 2, 8)");
+    QTest::newRow("pk sorted")
+        << (SortColumns() << qMakePair(QString("id"), Tf::DescendingOrder) << qMakePair(QString("score"), Tf::DescendingOrder))
+        << (QVariantList() << 5 << 2)
+        << QString("(t0.\"id\", t0.\"score\") < (5, 2)");
+    QTest::newRow("expanded")
+        << (SortColumns() << qMakePair(QString("score"), Tf::AscendingOrder) << qMakePair(QString("name"), Tf::DescendingOrder))
+        << (QVariantList() << 1 << "b" << 7)
+        << QString("(t0.\"score\" > 1 OR (t0.\"score\" = 1 AND (t0.\"name\" < 'b' OR (t0.\"name\" = 'b' AND t0.\"id\" < 7))))");
+}
+
+
+void TestSqlORMapper::keysetFilter()
+{
+    QFETCH(SortColumns, sort);
+    QFETCH(QVariantList, keys);
+    QFETCH(QString, filter);
+
+    ItemMapper mapper;
+    mapper.setSortOrder(sort);
+    mapper.setKeyset(keys);
+    QCOMPARE(mapper.keysetFilter(), filter);
+}
+
+
+void TestSqlORMapper::keysetFilterInvalid()
+{
+    // The number of the keys differs from that of the columns
+    ItemMapper mapper;
+    mapper.setSortOrder("score", Tf::AscendingOrder);
+    mapper.setKeyset(QVariantList() << 1);
+    QCOMPARE(mapper.keysetFilter(), QString("1=0"));
+    QCOMPARE(mapper.find(), 0);
+}
+
+
+void TestSqlORMapper::keysetValues()
+{
+    ItemObject obj;
+    obj.id = 7;
+    obj.name = "a";
+    obj.score = 1;
+
+    // The sort column is given case-insensitively
+    ItemMapper mapper;
+    mapper.setSortOrder("SCORE", Tf::AscendingOrder);
+    mapper.setSortOrder("Name", Tf::DescendingOrder);
+    QCOMPARE(mapper.keysetValues(obj), QVariantList() << 1 << "a" << 7);
+
+    mapper.setKeyset(mapper.keysetValues(obj));
+    QCOMPARE(mapper.keysetFilter(), QString("(t0.\"score\" > 1 OR (t0.\"score\" = 1 AND (t0.\"name\" < 'a' OR (t0.\"name\" = 'a' AND t0.\"id\" < 7))))"));
+}
+
+
+void TestSqlORMapper::keysetPages_data()
+{
+    QTest::addColumn<SortColumns>("sort");
+    QTest::addColumn<QList<int>>("ids");
+
+    QTest::newRow("pk") << SortColumns()
+        << (QList<int>() << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9);
+    QTest::newRow("uniform") << (SortColumns() << qMakePair(QString("score"), Tf::AscendingOrder))
+        << (QList<int>() << 3 << 6 << 9 << 1 << 4 << 7 << 2 << 5 << 8);
+    QTest::newRow("mixed") << (SortColumns() << qMakePair(QString("score"), Tf::AscendingOrder) << qMakePair(QString("name"), Tf::DescendingOrder))
+        << (QList<int>() << 6 << 9 << 3 << 4 << 7 << 1 << 8 << 2 << 5);
+}
+
+
+void TestSqlORMapper::keysetPages()
+{
+    QFETCH(SortColumns, sort);
+    QFETCH(QList<int>, ids);
+
+    for (int perPage = 1; perPage <= 4; perPage++) {
+        QList<int> actual;
+        QByteArray cursor;
+
+        for (int page = 0; page < 10; page++) {
+            ItemMapper mapper;
+            mapper.setSortOrder(sort);
+            mapper.setLimit(perPage);
+            mapper.setKeyset(TPaginator::decodeCursor(cursor));
+            if (mapper.find() <= 0) {
+                break;
+            }
+            for (auto it = mapper.begin(); it != mapper.end(); ++it) {
+                actual << (*it).id;
+            }
+            // Through the cursor token as the API service does
+            cursor = TPaginator::encodeCursor(mapper.keysetValues(mapper.last()));
+        }
+        QCOMPARE(actual, ids);
+    }
+}
+
+
+TF_TEST_MAIN(TestSqlORMapper)
+#include "main.moc"
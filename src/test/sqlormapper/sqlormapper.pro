@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = sqlormapper
+SOURCES = main.cpp
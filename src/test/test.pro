@@ -4,13 +4,18 @@ SUBDIRS  = htmlescape httpheader hmac htmlparser
 SUBDIRS += mailmessage multipartformdata  smtpmailer viewhelper paginator
 SUBDIRS += fieldnametovariablename rand urlrouter urlrouter2
 SUBDIRS += buildtest stack queue forlist
-SUBDIRS += jscontext compression sqlitedb url malloc
+SUBDIRS += jscontext compression sqlitedb url malloc jsonwriter loglayout localcache timerwheel modelcodec sqlormapper
 !mac {
   SUBDIRS += sharedmemoryhash sharedmemorymutex
 }
 unix {
   SUBDIRS += redis memcached
 }
+linux-* {
+  packagesExist(openssl) {
+    SUBDIRS += tls
+  }
+}
 
 fwtests.target = test
 fwtests.commands = make check
@@ -0,0 +1,152 @@
+#include <TfTest/TfTest>
+#include "../../ttimerwheel.h"
+
+using Timer = TTimerWheel::Timer;
+
+
+class TestTimerWheel : public QObject
+{
+    Q_OBJECT
+private slots:
+    void expire();
+    void expirePastDeadline();
+    void slotWrap();
+    void restart();
+    void restartSameSlot();
+    void stop();
+    void expireAfterLongPause();
+};
+
+
+void TestTimerWheel::expire()
+{
+    TTimerWheel wheel;
+    const int64_t t0 = wheel.currentTime();
+    Timer a, b;
+    wheel.start(&a, t0 + 3);
+    wheel.start(&b, t0 + 5);
+    QVERIFY(TTimerWheel::isActive(&a));
+    QVERIFY(TTimerWheel::isActive(&b));
+
+    QVERIFY(wheel.expire(t0 + 2).isEmpty());
+    QCOMPARE(wheel.expire(t0 + 3), QList<Timer *>() << &a);
+    QVERIFY(!TTimerWheel::isActive(&a));
+    QVERIFY(TTimerWheel::isActive(&b));
+    QCOMPARE(wheel.currentTime(), t0 + 3);
+
+    // The clock never goes back
+    QVERIFY(wheel.expire(t0 + 1).isEmpty());
+    QCOMPARE(wheel.currentTime(), t0 + 3);
+
+    QCOMPARE(wheel.expire(t0 + 6), QList<Timer *>() << &b);
+    QVERIFY(!TTimerWheel::isActive(&b));
+}
+
+
+void TestTimerWheel::expirePastDeadline()
+{
+    TTimerWheel wheel;
+    const int64_t t0 = wheel.currentTime();
+    Timer a, b;
+    wheel.start(&a, t0 - 10);
+    wheel.start(&b, t0);
+
+    QList<Timer *> expired = wheel.expire(t0 + 1);
+    QCOMPARE(expired.count(), 2);
+    QVERIFY(expired.contains(&a));
+    QVERIFY(expired.contains(&b));
+}
+
+
+void TestTimerWheel::slotWrap()
+{
+    TTimerWheel wheel;
+    const int64_t t0 = wheel.currentTime();
+    Timer near, far;
+    wheel.start(&near, t0 + 3);
+    wheel.start(&far, t0 + 3 + 64);  // same slot, a round later
+
+    QCOMPARE(wheel.expire(t0 + 3), QList<Timer *>() << &near);
+    QVERIFY(TTimerWheel::isActive(&far));
+
+    for (int64_t t = t0 + 4; t < t0 + 3 + 64; t++) {
+        QVERIFY(wheel.expire(t).isEmpty());
+    }
+    QVERIFY(TTimerWheel::isActive(&far));
+    QCOMPARE(wheel.expire(t0 + 3 + 64), QList<Timer *>() << &far);
+}
+
+
+void TestTimerWheel::restart()
+{
+    TTimerWheel wheel;
+    const int64_t t0 = wheel.currentTime();
+    Timer a;
+    wheel.start(&a, t0 + 3);
+    wheel.start(&a, t0 + 10);
+    QCOMPARE(a.deadline, t0 + 10);
+
+    QVERIFY(wheel.expire(t0 + 9).isEmpty());
+    QCOMPARE(wheel.expire(t0 + 10), QList<Timer *>() << &a);
+
+    // Restarts an expired timer
+    wheel.start(&a, t0 + 12);
+    QVERIFY(TTimerWheel::isActive(&a));
+    QCOMPARE(wheel.expire(t0 + 12), QList<Timer *>() << &a);
+}
+
+
+void TestTimerWheel::restartSameSlot()
+{
+    TTimerWheel wheel;
+    const int64_t t0 = wheel.currentTime();
+    Timer a, b;
+    wheel.start(&a, t0 + 3);
+    wheel.start(&b, t0 + 3);
+    wheel.start(&a, t0 + 3 + 64);  // moves the deadline only
+    QCOMPARE(a.deadline, t0 + 3 + 64);
+
+    QCOMPARE(wheel.expire(t0 + 3), QList<Timer *>() << &b);
+    QVERIFY(TTimerWheel::isActive(&a));
+    QCOMPARE(wheel.expire(t0 + 3 + 64), QList<Timer *>() << &a);
+}
+
+
+void TestTimerWheel::stop()
+{
+    TTimerWheel wheel;
+    const int64_t t0 = wheel.currentTime();
+    Timer a, b, c;
+    wheel.start(&a, t0 + 3);
+    wheel.start(&b, t0 + 3);
+    wheel.start(&c, t0 + 3);
+
+    wheel.stop(&b);
+    QVERIFY(!TTimerWheel::isActive(&b));
+    wheel.stop(&b);  // no-op
+
+    QCOMPARE(wheel.expire(t0 + 3), QList<Timer *>() << &a << &c);
+}
+
+
+void TestTimerWheel::expireAfterLongPause()
+{
+    TTimerWheel wheel;
+    const int64_t t0 = wheel.currentTime();
+    Timer timers[100];
+    for (int i = 0; i < 100; i++) {
+        wheel.start(&timers[i], t0 + 1 + i);
+    }
+
+    // Jumps more than a round; every slot is visited once
+    QList<Timer *> expired = wheel.expire(t0 + 80);
+    QCOMPARE(expired.count(), 80);
+    for (int i = 0; i < 100; i++) {
+        QCOMPARE(TTimerWheel::isActive(&timers[i]), i >= 80);
+    }
+    QCOMPARE(wheel.expire(t0 + 1000).count(), 20);
+}
+
+
+TF_TEST_SQLLESS_MAIN(TestTimerWheel)
+#include "main.moc"
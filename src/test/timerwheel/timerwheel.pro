@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = timerwheel
+SOURCES = main.cpp
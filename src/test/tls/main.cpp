@@ -0,0 +1,351 @@
+#include <TfTest/TfTest>
+#include "../../ttlsconnection.h"
+#include "../../ttlscontext.h"
+#include <QTemporaryDir>
+#include <cerrno>
+#include <fcntl.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+class TestTls : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void handshake();
+    void alpn_data();
+    void alpn();
+    void readWouldBlock();
+    void sessionResumption();
+    void noResumptionAcrossContexts();
+    void closeNotifyFromClient();
+    void closeNotifyFromServer();
+
+private:
+    TTlsContext *createContext(const QByteArrayList &alpnProtocols = QByteArrayList());
+
+    QTemporaryDir _dir;
+    QString _certFile;
+    QString _keyFile;
+};
+
+
+// A client and the server side of a TLS connection over a socket pair
+class Connection {
+public:
+    Connection(const TTlsContext *context, SSL_CTX *clientContext)
+    {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, _fds) == 0) {
+            fcntl(_fds[0], F_SETFL, fcntl(_fds[0], F_GETFL) | O_NONBLOCK);
+            fcntl(_fds[1], F_SETFL, fcntl(_fds[1], F_GETFL) | O_NONBLOCK);
+            server = new TTlsConnection(context, _fds[0]);
+            client = SSL_new(clientContext);
+            SSL_set_fd(client, _fds[1]);
+            SSL_set_connect_state(client);
+        }
+    }
+
+    ~Connection()
+    {
+        delete server;
+        if (client) {
+            SSL_free(client);
+        }
+        ::close(_fds[0]);
+        ::close(_fds[1]);
+    }
+
+    // Drives the handshakes of both sides until they finish
+    bool handshake()
+    {
+        int srv = 0;
+        bool cli = false;
+
+        for (int i = 0; i < 100 && (srv == 0 || !cli); i++) {
+            if (!cli) {
+                int ret = SSL_do_handshake(client);
+                if (ret == 1) {
+                    cli = true;
+                } else {
+                    int err = SSL_get_error(client, ret);
+                    if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) {
+                        return false;
+                    }
+                }
+            }
+            if (srv == 0) {
+                srv = server->handshake();
+            }
+            if (srv < 0) {
+                return false;
+            }
+        }
+        return srv == 1 && cli;
+    }
+
+    QByteArray clientRead()
+    {
+        char buf[256];
+        int len = SSL_read(client, buf, sizeof(buf));
+        return (len > 0) ? QByteArray(buf, len) : QByteArray();
+    }
+
+    TTlsConnection *server {nullptr};
+    SSL *client {nullptr};
+
+private:
+    int _fds[2] {-1, -1};
+};
+
+
+static SSL_CTX *createClientContext(const QByteArray &alpnProtocols = QByteArray())
+{
+    SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+    if (!alpnProtocols.isEmpty()) {
+        SSL_CTX_set_alpn_protos(ctx, (const unsigned char *)alpnProtocols.constData(), alpnProtocols.length());
+    }
+    return ctx;
+}
+
+
+void TestTls::initTestCase()
+{
+    QVERIFY(_dir.isValid());
+    _certFile = _dir.filePath("cert.pem");
+    _keyFile = _dir.filePath("key.pem");
+
+    // Self-signed certificate
+    EVP_PKEY *pkey = nullptr;
+    EVP_PKEY_CTX *pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+    QVERIFY(pctx);
+    QCOMPARE(EVP_PKEY_keygen_init(pctx), 1);
+    EVP_PKEY_CTX_set_rsa_keygen_bits(pctx, 2048);
+    QCOMPARE(EVP_PKEY_keygen(pctx, &pkey), 1);
+    EVP_PKEY_CTX_free(pctx);
+
+    X509 *x509 = X509_new();
+    X509_set_version(x509, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509), 3600);
+    X509_set_pubkey(x509, pkey);
+    X509_NAME *name = X509_get_subject_name(x509);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)"localhost", -1, -1, 0);
+    X509_set_issuer_name(x509, name);
+    QVERIFY(X509_sign(x509, pkey, EVP_sha256()) > 0);
+
+    BIO *bio = BIO_new_file(qUtf8Printable(_certFile), "w");
+    QVERIFY(bio);
+    PEM_write_bio_X509(bio, x509);
+    BIO_free(bio);
+
+    bio = BIO_new_file(qUtf8Printable(_keyFile), "w");
+    QVERIFY(bio);
+    PEM_write_bio_PrivateKey(bio, pkey, nullptr, nullptr, 0, nullptr, nullptr);
+    BIO_free(bio);
+
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+}
+
+
+TTlsContext *TestTls::createContext(const QByteArrayList &alpnProtocols)
+{
+    auto *context = new TTlsContext;
+    context->loadCertificate(_certFile, _keyFile);
+    context->setAlpnProtocols(alpnProtocols);
+    return context;
+}
+
+
+void TestTls::handshake()
+{
+    QScopedPointer<TTlsContext> context(createContext());
+    QVERIFY(context->isValid());
+    SSL_CTX *clientContext = createClientContext();
+
+    {
+        Connection conn(context.data(), clientContext);
+        QVERIFY(conn.server->isValid());
+        QVERIFY(!conn.server->isEstablished());
+        QVERIFY(conn.handshake());
+        QVERIFY(conn.server->isEstablished());
+        QVERIFY(!conn.server->isSessionReused());
+
+        // Server to client
+        QCOMPARE(conn.server->write("hello", 5), 5);
+        QCOMPARE(conn.clientRead(), QByteArray("hello"));
+
+        // Client to server
+        char buf[16];
+        QCOMPARE(SSL_write(conn.client, "world", 5), 5);
+        QCOMPARE(conn.server->read(buf, sizeof(buf)), 5);
+        QCOMPARE(QByteArray(buf, 5), QByteArray("world"));
+    }
+    SSL_CTX_free(clientContext);
+}
+
+
+void TestTls::alpn_data()
+{
+    QTest::addColumn<QByteArrayList>("serverProtocols");
+    QTest::addColumn<QByteArray>("clientProtocols");  // wire format
+    QTest::addColumn<QByteArray>("selected");
+
+    QTest::newRow("1") << QByteArrayList({"h2", "http/1.1"}) << QByteArray("\x08http/1.1") << QByteArray("http/1.1");
+    QTest::newRow("2") << QByteArrayList({"http/1.1"}) << QByteArray("\x02h2\x08http/1.1") << QByteArray("http/1.1");
+    QTest::newRow("3") << QByteArrayList({"http/1.1"}) << QByteArray("\x03" "foo") << QByteArray();
+    QTest::newRow("4") << QByteArrayList() << QByteArray("\x08http/1.1") << QByteArray();
+    QTest::newRow("5") << QByteArrayList({"http/1.1"}) << QByteArray() << QByteArray();
+}
+
+
+void TestTls::alpn()
+{
+    QFETCH(QByteArrayList, serverProtocols);
+    QFETCH(QByteArray, clientProtocols);
+    QFETCH(QByteArray, selected);
+
+    QScopedPointer<TTlsContext> context(createContext(serverProtocols));
+    SSL_CTX *clientContext = createClientContext(clientProtocols);
+
+    {
+        Connection conn(context.data(), clientContext);
+        QVERIFY(conn.handshake());  // continues without ALPN if not matched
+        QCOMPARE(conn.server->alpnProtocol(), selected);
+    }
+    SSL_CTX_free(clientContext);
+}
+
+
+void TestTls::readWouldBlock()
+{
+    QScopedPointer<TTlsContext> context(createContext());
+    SSL_CTX *clientContext = createClientContext();
+
+    {
+        Connection conn(context.data(), clientContext);
+        char buf[16];
+
+        // Before the handshake
+        errno = 0;
+        QCOMPARE(conn.server->read(buf, sizeof(buf)), -1);
+        QCOMPARE(errno, EAGAIN);
+
+        QVERIFY(conn.handshake());
+        errno = 0;
+        QCOMPARE(conn.server->read(buf, sizeof(buf)), -1);
+        QCOMPARE(errno, EAGAIN);
+    }
+    SSL_CTX_free(clientContext);
+}
+
+
+void TestTls::sessionResumption()
+{
+    QScopedPointer<TTlsContext> context(createContext());
+    SSL_CTX *clientContext = createClientContext();
+    SSL_SESSION *session = nullptr;
+
+    {
+        Connection conn(context.data(), clientContext);
+        QVERIFY(conn.handshake());
+        QVERIFY(!conn.server->isSessionReused());
+        // Reads the session tickets sent after the handshake in TLS 1.3
+        QCOMPARE(conn.server->write("hello", 5), 5);
+        QCOMPARE(conn.clientRead(), QByteArray("hello"));
+        session = SSL_get1_session(conn.client);
+        QVERIFY(session);
+    }
+
+    {
+        Connection conn(context.data(), clientContext);
+        SSL_set_session(conn.client, session);
+        QVERIFY(conn.handshake());
+        QVERIFY(conn.server->isSessionReused());
+        QVERIFY(SSL_session_reused(conn.client));
+    }
+    SSL_SESSION_free(session);
+    SSL_CTX_free(clientContext);
+}
+
+
+void TestTls::noResumptionAcrossContexts()
+{
+    // The session cache and the ticket keys belong to a context, that is,
+    // to an application server process
+    QScopedPointer<TTlsContext> context1(createContext());
+    QScopedPointer<TTlsContext> context2(createContext());
+    SSL_CTX *clientContext = createClientContext();
+    SSL_SESSION *session = nullptr;
+
+    {
+        Connection conn(context1.data(), clientContext);
+        QVERIFY(conn.handshake());
+        QCOMPARE(conn.server->write("hello", 5), 5);
+        QCOMPARE(conn.clientRead(), QByteArray("hello"));
+        session = SSL_get1_session(conn.client);
+        QVERIFY(session);
+    }
+
+    {
+        Connection conn(context2.data(), clientContext);
+        SSL_set_session(conn.client, session);
+        QVERIFY(conn.handshake());  // full handshake
+        QVERIFY(!conn.server->isSessionReused());
+    }
+    SSL_SESSION_free(session);
+    SSL_CTX_free(clientContext);
+}
+
+
+void TestTls::closeNotifyFromClient()
+{
+    QScopedPointer<TTlsContext> context(createContext());
+    SSL_CTX *clientContext = createClientContext();
+
+    {
+        Connection conn(context.data(), clientContext);
+        QVERIFY(conn.handshake());
+        QCOMPARE(SSL_write(conn.client, "bye", 3), 3);
+        SSL_shutdown(conn.client);
+
+        char buf[16];
+        QCOMPARE(conn.server->read(buf, sizeof(buf)), 3);
+        errno = EINVAL;
+        QCOMPARE(conn.server->read(buf, sizeof(buf)), 0);  // close_notify
+        QCOMPARE(errno, 0);
+    }
+    SSL_CTX_free(clientContext);
+}
+
+
+void TestTls::closeNotifyFromServer()
+{
+    QScopedPointer<TTlsContext> context(createContext());
+    SSL_CTX *clientContext = createClientContext();
+
+    {
+        Connection conn(context.data(), clientContext);
+        QVERIFY(conn.handshake());
+        conn.server->shutdown();
+        QVERIFY(!conn.server->isEstablished());
+
+        char buf[16];
+        int ret = SSL_read(conn.client, buf, sizeof(buf));
+        QCOMPARE(ret, 0);
+        QCOMPARE(SSL_get_error(conn.client, ret), SSL_ERROR_ZERO_RETURN);
+    }
+    SSL_CTX_free(clientContext);
+}
+
+
+TF_TEST_SQLLESS_MAIN(TestTls)
+#include "main.moc"
@@ -0,0 +1,9 @@
+include(../test.pri)
+TARGET = tls
+SOURCES = main.cpp
+# Built in, since the library has the TLS classes only if configured
+# with --enable-tls
+SOURCES += ../../ttlscontext.cpp ../../ttlsconnection.cpp
+DEFINES += TF_ENABLE_TLS
+LIBS += $$system("pkg-config --libs openssl 2>/dev/null || echo -lssl -lcrypto")
+QMAKE_CXXFLAGS += $$system("pkg-config --cflags openssl 2>/dev/null")
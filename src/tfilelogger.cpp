@@ -8,6 +8,10 @@
 #include "tfilelogger.h"
 #include <QMutexLocker>
 #include <TSystemGlobal>
+#ifdef Q_OS_UNIX
+# include "tfcore_unix.h"
+# include <climits>
+#endif
 
 /*!
   \class TFileLogger
@@ -80,6 +84,86 @@ void TFileLogger::log(const QByteArray &msg)
 }
 
 
+/*!
+  Formats the logs \a logs and writes them to the file at once.
+*/
+void TFileLogger::log(const QList<TLog> &logs)
+{
+    QByteArrayList messages;
+    messages.reserve(logs.count());
+    for (auto &tlog : logs) {
+        messages << logToByteArray(tlog);
+    }
+    write(messages);
+}
+
+/*!
+  Writes the \a messages to the file in as few system calls as possible.
+*/
+void TFileLogger::write(const QByteArrayList &messages)
+{
+    if (!isOpen() || messages.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+
+#ifdef Q_OS_UNIX
+    constexpr int MaxIovCount = (IOV_MAX < 64) ? IOV_MAX : 64;
+    struct iovec iov[MaxIovCount];
+    int fd = logFile.handle();
+    int idx = 0;
+
+    while (idx < messages.count()) {
+        int cnt = 0;
+        qint64 total = 0;
+        for (; cnt < MaxIovCount && idx + cnt < messages.count(); ++cnt) {
+            const QByteArray &msg = messages[idx + cnt];
+            iov[cnt].iov_base = const_cast<char *>(msg.data());
+            iov[cnt].iov_len = msg.length();
+            total += msg.length();
+        }
+        idx += cnt;
+
+        qint64 len = tf_writev(fd, iov, cnt);
+        if (len < 0) {
+            tSystemError("log write failed");
+            return;
+        }
+
+        if (len < total) {
+            // Writes the rest
+            for (int i = 0; i < cnt; ++i) {
+                if (len >= (qint64)iov[i].iov_len) {
+                    len -= iov[i].iov_len;
+                    continue;
+                }
+                const char *p = (const char *)iov[i].iov_base + len;
+                qint64 rest = (qint64)iov[i].iov_len - len;
+                len = 0;
+                while (rest > 0) {
+                    qint64 res = tf_write(fd, p, rest);
+                    if (res < 0) {
+                        tSystemError("log write failed");
+                        return;
+                    }
+                    p += res;
+                    rest -= res;
+                }
+            }
+        }
+    }
+#else
+    for (auto &msg : messages) {
+        if (logFile.write(msg) < 0) {
+            tSystemError("log write failed");
+            return;
+        }
+    }
+#endif
+}
+
+
 void TFileLogger::flush()
 {
     if (!isOpen()) {
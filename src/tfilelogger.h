@@ -1,4 +1,5 @@
 #pragma once
+#include <QByteArrayList>
 #include <QFile>
 #include <QMutex>
 #include <TLogger>
@@ -16,6 +17,8 @@ public:
     bool isOpen() const override;
     void log(const QByteArray &msg) override;
     void log(const TLog &tlog) override { TLogger::log(tlog); }
+    void log(const QList<TLog> &logs) override;
+    void write(const QByteArrayList &messages);
     void flush() override;
     void setFileName(const QString &name);
 
@@ -206,6 +206,37 @@ enum AppAttribute {
     SqlQueryLogFilePath,
     SqlQueryLogLayout,
     SqlQueryLogDateTimeFormat,
+    //
+    AccessLogEnableAsyncWrite,
+    SqlQueryLogEnableAsyncWrite,
+    //
+    TLSEnable,
+    TLSCertificateFile,
+    TLSPrivateKeyFile,
+    TLSAlpnProtocols,
+    TLSSessionCacheSize,
+    TLSEnableKernelTls,
+    //
+    WebSocketMaxWorkerThreads,
+    //
+    CacheL1MaxEntries,
+    CacheL1TimeToLive,
+    CacheStaleWhileRevalidate,
+    CacheLeaseTimeout,
+    //
+    SessionGcInterval,
+    //
+    MPMEpollBackend,
+    //
+    HttpRequestHeaderTimeout,
+    //
+    MPMEpollMaxRecvBufferSize,
+    //
+    MetricsPath,
+    //
+    TraceSampleRate,
+    TraceExport,
+    TraceServerTiming,
 };
 
 // Reason codes why a web socket has been closed
@@ -0,0 +1,84 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tfragmentcache.h"
+#include <TCache>
+
+/*!
+  \class TFragmentCache
+  \brief The TFragmentCache class caches a part of the output of a view,
+  used through the tcache() macro or the <%@cache %> directive.
+
+  If the part is cached, it is appended to the output without running
+  the code of the block, so its queries are not issued either. Otherwise
+  the output of the block is stored in the cache for the seconds given.
+  Only one of concurrent requests renders a missing part.
+*/
+
+constexpr auto KEY_PREFIX = "tf.fragment:";
+
+
+TFragmentCache::TFragmentCache(QString &output, const QByteArray &key, int seconds) :
+    _output(output),
+    _key(KEY_PREFIX + key),
+    _seconds(seconds)
+{
+}
+
+
+TFragmentCache::TFragmentCache(QString &output, const QString &key, int seconds) :
+    TFragmentCache(output, key.toUtf8(), seconds)
+{
+}
+
+
+TFragmentCache::TFragmentCache(QString &output, const char *key, int seconds) :
+    TFragmentCache(output, QByteArray(key), seconds)
+{
+}
+
+
+TFragmentCache::~TFragmentCache()
+{
+    if (_start >= 0 && !_done) {
+        // Left the block without storing
+        Tf::cache()->releaseLease(_key);
+    }
+}
+
+/*!
+  Returns true if the block needs to be executed; otherwise appends the
+  cached output and returns false.
+*/
+bool TFragmentCache::needsRendering()
+{
+    if (_done) {
+        return false;
+    }
+
+    bool recompute = false;
+    QByteArray fragment = Tf::cache()->fetch(_key, recompute);
+    if (!recompute && !fragment.isEmpty()) {
+        _output += QString::fromUtf8(fragment);
+        _done = true;
+        return false;
+    }
+
+    _start = _output.length();
+    return true;
+}
+
+/*!
+  Stores the output of the block.
+*/
+void TFragmentCache::store()
+{
+    if (_start >= 0 && !_done) {
+        Tf::cache()->set(_key, _output.mid(_start).toUtf8(), _seconds);
+    }
+    _done = true;
+}
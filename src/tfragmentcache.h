@@ -0,0 +1,34 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TFragmentCache {
+public:
+    TFragmentCache(QString &output, const QByteArray &key, int seconds);
+    TFragmentCache(QString &output, const QString &key, int seconds);
+    TFragmentCache(QString &output, const char *key, int seconds);
+    ~TFragmentCache();
+
+    bool needsRendering();
+    void store();
+
+private:
+    QString &_output;
+    QByteArray _key;
+    int _seconds {0};
+    int _start {-1};
+    bool _done {false};
+
+    T_DISABLE_COPY(TFragmentCache)
+    T_DISABLE_MOVE(TFragmentCache)
+};
+
+// Caches the output of the block with the KEY for SECONDS; the block
+// is not executed while it is cached.
+//   e.g. <% tcache("sidebar", 60) { %> ... <% } %>
+#define T_CACHE_FRAGMENT(KEY, SECONDS) \
+    for (TFragmentCache ___fragment(responsebody, (KEY), (SECONDS)); ___fragment.needsRendering(); ___fragment.store())
+
+#define tcache(KEY, SECONDS) T_CACHE_FRAGMENT(KEY, SECONDS)
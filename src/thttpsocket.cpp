@@ -8,9 +8,11 @@
 #include "thttpsocket.h"
 #include "tatomicptr.h"
 #include "tfcore.h"
+#include "tmetrics.h"
 #include "tsystemglobal.h"
 #include <QBuffer>
 #include <QDir>
+#include <QElapsedTimer>
 #include <TfCore>
 #include <TAppSettings>
 #include <TApplicationServerBase>
@@ -21,6 +23,10 @@
 #include <ctime>
 #include <thread>
 #include <algorithm>
+#ifdef TF_ENABLE_TLS
+# include "ttlsconnection.h"
+# include "ttlscontext.h"
+#endif
 
 constexpr uint READ_THRESHOLD_LENGTH = 4 * 1024 * 1024;  // bytes
 constexpr int64_t WRITE_LENGTH = 1408;
@@ -38,6 +44,7 @@ THttpSocket::THttpSocket(QByteArray &readBuffer, TActionContext *context, QObjec
 {
     connect(this, SIGNAL(requestWrite(const QByteArray &)), this, SLOT(writeRawData(const QByteArray &)), Qt::QueuedConnection);
     _idleElapsed = Tf::getMSecsSinceEpoch();
+    TMetrics::add(TMetrics::ActiveSockets);
 }
 
 
@@ -45,6 +52,7 @@ THttpSocket::~THttpSocket()
 {
     tSystemDebug("THttpSocket deleted  socket:%lld", _socket);
     abort();
+    TMetrics::add(TMetrics::ActiveSockets, -1);
 }
 
 
@@ -111,19 +119,35 @@ int THttpSocket::readRawData(char *data, int size, int msecs)
         throw StandardException("Logic error", __FILE__, __LINE__);
     }
 
-    int res = tf_poll_recv(_socket, msecs);
-    if (res < 0) {
-        tSystemError("socket poll error");
-        abort();
-        return -1;
-    }
+#ifdef TF_ENABLE_TLS
+    // Decrypted data may be buffered
+    bool pending = (_tls && _tls->pending() > 0);
+#else
+    constexpr bool pending = false;
+#endif
+
+    if (!pending) {
+        int res = tf_poll_recv(_socket, msecs);
+        if (res < 0) {
+            tSystemError("socket poll error");
+            abort();
+            return -1;
+        }
 
-    if (!res) {
-        // timeout
-        return 0;
+        if (!res) {
+            // timeout
+            return 0;
+        }
     }
 
+#ifdef TF_ENABLE_TLS
+    int len = (_tls) ? _tls->read(data, size) : tf_recv(_socket, data, size);
+    if (len < 0 && _tls && errno == EAGAIN) {
+        return 0;  // only TLS records without application data
+    }
+#else
     int len = tf_recv(_socket, data, size);
+#endif
     if (len < 0) {
         abort();
         return -1;
@@ -164,7 +188,14 @@ int64_t THttpSocket::writeRawData(const char *data, int64_t size)
             abort();
             break;
         } else {
+#ifdef TF_ENABLE_TLS
+            int64_t written = (_tls) ? _tls->write(data + total, qMin(size - total, WRITE_LENGTH)) : tf_send(_socket, data + total, qMin(size - total, WRITE_LENGTH));
+            if (written < 0 && _tls && errno == EAGAIN) {
+                continue;
+            }
+#else
             int64_t written = tf_send(_socket, data + total, qMin(size - total, WRITE_LENGTH));
+#endif
             if (Q_UNLIKELY(written <= 0)) {
                 tWarn("socket write error: total:%d (%d)  data length:%d", (int)total, (int)written, (int)size);
                 return -1;
@@ -271,8 +302,61 @@ void THttpSocket::setSocketDescriptor(qintptr socketDescriptor, QAbstractSocket:
 }
 
 
+/*!
+  Performs the TLS handshake as a server on the socket, waiting
+  for at most \a msecs milliseconds. Returns true if the connection
+  is established; otherwise returns false.
+*/
+bool THttpSocket::startServerEncryption(int msecs)
+{
+#ifdef TF_ENABLE_TLS
+    const TTlsContext *context = TTlsContext::instance();
+    if (!context || _tls || _socket <= 0) {
+        return false;
+    }
+
+    _tls = new TTlsConnection(context, _socket);
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    for (;;) {
+        int res = _tls->handshake();
+        if (res > 0) {
+            _idleElapsed = Tf::getMSecsSinceEpoch();
+            return true;
+        }
+
+        int remaining = msecs - (int)elapsed.elapsed();
+        if (res < 0 || remaining <= 0) {
+            break;
+        }
+
+        res = (_tls->wantsWrite()) ? tf_poll_send(_socket, remaining) : tf_poll_recv(_socket, remaining);
+        if (res <= 0) {
+            break;
+        }
+    }
+
+    tSystemDebug("TLS handshake failed  socket:%lld", _socket);
+    abort();
+    return false;
+#else
+    Q_UNUSED(msecs);
+    return false;
+#endif
+}
+
+
 void THttpSocket::abort()
 {
+#ifdef TF_ENABLE_TLS
+    if (_tls) {
+        _tls->shutdown();
+        delete _tls;
+        _tls = nullptr;
+    }
+#endif
+
     if (_socket > 0) {
         tf_close_socket(_socket);
         tSystemDebug("Closed socket : %lld", _socket);
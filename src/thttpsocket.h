@@ -8,6 +8,7 @@
 #include <TTemporaryFile>
 
 class TActionContext;
+class TTlsConnection;
 
 
 class T_CORE_EXPORT THttpSocket : public QObject {
@@ -30,6 +31,8 @@ public:
     ushort peerPort() const { return _peerPort; }
     QAbstractSocket::SocketState state() const { return _state; }
     void writeRawDataFromWebSocket(const QByteArray &data);
+    bool startServerEncryption(int msecs = 10000);
+    bool isEncrypted() const { return (bool)_tls; }
 
 protected:
     int readRawData(char *data, int size, int msecs);
@@ -52,6 +55,7 @@ private:
     TTemporaryFile _fileBuffer;
     uint64_t _idleElapsed {0};
     TActionContext *_context {nullptr};
+    TTlsConnection *_tls {nullptr};
 
     friend class TActionThread;
     T_DISABLE_COPY(THttpSocket)
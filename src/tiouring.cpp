@@ -0,0 +1,593 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tiouring.h"
+#include "tepollsocket.h"
+#include "tfcore.h"
+#include "tsendbuffer.h"
+#include "tsystemglobal.h"
+#include <QSysInfo>
+#include <QVersionNumber>
+#include <cstring>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+/*!
+  \class TIoUring
+  \brief The TIoUring class is an io_uring backend of the epoll MPM.
+
+  The connections are accepted by a multishot accept and received by
+  multishot receives into a ring of provided buffers, so that no system
+  call is needed per request except the one submitting all the queued
+  requests and waiting for the completions in each loop. TEpoll
+  delegates to this class if MPM.epoll.Backend is io_uring.
+*/
+
+namespace {
+constexpr unsigned int RingEntries = 4096;
+constexpr unsigned int BufferCount = 1024;  // must be a power of 2
+constexpr int BufferSize = 16 * 1024;
+constexpr int BufferGroup = 0;
+constexpr int SendChunkSize = 256 * 1024;
+}
+
+
+TIoUring::TIoUring()
+{
+    std::memset(&_ring, 0, sizeof(_ring));
+}
+
+
+TIoUring::~TIoUring()
+{
+    if (_initialized) {
+        if (_bufRing) {
+            io_uring_free_buf_ring(&_ring, _bufRing, BufferCount, BufferGroup);
+        }
+        io_uring_queue_exit(&_ring);
+    }
+
+    if (_wakeFd >= 0) {
+        tf_close(_wakeFd);
+    }
+
+    for (auto *context : (const QList<Context *> &)_deletedContexts) {
+        delete context->orphan;
+        delete context;
+    }
+    qDeleteAll(_contexts);
+    delete[] _buffers;
+}
+
+/*!
+  Returns a new io_uring backend, or nullptr if the kernel does not
+  support the features needed.
+*/
+TIoUring *TIoUring::create()
+{
+    // Multishot receives require Linux 6.0 or later
+    QVersionNumber kernel = QVersionNumber::fromString(QSysInfo::kernelVersion());
+    if (kernel < QVersionNumber(6, 0)) {
+        tSystemWarn("io_uring backend requires Linux 6.0 or later: %s", qUtf8Printable(QSysInfo::kernelVersion()));
+        return nullptr;
+    }
+
+    auto *uring = new TIoUring;
+    if (!uring->init()) {
+        delete uring;
+        return nullptr;
+    }
+    return uring;
+}
+
+
+bool TIoUring::init()
+{
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+
+    int ret = io_uring_queue_init_params(RingEntries, &_ring, &params);
+    if (ret == -EINVAL) {
+        std::memset(&params, 0, sizeof(params));
+        ret = io_uring_queue_init_params(RingEntries, &_ring, &params);
+    }
+    if (ret < 0) {
+        tSystemWarn("Failed io_uring_queue_init_params  errno:%d", -ret);
+        return false;
+    }
+    _initialized = true;
+
+    // Buffers for the multishot receives
+    _bufRing = io_uring_setup_buf_ring(&_ring, BufferCount, BufferGroup, 0, &ret);
+    if (!_bufRing) {
+        tSystemWarn("Failed io_uring_setup_buf_ring  errno:%d", -ret);
+        return false;
+    }
+
+    _buffers = new char[BufferCount * BufferSize];
+    for (unsigned int i = 0; i < BufferCount; i++) {
+        io_uring_buf_ring_add(_bufRing, bufferAddress(i), BufferSize, i, io_uring_buf_ring_mask(BufferCount), i);
+    }
+    io_uring_buf_ring_advance(_bufRing, BufferCount);
+
+    // Wakes up the ring from the other threads; blocking so that the
+    // read request waits in the kernel
+    _wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (_wakeFd < 0) {
+        tSystemWarn("Failed eventfd  errno:%d", errno);
+        return false;
+    }
+    prepare(nullptr, OpWakeUp);
+
+    tSystemDebug("io_uring initialized  entries:%u  features:0x%x", params.sq_entries, params.features);
+    return true;
+}
+
+
+struct io_uring_sqe *TIoUring::getSqe()
+{
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&_ring);
+    if (Q_UNLIKELY(!sqe)) {
+        // Submission queue full
+        io_uring_submit(&_ring);
+        sqe = io_uring_get_sqe(&_ring);
+    }
+    return sqe;
+}
+
+// Queues a request which is submitted in a batch at the next wait()
+void TIoUring::prepare(Context *context, uint64_t op)
+{
+    struct io_uring_sqe *sqe = getSqe();
+    if (Q_UNLIKELY(!sqe)) {
+        tSystemError("io_uring submission queue full");
+        return;
+    }
+
+    int fd = (context && context->socket) ? context->socket->socketDescriptor() : -1;
+
+    switch (op) {
+    case OpAccept:
+        io_uring_prep_multishot_accept(sqe, fd, nullptr, nullptr, SOCK_CLOEXEC);
+        context->receiving = true;
+        break;
+
+    case OpRecv:
+        io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, 0);
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BufferGroup;
+        context->receiving = true;
+        break;
+
+    case OpPollOut:
+        io_uring_prep_poll_add(sqe, fd, POLLOUT);
+        context->polling = true;
+        break;
+
+    case OpWakeUp:
+        io_uring_prep_read(sqe, _wakeFd, &_wakeValue, sizeof(_wakeValue), 0);
+        break;
+
+    default:
+        tSystemError("Logic error [%s:%d]", __FILE__, __LINE__);
+        return;
+    }
+
+    io_uring_sqe_set_data64(sqe, (uint64_t)context | op);
+    if (context) {
+        context->pending++;
+    }
+}
+
+
+void TIoUring::cancel(Context *context, uint64_t op)
+{
+    struct io_uring_sqe *sqe = getSqe();
+    if (Q_UNLIKELY(!sqe)) {
+        return;
+    }
+
+    io_uring_prep_cancel64(sqe, (uint64_t)context | op, 0);
+    io_uring_sqe_set_data64(sqe, OpCancel);
+    sqe->flags |= IOSQE_CQE_SKIP_SUCCESS;
+}
+
+/*!
+  Submits the queued requests and waits for completions for \a timeout
+  milliseconds. Returns the number of the events.
+*/
+int TIoUring::wait(int timeout)
+{
+    if (_eventIterator < _events.count()) {
+        return _events.count() - _eventIterator;
+    }
+
+    releaseEvents();
+
+    if (!_acceptedSockets.isEmpty()) {
+        timeout = 0;  // not accepted in the last loop
+    }
+
+    struct __kernel_timespec ts;
+    ts.tv_sec = timeout / 1000;
+    ts.tv_nsec = (timeout % 1000) * 1000000LL;
+
+    struct io_uring_cqe *cqe;
+    int ret = io_uring_submit_and_wait_timeout(&_ring, &cqe, 1, &ts, nullptr);
+    if (Q_UNLIKELY(ret < 0 && ret != -ETIME && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY)) {
+        tSystemError("Failed io_uring_submit_and_wait_timeout()  errno:%d", -ret);
+        return -1;
+    }
+
+    unsigned int head;
+    unsigned int count = 0;
+    io_uring_for_each_cqe(&_ring, head, cqe)
+    {
+        complete(cqe);
+        count++;
+    }
+    io_uring_cq_advance(&_ring, count);
+
+    // An event per accepted socket
+    if (_listenContext && _listenContext->socket) {
+        for (int i = 0; i < _acceptedSockets.count(); i++) {
+            Event event;
+            event.context = _listenContext;
+            event.op = OpAccept;
+            _events << event;
+        }
+    }
+    return _events.count();
+}
+
+
+void TIoUring::complete(struct io_uring_cqe *cqe)
+{
+    uint64_t data = io_uring_cqe_get_data64(cqe);
+    uint64_t op = data & OpMask;
+    auto *context = (Context *)(data & ~(uint64_t)OpMask);
+    bool more = (cqe->flags & IORING_CQE_F_MORE);
+    int bufferId = (cqe->flags & IORING_CQE_F_BUFFER) ? (int)(cqe->flags >> IORING_CQE_BUFFER_SHIFT) : -1;
+
+    if (op == OpCancel) {
+        return;
+    }
+
+    if (op == OpWakeUp) {
+        prepare(nullptr, OpWakeUp);
+        return;
+    }
+
+    if (!more) {
+        context->pending--;
+    }
+
+    Event event;
+    event.context = context;
+    event.op = op;
+    event.res = cqe->res;
+    event.bufferId = bufferId;
+
+    if (!context->socket) {
+        // Deleted from the ring
+        recycleBuffer(event);
+        if (op == OpAccept && cqe->res >= 0) {
+            tf_close(cqe->res);
+        }
+        return;
+    }
+
+    switch (op) {
+    case OpAccept:
+        if (!more) {
+            context->receiving = false;
+            if (cqe->res != -ECANCELED) {
+                prepare(context, OpAccept);
+            }
+        }
+        if (cqe->res >= 0) {
+            _acceptedSockets.enqueue(cqe->res);
+        } else if (cqe->res != -EAGAIN && cqe->res != -ECANCELED) {
+            tSystemWarn("Failed accept.  errno:%d", -cqe->res);
+        }
+        break;
+
+    case OpRecv:
+        if (!more) {
+            context->receiving = false;
+            if (cqe->res > 0 || cqe->res == -ENOBUFS) {
+                // Rearms the multishot receive
+                prepare(context, OpRecv);
+            }
+        }
+        if (cqe->res != -ENOBUFS && cqe->res != -ECANCELED) {
+            _events << event;
+        }
+        break;
+
+    case OpSend:
+        context->sending = false;
+        if (cqe->res == -EAGAIN) {
+            // Sends after the socket becomes writable
+            prepare(context, OpPollOut);
+        } else if (cqe->res != -ECANCELED) {
+            _events << event;
+        }
+        break;
+
+    case OpPollOut:
+        context->polling = false;
+        if (cqe->res != -ECANCELED) {
+            _events << event;
+        }
+        break;
+
+    default:
+        tSystemError("Logic error [%s:%d]", __FILE__, __LINE__);
+        break;
+    }
+}
+
+
+TEpollSocket *TIoUring::next()
+{
+    while (_eventIterator < _events.count()) {
+        if (_eventIterator > 0) {
+            recycleBuffer(_events[_eventIterator - 1]);
+        }
+
+        Event &event = _events[_eventIterator++];
+        if (event.context->socket) {
+            return event.context->socket;
+        }
+    }
+    return nullptr;
+}
+
+
+TIoUring::Event *TIoUring::currentEvent()
+{
+    return (_eventIterator > 0 && _eventIterator <= _events.count()) ? &_events[_eventIterator - 1] : nullptr;
+}
+
+
+bool TIoUring::canReceive() const
+{
+    return (_eventIterator > 0) && _events[_eventIterator - 1].op == OpRecv;
+}
+
+
+bool TIoUring::canSend() const
+{
+    if (_eventIterator <= 0) {
+        return false;
+    }
+    uint64_t op = _events[_eventIterator - 1].op;
+    return op == OpSend || op == OpPollOut;
+}
+
+/*!
+  Returns a socket accepted by the listening socket, or -1 if none.
+*/
+int TIoUring::accept(struct sockaddr *addr, socklen_t *addrlen)
+{
+    if (_acceptedSockets.isEmpty()) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    int fd = _acceptedSockets.dequeue();
+    if (addr && getpeername(fd, addr, addrlen) < 0) {
+        *addrlen = 0;
+    }
+    return fd;
+}
+
+/*!
+  Copies the data received by the current event into the receive
+  buffer of the \a socket.
+  @return  0:success  -1:error
+*/
+int TIoUring::recv(TEpollSocket *socket)
+{
+    Event *event = currentEvent();
+    if (!event || event->op != OpRecv || event->context->socket != socket || event->consumed) {
+        return 0;
+    }
+    event->consumed = true;
+
+    if (event->res <= 0) {
+        if (event->res == 0 || event->res == -ECONNRESET) {
+            tSystemDebug("Socket disconnected : sd:%d  errno:%d", socket->socketDescriptor(), -event->res);
+        } else {
+            tSystemError("Failed recv : sd:%d  errno:%d", socket->socketDescriptor(), -event->res);
+        }
+        return -1;
+    }
+
+    bool res;
+    try {
+        res = socket->appendRecvData(bufferAddress(event->bufferId), event->res);
+    } catch (...) {
+        recycleBuffer(*event);
+        throw;
+    }
+    recycleBuffer(*event);
+    return (res) ? 0 : -1;
+}
+
+/*!
+  Accounts the data sent by the current event and queues a request to
+  send the next data of the \a socket.
+  @return  0:success  -1:error
+*/
+int TIoUring::send(TEpollSocket *socket)
+{
+    Context *context = _contexts.value(socket);
+    if (Q_UNLIKELY(!context)) {
+        return -1;
+    }
+
+    Event *event = currentEvent();
+    if (event && event->context == context && !event->consumed && (event->op == OpSend || event->op == OpPollOut)) {
+        event->consumed = true;
+
+        if (event->op == OpSend && !socket->_sendBuffer.isEmpty()) {
+            TSendBuffer *buf = socket->_sendBuffer.head();
+            TAccessLogger &logger = buf->accessLogger();
+
+            if (event->res < 0) {
+                if (event->res == -EPIPE || event->res == -ECONNRESET) {
+                    tSystemDebug("Socket disconnected : sd:%d  errno:%d", socket->socketDescriptor(), -event->res);
+                } else {
+                    tSystemError("Failed send : sd:%d  errno:%d", socket->socketDescriptor(), -event->res);
+                }
+                logger.setResponseBytes(-1);
+                return -1;
+            }
+
+            buf->seekData(event->res);
+            logger.setResponseBytes(logger.responseBytes() + event->res);
+        }
+    }
+
+    if (context->sending || context->polling || !socket->isConnected()) {
+        return 0;
+    }
+
+    while (!socket->_sendBuffer.isEmpty()) {
+        TSendBuffer *buf = socket->_sendBuffer.head();
+        int len = SendChunkSize;
+        void *data = buf->getData(len);
+
+        if (len > 0) {
+            struct io_uring_sqe *sqe = getSqe();
+            if (Q_UNLIKELY(!sqe)) {
+                return -1;
+            }
+            io_uring_prep_send(sqe, socket->socketDescriptor(), data, len, MSG_NOSIGNAL);
+            io_uring_sqe_set_data64(sqe, (uint64_t)context | OpSend);
+            context->sending = true;
+            context->pending++;
+            break;
+        }
+
+        buf->accessLogger().write();  // Writes access log
+        delete socket->_sendBuffer.dequeue();
+    }
+    return 0;
+}
+
+/*!
+  Starts receiving on the \a socket. The listening socket is the only
+  one polled without EPOLLOUT, which starts accepting instead.
+*/
+bool TIoUring::addPoll(TEpollSocket *socket, int events)
+{
+    if (_contexts.contains(socket)) {
+        return true;
+    }
+
+    auto *context = new Context;
+    context->socket = socket;
+    _contexts.insert(socket, context);
+
+    if (!(events & EPOLLOUT)) {
+        _listenContext = context;
+        prepare(context, OpAccept);
+    } else {
+        prepare(context, OpRecv);
+        if (socket->state() == Tf::SocketState::Connecting) {
+            prepare(context, OpPollOut);
+        }
+    }
+    return true;
+}
+
+/*!
+  Cancels the requests of the \a socket. The buffer being sent is
+  kept until the kernel completes the request.
+*/
+bool TIoUring::deletePoll(TEpollSocket *socket)
+{
+    Context *context = _contexts.take(socket);
+    if (!context) {
+        return false;
+    }
+
+    if (context->receiving) {
+        cancel(context, (context == _listenContext) ? OpAccept : OpRecv);
+    }
+    if (context->polling) {
+        cancel(context, OpPollOut);
+    }
+    if (context->sending) {
+        cancel(context, OpSend);
+        if (!socket->_sendBuffer.isEmpty()) {
+            context->orphan = socket->_sendBuffer.dequeue();
+        }
+    }
+
+    context->socket = nullptr;
+    _deletedContexts << context;
+    return true;
+}
+
+/*!
+  Wakes up the ring waiting in the polling thread. This function is
+  thread-safe.
+*/
+void TIoUring::wakeUp()
+{
+    eventfd_write(_wakeFd, 1);
+}
+
+
+char *TIoUring::bufferAddress(int bufferId) const
+{
+    return _buffers + (int64_t)bufferId * BufferSize;
+}
+
+// Returns the buffer of the event to the ring
+void TIoUring::recycleBuffer(Event &event)
+{
+    if (event.bufferId < 0) {
+        return;
+    }
+
+    io_uring_buf_ring_add(_bufRing, bufferAddress(event.bufferId), BufferSize, event.bufferId, io_uring_buf_ring_mask(BufferCount), 0);
+    io_uring_buf_ring_advance(_bufRing, 1);
+    event.bufferId = -1;
+}
+
+
+void TIoUring::releaseEvents()
+{
+    for (auto &event : _events) {
+        recycleBuffer(event);
+    }
+    _events.resize(0);
+    _eventIterator = 0;
+
+    // Contexts having no requests in flight
+    for (auto it = _deletedContexts.begin(); it != _deletedContexts.end();) {
+        Context *context = *it;
+        if (context->pending > 0) {
+            ++it;
+            continue;
+        }
+
+        if (context == _listenContext) {
+            _listenContext = nullptr;
+        }
+        delete context->orphan;
+        delete context;
+        it = _deletedContexts.erase(it);
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QVector>
+#include <TGlobal>
+#include <liburing.h>
+#include <sys/socket.h>
+
+class TEpollSocket;
+class TSendBuffer;
+
+
+class T_CORE_EXPORT TIoUring {
+public:
+    ~TIoUring();
+
+    int wait(int timeout);
+    TEpollSocket *next();
+    bool canReceive() const;
+    bool canSend() const;
+    int accept(struct sockaddr *addr, socklen_t *addrlen);
+    int recv(TEpollSocket *socket);
+    int send(TEpollSocket *socket);
+    bool addPoll(TEpollSocket *socket, int events);
+    bool deletePoll(TEpollSocket *socket);
+    void wakeUp();
+
+    static TIoUring *create();
+
+private:
+    enum Operation : uint64_t {
+        OpAccept = 1,
+        OpRecv,
+        OpSend,
+        OpPollOut,
+        OpWakeUp,
+        OpCancel,
+        OpMask = 0x7,
+    };
+
+    struct alignas(8) Context {
+        TEpollSocket *socket {nullptr};  // nullptr if deleted from the ring
+        TSendBuffer *orphan {nullptr};  // buffer being sent by the kernel
+        int pending {0};  // number of requests in flight
+        bool receiving {false};
+        bool sending {false};
+        bool polling {false};
+    };
+
+    struct Event {
+        Context *context {nullptr};
+        uint64_t op {0};
+        int res {0};
+        int bufferId {-1};
+        bool consumed {false};
+    };
+
+    TIoUring();
+    bool init();
+    struct io_uring_sqe *getSqe();
+    void prepare(Context *context, uint64_t op);
+    void cancel(Context *context, uint64_t op);
+    void complete(struct io_uring_cqe *cqe);
+    Event *currentEvent();
+    char *bufferAddress(int bufferId) const;
+    void recycleBuffer(Event &event);
+    void releaseEvents();
+
+    struct io_uring _ring;
+    bool _initialized {false};
+    struct io_uring_buf_ring *_bufRing {nullptr};
+    char *_buffers {nullptr};
+    int _wakeFd {-1};
+    uint64_t _wakeValue {0};
+    Context *_listenContext {nullptr};
+    QHash<TEpollSocket *, Context *> _contexts;
+    QList<Context *> _deletedContexts;
+    QQueue<int> _acceptedSockets;
+    QVector<Event> _events;
+    int _eventIterator {0};
+
+    T_DISABLE_COPY(TIoUring)
+    T_DISABLE_MOVE(TIoUring)
+};
@@ -3,6 +3,7 @@
 #include <QJsonObject>
 #include <QList>
 #include <QVariantMap>
+#include <TJsonWriter>
 
 
 template <class T>
@@ -16,3 +17,14 @@ inline QJsonArray tfModelListToJsonArray(const QList<T> &models)
     return array;
 }
 
+/*!
+  Serializes the \a models to a compact JSON array directly, without
+  building QJsonObject objects.
+*/
+template <class T>
+inline QByteArray tfModelListToJson(const QList<T> &models, const QStringList &properties = QStringList())
+{
+    TJsonWriter writer;
+    writer.writeModelList(models, properties);
+    return writer.data();
+}
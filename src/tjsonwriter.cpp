@@ -0,0 +1,667 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include <QDateTime>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLocale>
+#include <QMetaProperty>
+#include <QReadWriteLock>
+#include <TAbstractModel>
+#include <TJsonWriter>
+#include <TModelObject>
+#include <algorithm>
+#include <cmath>
+
+/*!
+  \class TJsonWriter
+  \brief The TJsonWriter class writes compact JSON text directly into
+  a byte buffer.
+
+  Unlike QJsonDocument, no intermediate QVariantMap or QJsonObject is
+  built; values of models are read from their meta-properties and
+  serialized in place, so that large lists can be rendered with a
+  single buffer. The output is compatible with
+  QJsonDocument::toJson(QJsonDocument::Compact) of
+  TAbstractModel::toJsonObject().
+  \sa TActionController::renderJson(const TJsonWriter &)
+*/
+
+namespace {
+
+struct PropertyKey {
+    int index {0};
+    QString name;  // variable name
+    QByteArray key;  // quoted JSON key with a trailing colon
+};
+
+QHash<const QMetaObject *, QVector<PropertyKey>> propertyKeysHash;
+QReadWriteLock propertyKeysLock;
+
+
+QVector<PropertyKey> propertyKeys(const QMetaObject *metaObject)
+{
+    {
+        QReadLocker locker(&propertyKeysLock);
+        auto it = propertyKeysHash.constFind(metaObject);
+        if (it != propertyKeysHash.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QVector<PropertyKey> keys;
+    for (int i = metaObject->propertyOffset(); i < metaObject->propertyCount(); ++i) {
+        const char *propName = metaObject->property(i).name();
+        if (!propName || !*propName) {
+            continue;
+        }
+
+        PropertyKey pk;
+        pk.index = i;
+        pk.name = TAbstractModel::fieldNameToVariableName(QLatin1String(propName));
+        TJsonWriter writer;
+        writer.writeString(pk.name);
+        pk.key = writer.data() + ':';
+        keys << pk;
+    }
+
+    // Same order as QJsonObject
+    std::sort(keys.begin(), keys.end(), [](const PropertyKey &a, const PropertyKey &b) { return a.name < b.name; });
+
+    QWriteLocker locker(&propertyKeysLock);
+    propertyKeysHash.insert(metaObject, keys);
+    return keys;
+}
+
+
+inline char *writeFixedDigits(char *p, int value, int width)
+{
+    for (int i = width - 1; i >= 0; --i) {
+        p[i] = '0' + (value % 10);
+        value /= 10;
+    }
+    return p + width;
+}
+
+
+inline char *writeDateDigits(char *p, const QDate &date)
+{
+    p = writeFixedDigits(p, date.year(), 4);
+    *p++ = '-';
+    p = writeFixedDigits(p, date.month(), 2);
+    *p++ = '-';
+    return writeFixedDigits(p, date.day(), 2);
+}
+
+
+inline char *writeTimeDigits(char *p, const QTime &time)
+{
+    p = writeFixedDigits(p, time.hour(), 2);
+    *p++ = ':';
+    p = writeFixedDigits(p, time.minute(), 2);
+    *p++ = ':';
+    p = writeFixedDigits(p, time.second(), 2);
+    *p++ = '.';
+    return writeFixedDigits(p, time.msec(), 3);
+}
+
+}  // namespace
+
+/*!
+  Constructor. The buffer is preallocated with \a reserveSize bytes.
+*/
+TJsonWriter::TJsonWriter(int reserveSize)
+{
+    if (reserveSize > 0) {
+        _buffer.reserve(reserveSize);
+    }
+}
+
+/*!
+  Clears the contents written so far.
+*/
+void TJsonWriter::clear()
+{
+    _buffer.resize(0);
+    _needComma = false;
+}
+
+
+inline void TJsonWriter::separate()
+{
+    if (_needComma) {
+        _buffer += ',';
+    }
+}
+
+/*!
+  Writes the opening brace of an object.
+*/
+void TJsonWriter::beginObject()
+{
+    separate();
+    _buffer += '{';
+    _needComma = false;
+}
+
+/*!
+  Writes the closing brace of an object.
+*/
+void TJsonWriter::endObject()
+{
+    _buffer += '}';
+    _needComma = true;
+}
+
+/*!
+  Writes the opening bracket of an array.
+*/
+void TJsonWriter::beginArray()
+{
+    separate();
+    _buffer += '[';
+    _needComma = false;
+}
+
+/*!
+  Writes the closing bracket of an array.
+*/
+void TJsonWriter::endArray()
+{
+    _buffer += ']';
+    _needComma = true;
+}
+
+/*!
+  Writes the member name \a key of an object. The value must be written
+  next.
+*/
+void TJsonWriter::writeKey(const QString &key)
+{
+    separate();
+    appendEscaped(key.constData(), key.length());
+    _buffer += ':';
+    _needComma = false;
+}
+
+/*!
+  Writes the member name \a key of an object. The value must be written
+  next.
+*/
+void TJsonWriter::writeKey(const QLatin1String &key)
+{
+    separate();
+    appendEscaped(key.data(), key.size());
+    _buffer += ':';
+    _needComma = false;
+}
+
+/*!
+  Writes null.
+*/
+void TJsonWriter::writeNull()
+{
+    separate();
+    _buffer += "null";
+    _needComma = true;
+}
+
+/*!
+  Writes the boolean \a value.
+*/
+void TJsonWriter::writeBool(bool value)
+{
+    separate();
+    _buffer += (value) ? "true" : "false";
+    _needComma = true;
+}
+
+/*!
+  Writes the integer \a value.
+*/
+void TJsonWriter::writeInt(qint64 value)
+{
+    separate();
+    if (value < 0) {
+        _buffer += '-';
+        appendDigits(~quint64(value) + 1);
+    } else {
+        appendDigits(value);
+    }
+    _needComma = true;
+}
+
+/*!
+  Writes the unsigned integer \a value.
+*/
+void TJsonWriter::writeUInt(quint64 value)
+{
+    separate();
+    appendDigits(value);
+    _needComma = true;
+}
+
+/*!
+  Writes the floating point \a value in the shortest representation.
+  NaN and infinity are written as null like QJsonDocument does.
+*/
+void TJsonWriter::writeDouble(double value)
+{
+    if (!std::isfinite(value)) {
+        writeNull();
+        return;
+    }
+
+    separate();
+    const double abs = std::fabs(value);
+    if (abs < 9007199254740992.0 && abs == double(quint64(abs))) {
+        // Integral value below 2^53, formatted as 'f' like QJsonDocument
+        if (value < 0) {
+            _buffer += '-';
+        }
+        appendDigits(quint64(abs));
+    } else if (abs < 18446744073709551616.0 && abs == std::trunc(abs)) {
+        // Integral value below 2^64; the shortest digits padded with zeros
+        _buffer += QByteArray::number(value, 'f', QLocale::FloatingPointShortest);
+    } else {
+        _buffer += QByteArray::number(value, 'g', QLocale::FloatingPointShortest);
+    }
+    _needComma = true;
+}
+
+/*!
+  Writes the string \a value.
+*/
+void TJsonWriter::writeString(const QString &value)
+{
+    separate();
+    appendEscaped(value.constData(), value.length());
+    _needComma = true;
+}
+
+/*!
+  Writes the string \a value.
+*/
+void TJsonWriter::writeString(const QLatin1String &value)
+{
+    separate();
+    appendEscaped(value.data(), value.size());
+    _needComma = true;
+}
+
+/*!
+  Writes the \a date in ISO 8601 format (yyyy-MM-dd).
+  An invalid date is written as null.
+*/
+void TJsonWriter::writeDate(const QDate &date)
+{
+    if (!date.isValid()) {
+        writeNull();
+        return;
+    }
+
+    if (date.year() < 0 || date.year() > 9999) {
+        writeString(date.toString(Qt::ISODate));
+        return;
+    }
+
+    separate();
+    char buf[16];
+    char *p = buf;
+    *p++ = '"';
+    p = writeDateDigits(p, date);
+    *p++ = '"';
+    _buffer.append(buf, p - buf);
+    _needComma = true;
+}
+
+/*!
+  Writes the \a time in ISO 8601 format with milliseconds (HH:mm:ss.zzz).
+  An invalid time is written as null.
+*/
+void TJsonWriter::writeTime(const QTime &time)
+{
+    if (!time.isValid()) {
+        writeNull();
+        return;
+    }
+
+    separate();
+    char buf[16];
+    char *p = buf;
+    *p++ = '"';
+    p = writeTimeDigits(p, time);
+    *p++ = '"';
+    _buffer.append(buf, p - buf);
+    _needComma = true;
+}
+
+/*!
+  Writes the \a dateTime in ISO 8601 format with milliseconds, the same
+  as QDateTime::toString(Qt::ISODateWithMs). An invalid date-time is
+  written as null.
+*/
+void TJsonWriter::writeDateTime(const QDateTime &dateTime)
+{
+    if (!dateTime.isValid()) {
+        writeNull();
+        return;
+    }
+
+    const Qt::TimeSpec spec = dateTime.timeSpec();
+    const QDate date = dateTime.date();
+    if ((spec != Qt::LocalTime && spec != Qt::UTC) || date.year() < 0 || date.year() > 9999) {
+        writeString(dateTime.toString(Qt::ISODateWithMs));
+        return;
+    }
+
+    separate();
+    char buf[32];
+    char *p = buf;
+    *p++ = '"';
+    p = writeDateDigits(p, date);
+    *p++ = 'T';
+    p = writeTimeDigits(p, dateTime.time());
+    if (spec == Qt::UTC) {
+        *p++ = 'Z';
+    }
+    *p++ = '"';
+    _buffer.append(buf, p - buf);
+    _needComma = true;
+}
+
+/*!
+  Writes the variant \a value. Common scalar types are formatted
+  directly; other types are converted by QJsonValue::fromVariant().
+*/
+void TJsonWriter::writeVariant(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        writeNull();
+        break;
+
+    case QMetaType::Bool:
+        writeBool(value.toBool());
+        break;
+
+    case QMetaType::Int:
+    case QMetaType::Short:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        writeInt(value.toLongLong());
+        break;
+
+    case QMetaType::UInt:
+    case QMetaType::UShort:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        writeUInt(value.toULongLong());
+        break;
+
+    case QMetaType::Double:
+    case QMetaType::Float:
+        writeDouble(value.toDouble());
+        break;
+
+    case QMetaType::QString:
+        writeString(value.toString());
+        break;
+
+    case QMetaType::QDate:
+        writeDate(value.toDate());
+        break;
+
+    case QMetaType::QTime:
+        writeTime(value.toTime());
+        break;
+
+    case QMetaType::QDateTime:
+        writeDateTime(value.toDateTime());
+        break;
+
+    case QMetaType::QStringList: {
+        beginArray();
+        for (auto &str : value.toStringList()) {
+            writeString(str);
+        }
+        endArray();
+        break;
+    }
+
+    case QMetaType::QVariantList: {
+        beginArray();
+        for (auto &var : value.toList()) {
+            writeVariant(var);
+        }
+        endArray();
+        break;
+    }
+
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = value.toMap();
+        beginObject();
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            writeKey(it.key());
+            writeVariant(it.value());
+        }
+        endObject();
+        break;
+    }
+
+    default:
+        writeJsonValue(QJsonValue::fromVariant(value));
+        break;
+    }
+}
+
+/*!
+  Writes the JSON \a value.
+*/
+void TJsonWriter::writeJsonValue(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        writeBool(value.toBool());
+        break;
+
+    case QJsonValue::Double:
+        writeDouble(value.toDouble());
+        break;
+
+    case QJsonValue::String:
+        writeString(value.toString());
+        break;
+
+    case QJsonValue::Array:
+        writeJsonArray(value.toArray());
+        break;
+
+    case QJsonValue::Object:
+        writeJsonObject(value.toObject());
+        break;
+
+    default:
+        writeNull();
+        break;
+    }
+}
+
+/*!
+  Writes the JSON \a object.
+*/
+void TJsonWriter::writeJsonObject(const QJsonObject &object)
+{
+    beginObject();
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        writeKey(it.key());
+        writeJsonValue(it.value());
+    }
+    endObject();
+}
+
+/*!
+  Writes the JSON \a array.
+*/
+void TJsonWriter::writeJsonArray(const QJsonArray &array)
+{
+    beginArray();
+    for (const auto &val : array) {
+        writeJsonValue(val);
+    }
+    endArray();
+}
+
+/*!
+  \fn void TJsonWriter::writeModel(const T &model, const QStringList &properties)
+  Writes the \a model as a JSON object whose member names are the
+  variable names of the properties, the same as
+  TAbstractModel::toJsonObject(). If \a properties is not empty, only
+  those properties are written. The properties are read directly unless
+  the class of the \a model reimplements TAbstractModel::toVariantMap()
+  or TAbstractModel::toJsonObject(), whose object is written then.
+*/
+
+/*!
+  Writes the properties of the model data of the \a model.
+*/
+void TJsonWriter::writeModelData(const TAbstractModel &model, const QStringList &properties)
+{
+    const TModelObject *obj = model.modelData();
+    if (!obj) {
+        writeNull();
+        return;
+    }
+
+    const QMetaObject *metaObj = obj->metaObject();
+    const QVector<PropertyKey> keys = propertyKeys(metaObj);
+
+    beginObject();
+    for (auto &pk : keys) {
+        if (!properties.isEmpty() && !properties.contains(pk.name)) {
+            continue;
+        }
+        separate();
+        _buffer += pk.key;
+        _needComma = false;
+        writeVariant(metaObj->property(pk.index).read(obj));
+    }
+    endObject();
+}
+
+/*!
+  \fn void TJsonWriter::writeModelList(const QList<T> &models, const QStringList &properties)
+  Writes the list of \a models as a JSON array of objects.
+*/
+
+/*!
+  \fn const QByteArray &TJsonWriter::data() const
+  Returns the JSON text written so far.
+*/
+
+
+void TJsonWriter::appendDigits(quint64 value)
+{
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    char *p = end;
+    do {
+        *--p = '0' + (value % 10);
+        value /= 10;
+    } while (value);
+    _buffer.append(p, end - p);
+}
+
+
+void TJsonWriter::appendEscaped(const QChar *str, int length)
+{
+    static const char HexDigits[] = "0123456789abcdef";
+
+    // Reserves the worst case size, six bytes per character
+    const int offset = _buffer.size();
+    _buffer.resize(offset + length * 6 + 2);
+    char *p = _buffer.data() + offset;
+    *p++ = '"';
+
+    for (int i = 0; i < length; ++i) {
+        uint c = str[i].unicode();
+        if (c < 0x80) {
+            switch (c) {
+            case '"':
+                *p++ = '\\';
+                *p++ = '"';
+                break;
+            case '\\':
+                *p++ = '\\';
+                *p++ = '\\';
+                break;
+            case '\b':
+                *p++ = '\\';
+                *p++ = 'b';
+                break;
+            case '\f':
+                *p++ = '\\';
+                *p++ = 'f';
+                break;
+            case '\n':
+                *p++ = '\\';
+                *p++ = 'n';
+                break;
+            case '\r':
+                *p++ = '\\';
+                *p++ = 'r';
+                break;
+            case '\t':
+                *p++ = '\\';
+                *p++ = 't';
+                break;
+            default:
+                if (c < 0x20) {
+                    *p++ = '\\';
+                    *p++ = 'u';
+                    *p++ = '0';
+                    *p++ = '0';
+                    *p++ = HexDigits[c >> 4];
+                    *p++ = HexDigits[c & 0xf];
+                } else {
+                    *p++ = char(c);
+                }
+                break;
+            }
+        } else if (c < 0x800) {
+            *p++ = char(0xc0 | (c >> 6));
+            *p++ = char(0x80 | (c & 0x3f));
+        } else {
+            if (QChar::isSurrogate(c)) {
+                if (QChar::isHighSurrogate(c) && i + 1 < length && str[i + 1].isLowSurrogate()) {
+                    uint ucs4 = QChar::surrogateToUcs4(ushort(c), str[++i].unicode());
+                    *p++ = char(0xf0 | (ucs4 >> 18));
+                    *p++ = char(0x80 | ((ucs4 >> 12) & 0x3f));
+                    *p++ = char(0x80 | ((ucs4 >> 6) & 0x3f));
+                    *p++ = char(0x80 | (ucs4 & 0x3f));
+                    continue;
+                }
+                c = QChar::ReplacementCharacter;
+            }
+            *p++ = char(0xe0 | (c >> 12));
+            *p++ = char(0x80 | ((c >> 6) & 0x3f));
+            *p++ = char(0x80 | (c & 0x3f));
+        }
+    }
+
+    *p++ = '"';
+    _buffer.resize(p - _buffer.constData());
+}
+
+
+void TJsonWriter::appendEscaped(const char *str, int length)
+{
+    appendEscaped(QString::fromLatin1(str, length).constData(), length);
+}
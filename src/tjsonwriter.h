@@ -0,0 +1,88 @@
+#pragma once
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+#include <QVariant>
+#include <TGlobal>
+#include <type_traits>
+
+class QJsonValue;
+class QJsonArray;
+class TAbstractModel;
+
+
+class T_CORE_EXPORT TJsonWriter {
+public:
+    TJsonWriter(int reserveSize = 0);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void writeKey(const QString &key);
+    void writeKey(const QLatin1String &key);
+    void writeNull();
+    void writeBool(bool value);
+    void writeInt(qint64 value);
+    void writeUInt(quint64 value);
+    void writeDouble(double value);
+    void writeString(const QString &value);
+    void writeString(const QLatin1String &value);
+    void writeDate(const QDate &date);
+    void writeTime(const QTime &time);
+    void writeDateTime(const QDateTime &dateTime);
+    void writeVariant(const QVariant &value);
+    void writeJsonValue(const QJsonValue &value);
+    void writeJsonObject(const QJsonObject &object);
+    void writeJsonArray(const QJsonArray &array);
+    template <class T>
+    void writeModel(const T &model, const QStringList &properties = QStringList());
+    template <class T>
+    void writeModelList(const QList<T> &models, const QStringList &properties = QStringList());
+
+    const QByteArray &data() const { return _buffer; }
+    int size() const { return _buffer.size(); }
+    void clear();
+
+private:
+    void writeModelData(const TAbstractModel &model, const QStringList &properties);
+    void separate();
+    void appendEscaped(const QChar *str, int length);
+    void appendEscaped(const char *str, int length);
+    void appendDigits(quint64 value);
+
+    QByteArray _buffer;
+    bool _needComma {false};
+};
+
+
+template <class T>
+inline void TJsonWriter::writeModel(const T &model, const QStringList &properties)
+{
+    // A model reimplementing toVariantMap() or toJsonObject() is written as
+    // the object returned, the same as by the other actions
+    using ToVariantMap = QVariantMap (TAbstractModel::*)(const QStringList &) const;
+    using ToJsonObject = QJsonObject (TAbstractModel::*)(const QStringList &) const;
+    constexpr bool inherited = !std::is_same<T, TAbstractModel>::value
+        && std::is_same<decltype(&T::toVariantMap), ToVariantMap>::value
+        && std::is_same<decltype(&T::toJsonObject), ToJsonObject>::value;
+
+    if (inherited) {
+        writeModelData(model, properties);
+    } else {
+        writeJsonObject(model.toJsonObject(properties));
+    }
+}
+
+
+template <class T>
+inline void TJsonWriter::writeModelList(const QList<T> &models, const QStringList &properties)
+{
+    beginArray();
+    for (auto &model : models) {
+        writeModel(model, properties);
+    }
+    endArray();
+}
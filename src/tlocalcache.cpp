@@ -0,0 +1,189 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tlocalcache.h"
+#include "tpublisher.h"
+#include "tsystembus.h"
+#include "tsystemglobal.h"
+#include <TAppSettings>
+#include <TWebApplication>
+
+/*!
+  \class TLocalCache
+  \brief The TLocalCache class is an in-process cache in front of the
+  cache store of TCache.
+
+  It holds the uncompressed values of the recently read keys for a few
+  seconds in shards of LRU lists. Updates through TCache drop the keys
+  of the local caches in the other application servers via the system
+  bus.
+*/
+
+/*!
+  Returns a global instance, or nullptr if Cache.L1MaxEntries in the
+  application.ini is not positive.
+*/
+TLocalCache *TLocalCache::instance()
+{
+    static TLocalCache *globalInstance = []() -> TLocalCache * {
+        int maxEntries = Tf::appSettings()->value(Tf::CacheL1MaxEntries).toInt();
+        if (maxEntries <= 0) {
+            return nullptr;
+        }
+
+        int ttl = qMax(Tf::appSettings()->value(Tf::CacheL1TimeToLive).toInt(), 1);
+        if (Tf::app()->maxNumberOfAppServers() > 1) {
+            TPublisher::instance();  // receives invalidations from the system bus
+        }
+        tSystemDebug("Local cache  max entries:%d  ttl:%d", maxEntries, ttl);
+        return new TLocalCache(maxEntries, ttl);
+    }();
+    return globalInstance;
+}
+
+/*!
+  Constructs a local cache of up to \a maxEntries entries, which are
+  held for \a timeToLive seconds at the longest.
+*/
+TLocalCache::TLocalCache(int maxEntries, int timeToLive) :
+    _maxEntriesPerShard(qMax(maxEntries / (int)NumShards, 1)),
+    _timeToLive(timeToLive)
+{
+}
+
+
+TLocalCache::Shard &TLocalCache::shard(const QByteArray &key)
+{
+    return _shards[qHash(key) % NumShards];
+}
+
+/*!
+  Looks up the \a key and sets its value to \a value. Returns true if
+  it is found and not expired.
+*/
+bool TLocalCache::get(const QByteArray &key, QByteArray &value)
+{
+    Shard &sh = shard(key);
+    QMutexLocker locker(&sh.mutex);
+
+    auto it = sh.entries.find(key);
+    if (it == sh.entries.end()) {
+        _misses++;
+        return false;
+    }
+
+    if (it->expires <= Tf::getMSecsSinceEpoch()) {
+        removeEntry(sh, it);
+        _misses++;
+        return false;
+    }
+
+    sh.lru.splice(sh.lru.begin(), sh.lru, it->lru);
+    value = it->value;
+    _hits++;
+    return true;
+}
+
+/*!
+  Holds the \a value for the \a key for a given number of \a seconds,
+  which is capped by Cache.L1TimeToLive.
+*/
+void TLocalCache::set(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    if (key.isEmpty() || seconds <= 0) {
+        return;
+    }
+
+    Shard &sh = shard(key);
+    QMutexLocker locker(&sh.mutex);
+
+    auto it = sh.entries.find(key);
+    if (it == sh.entries.end()) {
+        while (sh.entries.count() >= _maxEntriesPerShard && !sh.lru.empty()) {
+            removeEntry(sh, sh.entries.find(sh.lru.back()));
+            _evictions++;
+        }
+        sh.lru.push_front(key);
+        it = sh.entries.insert(key, Entry());
+        it->lru = sh.lru.begin();
+    } else {
+        sh.lru.splice(sh.lru.begin(), sh.lru, it->lru);
+    }
+
+    it->value = value;
+    it->expires = Tf::getMSecsSinceEpoch() + qMin(seconds, _timeToLive) * 1000LL;
+}
+
+/*!
+  Removes the \a key from the local caches of all the application
+  servers.
+*/
+void TLocalCache::remove(const QByteArray &key)
+{
+    invalidate(key);
+
+    if (Tf::app()->maxNumberOfAppServers() > 1) {
+        TSystemBus::instance()->send(Tf::CacheInvalidate, QString(), key);
+    }
+}
+
+/*!
+  Removes all the keys from the local caches of all the application
+  servers.
+*/
+void TLocalCache::clear()
+{
+    remove(QByteArray());
+}
+
+/*!
+  Removes the \a key from the local cache of this process; an empty
+  key removes all.
+*/
+void TLocalCache::invalidate(const QByteArray &key)
+{
+    if (key.isEmpty()) {
+        for (auto &sh : _shards) {
+            QMutexLocker locker(&sh.mutex);
+            sh.entries.clear();
+            sh.lru.clear();
+        }
+    } else {
+        Shard &sh = shard(key);
+        QMutexLocker locker(&sh.mutex);
+        auto it = sh.entries.find(key);
+        if (it != sh.entries.end()) {
+            removeEntry(sh, it);
+        }
+    }
+    _invalidations++;
+}
+
+
+void TLocalCache::removeEntry(Shard &shard, QHash<QByteArray, Entry>::iterator it)
+{
+    shard.lru.erase(it->lru);
+    shard.entries.erase(it);
+}
+
+/*!
+  Returns the hit/miss statistics.
+*/
+TLocalCache::Statistics TLocalCache::statistics() const
+{
+    Statistics stats;
+    stats.hits = _hits.load();
+    stats.misses = _misses.load();
+    stats.evictions = _evictions.load();
+    stats.invalidations = _invalidations.load();
+
+    for (auto &sh : _shards) {
+        QMutexLocker locker(&sh.mutex);
+        stats.count += sh.entries.count();
+    }
+    return stats;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <TGlobal>
+#include <atomic>
+#include <list>
+
+
+class T_CORE_EXPORT TLocalCache {
+public:
+    struct Statistics {
+        quint64 hits {0};
+        quint64 misses {0};
+        quint64 evictions {0};
+        quint64 invalidations {0};
+        int count {0};
+    };
+
+    TLocalCache(int maxEntries, int timeToLive);
+    ~TLocalCache() { }
+
+    bool get(const QByteArray &key, QByteArray &value);
+    void set(const QByteArray &key, const QByteArray &value, int seconds);
+    void remove(const QByteArray &key);
+    void clear();
+    void invalidate(const QByteArray &key);
+    Statistics statistics() const;
+
+    static TLocalCache *instance();
+
+private:
+    enum {
+        NumShards = 16,
+    };
+
+    struct Entry {
+        QByteArray value;
+        int64_t expires {0};  // msecs since epoch
+        std::list<QByteArray>::iterator lru;
+    };
+
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<QByteArray, Entry> entries;
+        std::list<QByteArray> lru;  // most recently used first
+    };
+
+    Shard &shard(const QByteArray &key);
+    void removeEntry(Shard &shard, QHash<QByteArray, Entry>::iterator it);
+
+    Shard _shards[NumShards];
+    int _maxEntriesPerShard {0};
+    int _timeToLive {0};  // secs
+    std::atomic<quint64> _hits {0};
+    std::atomic<quint64> _misses {0};
+    std::atomic<quint64> _evictions {0};
+    std::atomic<quint64> _invalidations {0};
+
+    T_DISABLE_COPY(TLocalCache)
+    T_DISABLE_MOVE(TLocalCache)
+};
@@ -5,11 +5,13 @@
  * the New BSD License, which is incorporated herein by reference.
  */
 
+#include "tloglayout.h"
 #include <QDir>
 #include <QFileInfo>
 #include <TLogger>
 #include <TSystemGlobal>
 #include <TWebApplication>
+#include <atomic>
 #if QT_VERSION < 0x060000
 # include <QTextCodec>
 #endif
@@ -30,6 +32,7 @@ namespace {
 
 QByteArray logLayout;  // Layout of application log
 QByteArray logDateTimeFormat;  // DateTime format of application log
+std::atomic<int> logLayoutGeneration {0};  // Incremented when the layout changes
 
 }
 
@@ -37,15 +40,27 @@ QByteArray logDateTimeFormat;  // DateTime format of application log
 void Tf::setAppLogLayout(const QByteArray &layout)
 {
     logLayout = layout;
+    logLayoutGeneration.fetch_add(1, std::memory_order_release);
 }
 
 
 void Tf::setAppLogDateTimeFormat(const QByteArray &format)
 {
     logDateTimeFormat = format;
+    logLayoutGeneration.fetch_add(1, std::memory_order_release);
 }
 
 
+struct TLogger::CompiledLayout {
+    CompiledLayout(const QByteArray &layout, const QByteArray &dateTimeFormat, int generation) :
+        layout(layout, dateTimeFormat), generation(generation) { }
+
+    TLogLayout layout;
+    int generation {0};
+    CompiledLayout *previous {nullptr};  // kept for the threads formatting with it
+};
+
+
 /*!
   \class TLogger
   \brief The TLogger class provides an abstract base of logging functionality.
@@ -58,6 +73,31 @@ TLogger::TLogger()
 {
 }
 
+/*!
+  Destructor.
+*/
+TLogger::~TLogger()
+{
+    CompiledLayout *compiled = _compiledLayout.loadAcquire();
+    while (compiled) {
+        CompiledLayout *previous = compiled->previous;
+        delete compiled;
+        compiled = previous;
+    }
+}
+
+/*!
+  Writes the logs \a logs to the device. The default implementation
+  calls log(const TLog &) for each log; reimplement this function to
+  write them in one operation.
+*/
+void TLogger::log(const QList<TLog> &logs)
+{
+    for (auto &tlog : logs) {
+        log(tlog);
+    }
+}
+
 /*!
   Returns the value for logger setting \a key. If the setting doesn't exist,
   returns \a defaultValue.
@@ -75,11 +115,27 @@ QVariant TLogger::settingsValue(const QString &k, const QVariant &defaultValue)
 */
 QByteArray TLogger::logToByteArray(const TLog &log) const
 {
+    int generation = logLayoutGeneration.load(std::memory_order_acquire);
+    CompiledLayout *compiled = _compiledLayout.loadAcquire();
+
+    if (Q_UNLIKELY(!compiled || compiled->generation != generation)) {
+        // Compiles the layout, and again when it's changed by Tf::setAppLogLayout()
+        auto *newer = new CompiledLayout(layout(), dateTimeFormat(), generation);
 #if QT_VERSION < 0x060000
-    return logToByteArray(log, layout(), dateTimeFormat(), codec());
+        newer->layout.setCodec(codec());
 #else
-    return logToByteArray(log, layout(), dateTimeFormat(), encoding());
+        newer->layout.setEncoding(encoding());
 #endif
+        newer->previous = compiled;
+        if (_compiledLayout.testAndSetOrdered(compiled, newer)) {
+            compiled = newer;
+        } else {
+            // Compiled by another thread
+            delete newer;
+            compiled = _compiledLayout.loadAcquire();
+        }
+    }
+    return compiled->layout.format(log);
 }
 
 /*!
@@ -92,108 +148,13 @@ QByteArray TLogger::logToByteArray(const TLog &log, const QByteArray &layout, co
 QByteArray TLogger::logToByteArray(const TLog &log, const QByteArray &layout, const QByteArray &dateTimeFormat, QStringConverter::Encoding encoding)
 #endif
 {
-    static const QString Arg1("%1");
-
-    QByteArray message;
-    QByteArray dig;
-    message.reserve(layout.length() + log.message.length() + 100);
-    int pos = 0;
-
-    while (pos < layout.length()) {
-        char c = layout.at(pos++);
-        if (c != '%') {
-            message.append(c);
-            continue;
-        }
-
-        dig.resize(0);
-        for (;;) {
-            if (pos >= layout.length()) {
-                message.append('%').append(dig);
-                break;
-            }
-
-            c = layout.at(pos++);
-            if (c >= '0' && c <= '9') {
-                dig += c;
-                continue;
-            }
-
-            switch (c) {
-            case 'd':  // %d : timestamp
-                if (!dateTimeFormat.isEmpty()) {
-                    message.append(log.timestamp.toString(dateTimeFormat).toLatin1());
-                } else {
-                    message.append(log.timestamp.toString(Qt::ISODate).toLatin1());
-                }
-                break;
-
-            case 'p':
-            case 'P': {  // %p or %P : priority
-                QByteArray pri = priorityToString((Tf::LogPriority)log.priority);
-                if (c == 'p') {
-                    pri = pri.toLower();
-                }
-                if (!pri.isEmpty()) {
-                    message.append(pri);
-                    int d = dig.toInt() - pri.length();
-                    if (d > 0) {
-                        message.append(QByteArray(d, ' '));
-                    }
-                }
-                break;
-            }
-
-            case 't':
-            case 'T': {  // %t or %T : thread ID (dec or hex)
-                const QChar fillChar = (dig.length() > 0 && dig[0] == '0') ? QLatin1Char('0') : QLatin1Char(' ');
-                message.append(Arg1.arg((qulonglong)log.threadId, dig.toInt(), ((c == 't') ? 10 : 16), fillChar).toLatin1());
-                break;
-            }
-
-            case 'i':
-            case 'I': {  // %i or %I : PID (dec or hex)
-                const QChar fillChar = (dig.length() > 0 && dig[0] == '0') ? QLatin1Char('0') : QLatin1Char(' ');
-                message.append(Arg1.arg(log.pid, dig.toInt(), ((c == 'i') ? 10 : 16), fillChar).toLatin1());
-                break;
-            }
-
-            case 'n':  // %n : newline
-                message.append('\n');
-                break;
-
-            case 'm':  // %m : message
-                message.append(log.message);
-                break;
-
-            case 'e':
-                if (dig.isEmpty()) {
-                    message.append(QString::number(log.duration).toLatin1());
-                } else {
-                    const QChar fillChar = (dig[0] == '0') ? QLatin1Char('0') : QLatin1Char(' ');
-                    message.append(Arg1.arg(log.duration, dig.toInt(), 10, fillChar).toLatin1());
-                }
-                break;
-
-            case '%':
-                message.append('%').append(dig);
-                dig.resize(0);
-                continue;
-                break;
-
-            default:
-                message.append('%').append(dig).append(c);
-                break;
-            }
-            break;
-        }
-    }
-
+    TLogLayout &compiled = TLogLayout::cached(layout, dateTimeFormat);
 #if QT_VERSION < 0x060000
-    return (codec) ? codec->fromUnicode(QString::fromLocal8Bit(message.data(), message.length())) : message;
+    compiled.setCodec(codec);
 #else
-    return QStringEncoder(encoding).encode(QString::fromLocal8Bit(message.data(), message.length()));
+    compiled.setEncoding(encoding);
 #endif
+    return compiled.format(log);
 }
 
 /*!
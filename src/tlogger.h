@@ -1,4 +1,5 @@
 #pragma once
+#include <QAtomicPointer>
 #include <QString>
 #include <QVariant>
 #include <TGlobal>
@@ -8,6 +9,7 @@
 #endif
 
 class TLog;
+class TLogLayout;
 class QTextCodec;
 
 namespace Tf {
@@ -21,7 +23,7 @@ T_CORE_EXPORT void setAppLogDateTimeFormat(const QByteArray &format);
 class T_CORE_EXPORT TLogger {
 public:
     TLogger();
-    virtual ~TLogger() { }
+    virtual ~TLogger();
     virtual QString key() const = 0;
     virtual bool isMultiProcessSafe() const = 0;
     virtual bool open() = 0;
@@ -29,6 +31,7 @@ public:
     virtual bool isOpen() const = 0;
     virtual void log(const QByteArray &) = 0;  // thread safe log output
     virtual void log(const TLog &tlog) { log(logToByteArray(tlog)); }  // thread safe log output
+    virtual void log(const QList<TLog> &logs);  // thread safe log output
     virtual void flush() { }
     virtual QByteArray logToByteArray(const TLog &log) const;
 
@@ -55,6 +58,8 @@ protected:
 private:
     mutable Tf::LogPriority _threshold {(Tf::LogPriority)-1};
     mutable QString _target;
+    struct CompiledLayout;
+    mutable QAtomicPointer<CompiledLayout> _compiledLayout;
 #if QT_VERSION < 0x060000
     mutable QTextCodec *_codec {nullptr};
 #else
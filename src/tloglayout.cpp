@@ -0,0 +1,399 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tloglayout.h"
+#include <QDateTime>
+#include <QThreadStorage>
+#include <TAccessLog>
+#include <TLog>
+#include <atomic>
+#if QT_VERSION < 0x060000
+# include <QTextCodec>
+#else
+# include <QStringEncoder>
+#endif
+
+/*!
+  \class TLogLayout
+  \brief The TLogLayout class represents a log layout compiled into
+  a sequence of tokens.
+
+  The layout string such as "%d %5P [%t] %m%n" is parsed only once,
+  and the text of the timestamp is reused while the second does not
+  change, unless the date-time format contains milliseconds.
+*/
+
+namespace {
+
+std::atomic<quint64> layoutCounter {0};
+
+struct TimestampCache {
+    enum { Size = 4 };
+    struct Entry {
+        quint64 id {0};
+        qint64 secs {-1};
+        QByteArray text;
+    } entries[Size];
+    int next {0};
+};
+
+QThreadStorage<TimestampCache> timestampCacheTls;
+
+struct LayoutCache {
+    QByteArray layout;
+    QByteArray dateTimeFormat;
+    TLogLayout::Type type {TLogLayout::AppLog};
+    bool compiled {false};
+    TLogLayout logLayout;
+};
+
+QThreadStorage<LayoutCache> layoutCacheTls;
+
+const QByteArray UpperPriorityNames[] = {"FATAL", "ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
+const QByteArray LowerPriorityNames[] = {"fatal", "error", "warn", "info", "debug", "trace"};
+
+
+inline void appendNumber(QByteArray &buf, quint64 value, bool negative, int base, int width, char fill)
+{
+    static const char Digits[] = "0123456789abcdef";
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    char *p = end;
+
+    do {
+        *--p = Digits[value % base];
+        value /= base;
+    } while (value);
+
+    int pad = width - int(end - p) - (negative ? 1 : 0);
+    if (negative && fill == '0') {
+        buf += '-';  // sign before zeros
+        negative = false;
+    }
+    if (pad > 0) {
+        buf.append(pad, fill);
+    }
+    if (negative) {
+        buf += '-';
+    }
+    buf.append(p, int(end - p));
+}
+
+
+inline void appendNumber(QByteArray &buf, qint64 value, int width, char fill)
+{
+    if (value < 0) {
+        appendNumber(buf, ~quint64(value) + 1, true, 10, width, fill);
+    } else {
+        appendNumber(buf, quint64(value), false, 10, width, fill);
+    }
+}
+
+}  // namespace
+
+/*!
+  Constructs a log layout compiled from \a layout and \a dateTimeFormat.
+*/
+TLogLayout::TLogLayout(const QByteArray &layout, const QByteArray &dateTimeFormat, Type type)
+{
+    compile(layout, dateTimeFormat, type);
+}
+
+/*!
+  Returns the layout compiled from \a layout and \a dateTimeFormat for
+  the log of \a type. It is cached in the current thread, and compiled
+  again only when the arguments differ from those of the last call.
+*/
+TLogLayout &TLogLayout::cached(const QByteArray &layout, const QByteArray &dateTimeFormat, Type type)
+{
+    LayoutCache &cache = layoutCacheTls.localData();
+    if (!cache.compiled || cache.type != type || cache.layout != layout || cache.dateTimeFormat != dateTimeFormat) {
+        cache.logLayout.compile(layout, dateTimeFormat, type);
+        cache.layout = layout;
+        cache.dateTimeFormat = dateTimeFormat;
+        cache.type = type;
+        cache.compiled = true;
+    }
+    return cache.logLayout;
+}
+
+/*!
+  Compiles the \a layout and \a dateTimeFormat for the log of \a type.
+*/
+void TLogLayout::compile(const QByteArray &layout, const QByteArray &dateTimeFormat, Type type)
+{
+    _tokens.clear();
+    _dateTimeFormat = dateTimeFormat;
+    _type = type;
+    // A text containing milliseconds can not be reused
+    _timestampCacheable = !dateTimeFormat.contains('z');
+    _id = ++layoutCounter;
+
+    QByteArray literal;
+    QByteArray dig;
+
+    auto appendToken = [&](Op op) {
+        if (!literal.isEmpty()) {
+            Token lit;
+            lit.literal = literal;
+            _tokens << lit;
+            literal.clear();
+        }
+        Token token;
+        token.op = op;
+        token.width = dig.toInt();
+        token.fill = (!dig.isEmpty() && dig[0] == '0') ? '0' : ' ';
+        _tokens << token;
+    };
+
+    int pos = 0;
+    while (pos < layout.length()) {
+        char c = layout.at(pos++);
+        if (c != '%') {
+            literal.append(c);
+            continue;
+        }
+
+        dig.resize(0);
+        for (;;) {
+            if (pos >= layout.length()) {
+                literal.append('%').append(dig);
+                break;
+            }
+
+            c = layout.at(pos++);
+            if (c >= '0' && c <= '9') {
+                dig += c;
+                continue;
+            }
+
+            Op op = Literal;
+            switch (c) {
+            case 'd':  // %d : timestamp
+                op = Timestamp;
+                break;
+
+            case 'e':  // %e : duration
+                op = Duration;
+                break;
+
+            case 'n':  // %n : newline
+                literal.append('\n');
+                break;
+
+            case '%':
+                literal.append('%').append(dig);
+                dig.resize(0);
+                continue;
+                break;
+
+            default:
+                if (type == AppLog) {
+                    switch (c) {
+                    case 'p':
+                        op = PriorityLower;
+                        break;
+                    case 'P':
+                        op = PriorityUpper;
+                        break;
+                    case 't':
+                        op = ThreadIdDec;
+                        break;
+                    case 'T':
+                        op = ThreadIdHex;
+                        break;
+                    case 'i':
+                        op = PidDec;
+                        break;
+                    case 'I':
+                        op = PidHex;
+                        break;
+                    case 'm':
+                        op = Message;
+                        break;
+                    default:
+                        literal.append('%').append(dig).append(c);
+                        break;
+                    }
+                } else {
+                    switch (c) {
+                    case 'h':
+                        op = RemoteHost;
+                        break;
+                    case 'r':
+                        op = Request;
+                        break;
+                    case 's':
+                        op = StatusCode;
+                        break;
+                    case 'O':
+                        op = ResponseBytes;
+                        break;
+                    default:
+                        literal.append('%').append(dig).append(c);
+                        break;
+                    }
+                }
+                break;
+            }
+
+            if (op != Literal) {
+                appendToken(op);
+            }
+            break;
+        }
+    }
+
+    if (!literal.isEmpty()) {
+        Token lit;
+        lit.literal = literal;
+        _tokens << lit;
+    }
+}
+
+
+void TLogLayout::appendTimestamp(QByteArray &buf, const QDateTime &timestamp) const
+{
+    auto toText = [this](const QDateTime &dt) {
+        if (_dateTimeFormat.isEmpty()) {
+            return dt.toString(Qt::ISODate).toLatin1();
+        }
+        QString str = dt.toString(_dateTimeFormat);
+        return (_type == AccessLog) ? str.toLocal8Bit() : str.toLatin1();
+    };
+
+    if (!_timestampCacheable) {
+        buf += toText(timestamp);
+        return;
+    }
+
+    const qint64 secs = timestamp.toMSecsSinceEpoch() / 1000;
+    auto &cache = timestampCacheTls.localData();
+    for (auto &entry : cache.entries) {
+        if (entry.id == _id && entry.secs == secs) {
+            buf += entry.text;
+            return;
+        }
+    }
+
+    auto &entry = cache.entries[cache.next];
+    cache.next = (cache.next + 1) % TimestampCache::Size;
+    entry.id = _id;
+    entry.secs = secs;
+    entry.text = toText(timestamp);
+    buf += entry.text;
+}
+
+/*!
+  Returns the textual representation of the application log \a log.
+*/
+QByteArray TLogLayout::format(const TLog &log) const
+{
+    QByteArray message;
+    message.reserve(log.message.length() + 128);
+
+    for (auto &token : _tokens) {
+        switch (token.op) {
+        case Literal:
+            message += token.literal;
+            break;
+
+        case Timestamp:
+            appendTimestamp(message, log.timestamp);
+            break;
+
+        case PriorityUpper:
+        case PriorityLower:
+            if (log.priority >= Tf::FatalLevel && log.priority <= Tf::TraceLevel) {
+                const QByteArray &pri = (token.op == PriorityUpper) ? UpperPriorityNames[log.priority] : LowerPriorityNames[log.priority];
+                message += pri;
+                int d = token.width - pri.length();
+                if (d > 0) {
+                    message.append(d, ' ');
+                }
+            }
+            break;
+
+        case ThreadIdDec:
+        case ThreadIdHex:
+            appendNumber(message, (quint64)log.threadId, false, ((token.op == ThreadIdDec) ? 10 : 16), token.width, token.fill);
+            break;
+
+        case PidDec:
+        case PidHex:
+            appendNumber(message, (quint64)log.pid, false, ((token.op == PidDec) ? 10 : 16), token.width, token.fill);
+            break;
+
+        case Message:
+            message += log.message;
+            break;
+
+        case Duration:
+            appendNumber(message, (qint64)log.duration, token.width, token.fill);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+#if QT_VERSION < 0x060000
+    return (_codec) ? _codec->fromUnicode(QString::fromLocal8Bit(message.data(), message.length())) : message;
+#else
+# ifdef Q_OS_UNIX
+    if (_encoding == QStringConverter::Utf8) {
+        return message;  // local 8-bit is UTF-8 on Unix
+    }
+# endif
+    return QStringEncoder(_encoding).encode(QString::fromLocal8Bit(message.data(), message.length()));
+#endif
+}
+
+/*!
+  Returns the textual representation of the access log \a log.
+*/
+QByteArray TLogLayout::format(const TAccessLog &log) const
+{
+    QByteArray message;
+    message.reserve(log.request.length() + 128);
+
+    for (auto &token : _tokens) {
+        switch (token.op) {
+        case Literal:
+            message += token.literal;
+            break;
+
+        case Timestamp:
+            appendTimestamp(message, log.timestamp);
+            break;
+
+        case RemoteHost:
+            message += log.remoteHost;
+            break;
+
+        case Request:
+            message += log.request;
+            break;
+
+        case StatusCode:
+            appendNumber(message, (qint64)log.statusCode, 0, ' ');
+            break;
+
+        case ResponseBytes:
+            appendNumber(message, (qint64)log.responseBytes, token.width, token.fill);
+            break;
+
+        case Duration:
+            appendNumber(message, (qint64)log.duration, token.width, token.fill);
+            break;
+
+        default:
+            break;
+        }
+    }
+    return message;
+}
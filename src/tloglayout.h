@@ -0,0 +1,75 @@
+#pragma once
+#include <QByteArray>
+#include <QVector>
+#include <TGlobal>
+#if QT_VERSION >= 0x060000
+# include <QStringConverter>
+#endif
+
+class TLog;
+class TAccessLog;
+class QDateTime;
+class QTextCodec;
+
+
+class T_CORE_EXPORT TLogLayout {
+public:
+    enum Type {
+        AppLog = 0,
+        AccessLog,
+    };
+
+    TLogLayout() { }
+    TLogLayout(const QByteArray &layout, const QByteArray &dateTimeFormat, Type type = AppLog);
+
+    void compile(const QByteArray &layout, const QByteArray &dateTimeFormat, Type type = AppLog);
+    bool isEmpty() const { return _tokens.isEmpty(); }
+    QByteArray format(const TLog &log) const;
+    QByteArray format(const TAccessLog &log) const;
+
+    static TLogLayout &cached(const QByteArray &layout, const QByteArray &dateTimeFormat, Type type = AppLog);
+
+#if QT_VERSION < 0x060000
+    void setCodec(QTextCodec *codec) { _codec = codec; }
+#else
+    void setEncoding(QStringConverter::Encoding encoding) { _encoding = encoding; }
+#endif
+
+private:
+    enum Op {
+        Literal = 0,
+        Timestamp,
+        PriorityUpper,
+        PriorityLower,
+        ThreadIdDec,
+        ThreadIdHex,
+        PidDec,
+        PidHex,
+        Message,
+        Duration,
+        RemoteHost,
+        Request,
+        StatusCode,
+        ResponseBytes,
+    };
+
+    struct Token {
+        Op op {Literal};
+        int width {0};
+        char fill {' '};
+        QByteArray literal;
+    };
+
+    void appendTimestamp(QByteArray &buf, const QDateTime &timestamp) const;
+
+    QVector<Token> _tokens;
+    QByteArray _dateTimeFormat;
+    Type _type {AppLog};
+    bool _timestampCacheable {false};
+    quint64 _id {0};
+#if QT_VERSION < 0x060000
+    QTextCodec *_codec {nullptr};
+#else
+    QStringConverter::Encoding _encoding {QStringConverter::Utf8};
+#endif
+};
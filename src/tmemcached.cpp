@@ -159,6 +159,16 @@ bool TMemcached::remove(const QByteArray &key)
     return res.startsWith("DELETED");
 }
 
+/*!
+  Updates the expiration time of the \a key to \a seconds without
+  fetching the value.
+*/
+bool TMemcached::touch(const QByteArray &key, int seconds)
+{
+    QByteArray res = requestLine("touch", key, QByteArray::number(seconds), false);
+    return res.startsWith("TOUCHED");
+}
+
 
 uint64_t TMemcached::incr(const QByteArray &key, uint64_t value, bool *ok)
 {
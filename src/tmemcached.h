@@ -25,6 +25,7 @@ public:
     bool append(const QByteArray &key, const QByteArray &value, int seconds, uint flags = 0);
     bool prepend(const QByteArray &key, const QByteArray &value, int seconds, uint flags = 0);
     bool remove(const QByteArray &key);
+    bool touch(const QByteArray &key, int seconds);
     uint64_t incr(const QByteArray &key, uint64_t value, bool *ok = nullptr);
     uint64_t decr(const QByteArray &key, uint64_t value, bool *ok = nullptr);
     bool flushAll();
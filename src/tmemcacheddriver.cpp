@@ -6,7 +6,9 @@
  */
 
 #include "tmemcacheddriver.h"
+#include "tmetrics.h"
 #include "tsystemglobal.h"
+#include "ttrace.h"
 
 
 TMemcachedDriver::TMemcachedDriver() :
@@ -30,6 +32,9 @@ bool TMemcachedDriver::command(const QByteArray &cmd)
 */
 QByteArray TMemcachedDriver::request(const QByteArray &command, int msecs)
 {
+    TMetrics::Timer metricsTimer(TMetrics::KvsQuery);
+    TTrace::Span span(TTrace::KvsQuery);
+
     if (Q_UNLIKELY(!isOpen())) {
         tSystemError("Not open memcached session  [%s:%d]", __FILE__, __LINE__);
         return QByteArray();
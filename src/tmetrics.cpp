@@ -0,0 +1,608 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tmetrics.h"
+#include "tlocalcache.h"
+#include "tpublisher.h"
+#include "tsystembus.h"
+#include "tsystemglobal.h"
+#include <QDataStream>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QTimer>
+#include <QtAlgorithms>
+#include <TAppSettings>
+#include <TWebApplication>
+#include <algorithm>
+#include <atomic>
+
+/*!
+  \class TMetrics
+  \brief The TMetrics class collects the runtime statistics of the
+  application server and exposes them in the Prometheus text format.
+
+  Each thread records into its own shard of counters and histograms
+  without locking; a scrape sums up the shards. The latencies are
+  counted in log-scale buckets from 100 microseconds, doubling up to
+  about a minute. Requests are labeled with the controller#action
+  dispatched; the others are labeled "(other)".
+
+  The metrics are enabled by Metrics.Path in the application.ini, the
+  path to serve them. With two or more application server processes,
+  each process publishes its metrics over the system bus every few
+  seconds, so that a scrape of any process returns the sum of all.
+*/
+
+namespace {
+
+constexpr int64_t BUCKET_BASE = 100;  // usecs
+constexpr int NUM_BUCKETS = 21;  // the last is +Inf
+constexpr int MAX_ROUTES = 512;
+constexpr int MAX_STATUS_CODE = 600;
+constexpr int PUBLISH_INTERVAL = 5000;  // msecs
+constexpr int64_t REMOTE_EXPIRY = PUBLISH_INTERVAL * 3;  // msecs
+constexpr quint8 SNAPSHOT_VERSION = 1;
+const QByteArray OTHER_ROUTE = QByteArrayLiteral("(other)");
+
+
+struct HistogramData {
+    quint64 buckets[NUM_BUCKETS] {};
+    quint64 count {0};
+    quint64 sum {0};  // usecs
+
+    void add(const HistogramData &other)
+    {
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        sum += other.sum;
+    }
+};
+
+
+struct Snapshot {
+    QMap<QByteArray, HistogramData> requests;  // by route
+    QMap<int, quint64> statusCodes;
+    HistogramData histograms[TMetrics::NumHistograms];
+    qint64 counters[TMetrics::NumCounters] {};
+
+    void add(const Snapshot &other)
+    {
+        for (auto it = other.requests.cbegin(); it != other.requests.cend(); ++it) {
+            requests[it.key()].add(it.value());
+        }
+        for (auto it = other.statusCodes.cbegin(); it != other.statusCodes.cend(); ++it) {
+            statusCodes[it.key()] += it.value();
+        }
+        for (int i = 0; i < TMetrics::NumHistograms; i++) {
+            histograms[i].add(other.histograms[i]);
+        }
+        for (int i = 0; i < TMetrics::NumCounters; i++) {
+            counters[i] += other.counters[i];
+        }
+    }
+};
+
+
+QDataStream &operator<<(QDataStream &ds, const HistogramData &data)
+{
+    for (auto b : data.buckets) {
+        ds << b;
+    }
+    return ds << data.count << data.sum;
+}
+
+
+QDataStream &operator>>(QDataStream &ds, HistogramData &data)
+{
+    for (auto &b : data.buckets) {
+        ds >> b;
+    }
+    return ds >> data.count >> data.sum;
+}
+
+
+QDataStream &operator<<(QDataStream &ds, const Snapshot &snapshot)
+{
+    ds << snapshot.requests << snapshot.statusCodes;
+    for (auto &h : snapshot.histograms) {
+        ds << h;
+    }
+    for (auto c : snapshot.counters) {
+        ds << c;
+    }
+    return ds;
+}
+
+
+QDataStream &operator>>(QDataStream &ds, Snapshot &snapshot)
+{
+    ds >> snapshot.requests >> snapshot.statusCodes;
+    for (auto &h : snapshot.histograms) {
+        ds >> h;
+    }
+    for (auto &c : snapshot.counters) {
+        ds >> c;
+    }
+    return ds;
+}
+
+// Written by the owner thread only, so no read-modify-write is needed
+template <typename T>
+inline void increment(std::atomic<T> &value, T n)
+{
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+
+inline int bucketIndex(int64_t usecs)
+{
+    if (usecs <= BUCKET_BASE) {
+        return 0;
+    }
+    int index = 64 - qCountLeadingZeroBits((quint64)((usecs - 1) / BUCKET_BASE));
+    return std::min(index, NUM_BUCKETS - 1);
+}
+
+
+struct AtomicHistogram {
+    std::atomic<quint64> buckets[NUM_BUCKETS] {};
+    std::atomic<quint64> count {0};
+    std::atomic<quint64> sum {0};
+
+    void observe(int64_t usecs)
+    {
+        usecs = std::max(usecs, (int64_t)0);
+        increment(buckets[bucketIndex(usecs)], (quint64)1);
+        increment(count, (quint64)1);
+        increment(sum, (quint64)usecs);
+    }
+
+    void addTo(HistogramData &data) const
+    {
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            data.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+        }
+        data.count += count.load(std::memory_order_relaxed);
+        data.sum += sum.load(std::memory_order_relaxed);
+    }
+};
+
+
+struct Shard {
+    std::atomic<AtomicHistogram *> requests[MAX_ROUTES] {};  // by route index
+    std::atomic<quint64> statusCodes[MAX_STATUS_CODE] {};
+    AtomicHistogram histograms[TMetrics::NumHistograms];
+    std::atomic<qint64> counters[TMetrics::NumCounters] {};
+
+    ~Shard()
+    {
+        for (auto &h : requests) {
+            delete h.load();
+        }
+    }
+
+    void addTo(Snapshot &snapshot, const QByteArrayList &routes) const;
+};
+
+
+struct RemoteSnapshot {
+    int64_t received {0};  // msecs since epoch
+    Snapshot snapshot;
+};
+
+
+struct Registry {
+    QMutex mutex;
+    QList<Shard *> shards;
+    Snapshot retired;  // values of the threads exited
+    QByteArrayList routes {OTHER_ROUTE};
+    QHash<QByteArray, int> routeIndexes;
+    QMap<QString, RemoteSnapshot> remotes;  // by application server ID
+};
+
+
+Registry &registry()
+{
+    static Registry reg;
+    return reg;
+}
+
+
+void Shard::addTo(Snapshot &snapshot, const QByteArrayList &routes) const
+{
+    for (int i = 0; i < routes.count(); i++) {
+        const AtomicHistogram *h = requests[i].load(std::memory_order_acquire);
+        if (h) {
+            h->addTo(snapshot.requests[routes[i]]);
+        }
+    }
+    for (int code = 0; code < MAX_STATUS_CODE; code++) {
+        quint64 num = statusCodes[code].load(std::memory_order_relaxed);
+        if (num > 0) {
+            snapshot.statusCodes[code] += num;
+        }
+    }
+    for (int i = 0; i < TMetrics::NumHistograms; i++) {
+        histograms[i].addTo(snapshot.histograms[i]);
+    }
+    for (int i = 0; i < TMetrics::NumCounters; i++) {
+        snapshot.counters[i] += counters[i].load(std::memory_order_relaxed);
+    }
+}
+
+
+struct LocalShard {
+    Shard *shard {nullptr};
+
+    ~LocalShard()
+    {
+        if (shard) {
+            // Keeps the values of this thread
+            Registry &reg = registry();
+            QMutexLocker locker(&reg.mutex);
+            shard->addTo(reg.retired, reg.routes);
+            reg.shards.removeOne(shard);
+            delete shard;
+        }
+    }
+};
+
+thread_local LocalShard localShard;
+thread_local QHash<QByteArray, int> localRouteIndexes;
+
+
+Shard *shard()
+{
+    if (Q_UNLIKELY(!localShard.shard)) {
+        auto *sh = new Shard;
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        reg.shards << sh;
+        localShard.shard = sh;
+    }
+    return localShard.shard;
+}
+
+
+int routeIndex(const QByteArray &route)
+{
+    auto it = localRouteIndexes.constFind(route);
+    if (Q_LIKELY(it != localRouteIndexes.constEnd())) {
+        return it.value();
+    }
+
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    int index = reg.routeIndexes.value(route, -1);
+    if (index < 0) {
+        if (reg.routes.count() < MAX_ROUTES) {
+            index = reg.routes.count();
+            reg.routes << route;
+            reg.routeIndexes.insert(route, index);
+        } else {
+            tSystemWarn("Too many routes for metrics: %s", route.data());
+            index = 0;
+        }
+    }
+    locker.unlock();
+
+    localRouteIndexes.insert(route, index);
+    return index;
+}
+
+// Called with the mutex locked
+Snapshot collect(const Registry &reg)
+{
+    Snapshot snapshot = reg.retired;
+    for (auto *sh : reg.shards) {
+        sh->addTo(snapshot, reg.routes);
+    }
+    return snapshot;
+}
+
+
+void publish()
+{
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    Snapshot snapshot = collect(reg);
+    locker.unlock();
+
+    QByteArray data;
+    QDataStream ds(&data, QIODevice::WriteOnly);
+    ds << SNAPSHOT_VERSION << snapshot;
+    TSystemBus::instance()->send(Tf::MetricsSnapshot, QString::number(Tf::app()->applicationServerId()), data);
+}
+
+
+QByteArray escapeLabel(const QByteArray &value)
+{
+    QByteArray ret = value;
+    ret.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return ret;
+}
+
+
+QByteArray seconds(quint64 usecs)
+{
+    return QByteArray::number(usecs / 1000000.0, 'g', 10);
+}
+
+
+void appendHeader(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+
+void appendSample(QByteArray &out, const char *name, const char *suffix, const QByteArray &labels, const QByteArray &value)
+{
+    out += name;
+    out += suffix;
+    if (!labels.isEmpty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += value;
+    out += '\n';
+}
+
+
+void appendHistogram(QByteArray &out, const char *name, const QByteArray &labels, const HistogramData &data)
+{
+    static const QByteArrayList bounds = []() {
+        QByteArrayList lst;
+        for (int i = 0; i < NUM_BUCKETS - 1; i++) {
+            lst << seconds(BUCKET_BASE << i);
+        }
+        lst << QByteArrayLiteral("+Inf");
+        return lst;
+    }();
+
+    const QByteArray prefix = labels.isEmpty() ? QByteArray() : QByteArray(labels + ',');
+    quint64 cumulative = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        cumulative += data.buckets[i];
+        appendSample(out, name, "_bucket", prefix + "le=\"" + bounds[i] + '"', QByteArray::number(cumulative));
+    }
+    appendSample(out, name, "_sum", labels, seconds(data.sum));
+    appendSample(out, name, "_count", labels, QByteArray::number(data.count));
+}
+
+}  // namespace
+
+
+TMetrics::Timer::Timer(Histogram histogram) :
+    _histogram(histogram)
+{
+    if (isEnabled()) {
+        _timer.start();
+    }
+}
+
+
+TMetrics::Timer::~Timer()
+{
+    if (_timer.isValid()) {
+        observe(_histogram, _timer.nsecsElapsed() / 1000);
+    }
+}
+
+/*!
+  Returns true if the metrics are enabled by Metrics.Path in the
+  application.ini.
+*/
+bool TMetrics::isEnabled()
+{
+    static const bool enabled = !path().isEmpty();
+    return enabled;
+}
+
+/*!
+  Returns the path to serve the metrics.
+*/
+QString TMetrics::path()
+{
+    static const QString metricsPath = []() {
+        QString p = Tf::appSettings()->value(Tf::MetricsPath).toString().trimmed();
+        if (!p.isEmpty() && !p.startsWith(QLatin1Char('/'))) {
+            p.prepend(QLatin1Char('/'));
+        }
+        return p;
+    }();
+    return metricsPath;
+}
+
+/*!
+  Adds the \a value to the \a counter.
+*/
+void TMetrics::add(Counter counter, int64_t value)
+{
+    if (isEnabled()) {
+        increment(shard()->counters[counter], (qint64)value);
+    }
+}
+
+/*!
+  Observes the \a usecs microseconds into the \a histogram.
+*/
+void TMetrics::observe(Histogram histogram, int64_t usecs)
+{
+    if (isEnabled()) {
+        shard()->histograms[histogram].observe(usecs);
+    }
+}
+
+/*!
+  Observes a request processed by the \a route, responded with the
+  \a statusCode in \a usecs microseconds. An empty \a route is counted
+  as "(other)".
+*/
+void TMetrics::observeRequest(const QByteArray &route, int statusCode, int64_t usecs)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    Shard *sh = shard();
+    int index = route.isEmpty() ? 0 : routeIndex(route);
+    AtomicHistogram *h = sh->requests[index].load(std::memory_order_relaxed);
+    if (!h) {
+        h = new AtomicHistogram;
+        sh->requests[index].store(h, std::memory_order_release);
+    }
+    h->observe(usecs);
+
+    if (statusCode >= 100 && statusCode < MAX_STATUS_CODE) {
+        increment(sh->statusCodes[statusCode], (quint64)1);
+    }
+}
+
+/*!
+  Returns the metrics of all the application servers in the Prometheus
+  text format.
+*/
+QByteArray TMetrics::exposition()
+{
+    Registry &reg = registry();
+    const int64_t now = Tf::getMSecsSinceEpoch();
+    int servers = 1;
+
+    QMutexLocker locker(&reg.mutex);
+    Snapshot total = collect(reg);
+    for (auto it = reg.remotes.begin(); it != reg.remotes.end();) {
+        if (now - it->received > REMOTE_EXPIRY) {
+            it = reg.remotes.erase(it);  // process gone
+        } else {
+            total.add(it->snapshot);
+            servers++;
+            ++it;
+        }
+    }
+    locker.unlock();
+
+    QByteArray out;
+    out.reserve(64 * 1024);
+
+    constexpr auto requestDuration = "tf_http_request_duration_seconds";
+    appendHeader(out, requestDuration, "histogram", "Time to process HTTP requests by controller#action.");
+    for (auto it = total.requests.cbegin(); it != total.requests.cend(); ++it) {
+        appendHistogram(out, requestDuration, "route=\"" + escapeLabel(it.key()) + '"', it.value());
+    }
+
+    constexpr auto responses = "tf_http_responses_total";
+    appendHeader(out, responses, "counter", "HTTP responses by status code.");
+    for (auto it = total.statusCodes.cbegin(); it != total.statusCodes.cend(); ++it) {
+        appendSample(out, responses, "", "code=\"" + QByteArray::number(it.key()) + '"', QByteArray::number(it.value()));
+    }
+
+    const struct {
+        const char *name;
+        const char *help;
+    } histograms[NumHistograms] = {
+        {"tf_sql_pool_wait_seconds", "Time to get an SQL database from the pool."},
+        {"tf_sql_query_duration_seconds", "Time to execute SQL queries."},
+        {"tf_kvs_pool_wait_seconds", "Time to get a KVS database from the pool."},
+        {"tf_kvs_query_duration_seconds", "Time to execute Redis and memcached commands."},
+    };
+    for (int i = 0; i < NumHistograms; i++) {
+        appendHeader(out, histograms[i].name, "histogram", histograms[i].help);
+        appendHistogram(out, histograms[i].name, QByteArray(), total.histograms[i]);
+    }
+
+    const struct {
+        const char *name;
+        const char *type;
+        const char *help;
+    } counters[NumCounters] = {
+        {"tf_cache_hits_total", "counter", "Cache reads which found the value."},
+        {"tf_cache_misses_total", "counter", "Cache reads which found no value."},
+        {"tf_active_sockets", "gauge", "Client sockets open."},
+        {"tf_active_websockets", "gauge", "WebSocket connections open."},
+    };
+    for (int i = 0; i < NumCounters; i++) {
+        appendHeader(out, counters[i].name, counters[i].type, counters[i].help);
+        appendSample(out, counters[i].name, "", QByteArray(), QByteArray::number(total.counters[i]));
+    }
+
+    // Local cache of this process
+    if (TLocalCache::instance()) {
+        auto stats = TLocalCache::instance()->statistics();
+        QByteArray server = "server=\"" + QByteArray::number(Tf::app()->applicationServerId()) + '"';
+        appendHeader(out, "tf_local_cache_hits_total", "counter", "Local cache reads which found the value in this process.");
+        appendSample(out, "tf_local_cache_hits_total", "", server, QByteArray::number(stats.hits));
+        appendHeader(out, "tf_local_cache_misses_total", "counter", "Local cache reads which found no value in this process.");
+        appendSample(out, "tf_local_cache_misses_total", "", server, QByteArray::number(stats.misses));
+        appendHeader(out, "tf_local_cache_evictions_total", "counter", "Local cache entries evicted in this process.");
+        appendSample(out, "tf_local_cache_evictions_total", "", server, QByteArray::number(stats.evictions));
+        appendHeader(out, "tf_local_cache_entries", "gauge", "Local cache entries in this process.");
+        appendSample(out, "tf_local_cache_entries", "", server, QByteArray::number(stats.count));
+    }
+
+    appendHeader(out, "tf_app_servers", "gauge", "Application server processes included.");
+    appendSample(out, "tf_app_servers", "", QByteArray(), QByteArray::number(servers));
+    return out;
+}
+
+/*!
+  Starts publishing the metrics of this process to the other
+  application servers; called in the main thread.
+*/
+void TMetrics::startPublishing()
+{
+    if (!isEnabled() || Tf::app()->maxNumberOfAppServers() <= 1) {
+        return;
+    }
+
+    TPublisher::instance();  // receives the metrics from the system bus
+    auto *timer = new QTimer(Tf::app());
+    QObject::connect(timer, &QTimer::timeout, &publish);
+    timer->start(PUBLISH_INTERVAL);
+}
+
+/*!
+  Keeps the \a snapshot of the metrics published by the application
+  server \a sender.
+*/
+void TMetrics::receive(const QString &sender, const QByteArray &snapshot)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    QDataStream ds(snapshot);
+    quint8 version = 0;
+    RemoteSnapshot remote;
+    ds >> version;
+    if (version != SNAPSHOT_VERSION) {
+        return;
+    }
+
+    ds >> remote.snapshot;
+    if (ds.status() != QDataStream::Ok) {
+        tSystemError("Invalid metrics snapshot  [%s:%d]", __FILE__, __LINE__);
+        return;
+    }
+
+    remote.received = Tf::getMSecsSinceEpoch();
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    reg.remotes.insert(sender, remote);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TMetrics {
+public:
+    enum Histogram {
+        SqlPoolWait = 0,
+        SqlQuery,
+        KvsPoolWait,
+        KvsQuery,
+        NumHistograms,
+    };
+
+    enum Counter {
+        CacheHits = 0,
+        CacheMisses,
+        ActiveSockets,  // gauge
+        ActiveWebSockets,  // gauge
+        NumCounters,
+    };
+
+    // Observes the time to its destruction into the histogram
+    class Timer {
+    public:
+        Timer(Histogram histogram);
+        ~Timer();
+
+    private:
+        Histogram _histogram;
+        QElapsedTimer _timer;
+
+        T_DISABLE_COPY(Timer)
+        T_DISABLE_MOVE(Timer)
+    };
+
+    static bool isEnabled();
+    static QString path();
+    static void add(Counter counter, int64_t value = 1);
+    static void observe(Histogram histogram, int64_t usecs);
+    static void observeRequest(const QByteArray &route, int statusCode, int64_t usecs);
+    static QByteArray exposition();
+    static void startPublishing();
+    static void receive(const QString &sender, const QByteArray &snapshot);
+};
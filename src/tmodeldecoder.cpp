@@ -0,0 +1,181 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tmodeldecoder.h"
+#include "tmodelencoder.h"
+#include "tsystemglobal.h"
+
+/*!
+  \class TModelDecoder
+  \brief The TModelDecoder class decodes the fields of a model encoded
+  by TModelEncoder.
+
+  If the data is a variant map written by the models of the previous
+  versions, isLegacy() returns true and the map is returned by
+  legacyValues(). If the data is of another schema version, nothing is
+  decoded.
+  \sa TModelEncoder
+*/
+
+namespace {
+
+inline qint64 unzigzag(quint64 value)
+{
+    return (qint64)(value >> 1) ^ -(qint64)(value & 1);
+}
+
+}  // namespace
+
+/*!
+  Constructs a decoder that reads the data of a model from the stream
+  \a ds.
+*/
+TModelDecoder::TModelDecoder(QDataStream &ds, quint32 schemaVersion)
+{
+    quint32 head = 0;
+    ds >> head;
+    if (ds.status() != QDataStream::Ok) {
+        _status = ReadPastEnd;
+        return;
+    }
+
+    if (head != TModelEncoder::MAGIC) {
+        // The head is the number of the items of the variant map
+        for (quint32 i = 0; i < head && ds.status() == QDataStream::Ok; i++) {
+            QString key;
+            QVariant value;
+            ds >> key >> value;
+            _legacyValues.insert(key, value);
+        }
+        _status = (ds.status() == QDataStream::Ok) ? Legacy : ReadPastEnd;
+        return;
+    }
+
+    QByteArray data;
+    ds >> data;
+    _buffer.setData(data);
+    _buffer.open(QIODevice::ReadOnly);
+    _stream.setDevice(&_buffer);
+    _stream.setVersion(ds.version());
+    _stream.setFloatingPointPrecision(ds.floatingPointPrecision());
+
+    quint64 version = 0;
+    if (ds.status() != QDataStream::Ok || !readVarint(version)) {
+        _status = ReadPastEnd;
+    } else if (version != schemaVersion) {
+        tSystemWarn("Model data of another schema version discarded: %llx", (unsigned long long)version);
+        _status = SchemaMismatch;
+    }
+}
+
+
+TModelDecoder &TModelDecoder::operator>>(bool &value)
+{
+    if (_status == Ok) {
+        char byte;
+        if (_buffer.getChar(&byte)) {
+            value = byte;
+        } else {
+            _status = ReadPastEnd;
+        }
+    }
+    return *this;
+}
+
+
+TModelDecoder &TModelDecoder::operator>>(int &value)
+{
+    quint64 v;
+    if (_status == Ok && readVarint(v)) {
+        value = (int)unzigzag(v);
+    }
+    return *this;
+}
+
+
+TModelDecoder &TModelDecoder::operator>>(uint &value)
+{
+    quint64 v;
+    if (_status == Ok && readVarint(v)) {
+        value = (uint)v;
+    }
+    return *this;
+}
+
+
+TModelDecoder &TModelDecoder::operator>>(qint64 &value)
+{
+    quint64 v;
+    if (_status == Ok && readVarint(v)) {
+        value = unzigzag(v);
+    }
+    return *this;
+}
+
+
+TModelDecoder &TModelDecoder::operator>>(quint64 &value)
+{
+    if (_status == Ok) {
+        readVarint(value);
+    }
+    return *this;
+}
+
+
+TModelDecoder &TModelDecoder::operator>>(QString &value)
+{
+    QByteArray bytes;
+    if (_status == Ok && readBytes(bytes)) {
+        value = QString::fromUtf8(bytes);
+    }
+    return *this;
+}
+
+
+TModelDecoder &TModelDecoder::operator>>(QByteArray &value)
+{
+    if (_status == Ok) {
+        readBytes(value);
+    }
+    return *this;
+}
+
+
+bool TModelDecoder::readVarint(quint64 &value)
+{
+    quint64 v = 0;
+    char byte;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (!_buffer.getChar(&byte)) {
+            break;
+        }
+        v |= (quint64)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            value = v;
+            return true;
+        }
+    }
+    _status = ReadPastEnd;
+    return false;
+}
+
+
+bool TModelDecoder::readBytes(QByteArray &bytes)
+{
+    quint64 len;
+    if (!readVarint(len)) {
+        return false;
+    }
+
+    if (len > (quint64)_buffer.bytesAvailable()) {
+        _status = ReadPastEnd;
+        return false;
+    }
+    bytes = _buffer.read(len);
+    return true;
+}
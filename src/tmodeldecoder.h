@@ -0,0 +1,60 @@
+#pragma once
+#include <QBuffer>
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <QVariant>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TModelDecoder {
+public:
+    enum Status {
+        Ok = 0,
+        Legacy,  // variant map of the previous versions
+        SchemaMismatch,
+        ReadPastEnd,
+    };
+
+    TModelDecoder(QDataStream &ds, quint32 schemaVersion);
+
+    Status status() const { return _status; }
+    bool isLegacy() const { return _status == Legacy; }
+    const QVariantMap &legacyValues() const { return _legacyValues; }
+
+    TModelDecoder &operator>>(bool &value);
+    TModelDecoder &operator>>(int &value);
+    TModelDecoder &operator>>(uint &value);
+    TModelDecoder &operator>>(qint64 &value);
+    TModelDecoder &operator>>(quint64 &value);
+    TModelDecoder &operator>>(QString &value);
+    TModelDecoder &operator>>(QByteArray &value);
+    template <typename T>
+    TModelDecoder &operator>>(T &value);
+
+private:
+    bool readVarint(quint64 &value);
+    bool readBytes(QByteArray &bytes);
+
+    QBuffer _buffer;
+    QDataStream _stream;
+    QVariantMap _legacyValues;
+    Status _status {Ok};
+
+    T_DISABLE_COPY(TModelDecoder)
+    T_DISABLE_MOVE(TModelDecoder)
+};
+
+// Decodes a value of the other types with QDataStream
+template <typename T>
+inline TModelDecoder &TModelDecoder::operator>>(T &value)
+{
+    if (_status == Ok) {
+        _stream >> value;
+        if (_stream.status() != QDataStream::Ok) {
+            _status = ReadPastEnd;
+        }
+    }
+    return *this;
+}
+
@@ -0,0 +1,121 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tmodelencoder.h"
+
+/*!
+  \class TModelEncoder
+  \brief The TModelEncoder class encodes the fields of a model into a
+  compact binary, in the order of the fields and without their names.
+
+  The integers are encoded as varints, the strings and byte arrays as
+  their length and bytes, and the values of the other types with
+  QDataStream. The binary begins with the schema version of the model,
+  and is written to the stream with a magic number when the encoder is
+  destroyed, so that TModelDecoder tells it from the variant map written
+  by the models of the previous versions.
+  \sa TModelDecoder
+*/
+
+namespace {
+
+inline quint64 zigzag(qint64 value)
+{
+    return ((quint64)value << 1) ^ (quint64)(value >> 63);
+}
+
+}  // namespace
+
+/*!
+  Constructs an encoder that writes to the stream \a ds on destruction.
+*/
+TModelEncoder::TModelEncoder(QDataStream &ds, quint32 schemaVersion) :
+    _ds(ds),
+    _stream(&_data, QIODevice::WriteOnly)
+{
+    _stream.setVersion(ds.version());
+    _stream.setFloatingPointPrecision(ds.floatingPointPrecision());
+    writeVarint(schemaVersion);
+}
+
+/*!
+  Writes the encoded fields to the stream.
+*/
+TModelEncoder::~TModelEncoder()
+{
+    _ds << MAGIC << _data;
+}
+
+
+TModelEncoder &TModelEncoder::operator<<(bool value)
+{
+    _stream << (quint8)value;
+    return *this;
+}
+
+
+TModelEncoder &TModelEncoder::operator<<(int value)
+{
+    writeVarint(zigzag(value));
+    return *this;
+}
+
+
+TModelEncoder &TModelEncoder::operator<<(uint value)
+{
+    writeVarint(value);
+    return *this;
+}
+
+
+TModelEncoder &TModelEncoder::operator<<(qint64 value)
+{
+    writeVarint(zigzag(value));
+    return *this;
+}
+
+
+TModelEncoder &TModelEncoder::operator<<(quint64 value)
+{
+    writeVarint(value);
+    return *this;
+}
+
+
+TModelEncoder &TModelEncoder::operator<<(const QString &value)
+{
+    writeBytes(value.toUtf8());
+    return *this;
+}
+
+
+TModelEncoder &TModelEncoder::operator<<(const QByteArray &value)
+{
+    writeBytes(value);
+    return *this;
+}
+
+
+void TModelEncoder::writeVarint(quint64 value)
+{
+    char buf[10];
+    int len = 0;
+
+    while (value >= 0x80) {
+        buf[len++] = (char)(value | 0x80);
+        value >>= 7;
+    }
+    buf[len++] = (char)value;
+    _stream.writeRawData(buf, len);
+}
+
+
+void TModelEncoder::writeBytes(const QByteArray &bytes)
+{
+    writeVarint(bytes.size());
+    _stream.writeRawData(bytes.constData(), bytes.size());
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TModelEncoder {
+public:
+    TModelEncoder(QDataStream &ds, quint32 schemaVersion);
+    ~TModelEncoder();
+
+    TModelEncoder &operator<<(bool value);
+    TModelEncoder &operator<<(int value);
+    TModelEncoder &operator<<(uint value);
+    TModelEncoder &operator<<(qint64 value);
+    TModelEncoder &operator<<(quint64 value);
+    TModelEncoder &operator<<(const QString &value);
+    TModelEncoder &operator<<(const QByteArray &value);
+    template <typename T>
+    TModelEncoder &operator<<(const T &value);
+
+    static constexpr quint32 MAGIC = 0x7F544D01;  // "\x7fTM\x01"
+
+private:
+    void writeVarint(quint64 value);
+    void writeBytes(const QByteArray &bytes);
+
+    QDataStream &_ds;
+    QByteArray _data;
+    QDataStream _stream;
+
+    T_DISABLE_COPY(TModelEncoder)
+    T_DISABLE_MOVE(TModelEncoder)
+};
+
+// Encodes a value of the other types with QDataStream
+template <typename T>
+inline TModelEncoder &TModelEncoder::operator<<(const T &value)
+{
+    _stream << value;
+    return *this;
+}
+
@@ -75,6 +75,11 @@ bool TMongoDriver::open(const QString &db, const QString &user, const QString &p
 
 void TMongoDriver::close()
 {
+    for (auto *col : (const QHash<QString, void *> &)_collections) {
+        mongoc_collection_destroy((mongoc_collection_t *)col);
+    }
+    _collections.clear();
+
     if (isOpen()) {
         mongoc_client_destroy((mongoc_client_t *)_mongoClient);
         _mongoClient = nullptr;
@@ -89,7 +94,7 @@ bool TMongoDriver::isOpen() const
 
 
 bool TMongoDriver::find(const QString &collection, const QVariantMap &criteria, const QVariantMap &orderBy,
-    const QStringList &fields, int limit, int skip)
+    const QStringList &fields, int limit, int skip, int batchSize)
 {
     if (!isOpen()) {
         return false;
@@ -98,7 +103,7 @@ bool TMongoDriver::find(const QString &collection, const QVariantMap &criteria,
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection((mongoc_client_t *)_mongoClient, qUtf8Printable(_dbName), qUtf8Printable(collection));
+    auto *col = (mongoc_collection_t *)mongoCollection(collection);
     if (!col) {
         tSystemError("MongoDB GetCollection Error");
         return false;
@@ -109,6 +114,10 @@ bool TMongoDriver::find(const QString &collection, const QVariantMap &criteria,
         bson_append_int64(opts, "limit", 5, limit);
     }
 
+    if (batchSize > 0) {
+        bson_append_int32(opts, "batchSize", 9, batchSize);
+    }
+
     if (!fields.isEmpty()) {
         bson_append_document(opts, "projection", 10, (bson_t *)TBson::toBson(fields).data());
     }
@@ -138,7 +147,6 @@ bool TMongoDriver::find(const QString &collection, const QVariantMap &criteria,
         tSystemError("MongoDB Cursor Error");
     }
 
-    mongoc_collection_destroy(col);
     return (bool)cursor;
 }
 
@@ -165,11 +173,10 @@ bool TMongoDriver::insertOne(const QString &collection, const QVariantMap &objec
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection((mongoc_client_t *)_mongoClient, qUtf8Printable(_dbName), qUtf8Printable(collection));
+    auto *col = (mongoc_collection_t *)mongoCollection(collection);
     bson_t rep;
     bool res = mongoc_collection_insert_one(col, (bson_t *)TBson::toBson(object).constData(),
         nullptr, &rep, &error);
-    mongoc_collection_destroy(col);
 
     if (res) {
         if (reply) {
@@ -192,10 +199,9 @@ bool TMongoDriver::removeOne(const QString &collection, const QVariantMap &crite
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection((mongoc_client_t *)_mongoClient, qUtf8Printable(_dbName), qUtf8Printable(collection));
+    auto *col = (mongoc_collection_t *)mongoCollection(collection);
     bson_t rep;
     bool res = mongoc_collection_delete_one(col, (bson_t *)TBson::toBson(criteria).constData(), nullptr, &rep, &error);
-    mongoc_collection_destroy(col);
 
     if (res) {
         if (reply) {
@@ -218,10 +224,9 @@ bool TMongoDriver::removeMany(const QString &collection, const QVariantMap &crit
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection((mongoc_client_t *)_mongoClient, qUtf8Printable(_dbName), qUtf8Printable(collection));
+    auto *col = (mongoc_collection_t *)mongoCollection(collection);
     bson_t rep;
     bool res = mongoc_collection_delete_many(col, (bson_t *)TBson::toBson(criteria).constData(), nullptr, &rep, &error);
-    mongoc_collection_destroy(col);
 
     if (res) {
         if (reply) {
@@ -245,13 +250,12 @@ bool TMongoDriver::updateOne(const QString &collection, const QVariantMap &crite
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection((mongoc_client_t *)_mongoClient, qUtf8Printable(_dbName), qUtf8Printable(collection));
+    auto *col = (mongoc_collection_t *)mongoCollection(collection);
     bson_t rep;
     bson_t *opts = BCON_NEW("upsert", BCON_BOOL(upsert));
     bool res = mongoc_collection_update_one(col, (bson_t *)TBson::toBson(criteria).data(),
         (bson_t *)TBson::toBson(object).data(), opts, &rep, &error);
     bson_free(opts);
-    mongoc_collection_destroy(col);
 
     if (res) {
         if (reply) {
@@ -274,13 +278,12 @@ bool TMongoDriver::updateMany(const QString &collection, const QVariantMap &crit
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection((mongoc_client_t *)_mongoClient, qUtf8Printable(_dbName), qUtf8Printable(collection));
+    auto *col = (mongoc_collection_t *)mongoCollection(collection);
     bson_t rep;
     bson_t *opts = BCON_NEW("upsert", BCON_BOOL(upsert));
     bool res = mongoc_collection_update_many(col, (bson_t *)TBson::toBson(criteria).data(),
         (bson_t *)TBson::toBson(object).data(), opts, &rep, &error);
     bson_free(opts);
-    mongoc_collection_destroy(col);
 
     if (res) {
         if (reply) {
@@ -294,6 +297,85 @@ bool TMongoDriver::updateMany(const QString &collection, const QVariantMap &crit
 }
 
 
+/*!
+  Executes the write \a operations to the \a collection in a batch.
+  Each operation is a map of one entry in the form of the bulkWrite()
+  of MongoDB, e.g. {"insertOne": {"document": {...}}} or
+  {"updateOne": {"filter": {...}, "update": {...}, "upsert": false}}.
+  The supported operations are insertOne, updateOne, updateMany,
+  replaceOne, deleteOne and deleteMany.
+*/
+bool TMongoDriver::bulkWrite(const QString &collection, const QVariantList &operations, bool ordered, QVariantMap *reply)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    bson_error_t error;
+    clearError();
+
+    if (operations.isEmpty()) {
+        return true;
+    }
+
+    auto *col = (mongoc_collection_t *)mongoCollection(collection);
+    bson_t *opts = BCON_NEW("ordered", BCON_BOOL(ordered));
+    mongoc_bulk_operation_t *bulk = mongoc_collection_create_bulk_operation_with_opts(col, opts);
+    bson_destroy(opts);
+
+    bool res = true;
+    for (auto &var : operations) {
+        const QVariantMap operation = var.toMap();
+        const QString name = (operation.count() == 1) ? operation.firstKey() : QString();
+        const QVariantMap args = operation.value(name).toMap();
+        TBson filter = TBson::toBson(args.value(QStringLiteral("filter")).toMap());
+        bson_t *upsertOpts = BCON_NEW("upsert", BCON_BOOL(args.value(QStringLiteral("upsert")).toBool()));
+
+        if (name == QLatin1String("insertOne")) {
+            TBson doc = TBson::toBson(args.value(QStringLiteral("document")).toMap());
+            res = mongoc_bulk_operation_insert_with_opts(bulk, (bson_t *)doc.constData(), nullptr, &error);
+        } else if (name == QLatin1String("updateOne")) {
+            TBson doc = TBson::toBson(args.value(QStringLiteral("update")).toMap());
+            res = mongoc_bulk_operation_update_one_with_opts(bulk, (bson_t *)filter.constData(), (bson_t *)doc.constData(), upsertOpts, &error);
+        } else if (name == QLatin1String("updateMany")) {
+            TBson doc = TBson::toBson(args.value(QStringLiteral("update")).toMap());
+            res = mongoc_bulk_operation_update_many_with_opts(bulk, (bson_t *)filter.constData(), (bson_t *)doc.constData(), upsertOpts, &error);
+        } else if (name == QLatin1String("replaceOne")) {
+            TBson doc = TBson::toBson(args.value(QStringLiteral("replacement")).toMap());
+            res = mongoc_bulk_operation_replace_one_with_opts(bulk, (bson_t *)filter.constData(), (bson_t *)doc.constData(), upsertOpts, &error);
+        } else if (name == QLatin1String("deleteOne")) {
+            res = mongoc_bulk_operation_remove_one_with_opts(bulk, (bson_t *)filter.constData(), nullptr, &error);
+        } else if (name == QLatin1String("deleteMany")) {
+            res = mongoc_bulk_operation_remove_many_with_opts(bulk, (bson_t *)filter.constData(), nullptr, &error);
+        } else {
+            bson_set_error(&error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid bulk operation: %s", qUtf8Printable(name));
+            res = false;
+        }
+        bson_destroy(upsertOpts);
+
+        if (!res) {
+            break;
+        }
+    }
+
+    if (res) {
+        bson_t rep;
+        res = mongoc_bulk_operation_execute(bulk, &rep, &error);
+        if (reply) {
+            *reply = TBson::fromBson((TBsonObject *)&rep);
+        }
+        bson_destroy(&rep);
+    }
+    mongoc_bulk_operation_destroy(bulk);
+
+    if (!res) {
+        tSystemError("MongoDB BulkWrite Error: %s", error.message);
+        setLastError(&error);
+    }
+    return res;
+}
+
+
 int64_t TMongoDriver::count(const QString &collection, const QVariantMap &criteria)
 {
     int64_t count = -1;
@@ -305,13 +387,12 @@ int64_t TMongoDriver::count(const QString &collection, const QVariantMap &criter
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection((mongoc_client_t *)_mongoClient, qUtf8Printable(_dbName), qUtf8Printable(collection));
+    auto *col = (mongoc_collection_t *)mongoCollection(collection);
 #if MONGOC_CHECK_VERSION(1, 11, 0)
     count = mongoc_collection_count_documents(col, (bson_t *)TBson::toBson(criteria).data(), nullptr, nullptr, nullptr, &error);
 #else
     count = mongoc_collection_count(col, MONGOC_QUERY_NONE, (bson_t *)TBson::toBson(criteria).data(), 0, 0, nullptr, &error);
 #endif
-    mongoc_collection_destroy(col);
 
     if (count < 0) {
         tSystemError("MongoDB Count Error: %s", error.message);
@@ -321,6 +402,20 @@ int64_t TMongoDriver::count(const QString &collection, const QVariantMap &criter
 }
 
 
+// Returns the handle of the collection, which is kept while the connection is open
+void *TMongoDriver::mongoCollection(const QString &collection)
+{
+    void *col = _collections.value(collection);
+    if (!col) {
+        col = mongoc_client_get_collection((mongoc_client_t *)_mongoClient, qUtf8Printable(_dbName), qUtf8Printable(collection));
+        if (col) {
+            _collections.insert(collection, col);
+        }
+    }
+    return col;
+}
+
+
 void TMongoDriver::clearError()
 {
     _errorDomain = 0;
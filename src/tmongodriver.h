@@ -1,4 +1,5 @@
 #pragma once
+#include <QHash>
 #include <QStringList>
 #include <QVariant>
 #include <TGlobal>
@@ -18,7 +19,7 @@ public:
     bool isOpen() const;
 
     bool find(const QString &collection, const QVariantMap &criteria, const QVariantMap &orderBy,
-        const QStringList &fields, int limit, int skip);
+        const QStringList &fields, int limit, int skip, int batchSize = 0);
     QVariantMap findOne(const QString &collection, const QVariantMap &criteria,
         const QStringList &projectFields = QStringList());
     bool insertOne(const QString &collection, const QVariantMap &object, QVariantMap *reply = nullptr);
@@ -28,6 +29,7 @@ public:
         bool upsert = false, QVariantMap *reply = nullptr);
     bool removeOne(const QString &collection, const QVariantMap &criteria, QVariantMap *reply = nullptr);
     bool removeMany(const QString &collection, const QVariantMap &criteria, QVariantMap *reply = nullptr);
+    bool bulkWrite(const QString &collection, const QVariantList &operations, bool ordered = true, QVariantMap *reply = nullptr);
     int64_t count(const QString &collection, const QVariantMap &criteria);
     int lastErrorDomain() const { return _errorDomain; }
     int lastErrorCode() const { return _errorCode; }
@@ -40,10 +42,12 @@ public:
     const TMongoCursor &cursor() const { return *_mongoCursor; }
 
 private:
+    void *mongoCollection(const QString &collection);
     void clearError();
     void setLastError(const void *error);
 
     void *_mongoClient {nullptr};
+    QHash<QString, void *> _collections;  // mongoc_collection_t
     TMongoCursor *_mongoCursor {nullptr};
     QString _dbName;
     int _serverVerionNumber {-1};
@@ -31,7 +31,8 @@ TMongoObject::TMongoObject() :
 */
 TMongoObject::TMongoObject(const TMongoObject &other) :
     TModelObject(),
-    QVariantMap(other)
+    QVariantMap(other),
+    _loadedFields(other._loadedFields)
 {
 }
 
@@ -41,6 +42,7 @@ TMongoObject::TMongoObject(const TMongoObject &other) :
 TMongoObject &TMongoObject::operator=(const TMongoObject &other)
 {
     QVariantMap::operator=(*static_cast<const QVariantMap *>(&other));
+    _loadedFields = other._loadedFields;
     return *this;
 }
 
@@ -70,11 +72,24 @@ QString TMongoObject::collectionName() const
 void TMongoObject::setBsonData(const QVariantMap &bson)
 {
     QVariantMap::operator=(bson);
+    _loadedFields.clear();
     syncToObject();
 }
 
 
 bool TMongoObject::create()
+{
+    prepareToCreate();
+    TMongoQuery mongo(collectionName());
+    bool ret = mongo.insert(*this);
+    if (ret) {
+        syncToObject();  // '_id' reflected
+    }
+    return ret;
+}
+
+// Sets the properties for a new document and returns the document
+QVariantMap TMongoObject::prepareToCreate()
 {
     // Sets the values of 'created_at', 'updated_at' or 'modified_at' properties
     for (int i = metaObject()->propertyOffset(); i < metaObject()->propertyCount(); ++i) {
@@ -93,13 +108,7 @@ bool TMongoObject::create()
 
     syncToVariantMap();
     QVariantMap::remove("_id");  // remove _id to generate internally
-
-    TMongoQuery mongo(collectionName());
-    bool ret = mongo.insert(*this);
-    if (ret) {
-        syncToObject();  // '_id' reflected
-    }
-    return ret;
+    return *this;
 }
 
 
@@ -114,6 +123,7 @@ bool TMongoObject::update()
     // Updates the value of 'updated_at' or 'modified_at' property
     bool updflag = false;
     int revIndex = -1;
+    QString updatedProp;
 
     for (int i = metaObject()->propertyOffset(); i < metaObject()->propertyCount(); ++i) {
         const char *propName = metaObject()->property(i).name();
@@ -121,6 +131,7 @@ bool TMongoObject::update()
 
         if (!updflag && (prop == UpdatedAt || prop == ModifiedAt)) {
             setProperty(propName, QDateTime::currentDateTime());
+            updatedProp = QLatin1String(propName);
             updflag = true;
 
         } else if (revIndex < 0 && prop == LockRevision) {
@@ -145,6 +156,18 @@ bool TMongoObject::update()
     cri["_id"] = objectId();
 
     syncToVariantMap();
+    if (!_loadedFields.isEmpty()) {
+        // Writes back only the fields loaded by the projection, not to
+        // clear the others in the document
+        for (auto it = QVariantMap::begin(); it != QVariantMap::end();) {
+            if (_loadedFields.contains(it.key()) || it.key() == updatedProp) {
+                ++it;
+            } else {
+                it = QVariantMap::erase(it);
+            }
+        }
+    }
+
     TMongoQuery mongo(collectionName());
     int cnt = mongo.update(cri, *this);
 
@@ -298,5 +321,6 @@ void TMongoObject::syncToVariantMap()
 void TMongoObject::clear()
 {
     QVariantMap::clear();
+    _loadedFields.clear();
     objectId().resize(0);
 }
@@ -33,5 +33,13 @@ protected:
     void syncToVariantMap();
     void syncToObject();
     virtual QString &objectId() = 0;
+
+private:
+    QVariantMap prepareToCreate();
+
+    QStringList _loadedFields;  // fields loaded by a projection, or empty if all
+
+    template <class T>
+    friend class TMongoODMapper;
 };
 
@@ -24,9 +24,13 @@ public:
     TMongoODMapper<T> &offset(int offset);
     TMongoODMapper<T> &orderBy(int column, Tf::SortOrder order = Tf::AscendingOrder);
     TMongoODMapper<T> &orderBy(const QString &column, Tf::SortOrder order = Tf::AscendingOrder);
+    TMongoODMapper<T> &projection(const QList<int> &columns);
+    TMongoODMapper<T> &batchSize(int batchSize);
 
     void setLimit(int limit);
     void setOffset(int offset);
+    void setProjection(const QList<int> &columns);
+    void setBatchSize(int batchSize);
     void setSortOrder(int column, Tf::SortOrder order = Tf::AscendingOrder);
     void setSortOrder(const QString &column, Tf::SortOrder order = Tf::AscendingOrder);
 
@@ -45,10 +49,13 @@ public:
     int updateAll(const TCriteria &cri, int column, const QVariant &value);
     int updateAll(const TCriteria &cri, const QMap<int, QVariant> &values);
     int removeAll(const TCriteria &cri = TCriteria());
+    int insertAll(QList<T> &objects);
+    using TMongoQuery::bulkWrite;
 
 private:
     QString sortColumn;
     Tf::SortOrder sortOrder;
+    QStringList fields;
 
     T_DISABLE_COPY(TMongoODMapper)
     T_DISABLE_MOVE(TMongoODMapper)
@@ -86,6 +93,37 @@ inline void TMongoODMapper<T>::setOffset(int offset)
 }
 
 
+/*!
+  Sets the \a columns to return from the documents found; the other
+  properties of the objects are left empty. An empty list returns all.
+  TMongoObject::update() of such an object writes back only the columns
+  returned and the update timestamp, so the other fields of the document
+  are kept. Include the lock revision column in the \a columns to update
+  the objects with the optimistic lock.
+*/
+template <class T>
+inline void TMongoODMapper<T>::setProjection(const QList<int> &columns)
+{
+    fields.clear();
+    for (int column : columns) {
+        QString name = TCriteriaMongoConverter<T>::propertyName(column);
+        if (!name.isEmpty()) {
+            fields << name;
+        }
+    }
+}
+
+/*!
+  Sets the number of documents to return in each batch of the response
+  from the server.
+*/
+template <class T>
+inline void TMongoODMapper<T>::setBatchSize(int batchSize)
+{
+    TMongoQuery::setBatchSize(batchSize);
+}
+
+
 template <class T>
 inline void TMongoODMapper<T>::setSortOrder(int column, Tf::SortOrder order)
 {
@@ -144,13 +182,30 @@ inline TMongoODMapper<T> &TMongoODMapper<T>::orderBy(const QString &column, Tf::
 }
 
 
+template <class T>
+inline TMongoODMapper<T> &TMongoODMapper<T>::projection(const QList<int> &columns)
+{
+    setProjection(columns);
+    return *this;
+}
+
+
+template <class T>
+inline TMongoODMapper<T> &TMongoODMapper<T>::batchSize(int size)
+{
+    setBatchSize(size);
+    return *this;
+}
+
+
 template <class T>
 inline T TMongoODMapper<T>::findOne(const TCriteria &criteria)
 {
     T t;
-    QVariantMap doc = TMongoQuery::findOne(TCriteriaMongoConverter<T>(criteria).toVariantMap());
+    QVariantMap doc = TMongoQuery::findOne(TCriteriaMongoConverter<T>(criteria).toVariantMap(), fields);
     if (!doc.isEmpty()) {
         t.setBsonData(doc);
+        t._loadedFields = fields;
     }
     return t;
 }
@@ -161,9 +216,10 @@ inline T TMongoODMapper<T>::findFirstBy(int column, const QVariant &value)
 {
     T t;
     TCriteria cri(column, value);
-    QVariantMap doc = TMongoQuery::findOne(TCriteriaMongoConverter<T>(cri).toVariantMap());
+    QVariantMap doc = TMongoQuery::findOne(TCriteriaMongoConverter<T>(cri).toVariantMap(), fields);
     if (!doc.isEmpty()) {
         t.setBsonData(doc);
+        t._loadedFields = fields;
     }
     return t;
 }
@@ -173,9 +229,10 @@ template <class T>
 inline T TMongoODMapper<T>::findByObjectId(const QString &id)
 {
     T t;
-    QVariantMap doc = TMongoQuery::findById(id);
+    QVariantMap doc = TMongoQuery::findById(id, fields);
     if (!doc.isEmpty()) {
         t.setBsonData(doc);
+        t._loadedFields = fields;
     }
     return t;
 }
@@ -189,7 +246,7 @@ inline bool TMongoODMapper<T>::find(const TCriteria &criteria)
         order.insert(sortColumn, ((sortOrder == Tf::AscendingOrder) ? 1 : -1));
     }
 
-    return TMongoQuery::find(TCriteriaMongoConverter<T>(criteria).toVariantMap(), order);
+    return TMongoQuery::find(TCriteriaMongoConverter<T>(criteria).toVariantMap(), order, fields);
 }
 
 
@@ -221,6 +278,7 @@ inline T TMongoODMapper<T>::value() const
     QVariantMap doc = TMongoQuery::value();
     if (!doc.isEmpty()) {
         t.setBsonData(doc);
+        t._loadedFields = fields;
     }
     return t;
 }
@@ -305,3 +363,23 @@ inline int TMongoODMapper<T>::removeAll(const TCriteria &criteria)
     return TMongoQuery::remove(TCriteriaMongoConverter<T>(criteria).toVariantMap());
 }
 
+/*!
+  Creates the new \a objects in a batch and returns the number of the
+  objects created. The object IDs are set to the objects created.
+*/
+template <class T>
+inline int TMongoODMapper<T>::insertAll(QList<T> &objects)
+{
+    QList<QVariantMap> docs;
+    docs.reserve(objects.count());
+    for (auto &obj : objects) {
+        docs << obj.prepareToCreate();
+    }
+
+    int cnt = TMongoQuery::insertMany(docs);
+    for (int i = 0; i < cnt; ++i) {
+        objects[i].setBsonData(docs[i]);  // '_id' reflected
+    }
+    return cnt;
+}
+
@@ -43,7 +43,8 @@ TMongoQuery::TMongoQuery(const TMongoQuery &other) :
     _database(other._database),
     _collection(other._collection),
     _queryLimit(other._queryLimit),
-    _queryOffset(other._queryOffset)
+    _queryOffset(other._queryOffset),
+    _queryBatchSize(other._queryBatchSize)
 {
 }
 
@@ -56,6 +57,7 @@ TMongoQuery &TMongoQuery::operator=(const TMongoQuery &other)
     _collection = other._collection;
     _queryLimit = other._queryLimit;
     _queryOffset = other._queryOffset;
+    _queryBatchSize = other._queryBatchSize;
     return *this;
 }
 
@@ -71,7 +73,7 @@ bool TMongoQuery::find(const QVariantMap &criteria, const QVariantMap &orderBy,
         tSystemError("TMongoQuery::find : driver not loaded");
         return false;
     }
-    return driver()->find(_collection, criteria, orderBy, fields, _queryLimit, _queryOffset);
+    return driver()->find(_collection, criteria, orderBy, fields, _queryLimit, _queryOffset, _queryBatchSize);
 }
 
 /*!
@@ -151,6 +153,45 @@ bool TMongoQuery::insert(QVariantMap &document)
     return (insertedCount == 1);
 }
 
+/*!
+  Inserts the \a documents into the collection in a batch, and returns
+  the number of the documents inserted. The insertion stops at the first
+  error.
+*/
+int TMongoQuery::insertMany(QList<QVariantMap> &documents)
+{
+    QVariantList operations;
+    operations.reserve(documents.count());
+
+    for (auto &doc : documents) {
+        if (!doc.contains(ObjectIdKey)) {
+            // Sets Object ID
+            doc.insert(ObjectIdKey, TBson::generateObjectId());
+        }
+        operations << QVariantMap {{QStringLiteral("insertOne"), QVariantMap {{QStringLiteral("document"), doc}}}};
+    }
+
+    QVariantMap reply;
+    bulkWrite(operations, true, &reply);
+    int insertedCount = reply.value(QStringLiteral("nInserted")).toInt();
+    tSystemDebug("TMongoQuery::insertMany insertedCount:%d", insertedCount);
+    return insertedCount;
+}
+
+/*!
+  Executes the write \a operations in a batch, in order if \a ordered
+  is true. The result counts are set to the \a reply.
+  \sa TMongoDriver::bulkWrite()
+*/
+bool TMongoQuery::bulkWrite(const QVariantList &operations, bool ordered, QVariantMap *reply)
+{
+    if (!_database.isValid()) {
+        tSystemError("TMongoQuery::bulkWrite : driver not loaded");
+        return false;
+    }
+    return driver()->bulkWrite(_collection, operations, ordered, reply);
+}
+
 /*!
   Removes documents that matches the \a criteria from the collection.
 */
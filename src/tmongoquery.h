@@ -17,6 +17,8 @@ public:
     void setLimit(int limit);
     int offset() const;
     void setOffset(int offset);
+    int batchSize() const;
+    void setBatchSize(int batchSize);
     bool find(const QVariantMap &criteria = QVariantMap(), const QVariantMap &orderBy = QVariantMap(), const QStringList &fields = QStringList());
     bool next();
     QVariantMap value() const;
@@ -24,6 +26,7 @@ public:
     QVariantMap findOne(const QVariantMap &criteria = QVariantMap(), const QStringList &fields = QStringList());
     QVariantMap findById(const QString &id, const QStringList &fields = QStringList());
     bool insert(QVariantMap &document);
+    int insertMany(QList<QVariantMap> &documents);
     int update(const QVariantMap &criteria, const QVariantMap &document, bool upsert = false);
     bool updateById(const QVariantMap &document);
     int updateMany(const QVariantMap &criteria, const QVariantMap &document);
@@ -31,6 +34,7 @@ public:
     int remove(const QVariantMap &criteria);
     bool removeById(const QVariantMap &document);
     int count(const QVariantMap &criteria = QVariantMap());
+    bool bulkWrite(const QVariantList &operations, bool ordered = true, QVariantMap *reply = nullptr);
     QString lastErrorString() const;
 
     TMongoQuery &operator=(const TMongoQuery &other);
@@ -46,6 +50,7 @@ private:
     QString _collection;
     int _queryLimit {0};
     int _queryOffset {0};
+    int _queryBatchSize {0};
 
     friend class TCacheMongoStore;
 };
@@ -74,3 +79,15 @@ inline void TMongoQuery::setOffset(int offset)
     _queryOffset = offset;
 }
 
+
+inline int TMongoQuery::batchSize() const
+{
+    return _queryBatchSize;
+}
+
+
+inline void TMongoQuery::setBatchSize(int batchSize)
+{
+    _queryBatchSize = batchSize;
+}
+
@@ -10,11 +10,11 @@
 #include "tepollsocket.h"
 #include "tkvsdatabasepool.h"
 #include "tpublisher.h"
+#include "tsessionmanager.h"
 #include "tsqldatabasepool.h"
 #include "tsystembus.h"
 #include "tsystemglobal.h"
 #include "turlroute.h"
-#include <QElapsedTimer>
 #include <TActionWorker>
 #include <TAppSettings>
 #include <TApplicationServerBase>
@@ -111,11 +111,16 @@ bool TMultiplexingServer::start(bool debugMode)
         }
     }
 
+    if (!setupTls()) {
+        return false;
+    }
+
     // To work a timer in main thread
     TSqlDatabasePool::instance();
     TKvsDatabasePool::instance();
 
     TStaticInitializeThread::exec();
+    TSessionManager::instance().startGarbageCollector();
     QThread::start();
     return true;
 }
@@ -212,15 +217,6 @@ void TMultiplexingServer::run()
     TEpollSocket *epollListen = TEpollHttpSocket::create(listenSocket, QHostAddress(), false);
     TEpoll::instance()->addPoll(epollListen, EPOLLIN);
 
-    int keepAlivetimeout = Tf::appSettings()->value(Tf::HttpKeepAliveTimeout).toInt();
-    QElapsedTimer idleTimer;
-    if (keepAlivetimeout > 0) {
-        idleTimer.start();
-    }
-
-    QElapsedTimer elapsed;
-    elapsed.start();
-
     for (;;) {
         int res = processEvents(100);
         if (res < 0) {
@@ -228,15 +224,10 @@ void TMultiplexingServer::run()
         }
 
         // Check keep-alive timeout for HTTP sockets
-        if (keepAlivetimeout > 0 && idleTimer.elapsed() >= 1000) {
-            for (auto *http : (const QList<TEpollHttpSocket *> &)TEpollHttpSocket::allSockets()) {
-                if (Q_UNLIKELY(http->socketDescriptor() != listenSocket && http->idleTime() >= keepAlivetimeout)) {
-                    tSystemDebug("KeepAlive timeout: socket:%d", http->socketDescriptor());
-                    TEpoll::instance()->deletePoll(http);
-                    http->dispose();
-                }
-            }
-            idleTimer.start();
+        for (auto *http : (const QList<TEpollHttpSocket *> &)TEpollHttpSocket::timedOutSockets()) {
+            tSystemDebug("KeepAlive timeout: socket:%d", http->socketDescriptor());
+            TEpoll::instance()->deletePoll(http);
+            http->dispose();
         }
 
         // Check stop flag
@@ -10,14 +10,34 @@
  * Modified by AOYAMA Kazuharu
  */
 
+#include "tsystemglobal.h"
+#include <QMessageAuthenticationCode>
 #include <QtCore>
+#include <TAppSettings>
 #include <TPaginator>
 #include <cmath>
 
+namespace {
+
+constexpr int CURSOR_DIGEST_LENGTH = 16;
+constexpr auto CURSOR_ENCODING = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+
+QByteArray cursorDigest(const QByteArray &data)
+{
+    static const QByteArray secret = Tf::appSettings()->value(Tf::SessionSecret).toByteArray();
+    return QMessageAuthenticationCode::hash(data, secret, QCryptographicHash::Sha3_256).left(CURSOR_DIGEST_LENGTH);
+}
+
+}  // namespace
+
 /*!
   \class TPaginator
   \brief The TPaginator class provides simple functionality for a pagination
   bar.
+
+  For the keyset pagination of TSqlORMapper, encodeCursor() and
+  decodeCursor() convert the keys of the last row on a page to an opaque
+  token to be passed to the client, and back.
 */
 
 /*!
@@ -222,3 +242,52 @@ int TPaginator::currentPage() const
   \fn bool TPaginator::hasPage(int page) const
   Returns true if \a page is a valid page; otherwise returns false.
 */
+
+/*!
+  Returns an opaque token of the cursor of the keyset pagination for the
+  \a keys, the values returned by TSqlORMapper::keysetValues(). The token
+  is URL-safe and signed with the Session.Secret, not to be tampered with.
+  \sa decodeCursor(), TSqlORMapper::setKeyset()
+*/
+QByteArray TPaginator::encodeCursor(const QVariantList &keys)
+{
+    QByteArray data;
+    QDataStream ds(&data, QIODevice::WriteOnly);
+    ds << keys;
+    return data.toBase64(CURSOR_ENCODING) + '.' + cursorDigest(data).toBase64(CURSOR_ENCODING);
+}
+
+/*!
+  Returns the keys of the keyset pagination decoded from the \a cursor
+  token returned by encodeCursor(). If \a ok is not nullptr, *\a ok is set
+  to false for an invalid or tampered token, and an empty list is
+  returned.
+  \sa encodeCursor()
+*/
+QVariantList TPaginator::decodeCursor(const QByteArray &cursor, bool *ok)
+{
+    QVariantList keys;
+    bool valid = false;
+    int idx = cursor.indexOf('.');
+
+    if (idx > 0) {
+        QByteArray data = QByteArray::fromBase64(cursor.left(idx), CURSOR_ENCODING);
+        QByteArray digest = QByteArray::fromBase64(cursor.mid(idx + 1), CURSOR_ENCODING);
+
+        if (Tf::strcmp(digest, cursorDigest(data))) {
+            QDataStream ds(data);
+            ds >> keys;
+            valid = (ds.status() == QDataStream::Ok);
+        } else {
+            tSystemWarn("Received a tampered cursor or that of other web application.");
+        }
+    }
+
+    if (!valid) {
+        keys.clear();
+    }
+    if (ok) {
+        *ok = valid;
+    }
+    return keys;
+}
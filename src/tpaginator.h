@@ -1,5 +1,6 @@
 #pragma once
 #include <QList>
+#include <QVariant>
 #include <TGlobal>
 
 
@@ -34,6 +35,10 @@ public:
     bool hasNext() const { return (currentPage() < _numPages); }
     bool hasPage(int page) const { return (page > 0 && page <= _numPages); }
 
+    // Cursor of the keyset pagination
+    static QByteArray encodeCursor(const QVariantList &keys);
+    static QVariantList decodeCursor(const QByteArray &cursor, bool *ok = nullptr);
+
 protected:
     void calculateNumPages();  // Internal use
 
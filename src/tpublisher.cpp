@@ -6,6 +6,8 @@
  */
 
 #include "tpublisher.h"
+#include "tlocalcache.h"
+#include "tmetrics.h"
 #include "tsystembus.h"
 #include "tsystemglobal.h"
 #include "twebsocket.h"
@@ -110,6 +112,8 @@ TPublisher *TPublisher::instance()
 {
     static TPublisher *globalInstance = []() {
         auto *pub = new TPublisher();
+        // Receives in the main thread, not in the worker thread calling first
+        pub->moveToThread(Tf::app()->thread());
         connect(TSystemBus::instance(), SIGNAL(readyReceive()), pub, SLOT(receiveSystemBus()));
         return pub;
     }();
@@ -253,6 +257,16 @@ void TPublisher::receiveSystemBus()
             break;
         }
 
+        case Tf::CacheInvalidate:
+            if (TLocalCache::instance()) {
+                TLocalCache::instance()->invalidate(msg.data());
+            }
+            break;
+
+        case Tf::MetricsSnapshot:
+            TMetrics::receive(msg.target(), msg.data());
+            break;
+
         default:
             tSystemError("Internal Error  [%s:%d]", __FILE__, __LINE__);
             break;
@@ -214,6 +214,22 @@ int TRedis::del(const QByteArrayList &keys)
     return (res) ? resp.value(0).toInt() : 0;
 }
 
+/*!
+  Sets a timeout of \a seconds on the \a key. Returns false if the key
+  does not exist.
+ */
+bool TRedis::expire(const QByteArray &key, int seconds)
+{
+    if (!driver()) {
+        return false;
+    }
+
+    QVariantList resp;
+    QByteArrayList command = {"EXPIRE", key, QByteArray::number(seconds)};
+    bool res = driver()->request(command, resp);
+    return (res && resp.value(0).toInt() == 1);
+}
+
 /*!
   Inserts all the \a values at the tail of the list stored at the \a key.
   Returns the length of the list after the push operation.
@@ -33,6 +33,7 @@ public:
 
     bool del(const QByteArray &key);
     int del(const QByteArrayList &keys);
+    bool expire(const QByteArray &key, int seconds);
 
     // binary list
     int rpush(const QByteArray &key, const QByteArrayList &values);
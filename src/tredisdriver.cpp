@@ -6,7 +6,9 @@
  */
 
 #include "tredisdriver.h"
+#include "tmetrics.h"
 #include "tsystemglobal.h"
+#include "ttrace.h"
 
 
 TRedisDriver::TRedisDriver() :
@@ -27,6 +29,9 @@ bool TRedisDriver::command(const QByteArray &cmd)
 
 bool TRedisDriver::request(const QByteArrayList &command, QVariantList &response)
 {
+    TMetrics::Timer metricsTimer(TMetrics::KvsQuery);
+    TTrace::Span span(TTrace::KvsQuery);
+
     if (Q_UNLIKELY(!isOpen())) {
         tSystemError("Not open Redis session  [%s:%d]", __FILE__, __LINE__);
         return false;
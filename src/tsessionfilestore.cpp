@@ -6,83 +6,169 @@
  */
 
 #include "tsessionfilestore.h"
-#include "tfcore.h"
 #include "tsystemglobal.h"
 #include <QDataStream>
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
-#include <QReadWriteLock>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
 #include <TWebApplication>
+#include <atomic>
 
 constexpr auto SESSION_DIR_NAME = "session";
+constexpr auto EXPIRY_DIR_NAME = ".expiry";
+constexpr int EXPIRY_BUCKET_SECS = 60;
 
-static QReadWriteLock rwLock(QReadWriteLock::Recursive);  // Global read-write lock
+namespace {
+
+QMutex gcMutex;
+bool fullScanned = false;  // guarded by gcMutex
+std::atomic<bool> legacyFilesExist {true};
+
+// IDs written to the current bucket of the expiry index by this process
+QMutex indexMutex;
+QSet<QByteArray> indexedIds;
+int64_t indexedBucket = 0;
+
+
+bool isValidId(const QByteArray &id)
+{
+    if (id.length() < 4) {
+        return false;
+    }
+
+    for (char c : id) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Path of the file in two levels of directories, e.g. "session/3f/a2/3fa2..."
+QString sessionFilePath(const QByteArray &id)
+{
+    QString path = TSessionFileStore::sessionDirPath();
+    path += QLatin1String(id.left(2));
+    path += QLatin1Char('/');
+    path += QLatin1String(id.mid(2, 2));
+    path += QLatin1Char('/');
+    path += QLatin1String(id);
+    return path;
+}
+
+// Path in the flat directory used by the former versions
+QString legacyFilePath(const QByteArray &id)
+{
+    return TSessionFileStore::sessionDirPath() + QLatin1String(id);
+}
+
+
+QString expiryDirPath()
+{
+    return TSessionFileStore::sessionDirPath() + QLatin1String(EXPIRY_DIR_NAME) + QLatin1Char('/');
+}
+
+// Appends the ID to the bucket of the expiry index for the current
+// minute, once per bucket in this process
+void addToExpiryIndex(const QByteArray &id)
+{
+    const int64_t bucket = QDateTime::currentSecsSinceEpoch() / EXPIRY_BUCKET_SECS * EXPIRY_BUCKET_SECS;
+
+    QMutexLocker locker(&indexMutex);
+    if (bucket != indexedBucket) {
+        indexedIds.clear();
+        indexedBucket = bucket;
+    }
+
+    if (indexedIds.contains(id)) {
+        return;
+    }
+
+    QFile file(expiryDirPath() + QString::number(bucket));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        QDir().mkpath(expiryDirPath());
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            tSystemError("Failed to open the session expiry index: %s", qUtf8Printable(file.fileName()));
+            return;
+        }
+    }
+    QByteArray line = id;
+    line += '\n';
+    file.write(line);  // one write per line
+    indexedIds.insert(id);
+}
+
+}
 
 /*!
   \class TSessionFileStore
   \brief The TSessionFileStore class stores HTTP sessions to files.
+
+  The files are distributed in two levels of directories by the first
+  four characters of the session ID, and are replaced by atomic renames
+  so that readers never see partial files.
 */
 
 bool TSessionFileStore::store(TSession &session)
 {
-    QDir dir(sessionDirPath());
-    if (!dir.exists()) {
-        dir.mkpath(".");
+    if (!isValidId(session.id())) {
+        tSystemError("Invalid session ID: %s", session.id().data());
+        return false;
     }
 
-    bool res = false;
-    QWriteLocker locker(&rwLock);  // lock for threads
-    QFile file(sessionDirPath() + session.id());
-
-    if (file.open(QIODevice::ReadWrite)) {
-        auto reslock = tf_lockfile(file.handle(), true, true);  // blocking flock for processes
-        int err = errno;
-        if (reslock < 0) {
-            tSystemWarn("flock error  errno:%d", err);
+    QSaveFile file(sessionFilePath(session.id()));
+    if (!file.open(QIODevice::WriteOnly)) {
+        QDir().mkpath(QFileInfo(file.fileName()).path());
+        if (!file.open(QIODevice::WriteOnly)) {
+            tSystemError("Failed to open a session file: %s", qUtf8Printable(file.fileName()));
+            return false;
         }
+    }
 
-        QByteArray buffer;
-        QDataStream dsbuf(&buffer, QIODevice::WriteOnly);
-        dsbuf << *static_cast<const QVariantMap *>(&session);
-        buffer = Tf::lz4Compress(buffer);  // compress
-
-        file.resize(0);  // truncate
-        QDataStream ds(&file);
-        ds << buffer;
-        file.close();
+    QByteArray buffer;
+    QDataStream dsbuf(&buffer, QIODevice::WriteOnly);
+    dsbuf << *static_cast<const QVariantMap *>(&session);
+    buffer = Tf::lz4Compress(buffer);  // compress
 
-        res = (ds.status() == QDataStream::Ok);
-        if (!res) {
-            tSystemError("Failed to store session. Must set objects that can be serialized.");
-        }
+    QDataStream ds(&file);
+    ds << buffer;
+    if (ds.status() != QDataStream::Ok || dsbuf.status() != QDataStream::Ok) {
+        tSystemError("Failed to store session. Must set objects that can be serialized.");
+        file.cancelWriting();
     }
-    return res;
+    if (!file.commit()) {  // renames to the session file
+        return false;
+    }
+    addToExpiryIndex(session.id());
+    return true;
 }
 
 
 TSession TSessionFileStore::find(const QByteArray &id)
 {
-    QFileInfo fi(sessionDirPath() + id);
-    QDateTime modified = QDateTime::currentDateTime().addSecs(-lifeTimeSecs());
+    if (!isValidId(id)) {
+        return TSession();
+    }
+
+    QFileInfo fi(sessionFilePath(id));
+    if (!fi.exists()) {
+        fi.setFile(legacyFilePath(id));
+    }
 
+    QDateTime modified = QDateTime::currentDateTime().addSecs(-lifeTimeSecs());
     if (fi.exists() && fi.lastModified() >= modified) {
-        QReadLocker locker(&rwLock);  // lock for threads
         QFile file(fi.filePath());
-
         if (file.open(QIODevice::ReadOnly)) {
-            auto reslock = tf_lockfile(file.handle(), false, true);  // blocking flock for processes
-            int err = errno;
-            if (reslock < 0) {
-                tSystemWarn("flock error  errno:%d", err);
-            }
-
             QDataStream ds(&file);
             QByteArray buffer;
             ds >> buffer;
             file.close();
+
             buffer = Tf::lz4Uncompress(buffer);
             TSession result(id);
-
             if (buffer.isEmpty()) {
                 tSystemError("Failed to load a session from the file store.");
                 return result;
@@ -90,8 +176,7 @@ TSession TSessionFileStore::find(const QByteArray &id)
 
             QDataStream dsbuf(&buffer, QIODevice::ReadOnly);
             dsbuf >> *static_cast<QVariantMap *>(&result);
-
-            if (ds.status() == QDataStream::Ok) {
+            if (dsbuf.status() == QDataStream::Ok) {
                 return result;
             } else {
                 tSystemError("Failed to load a session from the file store.");
@@ -104,23 +189,126 @@ TSession TSessionFileStore::find(const QByteArray &id)
 
 bool TSessionFileStore::remove(const QByteArray &id)
 {
-    return QFile::remove(sessionDirPath() + id);
+    if (!isValidId(id)) {
+        return false;
+    }
+
+    bool res = QFile::remove(sessionFilePath(id));
+    if (legacyFilesExist) {
+        res |= QFile::remove(legacyFilePath(id));
+    }
+    return res;
+}
+
+
+bool TSessionFileStore::touch(const QByteArray &id)
+{
+    if (!isValidId(id)) {
+        return false;
+    }
+
+    QFile file(sessionFilePath(id));
+    if (!file.exists() || !file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+    if (!file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime)) {
+        return false;
+    }
+    addToExpiryIndex(id);
+    return true;
 }
 
+/*!
+  Removes the session files older than \a expire.
 
+  Each store or touch of a session appends its ID to the bucket file of
+  the current minute in the expiry index, so a collection reads only the
+  buckets older than \a expire and checks the files listed in them; a
+  file modified since is listed in a newer bucket too, and is kept. The
+  bucket files read are removed. The files not indexed, stored by the
+  former versions, are removed by a full scan of the directories at the
+  first collection of the process.
+*/
 int TSessionFileStore::gc(const QDateTime &expire)
+{
+    QMutexLocker locker(&gcMutex);
+    const int64_t expireSecs = expire.toSecsSinceEpoch();
+    int res = 0;
+
+    QDir dir(sessionDirPath());
+    if (!dir.exists()) {
+        return res;
+    }
+
+    if (!fullScanned) {
+        res += removeAllExpired(expireSecs);
+        fullScanned = true;
+    }
+
+    QDir expiryDir(expiryDirPath());
+    const QStringList buckets = expiryDir.entryList(QDir::Files, QDir::Name);
+    for (auto &bucket : buckets) {
+        bool ok;
+        int64_t bucketSecs = bucket.toLongLong(&ok);
+        if (!ok) {
+            expiryDir.remove(bucket);
+            continue;
+        }
+        if (bucketSecs + EXPIRY_BUCKET_SECS > expireSecs) {
+            continue;  // may list unexpired sessions
+        }
+
+        QFile file(expiryDir.filePath(bucket));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QSet<QByteArray> ids;
+        for (auto &id : file.readAll().split('\n')) {
+            ids.insert(id);
+        }
+        file.close();
+
+        for (auto &id : ids) {
+            if (!isValidId(id)) {
+                continue;
+            }
+            QFileInfo fi(sessionFilePath(id));
+            if (fi.exists() && fi.lastModified().toSecsSinceEpoch() < expireSecs && QFile::remove(fi.filePath())) {
+                res++;
+            }
+        }
+        file.remove();
+    }
+    tSystemDebug("TSessionFileStore::gc  removed:%d", res);
+    return res;
+}
+
+// Removes the expired files scanning all the directories
+int TSessionFileStore::removeAllExpired(int64_t expireSecs)
 {
     int res = 0;
     QDir dir(sessionDirPath());
-    if (dir.exists()) {
-        const QList<QFileInfo> lst = dir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+
+    if (legacyFilesExist) {
+        // Files in the flat directory
+        const QList<QFileInfo> lst = dir.entryInfoList(QDir::Files, QDir::NoSort);
+        int remaining = lst.count();
         for (auto &fi : lst) {
-            if (fi.lastModified() < expire) {
-                if (dir.remove(fi.fileName())) {
-                    res++;
-                }
-            } else {
-                break;
+            if (fi.lastModified().toSecsSinceEpoch() < expireSecs && dir.remove(fi.fileName())) {
+                res++;
+                remaining--;
+            }
+        }
+        legacyFilesExist = (remaining > 0);
+    }
+
+    const QStringList shards = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::NoSort);
+    for (auto &shard : shards) {
+        QDirIterator iter(dir.filePath(shard), QDir::Files, QDirIterator::Subdirectories);
+        while (iter.hasNext()) {
+            iter.next();
+            if (iter.fileInfo().lastModified().toSecsSinceEpoch() < expireSecs && QFile::remove(iter.filePath())) {
+                res++;
             }
         }
     }
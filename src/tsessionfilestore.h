@@ -8,8 +8,12 @@ public:
     TSession find(const QByteArray &id) override;
     bool store(TSession &session) override;
     bool remove(const QByteArray &id) override;
+    bool touch(const QByteArray &id) override;
     int gc(const QDateTime &expire) override;
 
     static QString sessionDirPath();
+
+private:
+    int removeAllExpired(int64_t expireSecs);
 };
 
@@ -10,11 +10,108 @@
 #include "tsystemglobal.h"
 #include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
 #include <QHostInfo>
+#include <QRandomGenerator>
 #include <QThread>
 #include <TAppSettings>
 #include <TAtomic>
+#include <TJobScheduler>
 #include <TSessionStore>
+#include <TWebApplication>
+#include <cstring>
+
+namespace {
+
+constexpr int SESSION_ID_BYTES = 20;  // 160 bits
+
+
+// Returns bytes from the CSPRNG of the system, buffered per thread
+QByteArray secureRandomBytes(int length)
+{
+    constexpr int BUFFER_SIZE = 1024;
+    thread_local quint32 buffer[BUFFER_SIZE / sizeof(quint32)];
+    thread_local int pos = BUFFER_SIZE;
+
+    QByteArray bytes;
+    bytes.reserve(length);
+    while (bytes.length() < length) {
+        if (pos >= BUFFER_SIZE) {
+            QRandomGenerator::system()->generate(std::begin(buffer), std::end(buffer));
+            pos = 0;
+        }
+        int len = qMin(length - (int)bytes.length(), BUFFER_SIZE - pos);
+        char *p = reinterpret_cast<char *>(buffer) + pos;
+        bytes.append(p, len);
+        std::memset(p, 0, len);  // not to leave used bytes
+        pos += len;
+    }
+    return bytes;
+}
+
+
+int removeExpiredSessions(const QString &storeType)
+{
+    int cnt = 0;
+    TSessionStore *store = TSessionStoreFactory::create(storeType);
+    if (store) {
+        int gclifetime = Tf::appSettings()->value(Tf::SessionGcMaxLifeTime).toInt();
+        QDateTime expire = QDateTime::currentDateTime().addSecs(-gclifetime);
+        cnt = store->gc(expire);
+        TSessionStoreFactory::destroy(storeType, store);
+    }
+    return cnt;
+}
+
+
+// Collects the garbage on the application server 0. The other servers
+// take it over if no collection is stamped for twice the interval, such
+// as while the server 0 is down.
+class SessionGcScheduler : public TJobScheduler {
+public:
+    SessionGcScheduler(int interval) :
+        _interval(interval),
+        _started(QDateTime::currentDateTime()) { }
+
+    // Starts the timer on every application server, unlike start()
+    void startOnEachServer()
+    {
+        emit startTimer(_interval * 1000);
+    }
+
+protected:
+    void job() override
+    {
+        const QString stampPath = Tf::app()->tmpPath() + QLatin1String("sessiongc.stamp");
+
+        if (Tf::app()->applicationServerId() != 0) {
+            QDateTime last = QFileInfo(stampPath).lastModified();
+            if (!last.isValid() || last < _started) {
+                last = _started;
+            }
+            if (last.secsTo(QDateTime::currentDateTime()) < _interval * 2) {
+                return;
+            }
+            tSystemDebug("Session garbage collector taken over by server %d", Tf::app()->applicationServerId());
+        }
+
+        QFile stamp(stampPath);
+        if (stamp.open(QIODevice::WriteOnly | QIODevice::Truncate)) {  // updates the mtime
+            stamp.close();
+        }
+
+        int cnt = removeExpiredSessions(TSessionManager::instance().storeType());
+        tSystemDebug("Session garbage collector removed %d sessions", cnt);
+    }
+
+private:
+    int _interval {0};  // secs
+    QDateTime _started;
+};
+
+}
 
 
 TSessionManager::TSessionManager()
@@ -63,6 +160,29 @@ bool TSessionManager::store(TSession &session)
 }
 
 
+/*!
+  Extends the lifetime of the \a session which is unchanged since it was
+  found. The session is stored entirely if the store does not support it.
+*/
+bool TSessionManager::touch(TSession &session)
+{
+    if (session.id().isEmpty()) {
+        tSystemError("Internal Error  [%s:%d]", __FILE__, __LINE__);
+        return false;
+    }
+
+    bool res = false;
+    TSessionStore *store = TSessionStoreFactory::create(storeType());
+    if (Q_LIKELY(store)) {
+        res = store->touch(session.id()) || store->store(session);
+        TSessionStoreFactory::destroy(storeType(), store);
+    } else {
+        tSystemError("Session store not found: %s", qUtf8Printable(storeType()));
+    }
+    return res;
+}
+
+
 bool TSessionManager::remove(const QByteArray &id)
 {
     if (!id.isEmpty()) {
@@ -93,43 +213,55 @@ QString TSessionManager::csrfProtectionKey() const
 }
 
 
+/*!
+  Generates a new session ID of 160 random bits from the CSPRNG of the
+  system. The probability of a collision is negligible, so the session
+  store is not looked up.
+*/
 QByteArray TSessionManager::generateId()
 {
-    QByteArray id;
-    int i;
-    for (i = 0; i < 3; ++i) {
-        id = QUuid::createUuid().toByteArray(QUuid::Id128);
-        if (findSession(id).isEmpty()) {
-            break;
-        }
-    }
+    return secureRandomBytes(SESSION_ID_BYTES).toHex();
+}
 
-    if (i == 3) {
-        throw RuntimeException("Unable to generate a unique session ID", __FILE__, __LINE__);
-    }
 
-    return id;
-}
+/*!
+  Starts the garbage collector of sessions running in the background
+  every Session.GcInterval seconds on each application server; the
+  garbage is collected on the application server 0 only unless it stops.
+  Called in the main thread at startup of the application server.
+*/
+void TSessionManager::startGarbageCollector()
+{
+    static const int interval = Tf::appSettings()->value(Tf::SessionGcInterval).toInt();
+    static SessionGcScheduler *scheduler = nullptr;
 
+    if (interval > 0 && !scheduler) {
+        scheduler = new SessionGcScheduler(interval);
+        scheduler->startOnEachServer();
+    }
+}
 
+/*!
+  Collects the garbage in the current thread at the rate of
+  Session.GcProbability unless Session.GcInterval is set, with which
+  the garbage collector started by startGarbageCollector() does it.
+*/
 void TSessionManager::collectGarbage()
 {
+    static const int interval = Tf::appSettings()->value(Tf::SessionGcInterval).toInt();
     static const int prob = Tf::appSettings()->value(Tf::SessionGcProbability).toInt();
 
+    if (interval > 0) {
+        return;
+    }
+
     if (prob > 0) {
         int r = Tf::random(0, prob - 1);
         tSystemDebug("Session garbage collector : rand = %d", r);
 
         if (r == 0) {
             tSystemDebug("Session garbage collector started");
-
-            TSessionStore *store = TSessionStoreFactory::create(storeType());
-            if (store) {
-                int gclifetime = Tf::appSettings()->value(Tf::SessionGcMaxLifeTime).toInt();
-                QDateTime expire = QDateTime::currentDateTime().addSecs(-gclifetime);
-                store->gc(expire);
-                TSessionStoreFactory::destroy(storeType(), store);
-            }
+            removeExpiredSessions(storeType());
         }
     }
 }
@@ -10,11 +10,13 @@ public:
 
     TSession findSession(const QByteArray &id);
     bool store(TSession &session);
+    bool touch(TSession &session);
     bool remove(const QByteArray &id);
     QString storeType() const;
     QString csrfProtectionKey() const;
     QByteArray generateId();
     void collectGarbage();
+    void startGarbageCollector();
 
     static TSessionManager &instance();
     static int sessionLifeTime();
@@ -73,6 +73,13 @@ bool TSessionMemcachedStore::remove(const QByteArray &id)
 }
 
 
+bool TSessionMemcachedStore::touch(const QByteArray &id)
+{
+    TMemcached memcached;
+    return memcached.touch('_' + id, lifeTimeSecs());
+}
+
+
 int TSessionMemcachedStore::gc(const QDateTime &)
 {
     return 0;
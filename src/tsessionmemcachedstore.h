@@ -8,5 +8,6 @@ public:
     TSession find(const QByteArray &id) override;
     bool store(TSession &session) override;
     bool remove(const QByteArray &id) override;
+    bool touch(const QByteArray &id) override;
     int gc(const QDateTime &expire) override;
 };
@@ -88,6 +88,14 @@ bool TSessionMongoStore::remove(const QByteArray &id)
 }
 
 
+bool TSessionMongoStore::touch(const QByteArray &id)
+{
+    TMongoODMapper<TSessionMongoObject> mapper;
+    int cnt = mapper.updateAll(TCriteria(TSessionMongoObject::SessionId, QString::fromUtf8(id)), TSessionMongoObject::UpdatedAt, QDateTime::currentDateTime());
+    return (cnt > 0);
+}
+
+
 int TSessionMongoStore::gc(const QDateTime &expire)
 {
     TMongoODMapper<TSessionMongoObject> mapper;
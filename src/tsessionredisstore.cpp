@@ -73,6 +73,13 @@ bool TSessionRedisStore::remove(const QByteArray &id)
 }
 
 
+bool TSessionRedisStore::touch(const QByteArray &id)
+{
+    TRedis redis;
+    return redis.expire('_' + id, lifeTimeSecs());
+}
+
+
 int TSessionRedisStore::gc(const QDateTime &)
 {
     return 0;
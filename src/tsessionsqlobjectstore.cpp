@@ -113,6 +113,15 @@ bool TSessionSqlObjectStore::remove(const QByteArray &id)
 }
 
 
+bool TSessionSqlObjectStore::touch(const QByteArray &id)
+{
+    TSqlORMapper<TSessionObject> mapper;
+    // updated_at is set by updateAll()
+    int cnt = mapper.updateAll(TCriteria(TSessionObject::Id, id), TSessionObject::Id, id);
+    return (cnt > 0);
+}
+
+
 int TSessionSqlObjectStore::gc(const QDateTime &expire)
 {
     TSqlORMapper<TSessionObject> mapper;
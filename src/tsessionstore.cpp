@@ -18,6 +18,16 @@ int64_t TSessionStore::lifeTimeSecs()
     return lifetime;
 }
 
+/*!
+  Extends the lifetime of the session with the ID \a id without
+  rewriting its data. Returns false if it is not supported by the store
+  or the session is not found, then the session is stored entirely.
+*/
+bool TSessionStore::touch(const QByteArray &)
+{
+    return false;
+}
+
 
 /*!
   \class TSessionStore
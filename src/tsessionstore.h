@@ -12,6 +12,7 @@ public:
     virtual TSession find(const QByteArray &id) = 0;
     virtual bool store(TSession &sesion) = 0;
     virtual bool remove(const QByteArray &id) = 0;
+    virtual bool touch(const QByteArray &id);
     virtual int gc(const QDateTime &expire) = 0;
 
     static int64_t lifeTimeSecs();
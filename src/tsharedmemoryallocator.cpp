@@ -8,10 +8,18 @@
 #include "tsharedmemoryallocator.h"
 #include "tsharedmemory.h"
 #include "tsystemglobal.h"
+#include <QtAlgorithms>
 #include <cstring>
 #include <cerrno>
 
 constexpr ushort CHECKDIGITS = 0x08C0;
+constexpr uint64_t LAYOUT_VERSION = 2;
+// Free lists: exact classes of 32 bytes up to 1024 bytes, and
+// power-of-two classes above them
+constexpr uint SMALL_BLOCK_MAX = 1024;
+constexpr int NUM_SMALL_BINS = SMALL_BLOCK_MAX / 32;
+constexpr int NUM_BINS = NUM_SMALL_BINS + 22;
+constexpr int MAX_BIN_SCAN = 32;
 
 namespace Tf {
 
@@ -20,11 +28,15 @@ struct alloc_table {
     uintptr_t headg {0};
     uintptr_t tailg {0};
     uint64_t used {0};  // used bytes
+    uint64_t binmap {0};  // bit set if the free list is not empty
+    uintptr_t bing[NUM_BINS] {0};  // free lists
 
     Tf::alloc_header_t *head() const { return headg ? (Tf::alloc_header_t *)((uintptr_t)this + headg) : nullptr; }
     Tf::alloc_header_t *tail() const { return tailg ? (Tf::alloc_header_t *)((uintptr_t)this + tailg) : nullptr; }
+    Tf::alloc_header_t *bin(int i) const { return bing[i] ? (Tf::alloc_header_t *)((uintptr_t)this + bing[i]) : nullptr; }
     void set_head(Tf::alloc_header_t *p) { headg = p ? (uintptr_t)p - (uintptr_t)this : 0; }
     void set_tail(Tf::alloc_header_t *p) { tailg = p ? (uintptr_t)p - (uintptr_t)this : 0; }
+    void set_bin(int i, Tf::alloc_header_t *p) { bing[i] = p ? (uintptr_t)p - (uintptr_t)this : 0; }
 };
 
 // Program break header
@@ -51,6 +63,18 @@ struct alloc_header_t {
     uintptr_t nextg {0};
     uintptr_t prevg {0};
 
+    alloc_header_t *next() const { return nextg ? (alloc_header_t *)((char *)this + nextg) : nullptr; }
+    alloc_header_t *prev() const { return prevg ? (alloc_header_t *)((char *)this + prevg) : nullptr; }
+    void set_next(alloc_header_t *p) { nextg = p ? (uintptr_t)p - (uintptr_t)this : 0; }
+    void set_prev(alloc_header_t *p) { prevg = p ? (uintptr_t)p - (uintptr_t)this : 0; }
+    struct free_link_t *link() const { return (free_link_t *)(this + 1); }
+};
+
+// Links of a free list, stored in the data area of a free block
+struct free_link_t {
+    uintptr_t nextg {0};
+    uintptr_t prevg {0};
+
     alloc_header_t *next() const { return nextg ? (alloc_header_t *)((char *)this + nextg) : nullptr; }
     alloc_header_t *prev() const { return prevg ? (alloc_header_t *)((char *)this + prevg) : nullptr; }
     void set_next(alloc_header_t *p) { nextg = p ? (uintptr_t)p - (uintptr_t)this : 0; }
@@ -61,6 +85,34 @@ struct alloc_header_t {
 
 const Tf::alloc_header_t INIT_HEADER;
 
+namespace {
+
+// Index of the free list, where the blocks are larger than
+// or equal to the lower limit of the class
+inline int binIndex(uint size)
+{
+    if (size <= SMALL_BLOCK_MAX) {
+        return qMax((int)(size / 32) - 1, 0);
+    }
+    int log2 = 31 - qCountLeadingZeroBits((quint32)size);
+    return qMin(NUM_SMALL_BINS + log2 - 10, NUM_BINS - 1);
+}
+
+
+inline uint roundUp(uint size)
+{
+    uint d = size % 32;
+    return size + (d ? 32 - d : 0);
+}
+
+
+inline uint64_t checksum(size_t size)
+{
+    return (uint64_t)size * (uint64_t)size + LAYOUT_VERSION;
+}
+
+}  // namespace
+
 
 TSharedMemoryAllocator *TSharedMemoryAllocator::initialize(const QString &name, size_t size)
 {
@@ -142,13 +194,13 @@ void TSharedMemoryAllocator::setbrk(bool initial)
     tSystemDebug("addr = %p", _sharedMemory->data());
 
     // Checks checksum
-    uint64_t ck = (uint64_t)_sharedMemory->size() * (uint64_t)_sharedMemory->size();
-    if (initial || pb_header->checksum != ck || !ck) {
+    uint64_t ck = checksum(_sharedMemory->size());
+    if (initial || pb_header->checksum != ck || !_sharedMemory->size()) {
         // new mmap
         std::memcpy(pb_header, &INIT_PB_HEADER, sizeof(Tf::program_break_header_t));
         pb_header->startg = pb_header->currentg = sizeof(Tf::program_break_header_t);
         pb_header->endg = _sharedMemory->size();
-        pb_header->checksum = (uint64_t)_sharedMemory->size() * (uint64_t)_sharedMemory->size();
+        pb_header->checksum = ck;
     }
     tSystemDebug("checksum = %lu", pb_header->checksum);
 
@@ -156,6 +208,7 @@ void TSharedMemoryAllocator::setbrk(bool initial)
 }
 
 
+// Takes a free block of at least 'size' bytes out of the free lists
 Tf::alloc_header_t *TSharedMemoryAllocator::free_block(uint size)
 {
     if (!pb_header) {
@@ -164,30 +217,89 @@ Tf::alloc_header_t *TSharedMemoryAllocator::free_block(uint size)
     }
 
     Tf::alloc_header_t *p = nullptr;
-    Tf::alloc_header_t *cur = pb_header->alloc_head();
+    int idx = binIndex(size);
 
-    while (cur) {
-        if (cur->freed && cur->size >= size) {
-            if (size >= cur->size * 0.8) {
-                return cur;
+    if (size <= SMALL_BLOCK_MAX) {
+        // Any block of the class fits
+        p = pb_header->at.bin(idx);
+    } else {
+        // Searches the class for the first fit
+        int cnt = 0;
+        for (auto *cur = pb_header->at.bin(idx); cur && cnt < MAX_BIN_SCAN; cur = cur->link()->next(), cnt++) {
+            if (cur->size >= size) {
+                p = cur;
+                break;
             }
+        }
+    }
 
-            if (!p || cur->size < p->size) {
-                p = cur;
+    if (!p) {
+        // Any block of larger classes fits
+        uint64_t map = (idx + 1 < NUM_BINS) ? pb_header->at.binmap & (~(uint64_t)0 << (idx + 1)) : 0;
+        if (map) {
+            p = pb_header->at.bin(qCountTrailingZeroBits((quint64)map));
+        } else if (size > SMALL_BLOCK_MAX) {
+            // Searches the rest of the class
+            for (auto *cur = pb_header->at.bin(idx); cur; cur = cur->link()->next()) {
+                if (cur->size >= size) {
+                    p = cur;
+                    break;
+                }
             }
         }
-        cur = cur->next();
     }
 
-    if (p && p->size - size > sizeof(Tf::alloc_header_t) * 10) {
-        // If free space is more than 240 bytes
-        divide(p, size);
+    if (!p) {
+        return nullptr;
     }
 
+    remove_free_block(p);
+    if (p->size - size > sizeof(Tf::alloc_header_t) * 10) {
+        // If free space is more than 240 bytes
+        insert_free_block(divide(p, size));
+    }
     return p;
 }
 
 
+void TSharedMemoryAllocator::insert_free_block(Tf::alloc_header_t *block)
+{
+    if (!block) {
+        return;
+    }
+
+    int idx = binIndex(block->size);
+    Tf::alloc_header_t *head = pb_header->at.bin(idx);
+    std::memset(block->link(), 0, sizeof(Tf::free_link_t));
+    block->link()->set_next(head);
+    if (head) {
+        head->link()->set_prev(block);
+    }
+    pb_header->at.set_bin(idx, block);
+    pb_header->at.binmap |= (uint64_t)1 << idx;
+}
+
+
+void TSharedMemoryAllocator::remove_free_block(Tf::alloc_header_t *block)
+{
+    int idx = binIndex(block->size);
+    Tf::alloc_header_t *next = block->link()->next();
+    Tf::alloc_header_t *prev = block->link()->prev();
+
+    if (prev) {
+        prev->link()->set_next(next);
+    } else {
+        pb_header->at.set_bin(idx, next);
+        if (!next) {
+            pb_header->at.binmap &= ~((uint64_t)1 << idx);
+        }
+    }
+    if (next) {
+        next->link()->set_prev(prev);
+    }
+}
+
+
 uint TSharedMemoryAllocator::allocSize(const void *ptr) const
 {
     if (!pb_header || !ptr) {
@@ -212,8 +324,7 @@ uint TSharedMemoryAllocator::allocSize(const void *ptr) const
 
 Tf::alloc_header_t *TSharedMemoryAllocator::divide(Tf::alloc_header_t *block, uint size)
 {
-    uint d = size % 32;
-    size += d ? 32 - d : 0;
+    size = roundUp(size);
 
     if (!block || block->size < size + sizeof(Tf::alloc_header_t)) {
         return nullptr;
@@ -256,63 +367,60 @@ void TSharedMemoryAllocator::free(void *ptr)
         return;
     }
 
-    while (ptr) {
-        if (ptr < pb_header->start() || ptr >= pb_header->end()) {
-            errno = ENOMEM;
-            Q_ASSERT(0);
-            return;
-        }
-
-        Tf::alloc_header_t *header = (Tf::alloc_header_t*)ptr - 1;
+    if (ptr < pb_header->start() || ptr >= pb_header->end()) {
+        errno = ENOMEM;
+        Q_ASSERT(0);
+        return;
+    }
 
-        // checks ptr
-        if (header->rsv != CHECKDIGITS) {
-            errno = ENOMEM;
-            Q_ASSERT(0);
-            return;
-        }
+    Tf::alloc_header_t *header = (Tf::alloc_header_t*)ptr - 1;
 
-        // marks as free
-        if (!header->freed) {
-            header->freed = 1;
-            pb_header->at.used -= sizeof(Tf::alloc_header_t) + header->size;
-        }
+    // checks ptr
+    if (header->rsv != CHECKDIGITS) {
+        errno = ENOMEM;
+        Q_ASSERT(0);
+        return;
+    }
 
-        if (header != pb_header->alloc_tail()) {
-            // next block
-            Tf::alloc_header_t *p = header->next();
-            if (p->freed) {
-                merge(header, p);
-            }
+    if (header->freed) {
+        return;  // already in a free list
+    }
 
-            // prev block
-            p = header->prev();
-            if (p && p->freed) {
-                merge(p, header);
-            }
+    // marks as free
+    header->freed = 1;
+    pb_header->at.used -= sizeof(Tf::alloc_header_t) + header->size;
 
-            break;
-        }
+    // Coalesces with the neighbors, the last block is never free
+    Tf::alloc_header_t *p = header->next();
+    if (p && p->freed) {
+        remove_free_block(p);
+        merge(header, p);
+    }
 
-        // header of last block
-        Tf::alloc_header_t *prev = header->prev();
-        pb_header->at.set_tail(prev);
+    bool last = (header == pb_header->alloc_tail());
+    p = header->prev();
+    if (p && p->freed) {
+        remove_free_block(p);
+        header = merge(p, header);
+    }
 
-        if (prev) {
-            prev->set_next(nullptr);
-        } else {
-            pb_header->at.set_head(nullptr);
-        }
+    if (!last) {
+        insert_free_block(header);
+        return;
+    }
 
-        // memory released
-        TSharedMemoryAllocator::sbrk(0 - (int64_t)header->size - (int64_t)sizeof(Tf::alloc_header_t));
+    // header of last block
+    Tf::alloc_header_t *prev = header->prev();
+    pb_header->at.set_tail(prev);
 
-        // frees recursively
-        if (!prev || !prev->freed) {
-            break;
-        }
-        ptr = prev + 1;
+    if (prev) {
+        prev->set_next(nullptr);
+    } else {
+        pb_header->at.set_head(nullptr);
     }
+
+    // memory released
+    TSharedMemoryAllocator::sbrk(0 - (int64_t)header->size - (int64_t)sizeof(Tf::alloc_header_t));
 }
 
 // Allocates size bytes and returns a pointer to the allocated memory
@@ -323,8 +431,7 @@ void *TSharedMemoryAllocator::malloc(uint size)
     }
 
     // rounds up to 32bytes
-    uint d = size % 32;
-    size += d ? 32 - d : 0;
+    size = roundUp(size);
 
     Tf::alloc_header_t *header = free_block(size);
     if (header) {
@@ -401,6 +508,22 @@ void *TSharedMemoryAllocator::realloc(void *ptr, uint size)
         return ptr;
     }
 
+    // Grows in place if the next block is free
+    size = roundUp(size);
+    Tf::alloc_header_t *next = header->next();
+    if (next && next->freed && header->size + sizeof(Tf::alloc_header_t) + next->size >= size) {
+        remove_free_block(next);
+        pb_header->at.used += sizeof(Tf::alloc_header_t) + next->size;
+        merge(header, next);
+
+        if (header->size - size > sizeof(Tf::alloc_header_t) * 10) {
+            Tf::alloc_header_t *rest = divide(header, size);
+            pb_header->at.used -= sizeof(Tf::alloc_header_t) + rest->size;
+            insert_free_block(rest);
+        }
+        return ptr;
+    }
+
     void *ret = TSharedMemoryAllocator::malloc(size);
     if (ret) {
         // relocate contents
@@ -426,8 +549,27 @@ void TSharedMemoryAllocator::summary() const
         return;
     }
 
+    size_t freeSize = sizeOfFreeBlocks();
+    size_t largest = largestFreeBlockSize();
+    // External fragmentation: the part of free space not usable by one allocation
+    double fragmentation = (freeSize > 0) ? 100.0 * (freeSize - largest) / freeSize : 0.0;
+
     tSystemDebug("-- memory block summary --");
     tSystemDebug("table info: blocks = %d, free = %d, used = %lu", countBlocks(), countFreeBlocks(), pb_header->at.used);
+    tSystemDebug("free info: free-size = %lu, largest = %lu, fragmentation = %.1f%%, segment-size = %lu", freeSize, largest, fragmentation, dataSegmentSize());
+
+    for (int i = 0; i < NUM_BINS; i++) {
+        if (!(pb_header->at.binmap & ((uint64_t)1 << i))) {
+            continue;
+        }
+
+        int count = 0;
+        for (auto *cur = pb_header->at.bin(i); cur; cur = cur->link()->next()) {
+            count++;
+        }
+        uint lower = (i < NUM_SMALL_BINS) ? (i + 1) * 32 : (1U << (i - NUM_SMALL_BINS + 10));
+        tSystemDebug("free list: class >= %u, blocks = %d", lower, count);
+    }
 }
 
 // Debug function to print the entire link list
@@ -509,6 +651,25 @@ size_t TSharedMemoryAllocator::sizeOfFreeBlocks() const
 }
 
 
+size_t TSharedMemoryAllocator::largestFreeBlockSize() const
+{
+    if (!pb_header) {
+        Q_ASSERT(0);
+        return 0;
+    }
+
+    size_t size = 0;
+    if (pb_header->at.binmap) {
+        // Searches the largest class only
+        int idx = 63 - qCountLeadingZeroBits((quint64)pb_header->at.binmap);
+        for (auto *cur = pb_header->at.bin(idx); cur; cur = cur->link()->next()) {
+            size = qMax(size, (size_t)cur->size);
+        }
+    }
+    return size;
+}
+
+
 size_t TSharedMemoryAllocator::dataSegmentSize() const
 {
     if (!pb_header) {
@@ -30,6 +30,7 @@ public:
     int countBlocks() const;  // Counts blocks
     int countFreeBlocks() const; // Counts free blocks
     size_t sizeOfFreeBlocks() const; // Total size of free blocks
+    size_t largestFreeBlockSize() const;
     size_t dataSegmentSize() const;
 
     static TSharedMemoryAllocator *initialize(const QString &name, size_t size);
@@ -41,6 +42,8 @@ private:
     char *sbrk(int64_t inc);
     void setbrk(bool initial = false);
     Tf::alloc_header_t *free_block(uint size);
+    void insert_free_block(Tf::alloc_header_t *block);
+    void remove_free_block(Tf::alloc_header_t *block);
 
     static Tf::alloc_header_t *merge(Tf::alloc_header_t *block, Tf::alloc_header_t *next);
     static Tf::alloc_header_t *divide(Tf::alloc_header_t *block, uint size);
@@ -10,49 +10,75 @@
 #include <TActionContext>
 #include <TSystemGlobal>
 #include <QDataStream>
+#include <climits>
 #include <cstring>
 
+constexpr uintptr_t FREE = (uintptr_t)-1;
+constexpr int WHEEL_SIZE = 1024;  // slots of one second
+constexpr uint REHASH_STEPS = 128;  // slots moved per write
+constexpr int EXPIRY_STEPS = 64;  // entries checked per write
+constexpr int EVICTION_SAMPLES = 8;
+constexpr int MAX_EVICTIONS = 32;  // per write
 
-const void *FREE = (void *)-1;
 
 struct hash_header_t {
     uintptr_t hashtg {0};
     uint tableSize {1024};
-    uint count {0};
+    uint count {0};  // entries in both tables
     uint freeCount {0};
+    // Old table being moved into the new one
+    uintptr_t oldhashtg {0};
+    uint oldTableSize {0};
+    uint rehashIndex {0};
+    // Memory usage
+    uint64_t usedBytes {0};
+    uint64_t memoryLimit {0};
+    uint64_t evictedCount {0};
+    // Expiry wheel
+    int64_t wheelTick {0};  // secs since epoch
+    uintptr_t wheelCursorg {0};
+    bool wheelScanning {false};
+    uintptr_t wheelg[WHEEL_SIZE] {0};
 
     uintptr_t *hashg() { return hashtg ? (uintptr_t *)((uintptr_t)this + hashtg) : nullptr; }
+    uintptr_t *oldHashg() { return oldhashtg ? (uintptr_t *)((uintptr_t)this + oldhashtg) : nullptr; }
 
     void setHashg(void *p)
     {
         hashtg = p ? (uintptr_t)p - (uintptr_t)this : 0;
     }
 
-    void *bucketPtr(uint index)
+    void setOldHashg(void *p)
     {
-        if (index < tableSize) {
-            uintptr_t g = *(hashg() + index);
-            return (g && g != (uintptr_t)-1) ? (char *)this + g : (void *)g;
-        } else {
-            Q_ASSERT(0);
-        }
-        return nullptr;
+        oldhashtg = p ? (uintptr_t)p - (uintptr_t)this : 0;
     }
 
-    void setBucketPtr(uint index, const void *ptr)
-    {
-        if (index < tableSize) {
-            *(hashg() + index) = (ptr && ptr != FREE) ? (uintptr_t)ptr - (uintptr_t)this : (uintptr_t)ptr;
-        } else {
-            Q_ASSERT(0);
-        }
-    }
+    entry_header_t *entry(uintptr_t g) { return (g && g != FREE) ? (entry_header_t *)((char *)this + g) : nullptr; }
+    uintptr_t offset(const void *p) const { return p ? (uintptr_t)p - (uintptr_t)this : 0; }
+    bool inTable(const uintptr_t *slot) { return slot >= hashg() && slot < hashg() + tableSize; }
+};
+
+// Placed before the serialized bucket
+struct entry_header_t {
+    int64_t expires {0};  // msecs since epoch
+    uint hash {0};  // hash of the key
+    uint accessed {0};  // secs since epoch, updated without write lock
+    uintptr_t nextg {0};  // links of the expiry wheel
+    uintptr_t prevg {0};
+
+    int wheelIndex() const { return (expires / 1000) % WHEEL_SIZE; }
 };
 
 /*!
   \class TSharedMemoryKvs
   \brief The TSharedMemoryKvs class provides a means of operating a in-memory
   KVS built in the server process.
+
+  The table grows incrementally; each write moves a part of the old
+  table into the new one, and lookups search both tables meanwhile.
+  Expired entries are reclaimed by each write through a wheel of
+  one-second slots. If the memory runs short or exceeds MEMORY_LIMIT,
+  the least recently used one out of several sampled entries is evicted.
 */
 
 
@@ -83,16 +109,18 @@ TSharedMemoryKvs::~TSharedMemoryKvs()
 */
 bool TSharedMemoryKvs::initialize(const QString &name, const QString &options)
 {
-    hash_header_t hashheader;
+    static const hash_header_t INIT_HASH_HEADER;
 
     TSharedMemoryKvsDriver::initialize(name, options);
     TSharedMemoryKvsDriver driver;
     driver.open(name, QString(), QString(), QString(), 0, options);
     hash_header_t *header = (hash_header_t *)driver.origin();
 
-    void *ptr = driver.malloc(sizeof(hashheader));
+    void *ptr = driver.malloc(sizeof(hash_header_t));
     Q_ASSERT(ptr == header);
-    std::memcpy(header, &hashheader, sizeof(hashheader));
+    std::memcpy(header, &INIT_HASH_HEADER, sizeof(hash_header_t));
+    header->memoryLimit = TSharedMemoryKvsDriver::memoryLimit(options, driver.mapSize());
+    header->wheelTick = Tf::getMSecsSinceEpoch() / 1000;
     ptr = driver.calloc(header->tableSize, sizeof(uintptr_t));
     header->setHashg(ptr);
     Q_ASSERT(ptr);
@@ -112,6 +140,21 @@ void TSharedMemoryKvs::cleanup()
   value, it is overwritten, regardless of its type.
  */
 bool TSharedMemoryKvs::set(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    return store(key, value, seconds, true);
+}
+
+/*!
+  Sets the \a key to hold the \a value only if the key does not hold
+  a value that is not expired. Returns true if it is set.
+ */
+bool TSharedMemoryKvs::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    return store(key, value, seconds, false);
+}
+
+
+bool TSharedMemoryKvs::store(const QByteArray &key, const QByteArray &value, int seconds, bool overwrite)
 {
     if (key.isEmpty() || seconds <= 0) {
         return false;
@@ -122,59 +165,47 @@ bool TSharedMemoryKvs::set(const QByteArray &key, const QByteArray &value, int s
     int64_t expires = Tf::getMSecsSinceEpoch() + seconds * 1000;
     ds << Bucket{key, value, expires};
 
-    lockForWrite();  // lock
-
-    Bucket bucket;
-    QByteArray buf;
-    uint idx = index(key);
+    const uint hash = qHash(key);
     bool ret = false;
 
-    for (uint i = 0; i < _h->tableSize; i++) {
-        void *pbucket = _h->bucketPtr(idx);
-        if (pbucket && pbucket != FREE) {
-            // checks key
-            int alcsize = driver()->allocSize(pbucket);
-            if (alcsize <= 0) {
-                // error
-                Q_ASSERT(0);
-                break;
-            }
-
-            buf.setRawData((char *)pbucket, alcsize);
-            QDataStream dsb(buf);
-            dsb >> bucket;
+    lockForWrite();  // lock
 
-            if (bucket.expires > Tf::getMSecsSinceEpoch() && bucket.key != key) {
-                idx = next(idx);
-                continue;
-            }
+    // Amortized maintenance
+    rehashStep(REHASH_STEPS);
+    expireStep(EXPIRY_STEPS);
 
-            driver()->free(pbucket);
-            (_h->count)--;
+    uintptr_t *slot = findSlot(key, hash);
+    if (slot) {
+        if (!overwrite && _h->entry(*slot)->expires > Tf::getMSecsSinceEpoch()) {
+            unlock();  // unlock
+            return false;
         }
+        removeSlot(slot);
+    }
 
-        // Inserts data
-        void *newbucket = driver()->malloc(data.size());
-        if (!newbucket) {
-            tError("Not enough space/cannot allocate memory.  errno:%d", errno);
-            break;
-        }
-
-        std::memcpy(newbucket, data.data(), data.size());
-        _h->setBucketPtr(idx, newbucket);
-        (_h->count)++;
-
-        if (pbucket == FREE) {
-            (_h->freeCount)--;
+    // Inserts data
+    auto *entry = (entry_header_t *)allocEntry(sizeof(entry_header_t) + data.size());
+    if (entry) {
+        entry->expires = expires;
+        entry->hash = hash;
+        entry->accessed = expires / 1000 - seconds;
+        std::memcpy(entry + 1, data.data(), data.size());
+        if (insertSlot(_h->offset(entry), hash)) {
+            linkWheel(entry);
+            _h->usedBytes += driver()->allocSize(entry);
+            (_h->count)++;
+            ret = true;
+        } else {
+            driver()->free(entry);
+            tError("Hash table full, failed to grow it.  size:%u", _h->tableSize);
         }
 
-        // Rehash
-        if (loadFactor() > 0.8) {
-            rehash();
+        // Rehash, retried by the next insert if failed
+        if (!_h->oldhashtg && loadFactor() > 0.8) {
+            startRehash((count() / (float)_h->tableSize > 0.5) ? _h->tableSize * 2 : _h->tableSize);
         }
-
-        ret = true;
-        break;
+    } else {
+        tError("Not enough space/cannot allocate memory.  errno:%d", errno);
     }
 
     unlock();  // unlock
@@ -182,41 +213,62 @@ bool TSharedMemoryKvs::set(const QByteArray &key, const QByteArray &value, int s
 }
 
 
-uint TSharedMemoryKvs::find(const QByteArray &key, Bucket &bucket) const
+bool TSharedMemoryKvs::readBucket(const entry_header_t *entry, Bucket &bucket) const
 {
-    if (key.isEmpty()) {
-        return -1;
+    int alcsize = (int)driver()->allocSize(entry) - (int)sizeof(entry_header_t);
+    if (alcsize <= 0) {
+        Q_ASSERT(0);
+        return false;
     }
 
-    uint idx = index(key);
     QByteArray buf;
+    buf.setRawData((const char *)(entry + 1), alcsize);
+    QDataStream ds(buf);
+    ds >> bucket;
+    return true;
+}
 
-    for (uint i = 0; i < _h->tableSize; i++) {
-        void *pbucket = _h->bucketPtr(idx);
-        if (!pbucket) {
-            break;
+// Returns the slot of the key in the new or old table
+uintptr_t *TSharedMemoryKvs::findSlot(const QByteArray &key, uint hash, Bucket *bucket) const
+{
+    if (key.isEmpty()) {
+        return nullptr;
+    }
+
+    Bucket bk;
+    uintptr_t *tables[] = {_h->hashg(), _h->oldHashg()};
+    const uint sizes[] = {_h->tableSize, _h->oldTableSize};
+
+    for (int t = 0; t < 2; t++) {
+        if (!tables[t]) {
+            continue;
         }
 
-        if (pbucket != FREE) {
-            int alcsize = driver()->allocSize(pbucket);
-            if (alcsize <= 0) {
-                Q_ASSERT(0);
+        uint idx = hash % sizes[t];
+        for (uint i = 0; i < sizes[t]; i++) {
+            uintptr_t g = tables[t][idx];
+            if (!g) {
                 break;
             }
 
-            buf.setRawData((char *)pbucket, alcsize);
-            QDataStream ds(buf);
-            ds >> bucket;
-
-            if (bucket.key == key) {
-                // Found
-                return idx;
+            entry_header_t *entry = _h->entry(g);
+            if (entry && entry->hash == hash) {
+                if (!readBucket(entry, bk)) {
+                    break;
+                }
+
+                if (bk.key == key) {
+                    // Found
+                    if (bucket) {
+                        *bucket = bk;
+                    }
+                    return &tables[t][idx];
+                }
             }
+            idx = (idx + 1) % sizes[t];
         }
-        idx = next(idx);
     }
-
-    return -1;
+    return nullptr;
 }
 
 
@@ -226,21 +278,8 @@ bool TSharedMemoryKvs::find(uint index, Bucket &bucket) const
         return false;
     }
 
-    void *pbucket = _h->bucketPtr(index);
-    if (!pbucket || pbucket == FREE) {
-        return false;
-    }
-
-    int alcsize = driver()->allocSize(pbucket);
-    if (alcsize <= 0) {
-        Q_ASSERT(0);
-        return false;
-    }
-
-    QByteArray buf((char *)pbucket, alcsize);
-    QDataStream ds(buf);
-    ds >> bucket;
-    return true;
+    entry_header_t *entry = _h->entry(_h->hashg()[index]);
+    return entry && readBucket(entry, bucket);
 }
 
 /*!
@@ -250,10 +289,19 @@ bool TSharedMemoryKvs::find(uint index, Bucket &bucket) const
 QByteArray TSharedMemoryKvs::get(const QByteArray &key)
 {
     Bucket bucket;
+    const int64_t now = Tf::getMSecsSinceEpoch();
+
     lockForRead();  // lock
-    uint idx = find(key, bucket);
+    uintptr_t *slot = findSlot(key, qHash(key), &bucket);
+    if (slot) {
+        // Only a hint for the eviction, so written under the read lock
+        entry_header_t *entry = _h->entry(*slot);
+        if (entry->accessed != (uint)(now / 1000)) {
+            entry->accessed = now / 1000;
+        }
+    }
     unlock();  // unlock
-    return (idx < tableSize() && bucket.expires > Tf::getMSecsSinceEpoch()) ? bucket.value : QByteArray();
+    return (slot && bucket.expires > now) ? bucket.value : QByteArray();
 }
 
 /*!
@@ -262,28 +310,168 @@ QByteArray TSharedMemoryKvs::get(const QByteArray &key)
  */
 bool TSharedMemoryKvs::remove(const QByteArray &key)
 {
-    Bucket bucket;
     lockForWrite();  // lock
-    uint idx = find(key, bucket);
-    remove(idx);
+    uintptr_t *slot = findSlot(key, qHash(key));
+    if (slot) {
+        removeSlot(slot);
+    }
+    rehashStep(REHASH_STEPS);
     unlock();  // unlock
-    return (idx < tableSize());
+    return (bool)slot;
 }
 
 
 void TSharedMemoryKvs::remove(uint index)
 {
     if (index < tableSize()) {
-        void *ptr = _h->bucketPtr(index);
-        if (ptr && ptr != FREE) {
-            driver()->free(ptr);
-            _h->setBucketPtr(index, FREE);
-            (_h->count)--;
-            (_h->freeCount)++;
+        uintptr_t *slot = _h->hashg() + index;
+        if (_h->entry(*slot)) {
+            removeSlot(slot);
         }
     }
 }
 
+
+void *TSharedMemoryKvs::allocEntry(uint size)
+{
+    if (_h->memoryLimit > 0) {
+        for (int i = 0; i < MAX_EVICTIONS && _h->usedBytes + size > _h->memoryLimit; i++) {
+            if (!evict()) {
+                break;
+            }
+        }
+    }
+
+    void *ptr = driver()->malloc(size);
+    for (int i = 0; !ptr && i < MAX_EVICTIONS; i++) {
+        if (!evict(size)) {
+            break;
+        }
+        ptr = driver()->malloc(size);
+    }
+    return ptr;
+}
+
+
+// Returns false if the table is full, which happens only when it could
+// not be grown
+bool TSharedMemoryKvs::insertSlot(uintptr_t entryg, uint hash)
+{
+    uintptr_t *table = _h->hashg();
+    uint idx = hash % _h->tableSize;
+
+    for (uint i = 0; i < _h->tableSize; i++) {
+        if (!table[idx] || table[idx] == FREE) {
+            if (table[idx] == FREE) {
+                (_h->freeCount)--;
+            }
+            table[idx] = entryg;
+            return true;
+        }
+        idx = (idx + 1) % _h->tableSize;
+    }
+    return false;
+}
+
+
+void TSharedMemoryKvs::removeSlot(uintptr_t *slot)
+{
+    entry_header_t *entry = _h->entry(*slot);
+    if (!entry) {
+        return;
+    }
+
+    unlinkWheel(entry);
+    _h->usedBytes -= driver()->allocSize(entry);
+    driver()->free(entry);
+    *slot = FREE;
+    (_h->count)--;
+
+    if (_h->inTable(slot)) {
+        (_h->freeCount)++;
+    }
+}
+
+// Removes the entry, searching its slot by the hash
+void TSharedMemoryKvs::removeEntry(entry_header_t *entry)
+{
+    const uintptr_t g = _h->offset(entry);
+    uintptr_t *tables[] = {_h->hashg(), _h->oldHashg()};
+    const uint sizes[] = {_h->tableSize, _h->oldTableSize};
+
+    for (int t = 0; t < 2; t++) {
+        if (!tables[t]) {
+            continue;
+        }
+
+        uint idx = entry->hash % sizes[t];
+        for (uint i = 0; i < sizes[t] && tables[t][idx]; i++) {
+            if (tables[t][idx] == g) {
+                removeSlot(&tables[t][idx]);
+                return;
+            }
+            idx = (idx + 1) % sizes[t];
+        }
+    }
+    Q_ASSERT(0);
+}
+
+// Evicts an expired entry or the least recently used one of samples,
+// preferring the entries not smaller than minSize to defragment
+bool TSharedMemoryKvs::evict(uint minSize)
+{
+    if (count() == 0) {
+        return false;
+    }
+
+    const int64_t now = Tf::getMSecsSinceEpoch();
+    const uint total = _h->tableSize + _h->oldTableSize;
+    auto slotAt = [this](uint i) {
+        return (i < _h->tableSize) ? _h->hashg() + i : _h->oldHashg() + (i - _h->tableSize);
+    };
+    auto better = [&](const entry_header_t *a, const entry_header_t *b) {
+        bool afit = driver()->allocSize(a) >= minSize;
+        bool bfit = driver()->allocSize(b) >= minSize;
+        if (afit != bfit) {
+            return afit;
+        }
+        return a->expires <= now || a->accessed < b->accessed;
+    };
+
+    uintptr_t *victim = nullptr;
+    for (int n = 0; n < EVICTION_SAMPLES; n++) {
+        uint i = Tf::random(total - 1);
+        for (uint j = 0; j < 64; j++) {
+            uintptr_t *slot = slotAt(i);
+            entry_header_t *entry = _h->entry(*slot);
+            if (entry) {
+                if (!victim || better(entry, _h->entry(*victim))) {
+                    victim = slot;
+                }
+                break;
+            }
+            i = (i + 1) % total;
+        }
+    }
+
+    if (!victim) {
+        // Sparse table
+        for (uint i = 0; i < total && !victim; i++) {
+            if (_h->entry(*slotAt(i))) {
+                victim = slotAt(i);
+            }
+        }
+    }
+
+    if (!victim) {
+        return false;
+    }
+
+    removeSlot(victim);
+    (_h->evictedCount)++;
+    return true;
+}
+
 /*!
   Returns the number of items set.
 */
@@ -304,24 +492,75 @@ float TSharedMemoryKvs::loadFactor() const
     return (count() + _h->freeCount) / (float)_h->tableSize;
 }
 
+/*!
+  Returns the bytes of memory allocated for the entries.
+*/
+quint64 TSharedMemoryKvs::usedBytes() const
+{
+    return _h->usedBytes;
+}
+
+/*!
+  Returns the limit of memory for the entries, 0 if no limit.
+  \sa setMemoryLimit()
+*/
+quint64 TSharedMemoryKvs::memoryLimit() const
+{
+    return _h->memoryLimit;
+}
+
+/*!
+  Sets the limit of memory for the entries to \a bytes, overriding
+  MEMORY_LIMIT of the options; 0 for no limit. The entries over the
+  limit are evicted by the following writes.
+*/
+void TSharedMemoryKvs::setMemoryLimit(quint64 bytes)
+{
+    lockForWrite();  // lock
+    _h->memoryLimit = qMin(bytes, (quint64)driver()->mapSize());
+    unlock();  // unlock
+}
+
+/*!
+  Returns the number of entries evicted for the memory.
+*/
+quint64 TSharedMemoryKvs::evictedCount() const
+{
+    return _h->evictedCount;
+}
+
 /*!
   Removes all items from the KVS.
 */
 void TSharedMemoryKvs::clear()
 {
     lockForWrite();  // lock
-    for (uint i = 0; i < _h->tableSize; i++) {
-        void *pbucket = _h->bucketPtr(i);
-        if (pbucket == FREE) {
-            (_h->freeCount)--;
-        } else if (pbucket) {
-            driver()->free(pbucket);
-            (_h->count)--;
+    uintptr_t *tables[] = {_h->hashg(), _h->oldHashg()};
+    const uint sizes[] = {_h->tableSize, _h->oldTableSize};
+
+    for (int t = 0; t < 2; t++) {
+        for (uint i = 0; tables[t] && i < sizes[t]; i++) {
+            entry_header_t *entry = _h->entry(tables[t][i]);
+            if (entry) {
+                driver()->free(entry);
+            }
+            tables[t][i] = 0;
         }
-        _h->setBucketPtr(i, nullptr);
     }
-    Q_ASSERT(_h->count == 0);
-    Q_ASSERT(_h->freeCount == 0);
+
+    if (_h->oldhashtg) {
+        driver()->free(_h->oldHashg());
+        _h->setOldHashg(nullptr);
+        _h->oldTableSize = 0;
+        _h->rehashIndex = 0;
+    }
+
+    _h->count = 0;
+    _h->freeCount = 0;
+    _h->usedBytes = 0;
+    _h->wheelScanning = false;
+    _h->wheelCursorg = 0;
+    std::memset(_h->wheelg, 0, sizeof(_h->wheelg));
     unlock();  // unlock
 }
 
@@ -330,13 +569,8 @@ void TSharedMemoryKvs::clear()
 */
 void TSharedMemoryKvs::gc()
 {
-    for (auto it = begin(); it != end(); ++it) {
-        if (it.isExpired()) {
-            it.remove();
-        }
-    }
-
     lockForWrite();  // lock
+    expireStep(INT_MAX);
     rehash();
     unlock();  // unlock
 }
@@ -346,65 +580,126 @@ void TSharedMemoryKvs::gc()
 */
 void TSharedMemoryKvs::rehash()
 {
+    // Completes the incremental one first
+    rehashStep(UINT_MAX);
+
     if (loadFactor() < 0.2) {
         // do nothing
         return;
     }
 
-    Bucket bucket;
-    QByteArray buf;
-    uintptr_t *const oldt = _h->hashg();
-    int oldsize = _h->tableSize;
+    startRehash((count() / (float)_h->tableSize > 0.5) ? _h->tableSize * 2 : _h->tableSize);
+    rehashStep(UINT_MAX);
+}
 
-    // Creates new table
-    if (count() / (float)_h->tableSize > 0.5) {
-        _h->tableSize = oldsize * 2;  // new table size
+
+void TSharedMemoryKvs::startRehash(uint newSize)
+{
+    Q_ASSERT(!_h->oldhashtg);
+
+    auto *ptr = driver()->calloc(newSize, sizeof(uintptr_t));
+    if (!ptr) {
+        tSystemWarn("Failed to allocate a hash table  size:%u", newSize);
+        return;
     }
 
-    auto *ptr = driver()->calloc(_h->tableSize, sizeof(uintptr_t));
+    _h->setOldHashg(_h->hashg());
+    _h->oldTableSize = _h->tableSize;
+    _h->rehashIndex = 0;
     _h->setHashg(ptr);
-    Q_ASSERT(ptr);
+    _h->tableSize = newSize;
+    _h->freeCount = 0;
+}
 
-    for (int i = 0; i < oldsize; i++) {
-        uintptr_t g = *(oldt + i);
-        void *pbucket = (g && g != (uintptr_t)-1) ? (char *)_h + g : nullptr;
+// Moves the entries of the old table into the new table
+void TSharedMemoryKvs::rehashStep(uint steps)
+{
+    uintptr_t *oldt = _h->oldHashg();
+    if (!oldt) {
+        return;
+    }
 
-        if (!pbucket) {
-            continue;
+    for (uint i = 0; i < steps && _h->rehashIndex < _h->oldTableSize; i++) {
+        uintptr_t &g = oldt[(_h->rehashIndex)++];
+        entry_header_t *entry = _h->entry(g);
+        if (entry) {
+            // Never full; the new table is not smaller than the old one
+            insertSlot(g, entry->hash);
+            g = FREE;  // keeps probe sequences of the old table
         }
+    }
 
-        int alcsize = driver()->allocSize(pbucket);
-        if (alcsize <= 0) {
-            Q_ASSERT(0);
-            continue;
+    if (_h->rehashIndex >= _h->oldTableSize) {
+        driver()->free(oldt);
+        _h->setOldHashg(nullptr);
+        _h->oldTableSize = 0;
+        _h->rehashIndex = 0;
+    }
+}
+
+// Removes the expired entries of the wheel slots whose second has passed
+void TSharedMemoryKvs::expireStep(int steps)
+{
+    const int64_t now = Tf::getMSecsSinceEpoch();
+    const int64_t nowSec = now / 1000;
+
+    if (_h->wheelTick < nowSec - WHEEL_SIZE) {
+        // A round has passed without writes
+        _h->wheelTick = nowSec - WHEEL_SIZE;
+        _h->wheelScanning = false;
+    }
+
+    while (_h->wheelTick < nowSec) {
+        if (!_h->wheelScanning) {
+            _h->wheelCursorg = _h->wheelg[_h->wheelTick % WHEEL_SIZE];
+            _h->wheelScanning = true;
         }
 
-        buf.setRawData((char *)pbucket, alcsize);
-        QDataStream ds(buf);
-        ds >> bucket;
+        while (_h->wheelCursorg && steps > 0) {
+            entry_header_t *entry = _h->entry(_h->wheelCursorg);
+            _h->wheelCursorg = entry->nextg;
+            if (entry->expires <= now) {
+                removeEntry(entry);
+            }
+            steps--;
+        }
 
-        int newidx = index(bucket.key);
-        while (_h->bucketPtr(newidx)) {
-            newidx = next(newidx);
+        if (_h->wheelCursorg) {
+            break;  // continued by next write
         }
-        _h->setBucketPtr(newidx, pbucket);
+        _h->wheelScanning = false;
+        (_h->wheelTick)++;
     }
-
-    _h->freeCount = 0;
-    //driver()->dump();
-    driver()->free(oldt);
 }
 
 
-uint TSharedMemoryKvs::index(const QByteArray &key) const
+void TSharedMemoryKvs::linkWheel(entry_header_t *entry)
 {
-    return qHash(key) % _h->tableSize;
+    uintptr_t &head = _h->wheelg[entry->wheelIndex()];
+    entry->prevg = 0;
+    entry->nextg = head;
+    if (head) {
+        _h->entry(head)->prevg = _h->offset(entry);
+    }
+    head = _h->offset(entry);
 }
 
 
-uint TSharedMemoryKvs::next(uint index) const
+void TSharedMemoryKvs::unlinkWheel(entry_header_t *entry)
 {
-    return (index + 1) % _h->tableSize;
+    if (_h->wheelScanning && _h->wheelCursorg == _h->offset(entry)) {
+        _h->wheelCursorg = entry->nextg;
+    }
+
+    if (entry->prevg) {
+        _h->entry(entry->prevg)->nextg = entry->nextg;
+    } else {
+        _h->wheelg[entry->wheelIndex()] = entry->nextg;
+    }
+
+    if (entry->nextg) {
+        _h->entry(entry->nextg)->prevg = entry->prevg;
+    }
 }
 
 /*!
@@ -479,6 +774,7 @@ const TSharedMemoryKvsDriver *TSharedMemoryKvs::driver() const
 TSharedMemoryKvs::WriteLockingIterator TSharedMemoryKvs::begin()
 {
     WriteLockingIterator it(this, (uint)-1);
+    rehashStep(UINT_MAX);  // iterates the new table only
     it.search();
     return it;
 }
@@ -6,6 +6,7 @@
 #include <TfNamespace>
 
 struct hash_header_t;
+struct entry_header_t;
 class TSharedMemoryKvsDriver;
 
 
@@ -69,12 +70,17 @@ public:
 
     QByteArray get(const QByteArray &key);
     bool set(const QByteArray &key, const QByteArray &value, int seconds);
+    bool add(const QByteArray &key, const QByteArray &value, int seconds);
     bool remove(const QByteArray &key);
     uint count() const;
     uint tableSize() const;
     void clear();
     void gc();
     float loadFactor() const;
+    quint64 usedBytes() const;
+    quint64 memoryLimit() const;
+    void setMemoryLimit(quint64 bytes);
+    quint64 evictedCount() const;
     void rehash();
     bool lockForRead();
     bool lockForWrite();
@@ -87,18 +93,26 @@ public:
     void cleanup();
 
 protected:
-    uint find(const QByteArray &key, Bucket &bucket) const;
+    uintptr_t *findSlot(const QByteArray &key, uint hash, Bucket *bucket = nullptr) const;
     bool find(uint index, Bucket &bucket) const;
-    int searchIndex(int first);
-    uint index(const QByteArray &key) const;
-    uint next(uint index) const;
     void remove(uint index);
 
-
 private:
     TSharedMemoryKvs(Tf::KvsEngine engine);
     TSharedMemoryKvsDriver *driver();
     const TSharedMemoryKvsDriver *driver() const;
+    bool store(const QByteArray &key, const QByteArray &value, int seconds, bool overwrite);
+    bool readBucket(const entry_header_t *entry, Bucket &bucket) const;
+    void *allocEntry(uint size);
+    bool insertSlot(uintptr_t entryg, uint hash);
+    void removeSlot(uintptr_t *slot);
+    void removeEntry(entry_header_t *entry);
+    bool evict(uint minSize = 0);
+    void startRehash(uint newSize);
+    void rehashStep(uint steps);
+    void expireStep(int steps);
+    void linkWheel(entry_header_t *entry);
+    void unlinkWheel(entry_header_t *entry);
 
     TKvsDatabase _database;
     hash_header_t *_h {nullptr};
@@ -34,11 +34,9 @@ static QString parseParameter(const QString &options, const QString &key)
 }
 
 
-static size_t memorySize(const QString &options)
+static size_t parseSize(const QString &sizestr)
 {
     const QRegularExpression re("^([\\d\\.]+)([GgMmKk]*)$");
-    auto sizestr = parseParameter(options, "MEMORY_SIZE");
-
     auto match = re.match(sizestr);
     if (!match.hasMatch()) {
         return 0;
@@ -61,6 +59,12 @@ static size_t memorySize(const QString &options)
 }
 
 
+static size_t memorySize(const QString &options)
+{
+    return parseSize(parseParameter(options, "MEMORY_SIZE"));
+}
+
+
 bool TSharedMemoryKvsDriver::open(const QString &db, const QString &, const QString &, const QString &, uint16_t, const QString &)
 {
     _name = db;
@@ -153,6 +157,23 @@ void TSharedMemoryKvsDriver::initialize(const QString &db, const QString &option
 }
 
 
+/*!
+  Returns the memory limit for the entries specified by MEMORY_LIMIT in
+  the \a options, which is a size such as "512M" or a percentage of the
+  \a mapSize such as "80%". Returns 0 if not specified, in which case
+  entries are evicted only when allocation fails.
+*/
+size_t TSharedMemoryKvsDriver::memoryLimit(const QString &options, size_t mapSize)
+{
+    auto limitstr = parseParameter(options, "MEMORY_LIMIT").trimmed();
+    if (limitstr.endsWith('%')) {
+        double pct = limitstr.chopped(1).toDouble();
+        return (pct > 0 && pct < 100) ? mapSize * pct / 100 : 0;
+    }
+    return qMin(parseSize(limitstr), mapSize);
+}
+
+
 void TSharedMemoryKvsDriver::cleanup()
 {
     if (!_name.isEmpty()) {
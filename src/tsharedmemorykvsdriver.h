@@ -33,6 +33,7 @@ public:
 
 private:
     static void initialize(const QString &db, const QString &options);
+    static size_t memoryLimit(const QString &options, size_t mapSize);
     void cleanup();
 
     QString _name;
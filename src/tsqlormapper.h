@@ -60,6 +60,7 @@ public:
     TSqlORMapper<T> &offset(int offset);
     TSqlORMapper<T> &orderBy(int column, Tf::SortOrder order = Tf::AscendingOrder);
     TSqlORMapper<T> &orderBy(const QString &column, Tf::SortOrder order = Tf::AscendingOrder);
+    TSqlORMapper<T> &keyset(const QVariantList &lastValues = QVariantList());
     template <class C>
     TSqlORMapper<T> &join(int column, const TSqlJoin<C> &join);
 
@@ -67,6 +68,7 @@ public:
     void setOffset(int offset);
     void setSortOrder(int column, Tf::SortOrder order = Tf::AscendingOrder);
     void setSortOrder(const QString &column, Tf::SortOrder order = Tf::AscendingOrder);
+    void setKeyset(const QVariantList &lastValues);
     template <class C>
     void setJoin(int column, const TSqlJoin<C> &join);
     void reset();
@@ -81,6 +83,7 @@ public:
     T first() const;
     T last() const;
     T value(int i) const;
+    QVariantList keysetValues(const T &object) const;
 
     int findCount(const TCriteria &cri = TCriteria());
     int findCountBy(int column, const QVariant &value);
@@ -143,6 +146,8 @@ public:
 protected:
     void setFilter(const QString &filter);
     QString orderBy() const;
+    QList<QPair<QString, Tf::SortOrder>> keysetColumns() const;
+    QString keysetFilter() const;
     virtual QString orderByClause() const { return QString(); }
     virtual void clear();
     virtual QString selectStatement() const;
@@ -153,6 +158,8 @@ private:
     QList<QPair<QString, Tf::SortOrder>> sortColumns;
     int queryLimit {0};
     int queryOffset {0};
+    bool keysetEnabled {false};
+    QVariantList queryKeyset;
     int joinCount {0};
     QStringList joinClauses;
     QStringList joinWhereClauses;
@@ -379,15 +386,53 @@ inline void TSqlORMapper<T>::setSortOrder(const QString &column, Tf::SortOrder o
 {
     if (!column.isEmpty()) {
         T obj;
-        if (obj.propertyNames().contains(column, Qt::CaseInsensitive)) {
-            sortColumns << qMakePair(column, order);
-        } else {
-            tWarn("Unable to set sort order : '%s' column not found in '%s' table",
-                qUtf8Printable(column), qUtf8Printable(obj.tableName()));
+        // Stores the property name as defined, looked up case-insensitively
+        const QStringList names = obj.propertyNames();
+        for (auto &name : names) {
+            if (name.compare(column, Qt::CaseInsensitive) == 0) {
+                sortColumns << qMakePair(name, order);
+                return;
+            }
         }
+        tWarn("Unable to set sort order : '%s' column not found in '%s' table",
+            qUtf8Printable(column), qUtf8Printable(obj.tableName()));
     }
 }
 
+/*!
+  Enables the keyset pagination, which retrieves the rows following the
+  \a lastValues in the sort order instead of skipping the rows of an
+  offset; each page costs the same however deep it is. The \a lastValues
+  are the keys of the last row of the previous page, returned by
+  keysetValues(), or an empty list for the first page.
+
+  The primary key is appended to the sort columns as a tiebreaker, so that
+  the rows are ordered uniquely. The sort columns should be NOT NULL and
+  indexed together with the primary key.
+  \sa keysetValues()
+*/
+template <class T>
+inline void TSqlORMapper<T>::setKeyset(const QVariantList &lastValues)
+{
+    keysetEnabled = true;
+    queryKeyset = lastValues;
+}
+
+/*!
+  Returns the values of the sort columns and the primary key of the
+  \a object, the keys to retrieve the next page with setKeyset().
+  \sa setKeyset()
+*/
+template <class T>
+inline QVariantList TSqlORMapper<T>::keysetValues(const T &object) const
+{
+    QVariantList values;
+    for (auto &p : keysetColumns()) {
+        values << object.property(p.first.toLatin1().constData());
+    }
+    return values;
+}
+
 /*!
   Sets the limit to \a limit, which is the limited number of rows for
   execution of SELECT statement.
@@ -430,6 +475,17 @@ inline TSqlORMapper<T> &TSqlORMapper<T>::orderBy(const QString &column, Tf::Sort
     return *this;
 }
 
+/*!
+  Enables the keyset pagination following the \a lastValues.
+  \sa setKeyset()
+*/
+template <class T>
+inline TSqlORMapper<T> &TSqlORMapper<T>::keyset(const QVariantList &lastValues)
+{
+    setKeyset(lastValues);
+    return *this;
+}
+
 /*!
   Sets the current filter to \a filter.
   The filter is a SQL WHERE clause without the keyword WHERE (for example,
@@ -493,6 +549,13 @@ inline QString TSqlORMapper<T>::selectStatement() const
         }
     }
 
+    if (keysetEnabled && !queryKeyset.isEmpty()) {
+        if (!filter.isEmpty()) {
+            filter += QLatin1String(" AND ");
+        }
+        filter += keysetFilter();
+    }
+
     if (Q_LIKELY(!filter.isEmpty())) {
         query.append(QLatin1String(" WHERE ")).append(filter);
     }
@@ -731,6 +794,8 @@ inline void TSqlORMapper<T>::clear()
     sortColumns.clear();
     queryLimit = 0;
     queryOffset = 0;
+    keysetEnabled = false;
+    queryKeyset.clear();
     joinCount = 0;
     joinClauses.clear();
     joinWhereClauses.clear();
@@ -747,10 +812,11 @@ inline QString TSqlORMapper<T>::orderBy() const
 {
     QString str;
 
-    if (!sortColumns.isEmpty()) {
+    const auto columns = (keysetEnabled) ? keysetColumns() : sortColumns;
+    if (!columns.isEmpty()) {
         str.reserve(64);
         str += QLatin1String(" ORDER BY ");
-        for (auto &p : sortColumns) {
+        for (auto &p : columns) {
             str += QLatin1String("t0.");
             str += TSqlQuery::escapeIdentifier(p.first, QSqlDriver::FieldName, database().driver());
             str += (p.second == Tf::AscendingOrder) ? QLatin1String(" ASC,") : QLatin1String(" DESC,");
@@ -760,3 +826,86 @@ inline QString TSqlORMapper<T>::orderBy() const
     return str;
 }
 
+/*!
+  Returns the columns of the keyset pagination, the sort columns and
+  the primary key.
+*/
+template <class T>
+inline QList<QPair<QString, Tf::SortOrder>> TSqlORMapper<T>::keysetColumns() const
+{
+    QList<QPair<QString, Tf::SortOrder>> columns;
+    const QSqlDriver *driver = database().driver();
+    QString pkName;
+    T obj;
+
+    int pkidx = obj.primaryKeyIndex();
+    if (pkidx >= 0) {
+        const QMetaObject *metaObject = obj.metaObject();
+        pkName = QLatin1String(metaObject->property(metaObject->propertyOffset() + pkidx).name());
+    }
+
+    bool pkSorted = false;
+    for (auto &p : sortColumns) {
+        QString name = (driver) ? driver->stripDelimiters(p.first, QSqlDriver::FieldName) : p.first;
+        pkSorted |= (name.compare(pkName, Qt::CaseInsensitive) == 0);
+        columns << qMakePair(name, p.second);
+    }
+
+    if (!pkSorted && !pkName.isEmpty()) {
+        Tf::SortOrder order = (columns.isEmpty()) ? Tf::AscendingOrder : columns.last().second;
+        columns << qMakePair(pkName, order);
+    }
+    return columns;
+}
+
+/*!
+  Returns a SQL WHERE condition for the rows following the keys of the
+  keyset pagination, such as "(t0.a, t0.id) > (1, 2)".
+*/
+template <class T>
+inline QString TSqlORMapper<T>::keysetFilter() const
+{
+    const auto columns = keysetColumns();
+    const QSqlDriver *driver = database().driver();
+
+    if (columns.count() != queryKeyset.count()) {
+        tWarn("Invalid keyset: %d values for %d columns in '%s' table",
+            (int)queryKeyset.count(), (int)columns.count(), qUtf8Printable(tableName()));
+        return QStringLiteral("1=0");
+    }
+
+    QStringList names;
+    QStringList values;
+    bool uniform = true;
+    for (int i = 0; i < columns.count(); ++i) {
+        QString name = QStringLiteral("t0.");
+        name += TSqlQuery::escapeIdentifier(columns[i].first, QSqlDriver::FieldName, driver);
+        names << name;
+        values << TSqlQuery::formatValue(queryKeyset[i], database());
+        uniform &= (columns[i].second == columns[0].second);
+    }
+
+    auto op = [&](int i) {
+        return (columns[i].second == Tf::AscendingOrder) ? QLatin1String(" > ") : QLatin1String(" < ");
+    };
+
+    // Row value comparison, which the index of the columns serves
+    auto dbms = (driver) ? driver->dbmsType() : QSqlDriver::UnknownDbms;
+    if (uniform && (dbms == QSqlDriver::PostgreSQL || dbms == QSqlDriver::MySqlServer || dbms == QSqlDriver::SQLite)) {
+        return QLatin1Char('(') + names.join(QLatin1String(", ")) + QLatin1Char(')') + op(0)
+            + QLatin1Char('(') + values.join(QLatin1String(", ")) + QLatin1Char(')');
+    }
+
+    // Expanded for mixed orders and other databases;
+    //  (a > 1 OR (a = 1 AND (b > 2 OR (b = 2 AND c > 3))))
+    QString filter;
+    for (int i = columns.count() - 1; i >= 0; --i) {
+        QString cond = names[i] + op(i) + values[i];
+        if (!filter.isEmpty()) {
+            cond = QLatin1Char('(') + cond + QLatin1String(" OR (") + names[i] + QLatin1String(" = ") + values[i]
+                + QLatin1String(" AND ") + filter + QLatin1String("))");
+        }
+        filter = cond;
+    }
+    return filter;
+}
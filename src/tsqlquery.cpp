@@ -6,8 +6,10 @@
  */
 
 #include "tsystemglobal.h"
+#include "tmetrics.h"
 #include "tsqldatabase.h"
 #include "tsqldriverextension.h"
+#include "ttrace.h"
 #include <TAppSettings>
 #include <TSqlQuery>
 #include <TWebApplication>
@@ -226,6 +228,8 @@ TSqlQuery &TSqlQuery::prepare(const QString &query)
 */
 bool TSqlQuery::exec(const QString &query)
 {
+    TMetrics::Timer metricsTimer(TMetrics::SqlQuery);
+    TTrace::Span span(TTrace::SqlQuery);
     QElapsedTimer time;
     time.start();
     bool ret = QSqlQuery::exec(query);
@@ -239,6 +243,8 @@ bool TSqlQuery::exec(const QString &query)
 */
 bool TSqlQuery::exec()
 {
+    TMetrics::Timer metricsTimer(TMetrics::SqlQuery);
+    TTrace::Span span(TTrace::SqlQuery);
     bool ret = false;
     QElapsedTimer time;
     time.start();
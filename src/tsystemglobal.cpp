@@ -8,6 +8,7 @@
 #include "tsystemglobal.h"
 #include "taccesslogstream.h"
 #include "tfilesystemlogger.h"
+#include "tloglayout.h"
 #include <QByteArray>
 #include <QDateTime>
 #include <QDir>
@@ -25,12 +26,9 @@ namespace {
 TAccessLogStream *accesslogstrm = nullptr;
 TAccessLogStream *sqllogstrm = nullptr;
 TSystemLogger *systemLogger = nullptr;
-QByteArray syslogLayout;
-QByteArray syslogDateTimeFormat;
-QByteArray accessLogLayout;
-QByteArray accessLogDateTimeFormat;
-QByteArray queryLogLayout;
-QByteArray queryLogDateTimeFormat;
+TLogLayout syslogLayout;
+TLogLayout accessLogLayout;
+TLogLayout queryLogLayout;
 
 
 void tSystemMessage(int priority, const char *msg, va_list ap)
@@ -40,7 +38,7 @@ void tSystemMessage(int priority, const char *msg, va_list ap)
     }
 
     TLog log(priority, QString::vasprintf(msg, ap).toLocal8Bit());
-    QByteArray buf = TLogger::logToByteArray(log, syslogLayout, syslogDateTimeFormat);
+    QByteArray buf = syslogLayout.format(log);
     systemLogger->write(buf.data(), buf.length());
 }
 }
@@ -49,7 +47,7 @@ void tSystemMessage(int priority, const char *msg, va_list ap)
 void Tf::writeAccessLog(const TAccessLog &log)
 {
     if (accesslogstrm) {
-        accesslogstrm->writeLog(log.toByteArray(accessLogLayout, accessLogDateTimeFormat));
+        accesslogstrm->writeLog(accessLogLayout.format(log));
     }
 }
 
@@ -70,8 +68,8 @@ void Tf::setupSystemLogger(TSystemLogger *logger)
     systemLogger = (logger) ? logger : new TFileSystemLogger(Tf::app()->systemLogFilePath());
     systemLogger->open();
 
-    syslogLayout = Tf::appSettings()->value(Tf::SystemLogLayout).toByteArray();
-    syslogDateTimeFormat = Tf::appSettings()->value(Tf::SystemLogDateTimeFormat).toByteArray();
+    syslogLayout.compile(Tf::appSettings()->value(Tf::SystemLogLayout).toByteArray(),
+        Tf::appSettings()->value(Tf::SystemLogDateTimeFormat).toByteArray());
 }
 
 
@@ -90,11 +88,12 @@ void Tf::setupAccessLogger()
     // access log
     QString accesslogpath = Tf::app()->accessLogFilePath();
     if (!accesslogstrm && !accesslogpath.isEmpty()) {
-        accesslogstrm = new TAccessLogStream(accesslogpath);
+        bool async = Tf::appSettings()->value(Tf::AccessLogEnableAsyncWrite).toBool();
+        accesslogstrm = new TAccessLogStream(accesslogpath, async);
     }
 
-    accessLogLayout = Tf::appSettings()->value(Tf::AccessLogLayout).toByteArray();
-    accessLogDateTimeFormat = Tf::appSettings()->value(Tf::AccessLogDateTimeFormat).toByteArray();
+    accessLogLayout.compile(Tf::appSettings()->value(Tf::AccessLogLayout).toByteArray(),
+        Tf::appSettings()->value(Tf::AccessLogDateTimeFormat).toByteArray(), TLogLayout::AccessLog);
 }
 
 
@@ -116,11 +115,12 @@ void Tf::setupQueryLogger()
     // sql query log
     QString querylogpath = Tf::app()->sqlQueryLogFilePath();
     if (!sqllogstrm && !querylogpath.isEmpty()) {
-        sqllogstrm = new TAccessLogStream(querylogpath);
+        bool async = Tf::appSettings()->value(Tf::SqlQueryLogEnableAsyncWrite).toBool();
+        sqllogstrm = new TAccessLogStream(querylogpath, async);
     }
 
-    queryLogLayout = Tf::appSettings()->value(Tf::SqlQueryLogLayout).toByteArray();
-    queryLogDateTimeFormat = Tf::appSettings()->value(Tf::SqlQueryLogDateTimeFormat).toByteArray();
+    queryLogLayout.compile(Tf::appSettings()->value(Tf::SqlQueryLogLayout).toByteArray(),
+        Tf::appSettings()->value(Tf::SqlQueryLogDateTimeFormat).toByteArray());
 }
 
 
@@ -192,8 +192,7 @@ void Tf::traceQueryLog(int duration, const char *msg, ...)
         va_list ap;
         va_start(ap, msg);
         TLog log(-1, QString::vasprintf(msg, ap).toLocal8Bit(), duration);
-        QByteArray buf = TLogger::logToByteArray(log, queryLogLayout, queryLogDateTimeFormat);
-        sqllogstrm->writeLog(buf);
+        sqllogstrm->writeLog(queryLogLayout.format(log));
         va_end(ap);
     }
 }
@@ -30,7 +30,9 @@ enum SystemOpCode {
     WebSocketSendBinary = 0x02,
     WebSocketPublishText = 0x03,
     WebSocketPublishBinary = 0x04,
-    MaxOpCode = 0x04,
+    CacheInvalidate = 0x05,
+    MetricsSnapshot = 0x06,
+    MaxOpCode = 0x06,
 };
 
 T_CORE_EXPORT QMap<QString, QVariant> settingsToMap(QSettings &settings, const QString &env = QString());
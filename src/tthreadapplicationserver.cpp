@@ -5,6 +5,7 @@
  * the New BSD License, which is incorporated herein by reference.
  */
 
+#include "tactionthreadpool.h"
 #include "tsystemglobal.h"
 #include <TActionThread>
 #include <TThreadApplicationServer>
@@ -17,10 +18,9 @@
   an web application server for thread.
 */
 
-TStack<TActionThread *> *TThreadApplicationServer::threadPoolPtr()
+TThreadApplicationServer::~TThreadApplicationServer()
 {
-    static TStack<TActionThread *> threadPool;
-    return &threadPool;
+    delete threadPool;
 }
 
 
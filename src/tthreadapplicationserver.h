@@ -1,5 +1,4 @@
 #pragma once
-#include "tstack.h"
 #include <QBasicTimer>
 #include <QTcpServer>
 #include <QtGlobal>
@@ -7,28 +6,31 @@
 #include <TApplicationServerBase>
 #include <TGlobal>
 
+class TActionThreadPool;
+
 
 #if defined(Q_OS_WIN) || defined(Q_OS_DARWIN)
 class T_CORE_EXPORT TThreadApplicationServer : public QTcpServer, public TApplicationServerBase {
     Q_OBJECT
 public:
     TThreadApplicationServer(int listeningSocket, QObject *parent = 0);
-    ~TThreadApplicationServer() { }
+    ~TThreadApplicationServer();
 
     bool start(bool debugMode) override;
     void stop() override;
     void setAutoReloadingEnabled(bool enable) override;
     bool isAutoReloadingEnabled() override;
 
+    static bool parkKeepAliveSocket(int socketDescriptor) { Q_UNUSED(socketDescriptor); return false; }
+
 protected:
     void incomingConnection(qintptr socketDescriptor) override;
     void timerEvent(QTimerEvent *event) override;
 
 private:
-    static TStack<TActionThread *> *threadPoolPtr();
-
     int listenSocket {0};
     int maxThreads {0};
+    TActionThreadPool *threadPool {nullptr};
     QBasicTimer reloadTimer;
 
     T_DISABLE_COPY(TThreadApplicationServer)
@@ -39,23 +41,26 @@ class T_CORE_EXPORT TThreadApplicationServer : public QThread, public TApplicati
     Q_OBJECT
 public:
     TThreadApplicationServer(int listeningSocket, QObject *parent = 0);
-    ~TThreadApplicationServer() { }
+    ~TThreadApplicationServer();
 
     bool start(bool debugMode) override;
     void stop() override;
     void setAutoReloadingEnabled(bool enable) override;
     bool isAutoReloadingEnabled() override;
 
+    static bool parkKeepAliveSocket(int socketDescriptor);
+
 protected:
     void incomingConnection(qintptr socketDescriptor);
     void timerEvent(QTimerEvent *event) override;
     void run() override;
 
 private:
-    static TStack<TActionThread *> *threadPoolPtr();
+    void closeIdleSockets();
 
     int listenSocket {0};
     int maxThreads {0};
+    TActionThreadPool *threadPool {nullptr};
     QBasicTimer reloadTimer;
     bool stopFlag {false};
 
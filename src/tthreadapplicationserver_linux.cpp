@@ -5,15 +5,37 @@
  * the New BSD License, which is incorporated herein by reference.
  */
 
+#include "tactionthreadpool.h"
 #include "tfcore_unix.h"
 #include "tkvsdatabasepool.h"
+#include "tsessionmanager.h"
 #include "tsqldatabasepool.h"
 #include "tsystemglobal.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <TActionThread>
 #include <TAppSettings>
 #include <TThreadApplicationServer>
 #include <TWebApplication>
-#include <thread>
+#include <sys/epoll.h>
+
+namespace {
+
+// Keep-alive sockets waiting for the next request without a thread
+int parkingEpollFd = 0;
+QMutex parkingMutex;
+QHash<int, int64_t> parkedSockets;  // socket, parked time (msecs)
+
+
+void closeParkedSocket(int socketDescriptor)
+{
+    tf_epoll_ctl(parkingEpollFd, EPOLL_CTL_DEL, socketDescriptor, nullptr);
+    tf_close_socket(socketDescriptor);
+}
+
+}
 
 
 TThreadApplicationServer::TThreadApplicationServer(int listeningSocket, QObject *parent) :
@@ -29,14 +51,21 @@ TThreadApplicationServer::TThreadApplicationServer(int listeningSocket, QObject
     }
     tSystemDebug("MaxThreads: %d", maxThreads);
 
+    bool parking = Tf::appSettings()->readValue(QLatin1String("MPM.") + mpm + ".EnableKeepAliveParking", false).toBool();
+    if (parking && !parkingEpollFd) {
+        parkingEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (parkingEpollFd < 0) {
+            tSystemError("Failed epoll_create1()");
+            parkingEpollFd = 0;
+        }
+    }
+
     // Thread pooling
-    for (int i = 0; i < maxThreads; i++) {
-        TActionThread *thread = new TActionThread(0);
-        connect(thread, &TActionThread::finished, [=]() {
-            threadPoolPtr()->push(thread);
-        });
-        threadPoolPtr()->push(thread);
+    int minThreads = Tf::appSettings()->readValue(QLatin1String("MPM.") + mpm + ".MinThreadsPerAppServer").toInt();
+    if (minThreads <= 0) {
+        minThreads = maxThreads;
     }
+    threadPool = new TActionThreadPool(minThreads, maxThreads);
 }
 
 
@@ -61,11 +90,16 @@ bool TThreadApplicationServer::start(bool debugMode)
         return false;
     }
 
+    if (!setupTls()) {
+        return false;
+    }
+
     // To work a timer in main thread
     TSqlDatabasePool::instance();
     TKvsDatabasePool::instance();
 
     TStaticInitializeThread::exec();
+    TSessionManager::instance().startGarbageCollector();
     QThread::start();
     return true;
 }
@@ -84,6 +118,7 @@ void TThreadApplicationServer::stop()
     if (!isAutoReloadingEnabled()) {
         TActionThread::waitForAllDone(10000);
     }
+    threadPool->stop();
     TStaticReleaseThread::exec();
 }
 
@@ -91,6 +126,70 @@ void TThreadApplicationServer::stop()
 void TThreadApplicationServer::run()
 {
     constexpr int timeout = 500;  // msec
+
+    if (parkingEpollFd > 0) {
+        // Watches the listening socket together with the parked sockets
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = listenSocket;
+        if (tf_epoll_ctl(parkingEpollFd, EPOLL_CTL_ADD, listenSocket, &ev) < 0) {
+            tSystemError("Failed epoll_ctl (EPOLL_CTL_ADD)  sd:%d", listenSocket);
+            return;
+        }
+
+        constexpr int MaxEvents = 128;
+        struct epoll_event events[MaxEvents];
+        QElapsedTimer idleTimer;
+        idleTimer.start();
+
+        while (listenSocket > 0 && !stopFlag) {
+            int num = tf_epoll_wait(parkingEpollFd, events, MaxEvents, timeout);
+            if (num < 0) {
+                tSystemError("epoll_wait error");
+                break;
+            }
+
+            for (int i = 0; i < num; i++) {
+                int fd = events[i].data.fd;
+
+                if (fd == listenSocket) {
+                    int socketDescriptor = tf_accept4(listenSocket, nullptr, nullptr, (SOCK_CLOEXEC | SOCK_NONBLOCK));
+                    if (socketDescriptor > 0) {
+                        threadPool->start(socketDescriptor);
+                    }
+                    continue;
+                }
+
+                // Next request arrived on a parked socket
+                QMutexLocker locker(&parkingMutex);
+                if (!parkedSockets.remove(fd)) {
+                    continue;  // already closed
+                }
+                locker.unlock();
+
+                if ((events[i].events & (EPOLLHUP | EPOLLERR)) || !(events[i].events & EPOLLIN)) {
+                    closeParkedSocket(fd);
+                } else {
+                    tf_epoll_ctl(parkingEpollFd, EPOLL_CTL_DEL, fd, nullptr);
+                    threadPool->start(fd);
+                }
+            }
+
+            if (idleTimer.elapsed() >= 1000) {
+                closeIdleSockets();
+                idleTimer.start();
+            }
+        }
+
+        tf_epoll_ctl(parkingEpollFd, EPOLL_CTL_DEL, listenSocket, nullptr);
+        QMutexLocker locker(&parkingMutex);
+        for (auto it = parkedSockets.cbegin(); it != parkedSockets.cend(); ++it) {
+            closeParkedSocket(it.key());
+        }
+        parkedSockets.clear();
+        return;
+    }
+
     struct pollfd pfd;
 
     while (listenSocket > 0 && !stopFlag) {
@@ -107,18 +206,56 @@ void TThreadApplicationServer::run()
         if (ret > 0 && (pfd.revents & POLLIN)) {
             int socketDescriptor = tf_accept4(listenSocket, nullptr, nullptr, (SOCK_CLOEXEC | SOCK_NONBLOCK));
             if (socketDescriptor > 0) {
-                tSystemDebug("incomingConnection  sd:%d  thread count:%d  max:%d", socketDescriptor, TActionThread::threadCount(), maxThreads);
-                TActionThread *thread;
+                threadPool->start(socketDescriptor);
+            }
+        }
+    }
+}
 
-                while (!threadPoolPtr()->pop(thread)) {
-                    std::this_thread::yield();
-                    Tf::msleep(1);
-                }
 
-                tSystemDebug("thread ptr: %ld", (uint64_t)thread);
-                thread->setSocketDescriptor(socketDescriptor);
-                thread->start();
-            }
+/*!
+  Parks the keep-alive socket \a socketDescriptor until the next request
+  arrives, so that the action thread can return to the pool. Returns
+  false if the keep-alive parking is disabled.
+*/
+bool TThreadApplicationServer::parkKeepAliveSocket(int socketDescriptor)
+{
+    if (parkingEpollFd <= 0 || socketDescriptor <= 0) {
+        return false;
+    }
+
+    QMutexLocker locker(&parkingMutex);
+    parkedSockets.insert(socketDescriptor, Tf::getMSecsSinceEpoch());
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.fd = socketDescriptor;
+    if (tf_epoll_ctl(parkingEpollFd, EPOLL_CTL_ADD, socketDescriptor, &ev) < 0) {
+        tSystemError("Failed epoll_ctl (EPOLL_CTL_ADD)  sd:%d", socketDescriptor);
+        parkedSockets.remove(socketDescriptor);
+        return false;
+    }
+    tSystemDebug("Parked keep-alive socket  sd:%d", socketDescriptor);
+    return true;
+}
+
+
+void TThreadApplicationServer::closeIdleSockets()
+{
+    const int keepAliveTimeout = TActionContext::keepAliveTimeout();
+    if (keepAliveTimeout <= 0) {
+        return;
+    }
+
+    const int64_t limit = Tf::getMSecsSinceEpoch() - keepAliveTimeout * 1000LL;
+    QMutexLocker locker(&parkingMutex);
+    for (auto it = parkedSockets.begin(); it != parkedSockets.end();) {
+        if (it.value() <= limit) {
+            tSystemDebug("KeepAlive timeout: socket:%d", it.key());
+            closeParkedSocket(it.key());
+            it = parkedSockets.erase(it);
+        } else {
+            ++it;
         }
     }
 }
@@ -5,12 +5,13 @@
  * the New BSD License, which is incorporated herein by reference.
  */
 
+#include "tactionthreadpool.h"
+#include "tsessionmanager.h"
 #include "tsystemglobal.h"
 #include <TActionThread>
 #include <TAppSettings>
 #include <TThreadApplicationServer>
 #include <TWebApplication>
-#include <thread>
 
 
 TThreadApplicationServer::TThreadApplicationServer(int listeningSocket, QObject *parent) :
@@ -27,13 +28,11 @@ TThreadApplicationServer::TThreadApplicationServer(int listeningSocket, QObject
     tSystemDebug("MaxThreads: %d", maxThreads);
 
     // Thread pooling
-    for (int i = 0; i < maxThreads; i++) {
-        TActionThread *thread = new TActionThread(0);
-        connect(thread, &TActionThread::finished, [=]() {
-            threadPoolPtr()->push(thread);
-        });
-        threadPoolPtr()->push(thread);
+    int minThreads = Tf::appSettings()->readValue(QLatin1String("MPM.") + mpm + ".MinThreadsPerAppServer").toInt();
+    if (minThreads <= 0) {
+        minThreads = maxThreads;
     }
+    threadPool = new TActionThreadPool(minThreads, maxThreads);
 
     Q_ASSERT(Tf::app()->multiProcessingModule() == TWebApplication::Thread);
 }
@@ -55,12 +54,17 @@ bool TThreadApplicationServer::start(bool debugMode)
         }
     }
 
+    if (!setupTls()) {
+        return false;
+    }
+
     if (listenSocket <= 0 || !setSocketDescriptor(listenSocket)) {
         tSystemError("Failed to set socket descriptor: %d", listenSocket);
         return false;
     }
 
     TStaticInitializeThread::exec();
+    TSessionManager::instance().startGarbageCollector();
     return true;
 }
 
@@ -77,6 +81,7 @@ void TThreadApplicationServer::stop()
     if (!isAutoReloadingEnabled()) {
         TActionThread::waitForAllDone(10000);
     }
+    threadPool->stop();
     TStaticReleaseThread::exec();
 }
 
@@ -84,13 +89,5 @@ void TThreadApplicationServer::stop()
 void TThreadApplicationServer::incomingConnection(qintptr socketDescriptor)
 {
     tSystemDebug("incomingConnection  sd:%lld  thread count:%d  max:%d", (int64_t)socketDescriptor, TActionThread::threadCount(), maxThreads);
-    TActionThread *thread;
-    while (!threadPoolPtr()->pop(thread)) {
-        std::this_thread::yield();
-        //qApp->processEvents(QEventLoop::ExcludeSocketNotifiers);
-        Tf::msleep(1);
-    }
-    tSystemDebug("thread ptr: %lld", (uint64_t)thread);
-    thread->setSocketDescriptor(socketDescriptor);
-    thread->start();
+    threadPool->start(socketDescriptor);
 }
@@ -0,0 +1,122 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "ttimerwheel.h"
+#include <chrono>
+
+/*!
+  \class TTimerWheel
+  \brief The TTimerWheel class is a hashed timing wheel with a tick of
+  one second.
+
+  The timers are linked into the slots of their deadlines, so starting,
+  restarting and stopping a timer take constant time, and expire()
+  visits only the slots of the seconds passed. A timer whose deadline
+  is further than a round of the wheel stays in its slot until the
+  deadline comes. The wheel is not thread-safe.
+*/
+
+TTimerWheel::TTimerWheel() :
+    _current(clock())
+{
+    for (auto &head : _slots) {
+        head.prev = &head;
+        head.next = &head;
+    }
+}
+
+
+TTimerWheel::~TTimerWheel()
+{
+    for (auto &head : _slots) {
+        while (head.next != &head) {
+            stop(head.next);
+        }
+    }
+}
+
+/*!
+  Returns the seconds of the monotonic clock.
+*/
+int64_t TTimerWheel::clock()
+{
+    using namespace std::chrono;
+    return duration_cast<seconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+TTimerWheel::Timer *TTimerWheel::slot(int64_t deadline)
+{
+    // A deadline passed expires at the next tick
+    deadline = std::max(deadline, _current + 1);
+    return &_slots[deadline & (NumSlots - 1)];
+}
+
+/*!
+  Starts or restarts the \a timer to expire at the \a deadline in
+  seconds of the wheel clock.
+*/
+void TTimerWheel::start(Timer *timer, int64_t deadline)
+{
+    if (isActive(timer)) {
+        if (slot(timer->deadline) == slot(deadline)) {
+            timer->deadline = deadline;
+            return;
+        }
+        stop(timer);
+    }
+
+    Timer *head = slot(deadline);
+    timer->deadline = deadline;
+    timer->prev = head->prev;
+    timer->next = head;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+/*!
+  Stops the \a timer.
+*/
+void TTimerWheel::stop(Timer *timer)
+{
+    if (!isActive(timer)) {
+        return;
+    }
+
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->prev = nullptr;
+    timer->next = nullptr;
+}
+
+/*!
+  Advances the wheel clock to \a now and returns the timers expired,
+  which are stopped.
+*/
+QList<TTimerWheel::Timer *> TTimerWheel::expire(int64_t now)
+{
+    QList<Timer *> expired;
+    if (now <= _current) {
+        return expired;
+    }
+
+    int64_t ticks = std::min(now - _current, (int64_t)NumSlots);
+    _current = now;
+
+    for (int64_t t = now - ticks + 1; t <= now; t++) {
+        Timer *head = &_slots[t & (NumSlots - 1)];
+        for (Timer *timer = head->next; timer != head;) {
+            Timer *next = timer->next;
+            if (timer->deadline <= now) {
+                stop(timer);
+                expired << timer;
+            }
+            timer = next;
+        }
+    }
+    return expired;
+}
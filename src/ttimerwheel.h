@@ -0,0 +1,38 @@
+#pragma once
+#include <QList>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TTimerWheel {
+public:
+    struct Timer {
+        Timer *prev {nullptr};
+        Timer *next {nullptr};
+        int64_t deadline {0};  // secs of the wheel clock
+        void *data {nullptr};
+    };
+
+    TTimerWheel();
+    ~TTimerWheel();
+
+    void start(Timer *timer, int64_t deadline);
+    void stop(Timer *timer);
+    static bool isActive(const Timer *timer) { return timer->next; }
+    int64_t currentTime() const { return _current; }
+    QList<Timer *> expire(int64_t now);
+
+    static int64_t clock();
+
+private:
+    enum {
+        NumSlots = 64,  // must be a power of 2
+    };
+
+    Timer *slot(int64_t deadline);
+
+    Timer _slots[NumSlots];
+    int64_t _current {0};
+
+    T_DISABLE_COPY(TTimerWheel)
+    T_DISABLE_MOVE(TTimerWheel)
+};
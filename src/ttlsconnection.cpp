@@ -0,0 +1,197 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "ttlsconnection.h"
+#include "tfcore.h"
+#include "tsystemglobal.h"
+#include "ttlscontext.h"
+#include <cerrno>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+/*!
+  \class TTlsConnection
+  \brief The TTlsConnection class provides the server side of a TLS
+  connection over a non-blocking socket.
+
+  The functions read() and write() behave like recv(2) and send(2);
+  they return -1 and set errno to EAGAIN when the operation would block,
+  so that the callers can wait for the socket as for a plain one.
+*/
+
+
+TTlsConnection::TTlsConnection(const TTlsContext *context, int socket) :
+    _ssl(context->createSsl(socket)),
+    _socket(socket)
+{
+}
+
+
+TTlsConnection::~TTlsConnection()
+{
+    if (_ssl) {
+        SSL_free(_ssl);
+    }
+}
+
+/*!
+  Performs the TLS handshake without blocking.
+  Returns 1 if the connection is established, 0 if the handshake is
+  in progress and -1 if an error occurred.
+*/
+int TTlsConnection::handshake()
+{
+    if (_established) {
+        return 1;
+    }
+
+    if (Q_UNLIKELY(!_ssl)) {
+        return -1;
+    }
+
+    ERR_clear_error();
+    int ret = SSL_do_handshake(_ssl);
+    if (ret == 1) {
+        _established = true;
+        _wantsWrite = false;
+#ifdef BIO_get_ktls_send
+        _kernelTlsSend = BIO_get_ktls_send(SSL_get_wbio(_ssl));
+#endif
+        tSystemDebug("TLS handshake done  sd:%d  %s  resumed:%d  ktls:%d", _socket, SSL_get_version(_ssl), isSessionReused(), _kernelTlsSend);
+        return 1;
+    }
+
+    if (error(ret) < 0 && errno == EAGAIN) {
+        return 0;
+    }
+
+    tSystemDebug("TLS handshake failed  sd:%d  %s", _socket, TTlsContext::lastErrorString().data());
+    return -1;
+}
+
+/*!
+  Reads at most \a size bytes into \a data.
+  Returns the number of bytes read, 0 if the peer closed the connection,
+  or -1 if an error occurred.
+*/
+int TTlsConnection::read(void *data, int size)
+{
+    if (Q_UNLIKELY(!_established)) {
+        int res = handshake();
+        if (res <= 0) {
+            errno = (res == 0) ? EAGAIN : ECONNRESET;
+            return -1;
+        }
+    }
+
+    ERR_clear_error();
+    int ret = SSL_read(_ssl, data, size);
+    return (ret > 0) ? ret : error(ret);
+}
+
+/*!
+  Writes at most \a size bytes of \a data.
+  Returns the number of bytes written, or -1 if an error occurred.
+*/
+int TTlsConnection::write(const void *data, int size)
+{
+    if (Q_UNLIKELY(!_established)) {
+        int res = handshake();
+        if (res <= 0) {
+            errno = (res == 0) ? EAGAIN : ECONNRESET;
+            return -1;
+        }
+    }
+
+    if (_kernelTlsSend) {
+        // The kernel encrypts the records
+        return tf_send(_socket, data, size);
+    }
+
+    ERR_clear_error();
+    int ret = SSL_write(_ssl, data, size);
+    return (ret > 0) ? ret : error(ret);
+}
+
+/*!
+  Returns the number of bytes decrypted and buffered, which can be read
+  without waiting for the socket.
+*/
+int TTlsConnection::pending() const
+{
+    return (_ssl) ? SSL_pending(_ssl) : 0;
+}
+
+/*!
+  Sends the close_notify alert if possible, without blocking.
+*/
+void TTlsConnection::shutdown()
+{
+    if (_ssl && _established) {
+        ERR_clear_error();
+        SSL_shutdown(_ssl);
+        ERR_clear_error();
+        _established = false;
+    }
+}
+
+/*!
+  Returns the protocol selected by ALPN, or an empty byte array.
+*/
+QByteArray TTlsConnection::alpnProtocol() const
+{
+    const unsigned char *proto = nullptr;
+    unsigned int len = 0;
+
+    if (_ssl) {
+        SSL_get0_alpn_selected(_ssl, &proto, &len);
+    }
+    return QByteArray((const char *)proto, len);
+}
+
+/*!
+  Returns true if the session was resumed by the handshake.
+*/
+bool TTlsConnection::isSessionReused() const
+{
+    return _ssl && SSL_session_reused(_ssl);
+}
+
+
+int TTlsConnection::error(int ret)
+{
+    int err = SSL_get_error(_ssl, ret);
+    _wantsWrite = false;
+
+    switch (err) {
+    case SSL_ERROR_WANT_READ:
+        errno = EAGAIN;
+        return -1;
+
+    case SSL_ERROR_WANT_WRITE:
+        _wantsWrite = true;
+        errno = EAGAIN;
+        return -1;
+
+    case SSL_ERROR_ZERO_RETURN:  // close_notify
+        errno = 0;
+        return 0;
+
+    case SSL_ERROR_SYSCALL:
+        if (ret == 0 || errno == 0) {
+            errno = 0;
+            return 0;  // EOF
+        }
+        return -1;
+
+    default:
+        tSystemDebug("TLS error  sd:%d  %s", _socket, TTlsContext::lastErrorString().data());
+        errno = ECONNRESET;
+        return -1;
+    }
+}
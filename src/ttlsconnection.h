@@ -0,0 +1,38 @@
+#pragma once
+#include <QByteArray>
+#include <TGlobal>
+
+class TTlsContext;
+typedef struct ssl_st SSL;
+
+
+class T_CORE_EXPORT TTlsConnection {
+public:
+    TTlsConnection(const TTlsContext *context, int socket);
+    ~TTlsConnection();
+
+    bool isValid() const { return (bool)_ssl; }
+    bool isEstablished() const { return _established; }
+    int handshake();
+    int read(void *data, int size);
+    int write(const void *data, int size);
+    int pending() const;
+    bool wantsWrite() const { return _wantsWrite; }
+    void shutdown();
+
+    QByteArray alpnProtocol() const;
+    bool isSessionReused() const;
+    bool isKernelTlsSendEnabled() const { return _kernelTlsSend; }
+
+private:
+    int error(int ret);
+
+    SSL *_ssl {nullptr};
+    int _socket {0};
+    bool _established {false};
+    bool _wantsWrite {false};
+    bool _kernelTlsSend {false};
+
+    T_DISABLE_COPY(TTlsConnection)
+    T_DISABLE_MOVE(TTlsConnection)
+};
@@ -0,0 +1,241 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "ttlscontext.h"
+#include "tsystemglobal.h"
+#include <QDir>
+#include <TAppSettings>
+#include <TWebApplication>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+/*!
+  \class TTlsContext
+  \brief The TTlsContext class holds the TLS configuration shared by the
+  connections which the application server accepts.
+
+  It is configured by the TLS settings in the application.ini.
+  The server-side session cache and the session tickets enable session
+  resumption, and the ALPN protocol is selected from the protocols set
+  by setAlpnProtocols(). If kernel TLS is enabled and supported by
+  the kernel and OpenSSL, the record encryption is offloaded to the
+  kernel after the handshake.
+
+  The session cache and the session ticket keys are held in memory by
+  each application server process, so a session cannot be resumed by
+  another server process nor after a restart; the client falls back to
+  a full handshake then.
+*/
+
+namespace {
+
+constexpr char SessionIdContext[] = "treefrog";
+
+
+int selectAlpnProtocol(SSL *, const unsigned char **out, unsigned char *outlen, const unsigned char *in, unsigned int inlen, void *arg)
+{
+    const QByteArray *protocols = static_cast<const QByteArray *>(arg);
+    unsigned char *selected = nullptr;
+
+    if (protocols->isEmpty()) {
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+
+    int res = SSL_select_next_proto(&selected, outlen, (const unsigned char *)protocols->constData(), protocols->length(), in, inlen);
+    if (res != OPENSSL_NPN_NEGOTIATED) {
+        return SSL_TLSEXT_ERR_NOACK;  // continues without ALPN
+    }
+    *out = selected;
+    return SSL_TLSEXT_ERR_OK;
+}
+
+}  // namespace
+
+
+TTlsContext::TTlsContext() :
+    _ctx(SSL_CTX_new(TLS_server_method()))
+{
+    if (Q_UNLIKELY(!_ctx)) {
+        tSystemError("Failed to create TLS context: %s", lastErrorString().data());
+        return;
+    }
+
+    SSL_CTX_set_min_proto_version(_ctx, TLS1_2_VERSION);
+    SSL_CTX_set_options(_ctx, SSL_OP_NO_COMPRESSION | SSL_OP_CIPHER_SERVER_PREFERENCE);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+    SSL_CTX_set_options(_ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);  // treats EOF as close_notify
+#endif
+    // Allows the retry of SSL_write() with a partial buffer
+    SSL_CTX_set_mode(_ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_RELEASE_BUFFERS);
+
+    // Session resumption
+    SSL_CTX_set_session_cache_mode(_ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_session_id_context(_ctx, (const unsigned char *)SessionIdContext, sizeof(SessionIdContext) - 1);
+
+    SSL_CTX_set_alpn_select_cb(_ctx, selectAlpnProtocol, &_alpnProtocols);
+}
+
+
+TTlsContext::~TTlsContext()
+{
+    if (_ctx) {
+        SSL_CTX_free(_ctx);
+    }
+}
+
+/*!
+  Loads the certificate chain and the private key in PEM format.
+*/
+bool TTlsContext::loadCertificate(const QString &certificateFile, const QString &privateKeyFile)
+{
+    _valid = false;
+
+    if (Q_UNLIKELY(!_ctx)) {
+        return false;
+    }
+
+    if (SSL_CTX_use_certificate_chain_file(_ctx, qUtf8Printable(certificateFile)) != 1) {
+        tSystemError("Failed to load certificate: %s  %s", qUtf8Printable(certificateFile), lastErrorString().data());
+        return false;
+    }
+
+    if (SSL_CTX_use_PrivateKey_file(_ctx, qUtf8Printable(privateKeyFile), SSL_FILETYPE_PEM) != 1) {
+        tSystemError("Failed to load private key: %s  %s", qUtf8Printable(privateKeyFile), lastErrorString().data());
+        return false;
+    }
+
+    if (SSL_CTX_check_private_key(_ctx) != 1) {
+        tSystemError("Private key does not match the certificate: %s", lastErrorString().data());
+        return false;
+    }
+
+    _valid = true;
+    return true;
+}
+
+/*!
+  Sets the ALPN protocols which the server supports in order of
+  preference, such as "http/1.1".
+*/
+void TTlsContext::setAlpnProtocols(const QByteArrayList &protocols)
+{
+    _alpnProtocols.clear();
+    for (auto &proto : protocols) {
+        if (!proto.isEmpty() && proto.length() < 256) {
+            _alpnProtocols += (char)proto.length();
+            _alpnProtocols += proto;
+        }
+    }
+}
+
+/*!
+  Sets the maximum number of the sessions in the server-side cache.
+*/
+void TTlsContext::setSessionCacheSize(int size)
+{
+    if (_ctx) {
+        SSL_CTX_sess_set_cache_size(_ctx, qMax(size, 0));
+    }
+}
+
+/*!
+  Enables the kernel TLS offload if \a enable is true.
+*/
+void TTlsContext::setKernelTlsEnabled(bool enable)
+{
+    _kernelTls = false;
+#ifdef SSL_OP_ENABLE_KTLS
+    if (_ctx) {
+        if (enable) {
+            SSL_CTX_set_options(_ctx, SSL_OP_ENABLE_KTLS);
+        } else {
+            SSL_CTX_clear_options(_ctx, SSL_OP_ENABLE_KTLS);
+        }
+        _kernelTls = enable;
+    }
+#else
+    if (enable) {
+        tSystemWarn("Kernel TLS is not supported by this OpenSSL");
+    }
+#endif
+}
+
+/*!
+  Creates a new SSL object in the server mode for the \a socket.
+*/
+SSL *TTlsContext::createSsl(int socket) const
+{
+    if (Q_UNLIKELY(!_valid)) {
+        return nullptr;
+    }
+
+    SSL *ssl = SSL_new(_ctx);
+    if (Q_UNLIKELY(!ssl)) {
+        tSystemError("Failed SSL_new: %s", lastErrorString().data());
+        return nullptr;
+    }
+
+    SSL_set_fd(ssl, socket);
+    SSL_set_accept_state(ssl);
+    return ssl;
+}
+
+/*!
+  Returns the TLS context configured by the application.ini, or nullptr
+  if TLS is disabled or the configuration is invalid.
+*/
+TTlsContext *TTlsContext::instance()
+{
+    static TTlsContext *context = []() -> TTlsContext * {
+        if (!Tf::appSettings()->value(Tf::TLSEnable).toBool()) {
+            return nullptr;
+        }
+
+        QDir root(Tf::app()->webRootPath());
+        QString cert = Tf::appSettings()->value(Tf::TLSCertificateFile).toString();
+        QString key = Tf::appSettings()->value(Tf::TLSPrivateKeyFile).toString();
+        if (key.isEmpty()) {
+            key = cert;  // a PEM file including the key
+        }
+
+        auto *ctx = new TTlsContext;
+        if (!ctx->loadCertificate(root.absoluteFilePath(cert), root.absoluteFilePath(key))) {
+            delete ctx;
+            return nullptr;
+        }
+
+        QByteArrayList protocols;
+        for (auto &proto : Tf::appSettings()->value(Tf::TLSAlpnProtocols).toString().split(QLatin1Char(','), Tf::SkipEmptyParts)) {
+            protocols << proto.trimmed().toLatin1();
+        }
+        ctx->setAlpnProtocols(protocols);
+        ctx->setSessionCacheSize(Tf::appSettings()->value(Tf::TLSSessionCacheSize).toInt());
+        ctx->setKernelTlsEnabled(Tf::appSettings()->value(Tf::TLSEnableKernelTls).toBool());
+        return ctx;
+    }();
+
+    return context;
+}
+
+/*!
+  Returns the error string of OpenSSL, and clears the error queue.
+*/
+QByteArray TTlsContext::lastErrorString()
+{
+    QByteArray str;
+    unsigned long err;
+    char buf[256];
+
+    while ((err = ERR_get_error()) != 0) {
+        ERR_error_string_n(err, buf, sizeof(buf));
+        if (!str.isEmpty()) {
+            str += "; ";
+        }
+        str += buf;
+    }
+    return str;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <QByteArray>
+#include <QByteArrayList>
+#include <QString>
+#include <TGlobal>
+
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_st SSL;
+
+
+class T_CORE_EXPORT TTlsContext {
+public:
+    TTlsContext();
+    ~TTlsContext();
+
+    bool isValid() const { return _valid; }
+    bool loadCertificate(const QString &certificateFile, const QString &privateKeyFile);
+    void setAlpnProtocols(const QByteArrayList &protocols);
+    void setSessionCacheSize(int size);
+    void setKernelTlsEnabled(bool enable);
+    bool isKernelTlsEnabled() const { return _kernelTls; }
+    SSL *createSsl(int socket) const;
+
+    static TTlsContext *instance();
+    static QByteArray lastErrorString();
+
+private:
+    SSL_CTX *_ctx {nullptr};
+    QByteArray _alpnProtocols;  // wire format
+    bool _valid {false};
+    bool _kernelTls {false};
+
+    T_DISABLE_COPY(TTlsContext)
+    T_DISABLE_MOVE(TTlsContext)
+};
@@ -0,0 +1,386 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "ttrace.h"
+#include "tsystemglobal.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QUdpSocket>
+#include <QUrl>
+#include <TAppSettings>
+#include <THttpRequestHeader>
+#include <TWebApplication>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+/*!
+  \class TTrace
+  \brief The TTrace class records the spans of a request, the time taken
+  by the pool waits and queries of SQL and KVS, the cache, the session,
+  the action, the view rendering and the socket write.
+
+  A trace is carried by the action context and is current in its thread
+  while the request is processed, so that a TTrace::Span created in the
+  code called by the action is recorded to it. The timestamps are taken
+  from the monotonic clock.
+
+  The sampled traces are exported as a line of OTLP/JSON to the file or
+  UDP collector of Trace.Export in the application.ini. A request is
+  sampled at the rate of Trace.SampleRate, or if its traceparent header
+  says so. With Trace.ServerTiming, the totals of the spans are returned
+  in the Server-Timing header of every response.
+*/
+
+namespace {
+
+constexpr int MAX_SPANS = 256;
+thread_local TTrace *currentTrace = nullptr;
+
+const char *const KIND_NAMES[TTrace::NumKinds] = {
+    "sql-pool",
+    "sql",
+    "kvs-pool",
+    "kvs",
+    "cache",
+    "session-load",
+    "session-store",
+    "action",
+    "render",
+    "write",
+};
+
+
+int64_t monotonicNsecs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+int64_t unixNsecs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+
+QByteArray randomHex(int bytes)
+{
+    QByteArray raw;
+    while (raw.length() < bytes) {
+        uint64_t r = Tf::rand64_r();
+        raw.append((const char *)&r, std::min(bytes - raw.length(), (int)sizeof(r)));
+    }
+    return raw.toHex();
+}
+
+// Parses a W3C traceparent header, "00-<trace-id>-<parent-id>-<flags>"
+bool parseTraceparent(const QByteArray &value, QByteArray &traceId, QByteArray &parentId, bool &sampled)
+{
+    const QByteArrayList parts = value.trimmed().toLower().split('-');
+    if (parts.count() < 4 || parts[1].length() != 32 || parts[2].length() != 16
+        || parts[1] == QByteArray(32, '0') || parts[2] == QByteArray(16, '0')) {
+        return false;
+    }
+
+    bool ok;
+    int flags = parts[3].toInt(&ok, 16);
+    if (!ok) {
+        return false;
+    }
+
+    traceId = parts[1];
+    parentId = parts[2];
+    sampled = flags & 0x01;
+    return true;
+}
+
+
+QString exportTarget()
+{
+    static const QString target = Tf::appSettings()->value(Tf::TraceExport).toString().trimmed();
+    return target;
+}
+
+
+double sampleRate()
+{
+    static const double rate = qBound(0.0, Tf::appSettings()->value(Tf::TraceSampleRate).toDouble(), 1.0);
+    return rate;
+}
+
+
+class Exporter {
+public:
+    Exporter()
+    {
+        QString target = exportTarget();
+        if (target.startsWith(QLatin1String("udp://"), Qt::CaseInsensitive)) {
+            QUrl url(target);
+            _host = QHostAddress(url.host());
+            _port = url.port();
+            if (_host.isNull() || _port <= 0) {
+                tSystemError("Invalid trace exporter: %s", qUtf8Printable(target));
+            }
+        } else {
+            QFileInfo fi(target);
+            _file.setFileName(fi.isAbsolute() ? fi.absoluteFilePath() : Tf::app()->webRootPath() + fi.filePath());
+            if (!_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+                tSystemError("Failed to open the trace file: %s", qUtf8Printable(_file.fileName()));
+            }
+        }
+    }
+
+    void write(const QByteArray &json)
+    {
+        if (_port > 0) {
+            // A socket per thread, not to share it among the threads
+            thread_local std::unique_ptr<QUdpSocket> socket(new QUdpSocket);
+            socket->writeDatagram(json, _host, _port);
+        } else if (_file.isOpen()) {
+            QMutexLocker locker(&_mutex);
+            _file.write(json + '\n');  // one write per line
+        }
+    }
+
+    static Exporter &instance()
+    {
+        static Exporter exporter;
+        return exporter;
+    }
+
+private:
+    QMutex _mutex;
+    QFile _file;
+    QHostAddress _host;
+    int _port {0};
+};
+
+
+QJsonObject attribute(const QString &key, const QJsonObject &value)
+{
+    return QJsonObject {{QStringLiteral("key"), key}, {QStringLiteral("value"), value}};
+}
+
+
+QJsonObject otlpSpan(const QByteArray &traceId, const QByteArray &spanId, const QByteArray &parentSpanId, const QString &name, int kind, int64_t start, int64_t end)
+{
+    QJsonObject span {
+        {QStringLiteral("traceId"), QString::fromLatin1(traceId)},
+        {QStringLiteral("spanId"), QString::fromLatin1(spanId)},
+        {QStringLiteral("name"), name},
+        {QStringLiteral("kind"), kind},
+        {QStringLiteral("startTimeUnixNano"), QString::number(start)},
+        {QStringLiteral("endTimeUnixNano"), QString::number(end)},
+    };
+    if (!parentSpanId.isEmpty()) {
+        span.insert(QStringLiteral("parentSpanId"), QString::fromLatin1(parentSpanId));
+    }
+    return span;
+}
+
+}  // namespace
+
+
+TTrace::Span::Span(Kind kind) :
+    _trace(currentTrace),
+    _kind(kind)
+{
+    if (_trace) {
+        _start = monotonicNsecs();
+    }
+}
+
+
+TTrace::Span::~Span()
+{
+    if (_trace) {
+        _trace->addSpan(_kind, _start, monotonicNsecs());
+    }
+}
+
+/*!
+  Returns true if the traces are exported or the Server-Timing header
+  is enabled.
+*/
+bool TTrace::isEnabled()
+{
+    static const bool enabled = !exportTarget().isEmpty() || isServerTimingEnabled();
+    return enabled;
+}
+
+/*!
+  Returns true if Trace.ServerTiming in the application.ini is true.
+*/
+bool TTrace::isServerTimingEnabled()
+{
+    static const bool enabled = Tf::appSettings()->value(Tf::TraceServerTiming).toBool();
+    return enabled;
+}
+
+/*!
+  Returns the trace of the request processed in the current thread, or
+  nullptr if none is active.
+*/
+TTrace *TTrace::current()
+{
+    return currentTrace;
+}
+
+/*!
+  Starts the trace of the request with the \a header; the spans are
+  recorded until finish() if the request is sampled or the
+  Server-Timing header is enabled.
+*/
+void TTrace::start(const THttpRequestHeader &header)
+{
+    bool parentSampled = false;
+    bool hasParent = false;
+    if (!exportTarget().isEmpty()) {
+        hasParent = parseTraceparent(header.rawHeader(QByteArrayLiteral("traceparent")), _traceId, _parentSpanId, parentSampled);
+        _sampled = parentSampled || (sampleRate() > 0 && Tf::rand32_r() < sampleRate() * 4294967296.0);
+    } else {
+        _sampled = false;
+    }
+
+    _active = _sampled || isServerTimingEnabled();
+    if (!_active) {
+        return;
+    }
+
+    if (!hasParent) {
+        _traceId = randomHex(16);
+        _parentSpanId.clear();
+    }
+    _spanId = randomHex(8);
+
+    const QByteArray &path = header.path();
+    int query = path.indexOf('?');
+    _name = header.method() + ' ' + path.left((query < 0) ? path.length() : query);
+    _spans.clear();
+    _droppedSpans = 0;
+    std::fill(std::begin(_totals), std::end(_totals), 0);
+    _start = monotonicNsecs();
+    _startUnixNano = unixNsecs();
+    // Nested in the processing of another request, such as of epoll
+    if (currentTrace != this) {
+        _previous = currentTrace;
+        currentTrace = this;
+    }
+}
+
+/*!
+  Finishes the trace of the request responded with the \a statusCode,
+  and exports it if sampled.
+*/
+void TTrace::finish(int statusCode)
+{
+    if (!_active) {
+        return;
+    }
+
+    int64_t end = monotonicNsecs();
+    _active = false;
+    if (currentTrace == this) {
+        currentTrace = _previous;
+    }
+    _previous = nullptr;
+
+    if (_sampled) {
+        Exporter::instance().write(toJson(statusCode, end));
+    }
+}
+
+/*!
+  Returns the value of the Server-Timing header, the totals of the spans
+  finished and the time elapsed in milliseconds.
+*/
+QByteArray TTrace::serverTiming() const
+{
+    QByteArray timing;
+    timing.reserve(256);
+
+    for (int i = 0; i < NumKinds; i++) {
+        if (_totals[i] > 0) {
+            timing += KIND_NAMES[i];
+            timing += ";dur=";
+            timing += QByteArray::number(_totals[i] / 1000000.0, 'f', 3);
+            timing += ", ";
+        }
+    }
+    timing += "total;dur=";
+    timing += QByteArray::number((monotonicNsecs() - _start) / 1000000.0, 'f', 3);
+    return timing;
+}
+
+
+void TTrace::addSpan(Kind kind, int64_t start, int64_t end)
+{
+    if (!_active) {
+        return;
+    }
+
+    _totals[kind] += end - start;
+    if (!_sampled) {
+        return;
+    }
+
+    if (_spans.count() < MAX_SPANS) {
+        _spans.append(SpanData {kind, start, end});
+    } else {
+        _droppedSpans++;
+    }
+}
+
+
+QByteArray TTrace::toJson(int statusCode, int64_t end) const
+{
+    constexpr int Server = 2;
+    constexpr int Internal = 1;
+    constexpr int Client = 3;
+    const int64_t offset = _startUnixNano - _start;  // monotonic to unix time
+
+    QJsonArray spans;
+    QJsonObject root = otlpSpan(_traceId, _spanId, _parentSpanId, QString::fromLatin1(_name), Server, _startUnixNano, end + offset);
+    QJsonArray rootAttributes {
+        attribute(QStringLiteral("http.response.status_code"), {{QStringLiteral("intValue"), QString::number(statusCode)}}),
+    };
+    if (_droppedSpans > 0) {
+        rootAttributes.append(attribute(QStringLiteral("tf.dropped_spans"), {{QStringLiteral("intValue"), QString::number(_droppedSpans)}}));
+    }
+    root.insert(QStringLiteral("attributes"), rootAttributes);
+    spans.append(root);
+
+    for (auto &sd : _spans) {
+        int kind = (sd.kind <= KvsQuery) ? Client : Internal;
+        spans.append(otlpSpan(_traceId, randomHex(8), _spanId, QLatin1String(KIND_NAMES[sd.kind]), kind, sd.start + offset, sd.end + offset));
+    }
+
+    QJsonObject resource {
+        {QStringLiteral("attributes"), QJsonArray {
+            attribute(QStringLiteral("service.name"), {{QStringLiteral("stringValue"), QFileInfo(Tf::app()->webRootPath()).dir().dirName()}}),
+            attribute(QStringLiteral("service.instance.id"), {{QStringLiteral("stringValue"), QString::number(Tf::app()->applicationServerId())}}),
+        }},
+    };
+    QJsonObject scopeSpans {
+        {QStringLiteral("scope"), QJsonObject {{QStringLiteral("name"), QStringLiteral("treefrog")}}},
+        {QStringLiteral("spans"), spans},
+    };
+    QJsonObject resourceSpans {
+        {QStringLiteral("resource"), resource},
+        {QStringLiteral("scopeSpans"), QJsonArray {scopeSpans}},
+    };
+    QJsonObject doc {{QStringLiteral("resourceSpans"), QJsonArray {resourceSpans}}};
+    return QJsonDocument(doc).toJson(QJsonDocument::Compact);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <QByteArray>
+#include <QVector>
+#include <TGlobal>
+
+class THttpRequestHeader;
+
+
+class T_CORE_EXPORT TTrace {
+public:
+    enum Kind {
+        SqlPoolWait = 0,
+        SqlQuery,
+        KvsPoolWait,
+        KvsQuery,
+        Cache,
+        SessionLoad,
+        SessionStore,
+        Action,
+        Render,
+        SocketWrite,
+        NumKinds,
+    };
+
+    // Records the time to its destruction as a span of the current trace
+    class Span {
+    public:
+        Span(Kind kind);
+        ~Span();
+
+    private:
+        TTrace *_trace {nullptr};
+        Kind _kind;
+        int64_t _start {0};
+
+        T_DISABLE_COPY(Span)
+        T_DISABLE_MOVE(Span)
+    };
+
+    TTrace() { }
+
+    void start(const THttpRequestHeader &header);
+    void finish(int statusCode);
+    bool isActive() const { return _active; }
+    QByteArray serverTiming() const;
+
+    static bool isEnabled();
+    static bool isServerTimingEnabled();
+    static TTrace *current();
+
+private:
+    struct SpanData {
+        Kind kind;
+        int64_t start {0};  // nsecs of the monotonic clock
+        int64_t end {0};
+    };
+
+    void addSpan(Kind kind, int64_t start, int64_t end);
+    QByteArray toJson(int statusCode, int64_t end) const;
+
+    QByteArray _name;
+    QByteArray _traceId;  // hex
+    QByteArray _spanId;  // hex
+    QByteArray _parentSpanId;  // hex
+    int64_t _start {0};  // nsecs of the monotonic clock
+    int64_t _startUnixNano {0};
+    int64_t _totals[NumKinds] {};
+    QVector<SpanData> _spans;
+    int _droppedSpans {0};
+    TTrace *_previous {nullptr};  // trace of the outer request
+    bool _active {false};
+    bool _sampled {false};
+
+    T_DISABLE_COPY(TTrace)
+    T_DISABLE_MOVE(TTrace)
+};
@@ -9,7 +9,7 @@
 #include "tatomicptr.h"
 #include "tdispatcher.h"
 #include "turlroute.h"
-#include "twebsocketworker.h"
+#include "twebsocketworkerpool.h"
 #include <TWebApplication>
 #include <QMap>
 #include <QMutex>
@@ -97,11 +97,6 @@ bool TWebSocket::canReadRequest() const
 
 void TWebSocket::readRequest()
 {
-    if (myWorkerCounter > 0) {
-        tSystemWarn("Worker already running  (sd:%ld)", (uint64_t)socketDescriptor());
-        return;
-    }
-
     int bytes = bytesAvailable();
     if (bytes > 0) {
         int sz = recvBuffer.size();
@@ -139,54 +134,54 @@ void TWebSocket::readRequest()
     }
 
     if (!payloads.isEmpty()) {
-        // Starts worker thread
-        TWebSocketWorker *worker = new TWebSocketWorker(TWebSocketWorker::Receiving, this, reqHeader.path());
-        worker->setPayloads(payloads);
-        startWorker(worker);
+        // Queues to the worker pool, processed in order of arrival
+        TWebSocketTask task;
+        task.mode = TWebSocketWorker::Receiving;
+        task.payloads = payloads;
+        startWorker(task);
     }
 }
 
 
 void TWebSocket::startWorkerForOpening(const TSession &session)
 {
-    TWebSocketWorker *worker = new TWebSocketWorker(TWebSocketWorker::Opening, this, reqHeader.path());
-    worker->setSession(session);
-    startWorker(worker);
+    TWebSocketTask task;
+    task.mode = TWebSocketWorker::Opening;
+    task.session = session;
+    startWorker(task);
 }
 
 
 void TWebSocket::startWorkerForClosing()
 {
     if (!closing.load()) {
-        TWebSocketWorker *worker = new TWebSocketWorker(TWebSocketWorker::Closing, this, reqHeader.path());
-        startWorker(worker);
+        TWebSocketTask task;
+        task.mode = TWebSocketWorker::Closing;
+        startWorker(task);
     }
 }
 
 
-void TWebSocket::startWorker(TWebSocketWorker *worker)
+void TWebSocket::startWorker(const TWebSocketTask &task)
 {
-    worker->moveToThread(Tf::app()->thread());
-    connect(worker, SIGNAL(finished()), this, SLOT(releaseWorker()));
+    TWebSocketTask t = task;
+    t.socket = this;
+    t.requestPath = reqHeader.path();
+    t.finished = [this]() {
+        QMetaObject::invokeMethod(this, "releaseWorker", Qt::QueuedConnection);
+    };
+
     ++myWorkerCounter;  // count-up
-    worker->start();
+    TWebSocketWorkerPool::instance()->start(t);
 }
 
 
 void TWebSocket::releaseWorker()
 {
-    TWebSocketWorker *worker = dynamic_cast<TWebSocketWorker *>(sender());
-    if (worker) {
-        worker->deleteLater();
-        --myWorkerCounter;  // count-down
+    --myWorkerCounter;  // count-down
 
-        if (deleting.load()) {
-            deleteLater();
-        } else {
-            if (bytesAvailable() > 0) {
-                readRequest();
-            }
-        }
+    if (deleting.load()) {
+        deleteLater();
     }
 }
 
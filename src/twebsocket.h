@@ -7,7 +7,7 @@
 #include <TGlobal>
 
 class TWebSocketFrame;
-class TWebSocketWorker;
+struct TWebSocketTask;
 class TSession;
 class THttpRequestHeader;
 
@@ -47,7 +47,7 @@ signals:
     void disconnectByWorker();
 
 private:
-    void startWorker(TWebSocketWorker *worker);
+    void startWorker(const TWebSocketTask &task);
 
     int sid {0};
     QByteArray recvBuffer;
@@ -7,6 +7,7 @@
 
 #include "twebsocketworker.h"
 #include "tabstractwebsocket.h"
+#include "twebsocketworkerpool.h"
 #include "tpublisher.h"
 #include "tsystemglobal.h"
 #include "turlroute.h"
@@ -21,11 +22,18 @@
 #include <QDataStream>
 
 
-TWebSocketWorker::TWebSocketWorker(TWebSocketWorker::RunMode m, TAbstractWebSocket *s, const QByteArray &path, QObject *parent) :
+/*!
+  \class TWebSocketWorker
+  \brief The TWebSocketWorker class is a thread of TWebSocketWorkerPool
+  which runs the WebSocket endpoints.
+
+  The endpoint objects and the database context of the thread are
+  reused for the tasks processed in it.
+*/
+
+TWebSocketWorker::TWebSocketWorker(TWebSocketWorkerPool *pool, QObject *parent) :
     TDatabaseContextThread(parent),
-    _mode(m),
-    _socket(s),
-    _requestPath(path)
+    _pool(pool)
 {
 }
 
@@ -36,43 +44,64 @@ TWebSocketWorker::~TWebSocketWorker()
 }
 
 
-void TWebSocketWorker::setPayload(TWebSocketFrame::OpCode opCode, const QByteArray &payload)
+void TWebSocketWorker::run()
 {
-    _payloads << qMakePair((int)opCode, payload);
-}
+    TDatabaseContext::setCurrentDatabaseContext(this);
+    TWebSocketTask task;
 
+    while (_pool->takeTask(task)) {
+        if (task.mode == Receiving) {
+            for (auto &p : (const QList<QPair<int, QByteArray>> &)task.payloads) {
+                execute(task, p.first, p.second);
+            }
+        } else {
+            execute(task);
+        }
+        TDatabaseContext::release();
+
+        // Ends the task before notifying, the socket may be deleted then
+        auto finished = task.finished;
+        _pool->finishTask(task.socket);
+        task = TWebSocketTask();
+        if (finished) {
+            finished();
+        }
+    }
 
-void TWebSocketWorker::setPayloads(QList<QPair<int, QByteArray>> payloads)
-{
-    _payloads = payloads;
+    qDeleteAll(_endpoints);
+    _endpoints.clear();
+    TDatabaseContext::setCurrentDatabaseContext(nullptr);
 }
 
 
-void TWebSocketWorker::setSession(const TSession &session)
+TWebSocketEndpoint *TWebSocketWorker::endpoint(const QString &name)
 {
-    _httpSession = session;
-}
-
+    TWebSocketEndpoint *endpoint = _endpoints.value(name);
+    if (endpoint) {
+        endpoint->reset();
+        return endpoint;
+    }
 
-void TWebSocketWorker::run()
-{
-    if (_mode == Receiving) {
-        for (auto &p : (const QList<QPair<int, QByteArray>> &)_payloads) {
-            execute(p.first, p.second);
+    auto factory = TDispatchTable::factory(name);
+    if (factory) {
+        QObject *obj = factory();
+        endpoint = dynamic_cast<TWebSocketEndpoint *>(obj);
+        if (endpoint) {
+            _endpoints.insert(name, endpoint);
+        } else {
+            delete obj;
         }
-        _payloads.clear();
-    } else {
-        execute();
     }
+    return endpoint;
 }
 
 
-void TWebSocketWorker::execute(int opcode, const QByteArray &payload)
+void TWebSocketWorker::execute(const TWebSocketTask &task, int opcode, const QByteArray &payload)
 {
     bool sendTask = false;
-    QString es = TUrlRoute::splitPath(_requestPath).value(0).toLower() + "endpoint";
-    TDispatcher<TWebSocketEndpoint> dispatcher(es);
-    TWebSocketEndpoint *endpoint = dispatcher.object();
+    TAbstractWebSocket *socket = task.socket;
+    QString es = TUrlRoute::splitPath(task.requestPath).value(0).toLower() + "endpoint";
+    TWebSocketEndpoint *endpoint = this->endpoint(es);
 
     if (!endpoint) {
         return;
@@ -82,9 +111,9 @@ void TWebSocketWorker::execute(int opcode, const QByteArray &payload)
         tSystemDebug("Found endpoint: %s", qUtf8Printable(es));
         tSystemDebug("TWebSocketWorker opcode: %d", opcode);
 
-        endpoint->sessionStore = _socket->session();  // Sets websocket session
-        //endpoint->sid = _socket->socketId();
-        auto peerInfo = TApplicationServerBase::getPeerInfo(_socket->socketDescriptor());
+        endpoint->sessionStore = socket->session();  // Sets websocket session
+        //endpoint->sid = socket->socketId();
+        auto peerInfo = TApplicationServerBase::getPeerInfo(socket->socketDescriptor());
         endpoint->peerAddr = peerInfo.first;
         endpoint->peerPortNumber = peerInfo.second;
         // Database Transaction
@@ -92,9 +121,9 @@ void TWebSocketWorker::execute(int opcode, const QByteArray &payload)
             setTransactionEnabled(endpoint->transactionEnabled(), databaseId);
         }
 
-        switch (_mode) {
+        switch (task.mode) {
         case Opening: {
-            bool res = endpoint->onOpen(_httpSession);
+            bool res = endpoint->onOpen(task.session);
             if (res) {
                 // For switch response
                 endpoint->taskList.prepend(qMakePair((int)TWebSocketEndpoint::OpenSuccess, QVariant()));
@@ -109,7 +138,7 @@ void TWebSocketWorker::execute(int opcode, const QByteArray &payload)
         }
 
         case Closing:
-            if (!_socket->closing.exchange(true)) {
+            if (!socket->closing.exchange(true)) {
                 endpoint->onClose(Tf::GoingAway);
                 endpoint->unsubscribeFromAll();
             }
@@ -134,7 +163,7 @@ void TWebSocketWorker::execute(int opcode, const QByteArray &payload)
                     ds >> closeCode;
                 }
 
-                if (!_socket->closing.exchange(true)) {
+                if (!socket->closing.exchange(true)) {
                     endpoint->onClose(closeCode);
                     endpoint->unsubscribeFromAll();
                 }
@@ -162,7 +191,7 @@ void TWebSocketWorker::execute(int opcode, const QByteArray &payload)
         }
 
         // Sets session to the websocket
-        _socket->setSession(endpoint->session());
+        socket->setSession(endpoint->session());
 
         for (auto &p : (const QList<QPair<int, QVariant>> &)endpoint->taskList) {
             const QVariant &taskData = p.second;
@@ -170,44 +199,44 @@ void TWebSocketWorker::execute(int opcode, const QByteArray &payload)
 
             switch (p.first) {
             case TWebSocketEndpoint::OpenSuccess:
-                _socket->sendHandshakeResponse();
+                socket->sendHandshakeResponse();
                 break;
 
             case TWebSocketEndpoint::OpenError:
-                _socket->closing = true;
-                _socket->closeSent = true;
-                _socket->disconnect();
+                socket->closing = true;
+                socket->closeSent = true;
+                socket->disconnect();
                 goto open_error;
                 break;
 
             case TWebSocketEndpoint::SendText:
-                _socket->sendText(taskData.toString());
+                socket->sendText(taskData.toString());
                 sendTask = true;
                 break;
 
             case TWebSocketEndpoint::SendBinary:
-                _socket->sendBinary(taskData.toByteArray());
+                socket->sendBinary(taskData.toByteArray());
                 sendTask = true;
                 break;
 
             case TWebSocketEndpoint::SendClose:
-                if (_socket->closing.load() && _socket->closeSent.load()) {
+                if (socket->closing.load() && socket->closeSent.load()) {
                     // close-frame sent and received
-                    _socket->disconnect();
+                    socket->disconnect();
                 } else {
                     uint closeCode = taskData.toUInt();
-                    _socket->sendClose(closeCode);
+                    socket->sendClose(closeCode);
                     sendTask = true;
                 }
                 break;
 
             case TWebSocketEndpoint::SendPing:
-                _socket->sendPing(taskData.toByteArray());
+                socket->sendPing(taskData.toByteArray());
                 sendTask = true;
                 break;
 
             case TWebSocketEndpoint::SendPong:
-                _socket->sendPong(taskData.toByteArray());
+                socket->sendPong(taskData.toByteArray());
                 sendTask = true;
                 break;
 
@@ -240,36 +269,36 @@ void TWebSocketWorker::execute(int opcode, const QByteArray &payload)
 
             case TWebSocketEndpoint::Subscribe: {
                 QVariantList lst = taskData.toList();
-                TPublisher::instance()->subscribe(lst[0].toString(), lst[1].toBool(), _socket);
+                TPublisher::instance()->subscribe(lst[0].toString(), lst[1].toBool(), socket);
                 break;
             }
 
             case TWebSocketEndpoint::Unsubscribe:
-                TPublisher::instance()->unsubscribe(taskData.toString(), _socket);
+                TPublisher::instance()->unsubscribe(taskData.toString(), socket);
                 break;
 
             case TWebSocketEndpoint::UnsubscribeFromAll:
-                TPublisher::instance()->unsubscribeFromAll(_socket);
+                TPublisher::instance()->unsubscribeFromAll(socket);
                 break;
 
             case TWebSocketEndpoint::PublishText: {
                 QVariantList lst = taskData.toList();
-                TPublisher::instance()->publish(lst[0].toString(), lst[1].toString(), _socket);
+                TPublisher::instance()->publish(lst[0].toString(), lst[1].toString(), socket);
                 break;
             }
 
             case TWebSocketEndpoint::PublishBinary: {
                 QVariantList lst = taskData.toList();
-                TPublisher::instance()->publish(lst[0].toString(), lst[1].toByteArray(), _socket);
+                TPublisher::instance()->publish(lst[0].toString(), lst[1].toByteArray(), socket);
                 break;
             }
 
             case TWebSocketEndpoint::StartKeepAlive:
-                _socket->startKeepAlive(taskData.toInt());
+                socket->startKeepAlive(taskData.toInt());
                 break;
 
             case TWebSocketEndpoint::StopKeepAlive:
-                _socket->stopKeepAlive();
+                socket->stopKeepAlive();
                 break;
 
             default:
@@ -280,7 +309,7 @@ void TWebSocketWorker::execute(int opcode, const QByteArray &payload)
 
         if (!sendTask) {
             // Receiving but not sending, so renew keep-alive
-            _socket->renewKeepAlive();
+            socket->renewKeepAlive();
         }
 
     open_error:
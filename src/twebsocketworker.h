@@ -2,12 +2,17 @@
 #include "tdatabasecontextthread.h"
 #include "twebsocketframe.h"
 #include <QList>
+#include <QMap>
 #include <QPair>
 #include <QThread>
 #include <TGlobal>
 #include <TSession>
+#include <functional>
 
 class TAbstractWebSocket;
+class TWebSocketEndpoint;
+class TWebSocketWorkerPool;
+struct TWebSocketTask;
 
 
 class T_CORE_EXPORT TWebSocketWorker : public TDatabaseContextThread {
@@ -19,22 +24,26 @@ public:
         Closing,
     };
 
-    TWebSocketWorker(RunMode mode, TAbstractWebSocket *socket, const QByteArray &path, QObject *parent = 0);
+    TWebSocketWorker(TWebSocketWorkerPool *pool, QObject *parent = 0);
     virtual ~TWebSocketWorker();
 
-    void setPayload(TWebSocketFrame::OpCode opCode, const QByteArray &data);
-    void setPayloads(QList<QPair<int, QByteArray>> payloads);
-    void setSession(const TSession &session);
-
 protected:
     void run() override;
-    void execute(int opcode = 0, const QByteArray &payload = QByteArray());
+    void execute(const TWebSocketTask &task, int opcode = 0, const QByteArray &payload = QByteArray());
 
 private:
-    RunMode _mode {Opening};
-    TAbstractWebSocket *_socket {nullptr};
-    TSession _httpSession;
-    QByteArray _requestPath;
-    QList<QPair<int, QByteArray>> _payloads;
+    TWebSocketEndpoint *endpoint(const QString &name);
+
+    TWebSocketWorkerPool *_pool {nullptr};
+    QMap<QString, TWebSocketEndpoint *> _endpoints;
 };
 
+
+struct TWebSocketTask {
+    TWebSocketWorker::RunMode mode {TWebSocketWorker::Opening};
+    TAbstractWebSocket *socket {nullptr};
+    QByteArray requestPath;
+    TSession session;
+    QList<QPair<int, QByteArray>> payloads;
+    std::function<void()> finished;  // called in the worker thread
+};
@@ -0,0 +1,163 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "twebsocketworkerpool.h"
+#include "tsystemglobal.h"
+#include <QCoreApplication>
+#include <QSemaphore>
+#include <TAppSettings>
+
+/*!
+  \class TWebSocketWorkerPool
+  \brief The TWebSocketWorkerPool class manages a fixed number of
+  TWebSocketWorker threads which process the tasks of WebSocket
+  connections.
+
+  The tasks are queued per connection and a connection is served by
+  at most one worker at a time, so the messages of a connection are
+  processed in order of arrival. A connection having more tasks goes
+  to the tail of the ready queue after each task.
+*/
+
+namespace {
+TWebSocketWorkerPool *workerPool = nullptr;
+
+
+void cleanup()
+{
+    delete workerPool;
+    workerPool = nullptr;
+}
+}
+
+
+TWebSocketWorkerPool::TWebSocketWorkerPool(int maxThreads)
+{
+    for (int i = 0; i < maxThreads; i++) {
+        auto *worker = new TWebSocketWorker(this);
+        _workers << worker;
+        worker->start();
+    }
+}
+
+
+TWebSocketWorkerPool::~TWebSocketWorkerPool()
+{
+    stop();
+}
+
+/*!
+  Returns a global instance of the pool. The number of the threads is
+  specified by WebSocket.MaxWorkerThreads in the application.ini.
+*/
+TWebSocketWorkerPool *TWebSocketWorkerPool::instance()
+{
+    static TWebSocketWorkerPool *globalInstance = []() {
+        int threads = Tf::appSettings()->value(Tf::WebSocketMaxWorkerThreads).toInt();
+        if (threads <= 0) {
+            threads = qMax(QThread::idealThreadCount(), 1);
+        }
+        tSystemDebug("WebSocket worker threads: %d", threads);
+        workerPool = new TWebSocketWorkerPool(threads);
+        qAddPostRoutine(::cleanup);
+        return workerPool;
+    }();
+    return globalInstance;
+}
+
+/*!
+  Queues the \a task to the tasks of its socket and returns immediately.
+*/
+void TWebSocketWorkerPool::start(const TWebSocketTask &task)
+{
+    QMutexLocker locker(&_mutex);
+    if (Q_UNLIKELY(_stopped)) {
+        tSystemWarn("WebSocket worker pool already stopped");
+        locker.unlock();
+        if (task.finished) {
+            task.finished();
+        }
+        return;
+    }
+
+    auto it = _strands.find(task.socket);
+    if (it != _strands.end()) {
+        // Runs after the preceding tasks of the socket
+        it->enqueue(task);
+        return;
+    }
+
+    _strands[task.socket].enqueue(task);
+    _readySockets.enqueue(task.socket);
+    _taskAvailable.wakeOne();
+}
+
+/*!
+  Queues the \a task and waits for it to be finished.
+*/
+void TWebSocketWorkerPool::startAndWait(const TWebSocketTask &task)
+{
+    QSemaphore semaphore;
+    TWebSocketTask t = task;
+    t.finished = [&semaphore]() {
+        semaphore.release();
+    };
+    start(t);
+    semaphore.acquire();
+}
+
+/*!
+  Stops the worker threads after the queued tasks are processed.
+*/
+void TWebSocketWorkerPool::stop()
+{
+    _mutex.lock();
+    _stopped = true;
+    _taskAvailable.wakeAll();
+    _mutex.unlock();
+
+    for (auto *worker : (const QList<TWebSocketWorker *> &)_workers) {
+        worker->wait();
+        delete worker;
+    }
+    _workers.clear();
+}
+
+// Takes the first task of a ready socket, called by the workers
+bool TWebSocketWorkerPool::takeTask(TWebSocketTask &task)
+{
+    QMutexLocker locker(&_mutex);
+    while (_readySockets.isEmpty()) {
+        if (_stopped) {
+            return false;
+        }
+        _taskAvailable.wait(&_mutex);
+    }
+
+    // The task stays at the head of the queue while running
+    TAbstractWebSocket *socket = _readySockets.dequeue();
+    task = _strands[socket].head();
+    return true;
+}
+
+
+void TWebSocketWorkerPool::finishTask(TAbstractWebSocket *socket)
+{
+    QMutexLocker locker(&_mutex);
+    auto it = _strands.find(socket);
+    if (Q_UNLIKELY(it == _strands.end())) {
+        return;
+    }
+
+    it->dequeue();
+    if (it->isEmpty()) {
+        _strands.erase(it);
+    } else {
+        _readySockets.enqueue(socket);
+        _taskAvailable.wakeOne();
+    }
+}
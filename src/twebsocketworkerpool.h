@@ -0,0 +1,37 @@
+#pragma once
+#include "twebsocketworker.h"
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TWebSocketWorkerPool {
+public:
+    ~TWebSocketWorkerPool();
+
+    void start(const TWebSocketTask &task);
+    void startAndWait(const TWebSocketTask &task);
+    int maxThreadCount() const { return _workers.count(); }
+    void stop();
+
+    static TWebSocketWorkerPool *instance();
+
+private:
+    TWebSocketWorkerPool(int maxThreads);
+    bool takeTask(TWebSocketTask &task);
+    void finishTask(TAbstractWebSocket *socket);
+
+    QMutex _mutex;
+    QWaitCondition _taskAvailable;
+    QHash<TAbstractWebSocket *, QQueue<TWebSocketTask>> _strands;
+    QQueue<TAbstractWebSocket *> _readySockets;
+    QList<TWebSocketWorker *> _workers;
+    bool _stopped {false};
+
+    friend class TWebSocketWorker;
+    T_DISABLE_COPY(TWebSocketWorkerPool)
+    T_DISABLE_MOVE(TWebSocketWorkerPool)
+};
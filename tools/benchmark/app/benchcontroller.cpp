@@ -0,0 +1,17 @@
+#include "benchcontroller.h"
+#include <TreeFrogController>
+
+
+void BenchController::hello()
+{
+    renderText(QStringLiteral("Hello, World!"));
+}
+
+void BenchController::json()
+{
+    renderJson(QJsonObject {{QStringLiteral("message"), QStringLiteral("Hello, World!")}});
+}
+
+
+// Don't remove below this line
+T_DEFINE_CONTROLLER(BenchController)
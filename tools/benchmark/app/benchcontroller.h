@@ -0,0 +1,15 @@
+#pragma once
+#include "applicationcontroller.h"
+
+
+class T_CONTROLLER_EXPORT BenchController : public ApplicationController {
+    Q_OBJECT
+public:
+    bool sessionEnabled() const override { return false; }
+    bool transactionEnabled() const override { return false; }
+
+public slots:
+    void hello();
+    void json();
+};
+
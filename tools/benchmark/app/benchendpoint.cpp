@@ -0,0 +1,42 @@
+#include "benchendpoint.h"
+
+static const QString TOPIC = QStringLiteral("bench");
+
+
+BenchEndpoint::BenchEndpoint() :
+    ApplicationEndpoint()
+{ }
+
+BenchEndpoint::BenchEndpoint(const BenchEndpoint &) :
+    ApplicationEndpoint()
+{ }
+
+bool BenchEndpoint::onOpen(const TSession &)
+{
+    subscribe(TOPIC, false);  // across the application servers
+    return true;
+}
+
+void BenchEndpoint::onClose(int)
+{
+    unsubscribeFromAll();
+}
+
+void BenchEndpoint::onTextReceived(const QString &text)
+{
+    // "pub ..." is fanned out to all the subscribers, others are echoed
+    if (text.startsWith(QLatin1String("pub "))) {
+        publish(TOPIC, text);
+    } else {
+        sendText(text);
+    }
+}
+
+void BenchEndpoint::onBinaryReceived(const QByteArray &binary)
+{
+    sendBinary(binary);
+}
+
+
+// Don't remove below this line
+T_DEFINE_CONTROLLER(BenchEndpoint)
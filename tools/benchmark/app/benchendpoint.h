@@ -0,0 +1,17 @@
+#pragma once
+#include "applicationendpoint.h"
+
+
+class T_CONTROLLER_EXPORT BenchEndpoint : public ApplicationEndpoint {
+    Q_OBJECT
+public:
+    BenchEndpoint();
+    BenchEndpoint(const BenchEndpoint &other);
+
+protected:
+    bool onOpen(const TSession &httpSession) override;
+    void onClose(int closeCode) override;
+    void onTextReceived(const QString &text) override;
+    void onBinaryReceived(const QByteArray &binary) override;
+};
+
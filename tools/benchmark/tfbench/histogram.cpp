@@ -0,0 +1,96 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// The values below SUB_COUNT have a bucket each, and every power of two
+// above is split into HALF_COUNT buckets
+constexpr int SUB_BITS = 7;
+constexpr int SUB_COUNT = 1 << SUB_BITS;
+constexpr int HALF_COUNT = SUB_COUNT / 2;
+constexpr int NUM_BUCKETS = (64 - SUB_BITS + 2) * HALF_COUNT;
+
+}  // namespace
+
+
+Histogram::Histogram() :
+    _buckets(NUM_BUCKETS, 0)
+{
+}
+
+
+void Histogram::record(int64_t value)
+{
+    value = std::max<int64_t>(value, 0);
+    _buckets[bucketIndex(value)]++;
+    _count++;
+    _sum += value;
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+}
+
+
+void Histogram::merge(const Histogram &other)
+{
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        _buckets[i] += other._buckets[i];
+    }
+    _count += other._count;
+    _sum += other._sum;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+
+double Histogram::mean() const
+{
+    return (_count > 0) ? (double)_sum / _count : 0;
+}
+
+// Returns the value at the percent, 0 to 100, of the recorded values
+int64_t Histogram::percentile(double percent) const
+{
+    if (_count == 0) {
+        return 0;
+    }
+
+    int64_t rank = std::max<int64_t>(std::ceil(_count * std::min(percent, 100.0) / 100.0), 1);
+    int64_t cumulative = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        cumulative += _buckets[i];
+        if (cumulative >= rank) {
+            return std::min(std::max(bucketValue(i), _min), _max);
+        }
+    }
+    return _max;
+}
+
+
+int Histogram::bucketIndex(int64_t value)
+{
+    if (value < SUB_COUNT) {
+        return value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BITS + 1;
+    return shift * HALF_COUNT + (int)(value >> shift);
+}
+
+// Returns the middle of the range of the bucket
+int64_t Histogram::bucketValue(int index)
+{
+    if (index < SUB_COUNT) {
+        return index;
+    }
+    int shift = index / HALF_COUNT - 1;
+    int64_t mantissa = index % HALF_COUNT + HALF_COUNT;
+    return (mantissa << shift) + ((int64_t)1 << shift) / 2;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+
+// Latency histogram of log-linear buckets, precise within 1/64 of a value
+class Histogram {
+public:
+    Histogram();
+
+    void record(int64_t value);
+    void merge(const Histogram &other);
+    int64_t count() const { return _count; }
+    int64_t min() const { return (_count > 0) ? _min : 0; }
+    int64_t max() const { return _max; }
+    double mean() const;
+    int64_t percentile(double percent) const;
+
+private:
+    static int bucketIndex(int64_t value);
+    static int64_t bucketValue(int index);
+
+    std::vector<int64_t> _buckets;
+    int64_t _count {0};
+    int64_t _sum {0};
+    int64_t _min {INT64_MAX};
+    int64_t _max {0};
+};
+
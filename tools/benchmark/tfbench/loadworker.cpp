@@ -0,0 +1,613 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "loadworker.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int READ_BUFFER_SIZE = 64 * 1024;
+constexpr int MAX_HEADER_SIZE = 64 * 1024;
+constexpr int64_t RETRY_INTERVAL = 10 * 1000000LL;  // nsecs
+constexpr auto WEBSOCKET_KEY = "dGhlIHNhbXBsZSBub25jZQ==";
+
+// Returns the value of the header field, the name of which is in lowercase
+QByteArray headerValue(const char *header, int length, const char *name)
+{
+    const int nameLength = strlen(name);
+    const char *end = header + length;
+    const char *p = (const char *)memchr(header, '\n', length);  // skips the status line
+
+    while (p && ++p < end) {
+        if (end - p > nameLength && qstrnicmp(p, name, nameLength) == 0 && p[nameLength] == ':') {
+            const char *value = p + nameLength + 1;
+            const char *eol = (const char *)memchr(value, '\r', end - value);
+            return QByteArray(value, (eol ? eol : end) - value).trimmed();
+        }
+        p = (const char *)memchr(p, '\n', end - p);
+    }
+    return QByteArray();
+}
+
+
+int64_t parseNumber(const char *data, int64_t length)
+{
+    int64_t number = 0;
+    for (int64_t i = 0; i < length && data[i] >= '0' && data[i] <= '9'; i++) {
+        number = number * 10 + (data[i] - '0');
+    }
+    return number;
+}
+
+}  // namespace
+
+
+struct Connection {
+    enum State {
+        Connecting = 0,
+        Handshaking,
+        Open,
+    };
+
+    int fd {-1};
+    State state {Connecting};
+    bool writeWaiting {false};  // for EPOLLOUT
+    QByteArray readBuffer;
+    QByteArray writeBuffer;
+    std::deque<int64_t> sentTimes;  // of the HTTP requests in flight
+    uint32_t maskKey {0};
+};
+
+
+void LoadStats::merge(const LoadStats &other)
+{
+    latency.merge(other.latency);
+    completed += other.completed;
+    bytesRead += other.bytesRead;
+    connectErrors += other.connectErrors;
+    ioErrors += other.ioErrors;
+    statusErrors += other.statusErrors;
+    parseErrors += other.parseErrors;
+}
+
+
+LoadWorker::LoadWorker(const LoadOptions &options, int connections, bool publisher) :
+    QThread(),
+    _options(options),
+    _random(std::random_device()())
+{
+    for (int i = 0; i < connections; i++) {
+        _connections.emplace_back(new Connection);
+    }
+
+    if (publisher && _options.webSocket && _options.publishRate > 0 && connections > 0) {
+        _publisher = _connections.front().get();
+    }
+
+    _request = "GET " + _options.path + " HTTP/1.1\r\nHost: " + _options.host + "\r\nUser-Agent: tfbench\r\n";
+    if (_options.webSocket) {
+        _request += "Upgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Version: 13\r\n";
+        _request += QByteArray("Sec-WebSocket-Key: ") + WEBSOCKET_KEY + "\r\n";
+    } else if (!_options.keepAlive) {
+        _request += "Connection: close\r\n";
+    }
+    _request += "\r\n";
+}
+
+
+LoadWorker::~LoadWorker()
+{
+    for (auto &conn : _connections) {
+        closeConnection(conn.get());
+    }
+}
+
+
+void LoadWorker::run()
+{
+    constexpr int MAX_EVENTS = 256;
+    epoll_event events[MAX_EVENTS];
+
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0) {
+        qCritical("epoll_create1 failed: %s", strerror(errno));
+        return;
+    }
+
+    for (auto &conn : _connections) {
+        openConnection(conn.get());
+    }
+
+    const int64_t publishInterval = (_publisher) ? 1000000000LL / _options.publishRate : 0;
+    int64_t nextPublish = nowNsecs();
+    int64_t nextRetry = 0;
+
+    for (;;) {
+        int64_t now = nowNsecs();
+        if (!isRunning(now)) {
+            break;
+        }
+
+        // Publishes at the constant rate, catching up after a stall
+        while (_publisher && now >= nextPublish) {
+            if (_publisher->state == Connection::Open) {
+                sendMessage(_publisher, "pub ");
+                flush(_publisher);
+            }
+            nextPublish += publishInterval;
+        }
+
+        // Reconnects the failed connections at intervals
+        if (!_retries.empty() && now >= nextRetry) {
+            std::vector<Connection *> retries;
+            retries.swap(_retries);
+            for (auto *conn : retries) {
+                openConnection(conn);
+            }
+            nextRetry = now + RETRY_INTERVAL;
+        }
+
+        int64_t wakeup = _options.deadline;
+        if (_publisher) {
+            wakeup = std::min(wakeup, nextPublish);
+        }
+        if (!_retries.empty()) {
+            wakeup = std::min(wakeup, nextRetry);
+        }
+        int timeout = std::max((wakeup - now + 999999) / 1000000, (int64_t)0);
+
+        int num = epoll_wait(_epollFd, events, MAX_EVENTS, timeout);
+        if (num < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            qCritical("epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < num; i++) {
+            handleEvent((Connection *)events[i].data.ptr, events[i].events);
+        }
+    }
+
+    for (auto &conn : _connections) {
+        closeConnection(conn.get());
+    }
+    close(_epollFd);
+    _epollFd = -1;
+}
+
+// Counts an error occurred in the measuring period
+void LoadWorker::countError(int64_t &counter)
+{
+    if (isMeasuring(nowNsecs())) {
+        counter++;
+    }
+}
+
+
+void LoadWorker::openConnection(Connection *conn)
+{
+    conn->fd = socket(_options.address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (conn->fd < 0) {
+        countError(_stats.connectErrors);
+        _retries.push_back(conn);
+        return;
+    }
+
+    int on = 1;
+    setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    conn->state = Connection::Connecting;
+    conn->maskKey = _random();
+
+    if (connect(conn->fd, (const sockaddr *)&_options.address, _options.addressLength) < 0 && errno != EINPROGRESS) {
+        countError(_stats.connectErrors);
+        closeConnection(conn);
+        _retries.push_back(conn);
+        return;
+    }
+
+    epoll_event ev {};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.ptr = conn;
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, conn->fd, &ev);
+    conn->writeWaiting = true;
+}
+
+
+void LoadWorker::closeConnection(Connection *conn)
+{
+    if (conn->fd >= 0) {
+        close(conn->fd);  // removed from the epoll too
+        conn->fd = -1;
+    }
+    conn->state = Connection::Connecting;
+    conn->writeWaiting = false;
+    conn->readBuffer.clear();
+    conn->writeBuffer.clear();
+    conn->sentTimes.clear();
+}
+
+
+void LoadWorker::reconnect(Connection *conn)
+{
+    closeConnection(conn);
+    if (isRunning(nowNsecs())) {
+        openConnection(conn);
+    }
+}
+
+
+void LoadWorker::handleEvent(Connection *conn, uint32_t events)
+{
+    if (conn->fd < 0) {
+        return;
+    }
+
+    if (conn->state == Connection::Connecting) {
+        int error = 0;
+        socklen_t len = sizeof(error);
+        getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &len);
+        if (error || (events & (EPOLLERR | EPOLLHUP))) {
+            countError(_stats.connectErrors);
+            closeConnection(conn);
+            _retries.push_back(conn);
+        } else if (events & EPOLLOUT) {
+            handleConnected(conn);
+        }
+        return;
+    }
+
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+        if (!readSocket(conn)) {
+            return;
+        }
+    }
+
+    if (events & EPOLLOUT) {
+        flush(conn);
+    }
+}
+
+
+void LoadWorker::handleConnected(Connection *conn)
+{
+    if (_options.webSocket) {
+        conn->state = Connection::Handshaking;
+        conn->writeBuffer += _request;
+    } else {
+        conn->state = Connection::Open;
+        int64_t now = nowNsecs();
+        for (int i = 0; i < _options.pipeline; i++) {
+            sendRequest(conn, now);
+        }
+    }
+    flush(conn);
+}
+
+// Returns false if the connection is closed
+bool LoadWorker::readSocket(Connection *conn)
+{
+    char buffer[READ_BUFFER_SIZE];
+    bool closed = false;
+
+    for (;;) {
+        ssize_t len = recv(conn->fd, buffer, sizeof(buffer), 0);
+        if (len > 0) {
+            conn->readBuffer.append(buffer, len);
+            if (isMeasuring(nowNsecs())) {
+                _stats.bytesRead += len;
+            }
+            if (len < (ssize_t)sizeof(buffer)) {
+                break;  // notified again if more
+            }
+        } else if (len == 0) {
+            closed = true;
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            countError(_stats.ioErrors);
+            reconnect(conn);
+            return false;
+        }
+    }
+
+    bool ok;
+    switch (conn->state) {
+    case Connection::Handshaking:
+        ok = parseHandshake(conn);
+        break;
+    case Connection::Open:
+        ok = (_options.webSocket) ? parseFrames(conn) : parseHttpResponses(conn);
+        break;
+    default:
+        ok = true;
+        break;
+    }
+
+    if (ok && closed) {
+        // Closed by the peer unexpectedly
+        if (_options.webSocket || !conn->sentTimes.empty() || conn->state != Connection::Open) {
+            countError(_stats.ioErrors);
+        }
+        reconnect(conn);
+        return false;
+    }
+    return ok;
+}
+
+// Returns false if the connection is closed
+bool LoadWorker::flush(Connection *conn)
+{
+    while (!conn->writeBuffer.isEmpty()) {
+        ssize_t len = send(conn->fd, conn->writeBuffer.constData(), conn->writeBuffer.size(), MSG_NOSIGNAL);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            countError(_stats.ioErrors);
+            reconnect(conn);
+            return false;
+        }
+        conn->writeBuffer.remove(0, len);
+    }
+
+    bool waiting = !conn->writeBuffer.isEmpty();
+    if (waiting != conn->writeWaiting) {
+        epoll_event ev {};
+        ev.events = EPOLLIN | (waiting ? EPOLLOUT : 0);
+        ev.data.ptr = conn;
+        epoll_ctl(_epollFd, EPOLL_CTL_MOD, conn->fd, &ev);
+        conn->writeWaiting = waiting;
+    }
+    return true;
+}
+
+// Parses the responses having a Content-Length header, not chunked ones
+bool LoadWorker::parseHttpResponses(Connection *conn)
+{
+    QByteArray &buf = conn->readBuffer;
+    const int64_t now = nowNsecs();
+
+    for (;;) {
+        int headerEnd = buf.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            if (buf.size() > MAX_HEADER_SIZE) {
+                countError(_stats.parseErrors);
+                reconnect(conn);
+                return false;
+            }
+            break;
+        }
+
+        if (!buf.startsWith("HTTP/1.") || headerEnd < 12 || conn->sentTimes.empty()) {
+            countError(_stats.parseErrors);
+            reconnect(conn);
+            return false;
+        }
+
+        int status = parseNumber(buf.constData() + 9, 3);
+        int64_t contentLength = 0;
+        QByteArray value = headerValue(buf.constData(), headerEnd, "content-length");
+        if (!value.isEmpty()) {
+            contentLength = value.toLongLong();
+        } else if (status != 204 && status != 304) {
+            countError(_stats.parseErrors);
+            reconnect(conn);
+            return false;
+        }
+
+        int64_t responseLength = headerEnd + 4 + contentLength;
+        if (buf.size() < responseLength) {
+            break;
+        }
+
+        bool close = (headerValue(buf.constData(), headerEnd, "connection").toLower() == "close");
+        buf.remove(0, responseLength);
+
+        int64_t sentTime = conn->sentTimes.front();
+        conn->sentTimes.pop_front();
+        if (isMeasuring(now)) {
+            _stats.latency.record(now - sentTime);
+            _stats.completed++;
+            if (status >= 400) {
+                _stats.statusErrors++;
+            }
+        }
+
+        if (close || !_options.keepAlive) {
+            reconnect(conn);
+            return false;
+        }
+
+        if (isRunning(now)) {
+            sendRequest(conn, now);
+        }
+    }
+    return flush(conn);
+}
+
+
+bool LoadWorker::parseHandshake(Connection *conn)
+{
+    QByteArray &buf = conn->readBuffer;
+    int headerEnd = buf.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (buf.size() > MAX_HEADER_SIZE) {
+            countError(_stats.parseErrors);
+            reconnect(conn);
+            return false;
+        }
+        return true;
+    }
+
+    if (!buf.startsWith("HTTP/1.1 101")) {
+        countError(_stats.statusErrors);
+        closeConnection(conn);
+        _retries.push_back(conn);
+        return false;
+    }
+
+    buf.remove(0, headerEnd + 4);
+    conn->state = Connection::Open;
+
+    if (_options.publishRate == 0) {
+        for (int i = 0; i < _options.pipeline; i++) {
+            sendMessage(conn, "echo ");
+        }
+    }
+    return parseFrames(conn);
+}
+
+// Parses the frames from the server, which are neither masked nor fragmented
+bool LoadWorker::parseFrames(Connection *conn)
+{
+    QByteArray &buf = conn->readBuffer;
+    int64_t pos = 0;
+
+    while (buf.size() - pos >= 2) {
+        const uchar *p = (const uchar *)buf.constData() + pos;
+        const int64_t available = buf.size() - pos;
+        const int opcode = p[0] & 0x0F;
+        int64_t length = p[1] & 0x7F;
+        int headerLength = 2;
+
+        if (!(p[0] & 0x80) || (p[1] & 0x80)) {
+            countError(_stats.parseErrors);
+            reconnect(conn);
+            return false;
+        }
+
+        if (length == 126) {
+            if (available < 4) {
+                break;
+            }
+            length = qFromBigEndian<quint16>(p + 2);
+            headerLength = 4;
+        } else if (length == 127) {
+            if (available < 10) {
+                break;
+            }
+            length = qFromBigEndian<quint64>(p + 2);
+            headerLength = 10;
+        }
+
+        if (available < headerLength + length) {
+            break;
+        }
+
+        const char *payload = (const char *)p + headerLength;
+        switch (opcode) {
+        case 0x1:  // text
+        case 0x2:  // binary
+            receiveMessage(conn, payload, length);
+            break;
+
+        case 0x8:  // close
+            countError(_stats.ioErrors);
+            reconnect(conn);
+            return false;
+
+        case 0x9:  // ping
+            sendFrame(conn, 0xA, payload, length);
+            break;
+
+        default:
+            break;
+        }
+        pos += headerLength + length;
+    }
+
+    buf.remove(0, pos);
+    return flush(conn);
+}
+
+// Receives an echoed or fanned-out message, which has the time sent
+void LoadWorker::receiveMessage(Connection *conn, const char *data, int64_t length)
+{
+    const int64_t now = nowNsecs();
+    bool echo = (length > 5 && memcmp(data, "echo ", 5) == 0);
+    bool pub = (length > 4 && memcmp(data, "pub ", 4) == 0);
+
+    if (!echo && !pub) {
+        countError(_stats.parseErrors);
+        return;
+    }
+
+    int prefixLength = (echo) ? 5 : 4;
+    int64_t sentTime = parseNumber(data + prefixLength, length - prefixLength);
+    if (isMeasuring(now)) {
+        _stats.latency.record(now - sentTime);
+        _stats.completed++;
+    }
+
+    if (echo && isRunning(now)) {
+        sendMessage(conn, "echo ");
+    }
+}
+
+
+void LoadWorker::sendRequest(Connection *conn, int64_t now)
+{
+    conn->writeBuffer += _request;
+    conn->sentTimes.push_back(now);
+}
+
+
+void LoadWorker::sendMessage(Connection *conn, const char *prefix)
+{
+    QByteArray text = QByteArray(prefix) + QByteArray::number((qint64)nowNsecs());
+    if (text.length() < _options.messageSize) {
+        text += QByteArray(_options.messageSize - text.length(), ' ');
+    }
+    sendFrame(conn, 0x1, text.constData(), text.length());
+}
+
+// Appends a masked frame to the write buffer
+void LoadWorker::sendFrame(Connection *conn, int opcode, const char *data, int64_t length)
+{
+    QByteArray &out = conn->writeBuffer;
+    uchar buf[8];
+
+    out.append((char)(0x80 | opcode));
+    if (length < 126) {
+        out.append((char)(0x80 | length));
+    } else if (length <= 0xFFFF) {
+        out.append((char)(0x80 | 126));
+        qToBigEndian<quint16>(length, buf);
+        out.append((const char *)buf, 2);
+    } else {
+        out.append((char)(0x80 | 127));
+        qToBigEndian<quint64>(length, buf);
+        out.append((const char *)buf, 8);
+    }
+
+    uchar mask[4];
+    qToBigEndian<quint32>(conn->maskKey, mask);
+    out.append((const char *)mask, 4);
+
+    int64_t offset = out.size();
+    out.append(data, length);
+    char *payload = out.data() + offset;
+    for (int64_t i = 0; i < length; i++) {
+        payload[i] ^= mask[i % 4];
+    }
+}
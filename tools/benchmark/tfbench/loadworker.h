@@ -0,0 +1,87 @@
+#pragma once
+#include "histogram.h"
+#include <QByteArray>
+#include <QThread>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <sys/socket.h>
+#include <vector>
+
+struct Connection;
+
+
+struct LoadOptions {
+    sockaddr_storage address {};
+    socklen_t addressLength {0};
+    QByteArray host;  // for the Host header
+    QByteArray path;
+    bool webSocket {false};
+    int pipeline {1};  // requests or messages in flight per connection
+    bool keepAlive {true};
+    int publishRate {0};  // fan-out messages per second, 0 for echo
+    int messageSize {0};
+    int64_t measureStart {0};  // nsecs of the monotonic clock
+    int64_t deadline {0};
+};
+
+
+struct LoadStats {
+    Histogram latency;  // nsecs
+    int64_t completed {0};
+    int64_t bytesRead {0};
+    int64_t connectErrors {0};
+    int64_t ioErrors {0};
+    int64_t statusErrors {0};
+    int64_t parseErrors {0};
+
+    void merge(const LoadStats &other);
+};
+
+
+inline int64_t nowNsecs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+class LoadWorker : public QThread {
+public:
+    LoadWorker(const LoadOptions &options, int connections, bool publisher);
+    ~LoadWorker();
+
+    const LoadStats &stats() const { return _stats; }
+
+protected:
+    void run() override;
+
+private:
+    bool isMeasuring(int64_t now) const { return now >= _options.measureStart && now < _options.deadline; }
+    bool isRunning(int64_t now) const { return now < _options.deadline; }
+    void countError(int64_t &counter);
+    void openConnection(Connection *conn);
+    void closeConnection(Connection *conn);
+    void reconnect(Connection *conn);
+    void handleEvent(Connection *conn, uint32_t events);
+    void handleConnected(Connection *conn);
+    bool readSocket(Connection *conn);
+    bool flush(Connection *conn);
+    bool parseHttpResponses(Connection *conn);
+    bool parseHandshake(Connection *conn);
+    bool parseFrames(Connection *conn);
+    void receiveMessage(Connection *conn, const char *data, int64_t length);
+    void sendRequest(Connection *conn, int64_t now);
+    void sendMessage(Connection *conn, const char *prefix);
+    void sendFrame(Connection *conn, int opcode, const char *data, int64_t length);
+
+    LoadOptions _options;
+    int _epollFd {-1};
+    std::vector<std::unique_ptr<Connection>> _connections;
+    std::vector<Connection *> _retries;
+    Connection *_publisher {nullptr};
+    QByteArray _request;
+    std::mt19937 _random;
+    LoadStats _stats;
+};
@@ -0,0 +1,359 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "loadworker.h"
+#include <QtCore>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <netdb.h>
+
+namespace {
+
+enum CommandOption {
+    Invalid = 0,
+    Connections,
+    Threads,
+    Duration,
+    Warmup,
+    Pipeline,
+    Close,
+    PublishRate,
+    MessageSize,
+    Name,
+    Label,
+    Output,
+    Compare,
+    Threshold,
+    PrintUsage,
+};
+
+const QMap<QString, int> options = {
+    {"-c", Connections},
+    {"-t", Threads},
+    {"-d", Duration},
+    {"-w", Warmup},
+    {"-p", Pipeline},
+    {"-r", PublishRate},
+    {"-s", MessageSize},
+    {"-n", Name},
+    {"-l", Label},
+    {"-o", Output},
+    {"-h", PrintUsage},
+    {"--close", Close},
+    {"--compare", Compare},
+    {"--threshold", Threshold},
+    {"--help", PrintUsage},
+};
+
+
+void usage()
+{
+    constexpr auto text = "Usage: %1 [options] url\n"
+                          "Usage: %1 --compare baseline-report current-report [--threshold percent]\n"
+                          "Generates the load of HTTP requests or WebSocket messages to the url,\n"
+                          "http://host:port/path or ws://host:port/path, and reports the rate and\n"
+                          "the latency percentiles.\n"
+                          "Options:\n"
+                          "  -c connections  : number of connections (default: 64)\n"
+                          "  -t threads      : number of threads (default: number of CPUs)\n"
+                          "  -d seconds      : duration of the measurement (default: 10)\n"
+                          "  -w seconds      : duration of the warmup not measured (default: 2)\n"
+                          "  -p depth        : requests or messages in flight per connection (default: 1)\n"
+                          "  --close         : close the connection after each response\n"
+                          "  -r rate         : publish messages per second to be fanned out to all the\n"
+                          "                    WebSocket connections, instead of echoing\n"
+                          "  -s bytes        : size of a WebSocket message\n"
+                          "  -n name         : name of the scenario in the report\n"
+                          "  -l label        : label of the report, such as a commit\n"
+                          "  -o file         : append the report as a line of JSON to the file\n"
+                          "  --threshold     : percent of the rate decrease or the 99th percentile\n"
+                          "                    increase regarded as a regression (default: 10)\n"
+                          "Type '%1 -h' to show this information.";
+
+    QString cmd = QFileInfo(QCoreApplication::applicationFilePath()).fileName();
+    std::printf("%s\n", qUtf8Printable(QString(text).arg(cmd)));
+}
+
+
+bool resolveAddress(const QUrl &url, LoadOptions &opts)
+{
+    const QByteArray host = url.host().toLatin1();
+    const QByteArray port = QByteArray::number(url.port(80));
+    addrinfo hints {};
+    addrinfo *result = nullptr;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int res = getaddrinfo(host.constData(), port.constData(), &hints, &result);
+    if (res != 0 || !result) {
+        std::fprintf(stderr, "Failed to resolve the host: %s  [%s]\n", host.data(), gai_strerror(res));
+        return false;
+    }
+
+    std::memcpy(&opts.address, result->ai_addr, result->ai_addrlen);
+    opts.addressLength = result->ai_addrlen;
+    freeaddrinfo(result);
+    return true;
+}
+
+
+QJsonObject report(const QString &name, const QString &label, const QUrl &url, const LoadOptions &opts, int threads, int connections, int duration, const LoadStats &stats)
+{
+    auto usecs = [](double nsecs) { return std::round(nsecs / 100.0) / 10.0; };
+    const Histogram &latency = stats.latency;
+    QString mode = (opts.webSocket) ? ((opts.publishRate > 0) ? "websocket-fanout" : "websocket-echo") : "http";
+
+    return QJsonObject {
+        {"name", name},
+        {"label", label},
+        {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"url", url.toString()},
+        {"mode", mode},
+        {"threads", threads},
+        {"connections", connections},
+        {"pipeline", opts.pipeline},
+        {"keepAlive", opts.keepAlive},
+        {"publishRate", opts.publishRate},
+        {"duration", duration},
+        {"completed", (double)stats.completed},
+        {"rate", std::round(stats.completed * 10.0 / duration) / 10.0},
+        {"bytesPerSec", std::round((double)stats.bytesRead / duration)},
+        {"errors", QJsonObject {
+            {"connect", (double)stats.connectErrors},
+            {"io", (double)stats.ioErrors},
+            {"status", (double)stats.statusErrors},
+            {"parse", (double)stats.parseErrors},
+        }},
+        {"latencyUsecs", QJsonObject {
+            {"min", usecs(latency.min())},
+            {"mean", usecs(latency.mean())},
+            {"p50", usecs(latency.percentile(50))},
+            {"p90", usecs(latency.percentile(90))},
+            {"p99", usecs(latency.percentile(99))},
+            {"p999", usecs(latency.percentile(99.9))},
+            {"max", usecs(latency.max())},
+        }},
+    };
+}
+
+
+void printReport(const QJsonObject &rep)
+{
+    const QJsonObject errors = rep["errors"].toObject();
+    const QJsonObject latency = rep["latencyUsecs"].toObject();
+
+    std::printf("%s  (%s, %d threads, %d connections, pipeline %d)\n", qUtf8Printable(rep["name"].toString()),
+        qUtf8Printable(rep["mode"].toString()), rep["threads"].toInt(), rep["connections"].toInt(), rep["pipeline"].toInt());
+    std::printf("  completed  : %.0f in %d secs\n", rep["completed"].toDouble(), rep["duration"].toInt());
+    std::printf("  rate       : %.1f /sec, %.0f bytes/sec\n", rep["rate"].toDouble(), rep["bytesPerSec"].toDouble());
+    std::printf("  latency    : min %.1f, mean %.1f, p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f usecs\n",
+        latency["min"].toDouble(), latency["mean"].toDouble(), latency["p50"].toDouble(), latency["p90"].toDouble(),
+        latency["p99"].toDouble(), latency["p999"].toDouble(), latency["max"].toDouble());
+    std::printf("  errors     : connect %.0f, io %.0f, status %.0f, parse %.0f\n", errors["connect"].toDouble(),
+        errors["io"].toDouble(), errors["status"].toDouble(), errors["parse"].toDouble());
+}
+
+// Reads the reports of a file, the last one of each name
+QMap<QString, QJsonObject> readReports(const QString &path)
+{
+    QMap<QString, QJsonObject> reports;
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "Failed to open the report: %s\n", qUtf8Printable(path));
+        return reports;
+    }
+
+    while (!file.atEnd()) {
+        QJsonObject rep = QJsonDocument::fromJson(file.readLine()).object();
+        if (!rep.isEmpty()) {
+            reports.insert(rep["name"].toString(), rep);
+        }
+    }
+    return reports;
+}
+
+// Compares the reports and returns the number of the regressions
+int compare(const QString &baselinePath, const QString &currentPath, double threshold)
+{
+    const QMap<QString, QJsonObject> baseline = readReports(baselinePath);
+    const QMap<QString, QJsonObject> current = readReports(currentPath);
+    int regressions = 0;
+
+    std::printf("%-32s %12s %12s %8s %10s %10s %8s\n", "scenario", "base rate", "rate", "diff", "base p99", "p99", "diff");
+    for (auto it = current.cbegin(); it != current.cend(); ++it) {
+        if (!baseline.contains(it.key())) {
+            std::printf("%-32s %12s\n", qUtf8Printable(it.key()), "(new)");
+            continue;
+        }
+
+        const QJsonObject &base = baseline[it.key()];
+        double baseRate = base["rate"].toDouble();
+        double rate = it.value()["rate"].toDouble();
+        double baseP99 = base["latencyUsecs"].toObject()["p99"].toDouble();
+        double p99 = it.value()["latencyUsecs"].toObject()["p99"].toDouble();
+        double rateDiff = (baseRate > 0) ? (rate - baseRate) * 100 / baseRate : 0;
+        double p99Diff = (baseP99 > 0) ? (p99 - baseP99) * 100 / baseP99 : 0;
+        bool regressed = (rateDiff < -threshold || p99Diff > threshold);
+
+        std::printf("%-32s %12.1f %12.1f %+7.1f%% %10.1f %10.1f %+7.1f%% %s\n", qUtf8Printable(it.key()),
+            baseRate, rate, rateDiff, baseP99, p99, p99Diff, (regressed ? "REGRESSION" : ""));
+        if (regressed) {
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+}  // namespace
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = QCoreApplication::arguments();
+    args.removeFirst();
+
+    int connections = 64;
+    int threads = std::max(QThread::idealThreadCount(), 1);
+    int duration = 10;
+    int warmup = 2;
+    double threshold = 10;
+    QString name, label, output;
+    QStringList compareFiles;
+    QUrl url;
+    LoadOptions opts;
+
+    while (!args.isEmpty()) {
+        QString arg = args.takeFirst();
+        int opt = options.value(arg, Invalid);
+        if (opt == Invalid && !arg.startsWith('-') && url.isEmpty()) {
+            url = QUrl(arg);
+            continue;
+        }
+
+        if (opt == Invalid || (opt != Close && opt != PrintUsage && args.isEmpty())) {
+            usage();
+            return 1;
+        }
+
+        switch (opt) {
+        case Connections:
+            connections = args.takeFirst().toInt();
+            break;
+        case Threads:
+            threads = args.takeFirst().toInt();
+            break;
+        case Duration:
+            duration = args.takeFirst().toInt();
+            break;
+        case Warmup:
+            warmup = args.takeFirst().toInt();
+            break;
+        case Pipeline:
+            opts.pipeline = args.takeFirst().toInt();
+            break;
+        case Close:
+            opts.keepAlive = false;
+            break;
+        case PublishRate:
+            opts.publishRate = args.takeFirst().toInt();
+            break;
+        case MessageSize:
+            opts.messageSize = args.takeFirst().toInt();
+            break;
+        case Name:
+            name = args.takeFirst();
+            break;
+        case Label:
+            label = args.takeFirst();
+            break;
+        case Output:
+            output = args.takeFirst();
+            break;
+        case Compare:
+            compareFiles << args.takeFirst();
+            if (args.isEmpty()) {
+                usage();
+                return 1;
+            }
+            compareFiles << args.takeFirst();
+            break;
+        case Threshold:
+            threshold = args.takeFirst().toDouble();
+            break;
+        default:
+            usage();
+            return (opt == PrintUsage) ? 0 : 1;
+        }
+    }
+
+    if (!compareFiles.isEmpty()) {
+        return (compare(compareFiles[0], compareFiles[1], threshold) > 0) ? 1 : 0;
+    }
+
+    const QString scheme = url.scheme().toLower();
+    if (!url.isValid() || url.host().isEmpty() || (scheme != "http" && scheme != "ws")) {
+        usage();
+        return 1;
+    }
+
+    if (connections < 1 || threads < 1 || duration < 1 || warmup < 0 || opts.pipeline < 1 || opts.publishRate < 0) {
+        std::fprintf(stderr, "Invalid option value\n");
+        return 1;
+    }
+
+    opts.webSocket = (scheme == "ws");
+    opts.host = url.host().toLatin1();
+    if (url.port() > 0) {
+        opts.host += ':' + QByteArray::number(url.port());
+    }
+    opts.path = url.path(QUrl::FullyEncoded).toLatin1();
+    if (opts.path.isEmpty()) {
+        opts.path = "/";
+    }
+    if (url.hasQuery()) {
+        opts.path += '?' + url.query(QUrl::FullyEncoded).toLatin1();
+    }
+    if (!opts.keepAlive) {
+        opts.pipeline = 1;  // a request per connection
+    }
+    if (!resolveAddress(url, opts)) {
+        return 1;
+    }
+
+    threads = std::min(threads, connections);
+    opts.measureStart = nowNsecs() + warmup * 1000000000LL;
+    opts.deadline = opts.measureStart + duration * 1000000000LL;
+
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    for (int i = 0; i < threads; i++) {
+        int num = connections / threads + ((i < connections % threads) ? 1 : 0);
+        workers.emplace_back(new LoadWorker(opts, num, (i == 0)));
+        workers.back()->start();
+    }
+
+    LoadStats stats;
+    for (auto &worker : workers) {
+        worker->wait();
+        stats.merge(worker->stats());
+    }
+
+    QJsonObject rep = report((name.isEmpty() ? url.toString() : name), label, url, opts, threads, connections, duration, stats);
+    printReport(rep);
+
+    if (!output.isEmpty()) {
+        QFile file(output);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            std::fprintf(stderr, "Failed to open the output: %s\n", qUtf8Printable(output));
+            return 1;
+        }
+        file.write(QJsonDocument(rep).toJson(QJsonDocument::Compact) + '\n');
+    }
+    return (stats.completed > 0) ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+TARGET   = tfbench
+TEMPLATE = app
+CONFIG  += console
+CONFIG  -= app_bundle
+QT      -= gui
+lessThan(QT_MAJOR_VERSION, 6) {
+  CONFIG += c++14
+} else {
+  CONFIG += c++17
+}
+
+DEFINES *= QT_USE_QSTRINGBUILDER
+
+!linux-* {
+  error("tfbench requires Linux")
+}
+
+SOURCES += main.cpp \
+           histogram.cpp \
+           loadworker.cpp
+
+HEADERS += histogram.h \
+           loadworker.h
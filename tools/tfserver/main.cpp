@@ -7,6 +7,7 @@
 
 #include "tdispatcher.h"
 #include "thazardptrmanager.h"
+#include "tmetrics.h"
 #include "tsystemglobal.h"
 #include <QMap>
 #include <QStringList>
@@ -318,6 +319,9 @@ int main(int argc, char *argv[])
     // Initialize cache
     webapp.initializeCache();
 
+    // Shares the metrics with the other servers
+    TMetrics::startPublishing();
+
     QObject::connect(&webapp, &QCoreApplication::aboutToQuit, [=]() { server->stop(); });
     ret = webapp.exec();
 
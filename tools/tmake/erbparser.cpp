@@ -7,6 +7,7 @@
 
 #include "erbparser.h"
 #include "erbconverter.h"
+#include <QRegularExpression>
 #include <THtmlParser>
 
 
@@ -24,6 +25,39 @@ static QString semicolonTrim(const QString &str)
 }
 
 
+// Splits the arguments at the last comma out of quotes and brackets
+static QPair<QString, QString> splitLastArgument(const QString &str)
+{
+    int depth = 0;
+    int comma = -1;
+    QChar quote;
+
+    for (int i = 0; i < str.length(); i++) {
+        QChar c = str[i];
+        if (!quote.isNull()) {
+            if (c == QLatin1Char('\\')) {
+                i++;
+            } else if (c == quote) {
+                quote = QChar();
+            }
+        } else if (c == QLatin1Char('"') || c == QLatin1Char('\'')) {
+            quote = c;
+        } else if (c == QLatin1Char('(') || c == QLatin1Char('[') || c == QLatin1Char('{')) {
+            depth++;
+        } else if (c == QLatin1Char(')') || c == QLatin1Char(']') || c == QLatin1Char('}')) {
+            depth--;
+        } else if (c == QLatin1Char(',') && depth == 0) {
+            comma = i;
+        }
+    }
+
+    if (comma < 0) {
+        return qMakePair(str.trimmed(), QString());
+    }
+    return qMakePair(str.left(comma).trimmed(), str.mid(comma + 1).trimmed());
+}
+
+
 static bool isAsciiString(const QString &str)
 {
     for (auto &c : str) {
@@ -191,6 +225,34 @@ void ErbParser::parsePercentTag()
             }
         }
 
+    } else if (c == QLatin1Char('@')) {  // <%@
+        startTag += c;
+        QPair<QString, QString> p = parseEndPercentTag();
+        str = semicolonTrim(p.first);
+        QString directive = str.section(QRegularExpression("[\\s(]"), 0, 0);
+
+        if (directive == QLatin1String("cache")) {
+            // Fragment cache block
+            QString params = str.mid(directive.length()).trimmed();
+            if (params.startsWith('(') && params.endsWith(')')) {
+                params = params.mid(1, params.length() - 2);
+            }
+            QPair<QString, QString> args = splitLastArgument(params);
+            if (args.second.isEmpty()) {
+                qCritical("Invalid cache directive, the key and seconds required: %s", qUtf8Printable(str));
+            }
+            srcCode += QLatin1String("tcache(");
+            srcCode += args.first;
+            srcCode += QLatin1String(", ");
+            srcCode += args.second;
+            srcCode += QLatin1String(") {\n");
+        } else if (directive == QLatin1String("endcache")) {
+            srcCode += QLatin1String("}\n");
+        } else {
+            qCritical("Unknown directive: %s", qUtf8Printable(str));
+            srcCode += QLatin1Char('\n');
+        }
+
     } else {  // <%
         --pos;
         QPair<QString, QString> p = parseEndPercentTag();
@@ -226,7 +288,7 @@ QPair<QString, QString> ErbParser::parseEndPercentTag()
                     skipWhiteSpacesAndNewLineCode();
 
             } else if (trimMode == NormalTrim || trimMode == StrongTrim) {  // NormalTrim:1
-                if (startTag == QLatin1String("<%") || startTag.startsWith("<%#")) {
+                if (startTag == QLatin1String("<%") || startTag.startsWith("<%#") || startTag == QLatin1String("<%@")) {
                     skipWhiteSpacesAndNewLineCode();
                 }
 
@@ -277,6 +277,12 @@ void TestTfpconverter::erbparse_data()
                         << "  responsebody += QStringLiteral(\"<body><script>function() { return '\\\\n'; }</script></body>\");\n";
     QTest::newRow("26") << "<body><script>function() { return \"\\n\"; }</script></body>"
                         << "  responsebody += QStringLiteral(\"<body><script>function() { return \\\"\\\\n\\\"; }</script></body>\");\n";
+
+    /** Fragment cache **/
+    QTest::newRow("27") << "<body><%@cache \"side:\" + QString::number(id, 10), 60 %>\n<%= name %><%@endcache %>\n</body>"
+                        << "  responsebody += QStringLiteral(\"<body>\");\n  tcache(\"side:\" + QString::number(id, 10), 60) {\n  responsebody += THttpUtility::htmlEscape(name);\n  }\n  responsebody += QStringLiteral(\"</body>\");\n";
+    QTest::newRow("28") << "<body><%@cache(key, 3600)%><%@endcache%></body>"
+                        << "  responsebody += QStringLiteral(\"<body>\");\n  tcache(key, 3600) {\n  }\n  responsebody += QStringLiteral(\"</body>\");\n";
 }
 
 
@@ -1,2 +1,5 @@
 TEMPLATE=subdirs
 SUBDIRS=tfmanager tfserver tmake tspawn
+
+benchmark.commands = $$PWD/benchmark/benchmark
+QMAKE_EXTRA_TARGETS += benchmark
@@ -36,7 +36,7 @@ constexpr auto CONTROLLER_SOURCE_FILE_TEMPLATE = "#include \"api%name%controller
                                                  "\n\n"
                                                  "void Api%clsname%Controller::index()\n"
                                                  "{\n"
-                                                 "    auto json = service.index();\n"
+                                                 "    auto json = service.index(request());\n"
                                                  "    renderJson(json);\n"
                                                  "}\n"
                                                  "\n"
@@ -18,13 +18,14 @@
 constexpr auto SERVICE_HEADER_FILE_TEMPLATE = "#pragma once\n"
                                               "#include <TGlobal>\n"
                                               "#include <QJsonObject>\n"
+                                              "#include <TJsonWriter>\n"
                                               "\n"
                                               "class THttpRequest;\n"
                                               "class TSession;\n"
                                               "\n\n"
                                               "class T_MODEL_EXPORT Api%clsname%Service {\n"
                                               "public:\n"
-                                              "    QJsonObject index();\n"
+                                              "    TJsonWriter index(THttpRequest &request);\n"
                                               "    QJsonObject get(%arg%);\n"
                                               "    QJsonObject create(THttpRequest &request);\n"
                                               "    QJsonObject save(THttpRequest &request, %arg%);\n"
@@ -35,12 +36,49 @@ constexpr auto SERVICE_HEADER_FILE_TEMPLATE = "#pragma once\n"
 
 constexpr auto SERVICE_SOURCE_FILE_TEMPLATE = "#include \"api%name%service.h\"\n"
                                               "#include \"objects/%name%.h\"\n"
+                                              "#include \"sqlobjects/%name%object.h\"\n"
                                               "#include <TreeFrogModel>\n"
+                                              "#include <TPaginator>\n"
+                                              "\n"
+                                              "constexpr int ITEMS_PER_PAGE = 100;\n"
                                               "\n\n"
-                                              "QJsonObject Api%clsname%Service::index()\n"
+                                              "TJsonWriter Api%clsname%Service::index(THttpRequest &request)\n"
                                               "{\n"
-                                              "    auto %varname%List = %clsname%::getAll();\n"
-                                              "    QJsonObject json = {{\"data\", tfConvertToJsonArray(%varname%List)}};\n"
+                                              "    TJsonWriter json;\n"
+                                              "    json.beginObject();\n"
+                                              "\n"
+                                              "    // Keyset pagination with the cursor of the previous page\n"
+                                              "    bool ok = true;\n"
+                                              "    QVariantList keys;\n"
+                                              "    QByteArray cursor = request.queryItemValue(\"cursor\").toLatin1();\n"
+                                              "    if (!cursor.isEmpty()) {\n"
+                                              "        keys = TPaginator::decodeCursor(cursor, &ok);\n"
+                                              "    }\n"
+                                              "    if (!ok) {\n"
+                                              "        json.writeKey(QLatin1String(\"error\"));\n"
+                                              "        json.writeJsonObject(QJsonObject({{\"message\", \"Invalid cursor\"}}));\n"
+                                              "        json.endObject();\n"
+                                              "        return json;\n"
+                                              "    }\n"
+                                              "\n"
+                                              "    TSqlORMapper<%clsname%Object> mapper;\n"
+                                              "    mapper.keyset(keys).limit(ITEMS_PER_PAGE);\n"
+                                              "    QList<%clsname%> %varname%List;\n"
+                                              "    if (mapper.find() > 0) {\n"
+                                              "        for (auto &obj : mapper) {\n"
+                                              "            %varname%List << %clsname%(obj);\n"
+                                              "        }\n"
+                                              "    }\n"
+                                              "\n"
+                                              "    json.writeKey(QLatin1String(\"data\"));\n"
+                                              "    json.writeModelList(%varname%List);\n"
+                                              "    json.writeKey(QLatin1String(\"next_cursor\"));\n"
+                                              "    if (%varname%List.count() == ITEMS_PER_PAGE) {\n"
+                                              "        json.writeString(QString::fromLatin1(TPaginator::encodeCursor(mapper.keysetValues(mapper.last()))));\n"
+                                              "    } else {\n"
+                                              "        json.writeNull();\n"
+                                              "    }\n"
+                                              "    json.endObject();\n"
                                               "    return json;\n"
                                               "}\n"
                                               "\n"
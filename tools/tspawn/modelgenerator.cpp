@@ -13,6 +13,7 @@
 #include "sqlobjgenerator.h"
 #include "util.h"
 #include <tfnamespace.h>
+#include <QCryptographicHash>
 
 constexpr auto USER_VIRTUAL_METHOD = "identityKey";
 constexpr auto LOCK_REVISION_FIELD = "lockRevision";
@@ -145,18 +146,24 @@ constexpr auto MODEL_IMPL_TEMPLATE = "#include <TreeFrogModel>\n"
                                      "    return d.data();\n"
                                      "}\n"
                                      "\n"
+                                     "// Version of the fields encoded, updated by tspawn\n"
+                                     "constexpr quint32 SCHEMA_VERSION = %schema%;\n"
+                                     "\n"
                                      "QDataStream &operator<<(QDataStream &ds, const %model% &model)\n"
                                      "{\n"
-                                     "    auto varmap = model.toVariantMap();\n"
-                                     "    ds << varmap;\n"
+                                     "    TModelEncoder encoder(ds, SCHEMA_VERSION);\n"
+                                     "%encodeImpl%"
                                      "    return ds;\n"
                                      "}\n"
                                      "\n"
                                      "QDataStream &operator>>(QDataStream &ds, %model% &model)\n"
                                      "{\n"
-                                     "    QVariantMap varmap;\n"
-                                     "    ds >> varmap;\n"
-                                     "    model.setProperties(varmap);\n"
+                                     "    TModelDecoder decoder(ds, SCHEMA_VERSION);\n"
+                                     "    if (decoder.isLegacy()) {\n"
+                                     "        model.setProperties(decoder.legacyValues());\n"
+                                     "    } else {\n"
+                                     "%decodeImpl%"
+                                     "    }\n"
                                      "    return ds;\n"
                                      "}\n"
 #if QT_VERSION < 0x060000
@@ -314,18 +321,24 @@ constexpr auto USER_MODEL_IMPL_TEMPLATE = "#include <TreeFrogModel>\n"
                                           "    return d.data();\n"
                                           "}\n"
                                           "\n"
+                                          "// Version of the fields encoded, updated by tspawn\n"
+                                          "constexpr quint32 SCHEMA_VERSION = %schema%;\n"
+                                          "\n"
                                           "QDataStream &operator<<(QDataStream &ds, const %model% &model)\n"
                                           "{\n"
-                                          "    auto varmap = model.toVariantMap();\n"
-                                          "    ds << varmap;\n"
+                                          "    TModelEncoder encoder(ds, SCHEMA_VERSION);\n"
+                                          "%encodeImpl%"
                                           "    return ds;\n"
                                           "}\n"
                                           "\n"
                                           "QDataStream &operator>>(QDataStream &ds, %model% &model)\n"
                                           "{\n"
-                                          "    QVariantMap varmap;\n"
-                                          "    ds >> varmap;\n"
-                                          "    model.setProperties(varmap);\n"
+                                          "    TModelDecoder decoder(ds, SCHEMA_VERSION);\n"
+                                          "    if (decoder.isLegacy()) {\n"
+                                          "        model.setProperties(decoder.legacyValues());\n"
+                                          "    } else {\n"
+                                          "%decodeImpl%"
+                                          "    }\n"
                                           "    return ds;\n"
                                           "}\n"
 #if QT_VERSION < 0x060000
@@ -484,6 +497,7 @@ QStringList ModelGenerator::genUserModel(const QString &dstDir, const QString &u
 QPair<PlaceholderList, PlaceholderList> ModelGenerator::createModelParams()
 {
     QString setgetDecl, setgetImpl, crtparams, getOptDecl, getOptImpl;
+    QString encodeImpl, decodeImpl, schema;
     QList<QPair<QString, QString>> writableFields;
     bool optlockMethod = false;
     FieldList fields = objGen->fieldList();
@@ -503,6 +517,13 @@ QPair<PlaceholderList, PlaceholderList> ModelGenerator::createModelParams()
         if (type.isEmpty())
             continue;
 
+        // Binary stream of the fields in order
+        encodeImpl += (encodeImpl.isEmpty()) ? "    encoder << " : "\n            << ";
+        encodeImpl += "model.d->" + p.first;
+        decodeImpl += (decodeImpl.isEmpty()) ? "        decoder >> " : "\n                >> ";
+        decodeImpl += "model.d->" + p.first;
+        schema += p.first + ':' + type + ',';
+
         // Getter method
         setgetDecl += QString("    %1 %2() const;\n").arg(type, var);
         setgetImpl += QString("%1 %2::%3() const\n{\n    return d->%4;\n}\n\n").arg(type, modelName, var, p.first);
@@ -526,6 +547,13 @@ QPair<PlaceholderList, PlaceholderList> ModelGenerator::createModelParams()
     }
     crtparams.chop(2);
 
+    if (!encodeImpl.isEmpty()) {
+        encodeImpl += ";\n";
+        decodeImpl += ";\n";
+    }
+    QByteArray hash = QCryptographicHash::hash(schema.toUtf8(), QCryptographicHash::Sha1);
+    QString schemaVersion = QLatin1String("0x") + QString::fromLatin1(hash.left(4).toHex());
+
     if (crtparams.isEmpty()) {
         crtparams += "const QString &";
     }
@@ -622,7 +650,10 @@ QPair<PlaceholderList, PlaceholderList> ModelGenerator::createModelParams()
              << pair("7", getparams)
              << pair("8", getImpl)
              << pair("10", getOptImpl)
-             << pair("11", ((objectType == Mongo) ? "Mongo" : ""));
+             << pair("11", ((objectType == Mongo) ? "Mongo" : ""))
+             << pair("schema", schemaVersion)
+             << pair("encodeImpl", encodeImpl)
+             << pair("decodeImpl", decodeImpl);
 
     headerList << pair("7", "class QJsonArray;\n")
                << pair("8", "    static QJsonArray getAllJson(const QStringList &properties = QStringList());\n");